@@ -0,0 +1,110 @@
+/**
+ * @file AdvertisingScheduler.cpp
+ * @brief Implementation of the advertising scheduler
+ */
+
+#include "AdvertisingScheduler.h"
+#include <cstring>
+
+// Indexed by AdvertisingPhase (ADV_FAST, ADV_SLOW)
+static const AdvertisingParams PHASE_PARAMS[2] = {
+    {32, 48},       // Fast: 20-30 ms
+    {1636, 1636},   // Slow: 1022.5 ms
+};
+
+AdvertisingScheduler::AdvertisingScheduler()
+    : phase(ADV_IDLE), bonded(false), idleStopMs(0), startMs(0), phaseStartMs(0) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+const AdvertisingParams& AdvertisingScheduler::getPhaseParams(AdvertisingPhase phase) {
+    return PHASE_PARAMS[phase == ADV_SLOW ? 1 : 0];
+}
+
+void AdvertisingScheduler::setIdleStop(uint32_t idleStopMs) {
+    this->idleStopMs = idleStopMs > ADV_MAX_DURATION_MS ? ADV_MAX_DURATION_MS : idleStopMs;
+}
+
+/**
+ * @brief Add the time spent in the current phase to its counter
+ */
+void AdvertisingScheduler::endPhase(uint32_t nowMs) {
+    if (phase == ADV_FAST) {
+        stats.fastMs += nowMs - phaseStartMs;
+    } else if (phase == ADV_SLOW) {
+        stats.slowMs += nowMs - phaseStartMs;
+    }
+}
+
+void AdvertisingScheduler::start(uint32_t nowMs) {
+    endPhase(nowMs);
+    phase = ADV_FAST;
+    startMs = nowMs;
+    phaseStartMs = nowMs;
+    stats.starts++;
+}
+
+bool AdvertisingScheduler::phaseEnded(uint32_t nowMs) {
+    endPhase(nowMs);
+    phaseStartMs = nowMs;
+    if (phase == ADV_FAST) {
+        phase = ADV_SLOW;
+        return true;
+    }
+    if (phase == ADV_SLOW) {
+        phase = ADV_STOPPED;
+        stats.idleStops++;
+    }
+    return false;
+}
+
+void AdvertisingScheduler::connected(uint32_t nowMs) {
+    if (!isAdvertising()) {
+        phase = ADV_CONNECTED;
+        return;
+    }
+    endPhase(nowMs);
+    uint32_t connectMs = nowMs - startMs;
+    if (phase == ADV_FAST) {
+        stats.fastConnections++;
+    } else {
+        stats.slowConnections++;
+    }
+    stats.lastConnectMs = connectMs;
+    stats.totalConnectMs += connectMs;
+    if (connectMs > stats.maxConnectMs) {
+        stats.maxConnectMs = connectMs;
+    }
+    phase = ADV_CONNECTED;
+}
+
+bool AdvertisingScheduler::wake(uint32_t nowMs) {
+    if (phase != ADV_STOPPED) {
+        return false;
+    }
+    start(nowMs);
+    return true;
+}
+
+/**
+ * @brief Duration of the current phase
+ * 
+ * Fast advertising always ends after ADV_FAST_DURATION_MS. Slow
+ * advertising only ends when a phone is bonded (it reconnects after a
+ * wake) and an idle stop is set; otherwise an unbonded phone could never
+ * find the device again.
+ */
+uint32_t AdvertisingScheduler::getPhaseDurationMs() const {
+    if (phase == ADV_FAST) {
+        return ADV_FAST_DURATION_MS;
+    }
+    if (phase == ADV_SLOW && bonded) {
+        return idleStopMs;
+    }
+    return 0;
+}
+
+uint32_t AdvertisingScheduler::getMeanConnectMs() const {
+    uint32_t connections = stats.fastConnections + stats.slowConnections;
+    return connections ? stats.totalConnectMs / connections : 0;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file AdvertisingScheduler.h
+ * @brief Chooses the BLE advertising interval and measures time to connect
+ * 
+ * Advertising at one fixed interval trades reconnect latency against
+ * current for as long as nobody connects. The scheduler splits it into
+ * phases instead:
+ * - ADV_FAST: 20-30 ms for ADV_FAST_DURATION_MS after boot or a
+ *   disconnect, when a phone is most likely nearby and scanning
+ * - ADV_SLOW: 1022.5 ms afterwards, until a connection
+ * - ADV_STOPPED: optional; once bonded, slow advertising ends after the
+ *   idle stop time and resumes (fast) at the next wake(), e.g. a detection
+ *   worth reporting
+ * 
+ * Intervals follow the Apple accessory guidelines (20 ms for the first
+ * 30 s, then one of the listed longer values), which phones scan for.
+ * 
+ * Each phase has a duration that the stack enforces (the advertising set
+ * ends on its own, see phaseEnded()), so no timer runs here. The time
+ * from the start of advertising to the connection is recorded per phase,
+ * together with the time spent advertising in each phase, to balance
+ * reconnect latency against current draw.
+ * 
+ * Advertising intervals are in 0.625 ms units, as on the air.
+ */
+
+#ifndef ADVERTISING_SCHEDULER_H
+#define ADVERTISING_SCHEDULER_H
+
+#include <cstdint>
+
+const uint32_t ADV_FAST_DURATION_MS = 30000;    // Fast advertising after boot or a disconnect
+const uint32_t ADV_MAX_DURATION_MS = 655350;    // Longest phase the stack can time (10 ms units)
+
+/**
+ * @enum AdvertisingPhase
+ * @brief Advertising state
+ */
+enum AdvertisingPhase {
+    ADV_FAST = 0,       // Short interval after boot or a disconnect
+    ADV_SLOW,           // Long interval until a connection
+    ADV_STOPPED,        // Bonded and idle, waiting for wake()
+    ADV_CONNECTED,      // Not advertising, a connection is open
+    ADV_IDLE            // Not started yet
+};
+
+/**
+ * @struct AdvertisingParams
+ * @brief Advertising interval of a phase
+ */
+struct AdvertisingParams {
+    uint16_t minInterval;       // Shortest interval (0.625 ms units)
+    uint16_t maxInterval;       // Longest interval (0.625 ms units)
+};
+
+/**
+ * @struct AdvertisingStats
+ * @brief Advertising and time-to-connect counters
+ */
+struct AdvertisingStats {
+    uint32_t starts;            // Advertising started (boot, disconnect, wake)
+    uint32_t fastConnections;   // Connections during fast advertising
+    uint32_t slowConnections;   // Connections during slow advertising
+    uint32_t idleStops;         // Advertising stopped while bonded and idle
+    uint32_t lastConnectMs;     // Time to connect of the latest connection (ms)
+    uint32_t maxConnectMs;      // Longest time to connect (ms)
+    uint32_t totalConnectMs;    // Sum of the times to connect (ms)
+    uint32_t fastMs;            // Time spent advertising fast (ms)
+    uint32_t slowMs;            // Time spent advertising slow (ms)
+};
+
+/**
+ * @class AdvertisingScheduler
+ * @brief Tracks the advertising phase and the time to connect
+ */
+class AdvertisingScheduler {
+public:
+    AdvertisingScheduler();
+    
+    /**
+     * @brief Interval of an advertising phase
+     * @param phase ADV_FAST or ADV_SLOW
+     */
+    static const AdvertisingParams& getPhaseParams(AdvertisingPhase phase);
+    
+    /**
+     * @brief Stop slow advertising after a while once bonded
+     * 
+     * Takes effect at the next slow phase.
+     * 
+     * @param idleStopMs Slow advertising time before stopping (ms, 0 = never,
+     *                   at most ADV_MAX_DURATION_MS)
+     */
+    void setIdleStop(uint32_t idleStopMs);
+    
+    /**
+     * @brief Whether a phone is bonded (only then may advertising stop)
+     */
+    void setBonded(bool bonded) { this->bonded = bonded; }
+    
+    /**
+     * @brief Start advertising fast (boot or disconnect)
+     * @param nowMs Current time (ms), starts the time to connect
+     */
+    void start(uint32_t nowMs);
+    
+    /**
+     * @brief The stack ended the current phase (its duration ran out)
+     * 
+     * Moves from ADV_FAST to ADV_SLOW and from ADV_SLOW to ADV_STOPPED.
+     * 
+     * @param nowMs Current time (ms)
+     * @return true if advertising continues in the new phase
+     */
+    bool phaseEnded(uint32_t nowMs);
+    
+    /**
+     * @brief A connection was opened; records the time to connect
+     * @param nowMs Current time (ms)
+     */
+    void connected(uint32_t nowMs);
+    
+    /**
+     * @brief Resume advertising if it was stopped
+     * @param nowMs Current time (ms)
+     * @return true if advertising restarts (fast)
+     */
+    bool wake(uint32_t nowMs);
+    
+    /**
+     * @brief Duration of the current phase, for the stack to enforce
+     * @return Duration (ms, 0 = until a connection)
+     */
+    uint32_t getPhaseDurationMs() const;
+    
+    AdvertisingPhase getPhase() const { return phase; }
+    bool isAdvertising() const { return phase == ADV_FAST || phase == ADV_SLOW; }
+    bool isBonded() const { return bonded; }
+    const AdvertisingStats& getStats() const { return stats; }
+    
+    /**
+     * @brief Mean time from the start of advertising to a connection
+     * @return Mean (ms), 0 before the first connection
+     */
+    uint32_t getMeanConnectMs() const;
+    
+private:
+    AdvertisingPhase phase;     // Current phase
+    bool bonded;                // A phone is bonded
+    uint32_t idleStopMs;        // Slow advertising before stopping (ms, 0 = never)
+    uint32_t startMs;           // When advertising started (ms)
+    uint32_t phaseStartMs;      // When the current phase started (ms)
+    AdvertisingStats stats;     // Counters
+    
+    void endPhase(uint32_t nowMs);
+};
+
+#endif
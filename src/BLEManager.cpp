@@ -7,6 +7,9 @@
  */
 
 #include "BLEManager.h"
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
 #ifdef MBED_OS
 #include "ble/BLE.h"
 #include "ble/Gap.h"
@@ -17,40 +20,77 @@
 #include "ble/gap/AdvertisingDataSimpleBuilder.h"
 #include "ble/gap/AdvertisingParameters.h"
 #include "ble/common/BLETypes.h"
+#include <chrono>
 #endif
 
+static const char* const ADV_PHASE_NAMES[] = {"fast", "slow", "stopped", "connected", "idle"};
+
 /**
  * @brief Constructor - Initialize BLE manager
  * 
  * Initializes all characteristic values to zero.
  */
-BLEManager::BLEManager() : initialized(false), simulationMode(false) {
+BLEManager::BLEManager() : initialized(false), simulationMode(false), nextSequence(0),
+    pendingCount(0), resultsRefused(false), batchRecords(1), batchDelayMs(0), attMtu(ATT_DEFAULT_MTU),
+    notifyInFlight(0), notifyBudget(NOTIFY_BUFFERS), deltaByte(0), keepAliveMs(0), haveSent(false), featureNotify(false), streaming(false), streamBuffered(0),
+    streamRefused(false), streamChannels(3), streamRateHz(0), streamSequence(0),
+    history(historyStorage, RESULT_RECORD_SIZE, HISTORY_RECORDS), bulkServer(history),
+    bulkEnabled(false), bulkRefused(false), eventCallback(nullptr) {
     tremorStatus = 0;
     tremorIntensityByte = 0;
     dyskinesiaStatus = 0;
     dyskinesiaIntensityByte = 0;
     fogStatus = 0;
     fogIntensityByte = 0;
+    memset(&lastRecord, 0, sizeof(lastRecord));
+    memset(resultValue, 0, sizeof(resultValue));
+    memset(&stats, 0, sizeof(stats));
+    memset(&lastSent, 0, sizeof(lastSent));
+    memset(&lastFeatures, 0, sizeof(lastFeatures));
+    memset(featureValue, 0, sizeof(featureValue));
+    memset(streamValue, 0, sizeof(streamValue));
+    memset(&streamStats, 0, sizeof(streamStats));
+    memset(bulkControlValue, 0, sizeof(bulkControlValue));
+    memset(bulkDataValue, 0, sizeof(bulkDataValue));
+    clock.start();
     #ifdef MBED_OS
     ble = nullptr;
+    connectionHandle = 0;
+    resultNotify = false;
     tremorChar = nullptr;
     dyskinesiaChar = nullptr;
     fogChar = nullptr;
+    resultChar = nullptr;
+    rawStreamChar = nullptr;
+    bulkControlChar = nullptr;
+    bulkDataChar = nullptr;
+    featureChar = nullptr;
     symptomService = nullptr;
+    #else
+    gattSim = nullptr;
+    manualClock = false;
+    manualClockMs = 0;
     #endif
 }
 
+void BLEManager::setEventCallback(BleEventCallback callback) {
+    eventCallback = callback;
+}
+
 /**
  * @brief Initialize BLE and create GATT service/characteristics
  * 
  * Initialization steps:
- * 1. Initialize BLE stack
- * 2. Set device name and advertising parameters
+ * 1. Initialize BLE stack (events processed here until it is up)
+ * 2. Set device name
  * 3. Create UUIDs for service and characteristics
- * 4. Create three characteristics (tremor, dyskinesia, FOG)
+ * 4. Create the status characteristics (tremor, dyskinesia, FOG), the
+ *    packed result characteristic, the raw IMU stream characteristic and
+ *    the bulk transfer control and data characteristics and the
+ *    spectral feature characteristic
  * 5. Create service containing all characteristics
  * 6. Add service to GATT server
- * 7. Start BLE advertising
+ * 7. Start BLE advertising (fast phase)
  * 
  * @return true if initialization successful, false otherwise
  */
@@ -62,6 +102,10 @@ bool BLEManager::begin() {
         BLE* bleInstance = &BLE::Instance();
         this->ble = static_cast<void*>(bleInstance);
         
+        // The stack signals pending events instead of being polled; the
+        // handler must be registered before init()
+        bleInstance->onEventsToProcess(makeFunctionPointer(this, &BLEManager::onEventsToProcess));
+        
         // Initialize BLE stack
         ble_error_t error = bleInstance->init();
         if (error != BLE_ERROR_NONE) {
@@ -69,16 +113,19 @@ bool BLEManager::begin() {
             return false;
         }
         
-        // Configure GAP (Generic Access Profile) parameters
-        // Set advertising parameters (connectable, undirected)
-        AdvertisingParameters advParams;
-        advParams.setType(advertising_type_t::CONNECTABLE_UNDIRECTED);
-        error = bleInstance->gap().setAdvertisingParameters(LEGACY_ADVERTISING_HANDLE, advParams);
-        if (error != BLE_ERROR_NONE) {
-            printf("Failed to set advertising parameters: %d\r\n", error);
+        // init() completes through stack events; the scheduler does not
+        // dispatch yet, so process them here
+        for (int waitedMs = 0; !bleInstance->hasInitialized() && waitedMs < BLE_INIT_TIMEOUT_MS; waitedMs++) {
+            bleInstance->processEvents();
+            thread_sleep_for(1);
+        }
+        if (!bleInstance->hasInitialized()) {
+            printf("BLE initialization timed out\r\n");
             return false;
         }
         
+        // Configure GAP (Generic Access Profile) parameters; the advertising
+        // parameters are set per phase by startAdvertising()
         // Set advertising payload with device name
         error = bleInstance->gap().setAdvertisingPayload(
             LEGACY_ADVERTISING_HANDLE,
@@ -98,27 +145,42 @@ bool BLEManager::begin() {
         UUID::LongUUIDBytes_t tremorUUIDBytes;
         UUID::LongUUIDBytes_t dyskinesiaUUIDBytes;
         UUID::LongUUIDBytes_t fogUUIDBytes;
+        UUID::LongUUIDBytes_t resultUUIDBytes;
+        UUID::LongUUIDBytes_t rawStreamUUIDBytes;
+        UUID::LongUUIDBytes_t bulkControlUUIDBytes;
+        UUID::LongUUIDBytes_t bulkDataUUIDBytes;
+        UUID::LongUUIDBytes_t featureUUIDBytes;
         
         // Copy UUID arrays
         memcpy(serviceUUIDBytes, SERVICE_UUID, 16);
         memcpy(tremorUUIDBytes, TREMOR_CHAR_UUID, 16);
         memcpy(dyskinesiaUUIDBytes, DYSKINESIA_CHAR_UUID, 16);
         memcpy(fogUUIDBytes, FOG_CHAR_UUID, 16);
+        memcpy(resultUUIDBytes, RESULT_CHAR_UUID, 16);
+        memcpy(rawStreamUUIDBytes, RAW_STREAM_CHAR_UUID, 16);
+        memcpy(bulkControlUUIDBytes, BULK_CONTROL_CHAR_UUID, 16);
+        memcpy(bulkDataUUIDBytes, BULK_DATA_CHAR_UUID, 16);
+        memcpy(featureUUIDBytes, FEATURE_CHAR_UUID, 16);
         
         UUID serviceUUID(serviceUUIDBytes, UUID::MSB);
         UUID tremorUUID(tremorUUIDBytes, UUID::MSB);
         UUID dyskinesiaUUID(dyskinesiaUUIDBytes, UUID::MSB);
         UUID fogUUID(fogUUIDBytes, UUID::MSB);
+        UUID resultUUID(resultUUIDBytes, UUID::MSB);
+        UUID rawStreamUUID(rawStreamUUIDBytes, UUID::MSB);
+        UUID bulkControlUUID(bulkControlUUIDBytes, UUID::MSB);
+        UUID bulkDataUUID(bulkDataUUIDBytes, UUID::MSB);
+        UUID featureUUID(featureUUIDBytes, UUID::MSB);
         
-        // Create characteristics (readable and notifiable)
+        // Create status characteristics (read only: the result record
+        // characteristic notifies the same state)
         // Each characteristic stores 1 byte: detection status (0 or 1)
         GattCharacteristic* tremorCharPtr = new GattCharacteristic(
             tremorUUID,              // Characteristic UUID
             &tremorStatus,           // Initial value pointer
             1,                       // Current length (bytes)
             1,                       // Maximum length (bytes)
-            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ |   // Can be read
-            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY   // Can send notifications
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ     // Can be read
         );
         this->tremorChar = static_cast<void*>(tremorCharPtr);
         
@@ -127,8 +189,7 @@ bool BLEManager::begin() {
             &dyskinesiaStatus,
             1,
             1,
-            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | 
-            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ
         );
         this->dyskinesiaChar = static_cast<void*>(dyskinesiaCharPtr);
         
@@ -137,14 +198,72 @@ bool BLEManager::begin() {
             &fogStatus,
             1,
             1,
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ
+        );
+        this->fogChar = static_cast<void*>(fogCharPtr);
+        
+        // Packed result records: the only characteristic written with a
+        // notification. Variable length, one or more records per value
+        GattCharacteristic* resultCharPtr = new GattCharacteristic(
+            resultUUID,
+            resultValue,
+            RESULT_RECORD_SIZE,
+            MAX_NOTIFY_PAYLOAD,
             GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | 
             GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY
         );
-        this->fogChar = static_cast<void*>(fogCharPtr);
+        this->resultChar = static_cast<void*>(resultCharPtr);
         
-        // Create service containing all three characteristics
-        GattCharacteristic* characteristics[] = {tremorCharPtr, dyskinesiaCharPtr, fogCharPtr};
-        GattService* servicePtr = new GattService(serviceUUID, characteristics, 3);
+        // Raw IMU stream: notify only, subscribing starts the stream
+        GattCharacteristic* rawStreamCharPtr = new GattCharacteristic(
+            rawStreamUUID,
+            streamValue,
+            IMU_STREAM_HEADER_SIZE,
+            MAX_NOTIFY_PAYLOAD,
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY
+        );
+        this->rawStreamChar = static_cast<void*>(rawStreamCharPtr);
+        
+        // Bulk history transfer: the phone writes REQUEST/CREDIT/ABORT
+        // messages to the control characteristic and receives pages as
+        // notifications of the data characteristic
+        GattCharacteristic* bulkControlCharPtr = new GattCharacteristic(
+            bulkControlUUID,
+            bulkControlValue,
+            1,
+            BULK_CONTROL_MAX,
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE | 
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_WRITE_WITHOUT_RESPONSE
+        );
+        this->bulkControlChar = static_cast<void*>(bulkControlCharPtr);
+        
+        GattCharacteristic* bulkDataCharPtr = new GattCharacteristic(
+            bulkDataUUID,
+            bulkDataValue,
+            BULK_END_SIZE,
+            MAX_NOTIFY_PAYLOAD,
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY
+        );
+        this->bulkDataChar = static_cast<void*>(bulkDataCharPtr);
+        
+        // Spectral features: one packed FeatureRecord per window,
+        // notified while the phone is subscribed
+        GattCharacteristic* featureCharPtr = new GattCharacteristic(
+            featureUUID,
+            featureValue,
+            FEATURE_RECORD_SIZE,
+            FEATURE_RECORD_SIZE,
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ | 
+            GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_NOTIFY
+        );
+        this->featureChar = static_cast<void*>(featureCharPtr);
+        
+        // Create service containing all characteristics
+        GattCharacteristic* characteristics[] = {tremorCharPtr, dyskinesiaCharPtr, fogCharPtr,
+                                                 resultCharPtr, rawStreamCharPtr,
+                                                 bulkControlCharPtr, bulkDataCharPtr,
+                                                 featureCharPtr};
+        GattService* servicePtr = new GattService(serviceUUID, characteristics, 8);
         this->symptomService = static_cast<void*>(servicePtr);
         
         // Add service to GATT server
@@ -154,10 +273,17 @@ bool BLEManager::begin() {
             return false;
         }
         
-        // Start BLE advertising (makes device discoverable)
-        error = bleInstance->gap().startAdvertising(LEGACY_ADVERTISING_HANDLE);
-        if (error != BLE_ERROR_NONE) {
-            printf("Failed to start BLE advertising: %d\r\n", error);
+        // MTU exchange results, subscriptions and control writes arrive
+        // through the event handler; the stack requests the MTU and data length set in
+        // mbed_app.json
+        bleInstance->gattServer().setEventHandler(this);
+        
+        // Connections, disconnections and parameter updates
+        bleInstance->gap().setEventHandler(this);
+        
+        // Start BLE advertising (makes device discoverable), fast at first
+        advScheduler.start(clockMs());
+        if (!startAdvertising()) {
             return false;
         }
         
@@ -169,14 +295,15 @@ bool BLEManager::begin() {
         printf("BLE running in simulation mode\r\n");
         simulationMode = true;
         initialized = true;
-        return true;
+        advScheduler.start(clockMs());
+        return startAdvertising();
     #endif
 }
 
 /**
  * @brief Process BLE events
  * 
- * Must be called regularly in main loop to handle BLE stack events:
+ * Called after the stack signalled pending events, to handle:
  * - Connection/disconnection events
  * - Data transmission events
  * - Notification delivery
@@ -187,41 +314,88 @@ void BLEManager::update() {
         if (this->ble) {
             BLE* bleInstance = static_cast<BLE*>(this->ble);
             bleInstance->processEvents();  // Process pending BLE events
+            stats.eventRuns++;
         }
-    #else
-        // No event processing needed in simulation mode
     #endif
+    
+    // Also reached from the relax delay timeout
+    updateLinkProfile();
 }
 
+#ifdef MBED_OS
+/**
+ * @brief Stack callback: events are pending (possibly in interrupt context)
+ * 
+ * Without an event callback the events wait for the next periodic
+ * update().
+ */
+void BLEManager::onEventsToProcess(ble::BLE::OnEventsToProcessCallbackContext* context) {
+    (void)context;
+    stats.eventSignals++;
+    if (eventCallback) {
+        eventCallback();
+    }
+}
+#endif
+
 /**
  * @brief Update BLE characteristics with latest detection results
  * 
- * Converts detection results to bytes and writes to BLE characteristics.
- * If a mobile device is connected and subscribed to notifications,
- * it will automatically receive updates.
+ * Packs the results into a ResultRecord and queues it for the result
+ * characteristic; the queue is sent as soon as a batching bound is
+ * reached. The status characteristics are updated locally only (readable,
+ * no notification), so a window costs at most one notification instead
+ * of three.
  * 
  * Data format:
- * - Status: 1 byte (0 = not detected, 1 = detected)
- * - Intensity: 1 byte (0-255, normalized from 0.0-1.0 float)
+ * - Status characteristics: 1 byte (0 = not detected, 1 = detected)
+ * - Result characteristic: one or more packed ResultRecords, oldest first
+ *   (see BLEManager.h)
  * 
  * @param tremorDetected, tremorIntensity Tremor detection result and intensity
  * @param dyskinesiaDetected, dyskinesiaIntensity Dyskinesia detection result and intensity
  * @param fogDetected, fogIntensity FOG detection result and intensity
+ * @param timestampMs Device time at the end of the window (ms)
  */
 void BLEManager::updateCharacteristics(bool tremorDetected, float tremorIntensity,
                                       bool dyskinesiaDetected, float dyskinesiaIntensity,
-                                      bool fogDetected, float fogIntensity) {
+                                      bool fogDetected, float fogIntensity,
+                                      uint32_t timestampMs) {
     // Update characteristic values
     // Convert boolean to byte (0 or 1)
     tremorStatus = tremorDetected ? 1 : 0;
     // Convert float (0.0-1.0) to byte (0-255)
-    tremorIntensityByte = (uint8_t)(tremorIntensity * 255);
+    tremorIntensityByte = intensityByte(tremorIntensity);
     
     dyskinesiaStatus = dyskinesiaDetected ? 1 : 0;
-    dyskinesiaIntensityByte = (uint8_t)(dyskinesiaIntensity * 255);
+    dyskinesiaIntensityByte = intensityByte(dyskinesiaIntensity);
     
     fogStatus = fogDetected ? 1 : 0;
-    fogIntensityByte = (uint8_t)(fogIntensity * 255);
+    fogIntensityByte = intensityByte(fogIntensity);
+    
+    // Pack the window into the next result record
+    lastRecord.flags = (tremorDetected ? RESULT_TREMOR : 0) |
+                       (dyskinesiaDetected ? RESULT_DYSKINESIA : 0) |
+                       (fogDetected ? RESULT_FOG : 0);
+    lastRecord.tremorIntensity = tremorIntensityByte;
+    lastRecord.dyskinesiaIntensity = dyskinesiaIntensityByte;
+    lastRecord.fogIntensity = fogIntensityByte;
+    lastRecord.sequence = nextSequence++;
+    lastRecord.timestampMs = timestampMs;
+    stats.windows++;
+    
+    // A detection is worth reconnecting for when advertising stopped
+    if (lastRecord.flags && advScheduler.wake(clockMs())) {
+        printf("BLE advertising resumed by a detection\r\n");
+        if (initialized) {
+            startAdvertising();
+        }
+    }
+    
+    // Every window goes into the history, whether it is notified or not
+    uint8_t packed[RESULT_RECORD_SIZE];
+    packResult(lastRecord, packed);
+    history.append(packed);
     
     #ifdef MBED_OS
         using namespace ble;
@@ -231,38 +405,981 @@ void BLEManager::updateCharacteristics(bool tremorDetected, float tremorIntensit
             GattCharacteristic* dyskinesiaCharPtr = static_cast<GattCharacteristic*>(this->dyskinesiaChar);
             GattCharacteristic* fogCharPtr = static_cast<GattCharacteristic*>(this->fogChar);
             
-            // Update characteristics and notify connected clients
-            // Write tremor status to characteristic
-            // Notifications are sent automatically if client is subscribed
+            // Status characteristics: update the stored values only
+            // (localOnly = true), readers still get the latest state
             (void)bleInstance->gattServer().write(
                 tremorCharPtr->getValueHandle(),  // Characteristic handle
                 &tremorStatus,                 // Data to write
-                1                               // Data length (bytes)
+                1,                              // Data length (bytes)
+                true                            // Local only: no notification
             );
-            
-            // Write dyskinesia status to characteristic
             (void)bleInstance->gattServer().write(
                 dyskinesiaCharPtr->getValueHandle(),
                 &dyskinesiaStatus,
-                1
+                1,
+                true
             );
-            
-            // Write FOG status to characteristic
             (void)bleInstance->gattServer().write(
                 fogCharPtr->getValueHandle(),
                 &fogStatus,
-                1
+                1,
+                true
             );
         }
     #else
         // Print data in simulation mode
         if (simulationMode) {
-            printf("[BLE Simulation] Tremor:%d(%.2f) Dyskinesia:%d(%.2f) FOG:%d(%.2f)\r\n",
+            printf("[BLE Simulation] #%u Tremor:%d(%.2f) Dyskinesia:%d(%.2f) FOG:%d(%.2f)\r\n",
+                   lastRecord.sequence,
                    tremorStatus, tremorIntensity,
                    dyskinesiaStatus, dyskinesiaIntensity,
                    fogStatus, fogIntensity);
         }
     #endif
+    
+    // Queue the record unless the policy suppresses it
+    bool transition = false;
+    if (worthSending(lastRecord)) {
+        transition = haveSent && lastRecord.flags != lastSent.flags;
+        lastSent = lastRecord;
+        haveSent = true;
+        if (pendingCount == MAX_BATCH_RECORDS) {
+            // Refused for a whole batch: the oldest is only in the history now
+            pendingCount--;
+            memmove(pending, pending + 1, pendingCount * sizeof(pending[0]));
+            stats.dropped++;
+        }
+        pending[pendingCount++] = lastRecord;
+    } else {
+        stats.suppressed++;
+    }
+    
+    // Send when the count or age bound is reached, or at once when a
+    // detection changed; suppressed windows still age the queue
+    if (pendingCount > 0 && (transition || pendingCount >= batchRecords ||
+        timestampMs - pending[0].timestampMs >= batchDelayMs)) {
+        flush();
+    }
+    
+    // Windows are the clock of the relax delay back to the summary profile
+    updateLinkProfile();
+}
+
+void BLEManager::setNotificationPolicy(float intensityDelta, uint32_t keepAliveMs) {
+    deltaByte = intensityByte(intensityDelta);
+    this->keepAliveMs = keepAliveMs;
+}
+
+/**
+ * @brief Apply the change-only policy to a new record
+ * 
+ * Intensities are compared with the last record sent, not the previous
+ * window, so a slow drift is still reported once it exceeds the delta.
+ * 
+ * @param record Record of the current window
+ * @return true if the record should be sent
+ */
+bool BLEManager::worthSending(const ResultRecord& record) const {
+    if (deltaByte == 0 || !haveSent) {
+        return true;
+    }
+    if (record.flags != lastSent.flags) {
+        return true;
+    }
+    if (abs(record.tremorIntensity - lastSent.tremorIntensity) > deltaByte ||
+        abs(record.dyskinesiaIntensity - lastSent.dyskinesiaIntensity) > deltaByte ||
+        abs(record.fogIntensity - lastSent.fogIntensity) > deltaByte) {
+        return true;
+    }
+    return keepAliveMs > 0 && record.timestampMs - lastSent.timestampMs >= keepAliveMs;
+}
+
+void BLEManager::setBatching(int maxRecords, uint32_t maxDelayMs) {
+    if (maxRecords < 1) maxRecords = 1;
+    if (maxRecords > MAX_BATCH_RECORDS) maxRecords = MAX_BATCH_RECORDS;
+    batchRecords = maxRecords;
+    batchDelayMs = maxDelayMs;
+    if (pendingCount >= batchRecords) {
+        flush();
+    }
+}
+
+void BLEManager::setAttMtu(uint16_t mtu) {
+    attMtu = (mtu < ATT_DEFAULT_MTU) ? ATT_DEFAULT_MTU : mtu;
+}
+
+/**
+ * @brief Records that fit in one notification at the current MTU
+ * 
+ * A notification carries ATT MTU - 3 bytes (opcode and handle), capped
+ * at the payload of one Data Length Extension packet.
+ * 
+ * @return Records per notification (at least 1)
+ */
+int BLEManager::getBatchCapacity() const {
+    int records = payloadCapacity() / RESULT_RECORD_SIZE;
+    return records < 1 ? 1 : records;
+}
+
+/**
+ * @brief Notification payload at the current MTU
+ * @return ATT MTU - 3, capped at MAX_NOTIFY_PAYLOAD (bytes)
+ */
+int BLEManager::payloadCapacity() const {
+    int payload = attMtu - 3;
+    return (payload > MAX_NOTIFY_PAYLOAD) ? MAX_NOTIFY_PAYLOAD : payload;
+}
+
+/**
+ * @brief Send all queued records, oldest first
+ * 
+ * Each notification carries as many records as the MTU allows. Sending
+ * stops at the first notification the stack refuses; its records and
+ * the later ones stay queued.
+ */
+void BLEManager::flush() {
+    int capacity = getBatchCapacity();
+    int sent = 0;
+    resultsRefused = false;
+    while (sent < pendingCount) {
+        int count = pendingCount - sent;
+        if (count > capacity) count = capacity;
+        for (int i = 0; i < count; i++) {
+            packResult(pending[sent + i], resultValue + i * RESULT_RECORD_SIZE);
+        }
+        if (!notifyResults(count * RESULT_RECORD_SIZE)) {
+            resultsRefused = true;
+            break;
+        }
+        sent += count;
+    }
+    pendingCount -= sent;
+    memmove(pending, pending + sent, pendingCount * sizeof(pending[0]));
+}
+
+/**
+ * @brief Write the packed records in resultValue to the result characteristic
+ * @param length Payload length (bytes)
+ * @return false if the notification was refused (no stack buffer free)
+ */
+bool BLEManager::notifyResults(int length) {
+    #ifdef MBED_OS
+        using namespace ble;
+        if (this->ble && initialized && this->resultChar) {
+            BLE* bleInstance = static_cast<BLE*>(this->ble);
+            GattCharacteristic* resultCharPtr = static_cast<GattCharacteristic*>(this->resultChar);
+            if (resultNotify && !notifyBufferFree()) {
+                stats.refused++;
+                return false;
+            }
+            // Local only while nobody is subscribed: no notification to wait for
+            ble_error_t error = bleInstance->gattServer().write(
+                resultCharPtr->getValueHandle(),
+                resultValue,
+                length,
+                !resultNotify
+            );
+            if (error != BLE_ERROR_NONE) {
+                stats.refused++;
+                return false;
+            }
+            if (resultNotify) {
+                notifyInFlight++;
+            }
+        }
+    #else
+        if (gattSim) {
+            if (!notifyBufferFree() || !gattSim->notify(SIM_CHAR_RESULT, resultValue, length)) {
+                stats.refused++;
+                return false;
+            }
+            notifyInFlight++;
+        }
+        if (simulationMode && length > RESULT_RECORD_SIZE) {
+            printf("[BLE Simulation] notification: %d records, %d bytes\r\n",
+                   length / RESULT_RECORD_SIZE, length);
+        }
+    #endif
+    stats.notifications++;
+    stats.bytesSent += length;
+    return true;
+}
+
+void BLEManager::printStats() const {
+    printf("BLE: %lu windows (%lu unchanged, not sent) in %lu notifications (%lu bytes), "
+           "MTU %u, %d records/notification\r\n",
+           (unsigned long)stats.windows, (unsigned long)stats.suppressed,
+           (unsigned long)stats.notifications, (unsigned long)stats.bytesSent,
+           attMtu, getBatchCapacity());
+    if (stats.refused > 0) {
+        printf("BLE results: %lu notifications refused and retried, %lu records dropped\r\n",
+               (unsigned long)stats.refused, (unsigned long)stats.dropped);
+    }
+    if (stats.featureNotifications > 0) {
+        printf("BLE features: %lu records notified (%d bytes each)\r\n",
+               (unsigned long)stats.featureNotifications, FEATURE_RECORD_SIZE);
+    }
+    if (streamStats.packets > 0) {
+        printf("BLE stream: %lu frames in %lu packets, %.0f B/s (%.2f of raw int16), "
+               "%lu refused, %lu dropped\r\n",
+               (unsigned long)streamStats.frames, (unsigned long)streamStats.packets,
+               getStreamRate(),
+               streamStats.rawBytes ? (float)streamStats.bytesSent / streamStats.rawBytes : 0.0f,
+               (unsigned long)streamStats.refused, (unsigned long)streamStats.dropped);
+        if (streamStats.accelOnly > 0) {
+            printf("BLE stream: %lu frames without the gyroscope (MTU %u too small for 6 axes)\r\n",
+                   (unsigned long)streamStats.accelOnly, attMtu);
+        }
+    }
+    const AdvertisingStats& adv = advScheduler.getStats();
+    printf("BLE advertising: %s, %lu starts, %lu connections (%lu fast, %lu slow), "
+           "time to connect mean %lu ms, max %lu ms, advertised %lu s fast, %lu s slow, "
+           "%lu idle stops\r\n",
+           ADV_PHASE_NAMES[advScheduler.getPhase()], (unsigned long)adv.starts,
+           (unsigned long)(adv.fastConnections + adv.slowConnections),
+           (unsigned long)adv.fastConnections, (unsigned long)adv.slowConnections,
+           (unsigned long)advScheduler.getMeanConnectMs(), (unsigned long)adv.maxConnectMs,
+           (unsigned long)(adv.fastMs / 1000), (unsigned long)(adv.slowMs / 1000),
+           (unsigned long)adv.idleStops);
+    const LinkStats& link = linkManager.getStats();
+    if (link.connections > 0) {
+        printf("BLE link: %s, interval %.2f ms, latency %u, %lu connections, "
+               "%lu parameter requests (%lu rejected), %lu stack event runs\r\n",
+               linkManager.isConnected() ? "connected" : "disconnected",
+               linkManager.getInterval() * 1.25f, linkManager.getLatency(),
+               (unsigned long)link.connections, (unsigned long)link.requests,
+               (unsigned long)link.rejected, (unsigned long)stats.eventRuns);
+    }
+    const BulkStats& bulk = bulkServer.getStats();
+    if (bulk.transfers > 0) {
+        printf("BLE bulk: %lu transfers (%lu complete), %lu records in %lu pages (%lu bytes), "
+               "%lu credit stalls\r\n",
+               (unsigned long)bulk.transfers, (unsigned long)bulk.completed,
+               (unsigned long)bulk.records, (unsigned long)bulk.pages,
+               (unsigned long)bulk.bytesSent, (unsigned long)bulk.creditStalls);
+    }
+}
+
+/**
+ * @brief Publish the spectral features of the latest window
+ * 
+ * The record takes the sequence number of the last ResultRecord, so the
+ * phone can join it with the results of the same window.
+ * 
+ * @param features Features from SymptomDetector::getFeatures()
+ */
+void BLEManager::updateFeatures(const SpectralFeatures& features) {
+    quantizeFeatures(features, lastRecord.sequence, lastFeatures);
+    packFeatures(lastFeatures, featureValue);
+    
+    // Features are not queued: without a free buffer only the value is updated
+    bool notify = featureNotify && notifyBufferFree();
+    #ifdef MBED_OS
+        using namespace ble;
+        if (this->ble && initialized && this->featureChar) {
+            BLE* bleInstance = static_cast<BLE*>(this->ble);
+            GattCharacteristic* featureCharPtr = static_cast<GattCharacteristic*>(this->featureChar);
+            // Local only while nobody is subscribed: readers get the latest value
+            ble_error_t error = bleInstance->gattServer().write(featureCharPtr->getValueHandle(),
+                                                                featureValue, FEATURE_RECORD_SIZE,
+                                                                !notify);
+            if (error == BLE_ERROR_NONE && notify) {
+                notifyInFlight++;
+                stats.featureNotifications++;
+            }
+        }
+    #else
+        if (notify) {
+            if (!gattSim) {
+                stats.featureNotifications++;
+            } else if (gattSim->notify(SIM_CHAR_FEATURE, featureValue, FEATURE_RECORD_SIZE)) {
+                notifyInFlight++;
+                stats.featureNotifications++;
+            }
+        }
+    #endif
+}
+
+void BLEManager::setFeatureNotify(bool enabled) {
+    featureNotify = enabled;
+}
+
+void BLEManager::setStreaming(bool enabled) {
+    if (!enabled && streaming) {
+        flushStream();
+        streamStats.dropped += streamBuffered;  // Refused: nobody to send them to any more
+        removeStreamFrames(streamBuffered);
+        streamRefused = false;
+    }
+    if (enabled && !streaming) {
+        streamStats.firstUs = 0;
+        streamStats.lastUs = 0;
+        streamStats.frames = 0;
+        streamStats.packets = 0;
+        streamStats.bytesSent = 0;
+        streamStats.rawBytes = 0;
+        streamStats.dropped = 0;
+        streamStats.refused = 0;
+        streamStats.accelOnly = 0;
+    }
+    streaming = enabled;
+    printf("BLE raw IMU stream %s\r\n", enabled ? "started" : "stopped");
+    int fullPacket = ImuStreamCodec::packetSize(1, 6, 0);
+    if (enabled && fullPacket > payloadCapacity()) {
+        printf("BLE raw IMU stream: accelerometer only until the MTU is at least %d (now %u)\r\n",
+               fullPacket + 3, attMtu);
+    }
+    updateLinkProfile();
+}
+
+/**
+ * @brief Add samples to the raw IMU stream
+ * 
+ * A change of channel count (gyroscope switched) or rate first sends the
+ * frames buffered so far, since a packet has one layout; frames the stack
+ * refuses then are dropped. The same happens when an MTU exchange makes
+ * room for the gyroscope. While packets are refused frames accumulate
+ * until notificationsSent(), the oldest dropped once the buffer is full.
+ */
+void BLEManager::streamSamples(const float* accelX, const float* accelY, const float* accelZ,
+                               const float* gyroX, const float* gyroY, const float* gyroZ,
+                               const uint32_t* timestampUs, int count, float rateHz) {
+    if (!streaming) {
+        return;
+    }
+    int channels = (gyroX && gyroY && gyroZ) ? 6 : 3;
+    if (channels == 6 && ImuStreamCodec::packetSize(1, 6, 0) > payloadCapacity()) {
+        channels = 3;
+        streamStats.accelOnly += count;
+    }
+    uint8_t rate = (uint8_t)(rateHz + 0.5f);
+    if (streamBuffered > 0 && (channels != streamChannels || rate != streamRateHz)) {
+        flushStream();
+        streamStats.dropped += streamBuffered;
+        removeStreamFrames(streamBuffered);
+    }
+    streamChannels = channels;
+    streamRateHz = rate;
+    
+    for (int i = 0; i < count; i++) {
+        if (streamBuffered == STREAM_BUFFER_FRAMES) {
+            streamStats.dropped++;
+            removeStreamFrames(1);
+        }
+        int16_t* frame = streamFrames[streamBuffered];
+        frame[0] = ImuStreamCodec::toCounts(accelX[i], IMU_ACCEL_COUNTS_PER_G);
+        frame[1] = ImuStreamCodec::toCounts(accelY[i], IMU_ACCEL_COUNTS_PER_G);
+        frame[2] = ImuStreamCodec::toCounts(accelZ[i], IMU_ACCEL_COUNTS_PER_G);
+        if (channels == 6) {
+            frame[3] = ImuStreamCodec::toCounts(gyroX[i], IMU_GYRO_COUNTS_PER_DPS);
+            frame[4] = ImuStreamCodec::toCounts(gyroY[i], IMU_GYRO_COUNTS_PER_DPS);
+            frame[5] = ImuStreamCodec::toCounts(gyroZ[i], IMU_GYRO_COUNTS_PER_DPS);
+        }
+        streamTimes[streamBuffered] = timestampUs ? timestampUs[i] : 0;
+        streamBuffered++;
+        sendStreamPackets();
+    }
+}
+
+void BLEManager::flushStream() {
+    while (streamBuffered > 0 && !streamRefused) {
+        int fit = ImuStreamCodec::fitFrames(streamFrames, streamBuffered, streamChannels,
+                                            payloadCapacity());
+        sendStreamPacket(fit);
+    }
+}
+
+/**
+ * @brief Send the complete packets in the stream buffer
+ * 
+ * A packet is complete once the newest frame no longer fits in it, or
+ * the buffer is full. Nothing is written while a packet waits for stack
+ * buffers.
+ */
+void BLEManager::sendStreamPackets() {
+    while (streamBuffered > 0 && !streamRefused) {
+        int fit = ImuStreamCodec::fitFrames(streamFrames, streamBuffered, streamChannels,
+                                            payloadCapacity());
+        if (fit == streamBuffered && streamBuffered < STREAM_BUFFER_FRAMES) {
+            return;
+        }
+        sendStreamPacket(fit);
+    }
+}
+
+/**
+ * @brief Encode and notify the first buffered frames
+ * 
+ * @param frames Frames to send; 0 when the MTU is too small for a single
+ *               frame, which drops the whole buffer
+ * @return false if the stack refused the packet; its frames stay buffered
+ */
+bool BLEManager::sendStreamPacket(int frames) {
+    if (frames <= 0) {
+        streamStats.dropped += streamBuffered;
+        removeStreamFrames(streamBuffered);
+        return true;
+    }
+    ImuStreamHeader header = {streamSequence, streamTimes[0], (uint8_t)frames,
+                              (uint8_t)streamChannels, streamRateHz};
+    int length = ImuStreamCodec::encode(header, streamFrames, frames, streamValue,
+                                        payloadCapacity());
+    if (length <= 0) {
+        streamStats.dropped += frames;
+        removeStreamFrames(frames);
+        return true;
+    }
+    
+    #ifdef MBED_OS
+        using namespace ble;
+        if (this->ble && initialized && this->rawStreamChar) {
+            BLE* bleInstance = static_cast<BLE*>(this->ble);
+            GattCharacteristic* rawCharPtr = static_cast<GattCharacteristic*>(this->rawStreamChar);
+            if (!notifyBufferFree() ||
+                bleInstance->gattServer().write(rawCharPtr->getValueHandle(),
+                                                streamValue, length) != BLE_ERROR_NONE) {
+                streamRefused = true;
+            } else {
+                notifyInFlight++;
+            }
+        }
+    #else
+        if (gattSim) {
+            if (!notifyBufferFree() || !gattSim->notify(SIM_CHAR_RAW_STREAM, streamValue, length)) {
+                streamRefused = true;
+            } else {
+                notifyInFlight++;
+            }
+        }
+    #endif
+    if (streamRefused) {
+        streamStats.refused++;
+        return false;
+    }
+    
+    streamSequence++;
+    if (streamStats.packets == 0) {
+        streamStats.firstUs = streamTimes[0];
+    }
+    streamStats.lastUs = streamTimes[frames - 1];
+    streamStats.frames += frames;
+    streamStats.packets++;
+    streamStats.bytesSent += length;
+    streamStats.rawBytes += frames * streamChannels * 2;
+    removeStreamFrames(frames);
+    return true;
+}
+
+/**
+ * @brief Remove the oldest frames from the stream buffer
+ * @param frames Frames to remove (sent or dropped)
+ */
+void BLEManager::removeStreamFrames(int frames) {
+    streamBuffered -= frames;
+    memmove(streamFrames, streamFrames + frames, streamBuffered * sizeof(streamFrames[0]));
+    memmove(streamTimes, streamTimes + frames, streamBuffered * sizeof(streamTimes[0]));
+}
+
+float BLEManager::getStreamRate() const {
+    uint32_t spanUs = streamStats.lastUs - streamStats.firstUs;
+    if (streamStats.frames < 2 || spanUs == 0) {
+        return 0.0f;
+    }
+    return streamStats.bytesSent * 1e6f / spanUs;
+}
+
+void BLEManager::setBulkTransfer(bool enabled) {
+    bulkEnabled = enabled;
+    bulkRefused = false;
+    bulkServer.setChannel(enabled ? this : nullptr);
+    printf("BLE bulk transfer channel %s, %lu records of history\r\n",
+           enabled ? "open" : "closed",
+           (unsigned long)(history.getEndIndex() - history.getFirstIndex()));
+    updateLinkProfile();
+}
+
+bool BLEManager::handleBulkControl(const uint8_t* data, int length) {
+    bool accepted = bulkServer.handleControl(data, length);
+    updateLinkProfile();
+    return accepted;
+}
+
+int BLEManager::getMaxSdu() const {
+    return payloadCapacity();
+}
+
+/**
+ * @brief Send one bulk page as a notification of the bulk data characteristic
+ * 
+ * When no stack buffer is left the page is refused; the server sends it
+ * again once onDataSent() reports free buffers.
+ */
+bool BLEManager::sendSdu(const uint8_t* data, int length) {
+    if (!bulkEnabled) {
+        return false;
+    }
+    #ifdef MBED_OS
+        using namespace ble;
+        if (this->ble && initialized && this->bulkDataChar) {
+            BLE* bleInstance = static_cast<BLE*>(this->ble);
+            GattCharacteristic* bulkDataCharPtr = static_cast<GattCharacteristic*>(this->bulkDataChar);
+            if (!notifyBufferFree() ||
+                bleInstance->gattServer().write(bulkDataCharPtr->getValueHandle(),
+                                                data, length) != BLE_ERROR_NONE) {
+                bulkRefused = true;
+                stats.pagesRefused++;
+                return false;
+            }
+            notifyInFlight++;
+        }
+    #else
+        if (gattSim) {
+            if (!notifyBufferFree() || !gattSim->notify(SIM_CHAR_BULK_DATA, data, length)) {
+                bulkRefused = true;
+                stats.pagesRefused++;
+                return false;
+            }
+            notifyInFlight++;
+        }
+    #endif
+    return true;
+}
+
+/**
+ * @brief Whether another notification fits in the stack's buffers
+ * 
+ * write() succeeds once the value is stored, and the stack drops the
+ * notification if the controller has no buffer for it, so the count of
+ * notifications in flight decides instead.
+ */
+bool BLEManager::notifyBufferFree() const {
+    return notifyInFlight < notifyBudget;
+}
+
+/**
+ * @brief Notifications left the stack's buffers
+ * 
+ * Stack buffers are free again, so what was refused earlier is retried:
+ * results first, as they are the live state, then the raw stream, then
+ * the bulk page.
+ */
+void BLEManager::notificationsSent(int count) {
+    notifyInFlight = (count < notifyInFlight) ? notifyInFlight - count : 0;
+    if (resultsRefused) {
+        flush();
+    }
+    if (streamRefused) {
+        streamRefused = false;
+        sendStreamPackets();
+    }
+    if (bulkRefused) {
+        bulkRefused = false;
+        bulkServer.pump();
+        updateLinkProfile();
+    }
+}
+
+#ifdef NATIVE_TEST_MODE
+void BLEManager::setGattServerSim(GattServerSim* sim) {
+    gattSim = sim;
+    if (sim) {
+        notifyBudget = sim->getLink().txBuffers;
+        setAttMtu(sim->getLink().attMtu);
+    } else {
+        notifyBudget = NOTIFY_BUFFERS;
+    }
+}
+
+void BLEManager::setClockMs(uint32_t ms) {
+    manualClock = true;
+    manualClockMs = ms;
+}
+#endif
+
+void BLEManager::connectionOpened(uint16_t interval, uint16_t latency, uint16_t timeout) {
+    linkManager.connected(interval, latency, timeout);
+    bool advertising = advScheduler.isAdvertising();
+    AdvertisingPhase phase = advScheduler.getPhase();
+    advScheduler.connected(clockMs());
+    printf("BLE connected: interval %.2f ms, latency %u\r\n", interval * 1.25f, latency);
+    if (advertising) {
+        printf("BLE time to connect: %lu ms (%s advertising)\r\n",
+               (unsigned long)advScheduler.getStats().lastConnectMs, ADV_PHASE_NAMES[phase]);
+    }
+    updateLinkProfile();
+}
+
+void BLEManager::connectionClosed() {
+    linkManager.disconnected();
+    notifyInFlight = 0;     // The stack discards what the link did not send
+    if (streaming) {
+        setStreaming(false);
+    }
+    if (bulkEnabled) {
+        setBulkTransfer(false);
+    }
+    setFeatureNotify(false);
+    #ifdef MBED_OS
+        resultNotify = false;
+    #endif
+    setAttMtu(ATT_DEFAULT_MTU);
+    printf("BLE disconnected\r\n");
+    
+    // Advertising stops when a connection opens; resume it, fast, since
+    // the phone is likely still in range
+    advScheduler.start(clockMs());
+    if (initialized) {
+        startAdvertising();
+    }
+}
+
+void BLEManager::advertisingEnded() {
+    if (advScheduler.phaseEnded(clockMs())) {
+        startAdvertising();
+    } else if (advScheduler.getPhase() == ADV_STOPPED) {
+        printf("BLE advertising stopped (bonded, idle)\r\n");
+    }
+}
+
+void BLEManager::setBonded(bool bonded) {
+    advScheduler.setBonded(bonded);
+}
+
+void BLEManager::setAdvertisingIdleStop(uint32_t idleStopMs) {
+    advScheduler.setIdleStop(idleStopMs);
+}
+
+/**
+ * @brief Start advertising with the interval and duration of the current phase
+ * 
+ * The stack ends a phase with a duration on its own and reports it
+ * through onAdvertisingEnd().
+ * 
+ * @return false if the stack refused the parameters or the start
+ */
+bool BLEManager::startAdvertising() {
+    AdvertisingPhase phase = advScheduler.getPhase();
+    const AdvertisingParams& params = AdvertisingScheduler::getPhaseParams(phase);
+    uint32_t durationMs = advScheduler.getPhaseDurationMs();
+    #ifdef MBED_OS
+        using namespace ble;
+        if (!this->ble) {
+            return false;
+        }
+        BLE* bleInstance = static_cast<BLE*>(this->ble);
+        
+        // Connectable, undirected, at the phase's interval
+        AdvertisingParameters advParams;
+        advParams.setType(advertising_type_t::CONNECTABLE_UNDIRECTED);
+        advParams.setPrimaryInterval(adv_interval_t(params.minInterval),
+                                     adv_interval_t(params.maxInterval));
+        ble_error_t error = bleInstance->gap().setAdvertisingParameters(LEGACY_ADVERTISING_HANDLE,
+                                                                         advParams);
+        if (error != BLE_ERROR_NONE) {
+            printf("Failed to set advertising parameters: %d\r\n", error);
+            return false;
+        }
+        
+        // Duration in 10 ms units, 0 advertises until a connection
+        error = bleInstance->gap().startAdvertising(LEGACY_ADVERTISING_HANDLE,
+                                                    adv_duration_t(durationMs / 10));
+        if (error != BLE_ERROR_NONE) {
+            printf("Failed to start BLE advertising: %d\r\n", error);
+            return false;
+        }
+    #else
+        if (simulationMode) {
+            printf("[BLE Simulation] advertising %s every %.1f-%.1f ms, for %lu ms (0 = until connected)\r\n",
+                   ADV_PHASE_NAMES[phase], params.minInterval * 0.625f,
+                   params.maxInterval * 0.625f, (unsigned long)durationMs);
+        }
+    #endif
+    return true;
+}
+
+uint32_t BLEManager::clockMs() {
+    #ifdef MBED_OS
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        clock.elapsed_time()).count();
+    #else
+    if (gattSim) {
+        return gattSim->getNowUs() / 1000;
+    }
+    return manualClock ? manualClockMs : (uint32_t)clock.read_ms();
+    #endif
+}
+
+void BLEManager::connectionUpdated(bool accepted, uint16_t interval, uint16_t latency,
+                                   uint16_t timeout) {
+    linkManager.updated(accepted, interval, latency, timeout);
+    if (accepted) {
+        printf("BLE connection parameters: interval %.2f ms, latency %u, timeout %u ms\r\n",
+               interval * 1.25f, latency, timeout * 10u);
+    } else {
+        printf("BLE connection parameter update rejected\r\n");
+    }
+    // The demand may have changed while the update was outstanding
+    updateLinkProfile();
+}
+
+/**
+ * @brief Request the connection parameters the current traffic needs
+ * 
+ * The bulk profile applies while a download is active, the streaming
+ * profile while the raw stream runs, the summary profile otherwise.
+ * When the summary profile waits for its relax delay, a timeout signals
+ * an event at its end, so update() requests it even if no window or
+ * link event comes in between.
+ */
+void BLEManager::updateLinkProfile() {
+    uint32_t nowMs = clockMs();
+    linkManager.setDemand(streaming, bulkServer.isActive(), nowMs);
+    ConnectionParams params;
+    if (linkManager.nextRequest(nowMs, params)) {
+        requestLinkParams(params);
+    }
+    
+    #ifdef MBED_OS
+    int32_t waitMs = linkManager.msUntilRequest(clockMs());
+    linkTimer.detach();
+    if (waitMs >= 0 && eventCallback) {
+        linkTimer.attach(eventCallback, std::chrono::milliseconds(waitMs + 1));
+    }
+    #endif
+}
+
+/**
+ * @brief Send a connection parameter request to the central
+ * @param params Parameters from ConnectionParamManager::nextRequest()
+ */
+void BLEManager::requestLinkParams(const ConnectionParams& params) {
+    #ifdef MBED_OS
+        using namespace ble;
+        if (this->ble && initialized) {
+            BLE* bleInstance = static_cast<BLE*>(this->ble);
+            ble_error_t error = bleInstance->gap().updateConnectionParameters(
+                connectionHandle,
+                conn_interval_t(params.minInterval),
+                conn_interval_t(params.maxInterval),
+                slave_latency_t(params.slaveLatency),
+                supervision_timeout_t(params.supervisionTimeout)
+            );
+            if (error != BLE_ERROR_NONE) {
+                printf("BLE connection parameter request failed: %d\r\n", error);
+                linkManager.updated(false, 0, 0, 0);
+            }
+        }
+    #else
+        if (simulationMode) {
+            printf("[BLE Simulation] requesting interval %.2f-%.2f ms, latency %u\r\n",
+                   params.minInterval * 1.25f, params.maxInterval * 1.25f, params.slaveLatency);
+        }
+        if (gattSim) {
+            // The simulated central picks the longest interval allowed
+            bool accepted = gattSim->requestInterval(params.maxInterval * 1250u);
+            connectionUpdated(accepted, params.maxInterval, params.slaveLatency,
+                              params.supervisionTimeout);
+        }
+    #endif
+}
+
+#ifdef MBED_OS
+/**
+ * @brief GattServer event: ATT MTU exchange completed
+ * @param connectionHandle Connection the MTU applies to
+ * @param attMtuSize Agreed ATT MTU (bytes)
+ */
+void BLEManager::onAttMtuChange(ble::connection_handle_t connectionHandle, uint16_t attMtuSize) {
+    (void)connectionHandle;
+    setAttMtu(attMtuSize);
+    printf("BLE ATT MTU: %u bytes, %d records per notification\r\n", attMtu, getBatchCapacity());
+}
+
+void BLEManager::onUpdatesEnabled(const GattUpdatesEnabledCallbackParams& params) {
+    ble::GattCharacteristic* resultCharPtr = static_cast<ble::GattCharacteristic*>(this->resultChar);
+    ble::GattCharacteristic* rawCharPtr = static_cast<ble::GattCharacteristic*>(this->rawStreamChar);
+    ble::GattCharacteristic* bulkDataCharPtr = static_cast<ble::GattCharacteristic*>(this->bulkDataChar);
+    ble::GattCharacteristic* featureCharPtr = static_cast<ble::GattCharacteristic*>(this->featureChar);
+    if (resultCharPtr && params.attHandle == resultCharPtr->getValueHandle()) {
+        resultNotify = true;
+    } else if (rawCharPtr && params.attHandle == rawCharPtr->getValueHandle()) {
+        setStreaming(true);
+    } else if (bulkDataCharPtr && params.attHandle == bulkDataCharPtr->getValueHandle()) {
+        setBulkTransfer(true);
+    } else if (featureCharPtr && params.attHandle == featureCharPtr->getValueHandle()) {
+        setFeatureNotify(true);
+    }
+}
+
+void BLEManager::onUpdatesDisabled(const GattUpdatesDisabledCallbackParams& params) {
+    ble::GattCharacteristic* resultCharPtr = static_cast<ble::GattCharacteristic*>(this->resultChar);
+    ble::GattCharacteristic* rawCharPtr = static_cast<ble::GattCharacteristic*>(this->rawStreamChar);
+    ble::GattCharacteristic* bulkDataCharPtr = static_cast<ble::GattCharacteristic*>(this->bulkDataChar);
+    ble::GattCharacteristic* featureCharPtr = static_cast<ble::GattCharacteristic*>(this->featureChar);
+    if (resultCharPtr && params.attHandle == resultCharPtr->getValueHandle()) {
+        resultNotify = false;
+    } else if (rawCharPtr && params.attHandle == rawCharPtr->getValueHandle()) {
+        setStreaming(false);
+    } else if (bulkDataCharPtr && params.attHandle == bulkDataCharPtr->getValueHandle()) {
+        setBulkTransfer(false);
+    } else if (featureCharPtr && params.attHandle == featureCharPtr->getValueHandle()) {
+        setFeatureNotify(false);
+    }
+}
+
+void BLEManager::onDataWritten(const GattWriteCallbackParams& params) {
+    ble::GattCharacteristic* bulkControlCharPtr = static_cast<ble::GattCharacteristic*>(this->bulkControlChar);
+    if (bulkControlCharPtr && params.handle == bulkControlCharPtr->getValueHandle()) {
+        if (!handleBulkControl(params.data, params.len)) {
+            printf("BLE bulk: control message rejected (%u bytes)\r\n", params.len);
+        }
+    }
+}
+
+/**
+ * @brief GattServer event: a notification was sent
+ */
+void BLEManager::onDataSent(const GattDataSentCallbackParams& params) {
+    (void)params;
+    notificationsSent(1);
+}
+
+void BLEManager::onConnectionComplete(const ble::ConnectionCompleteEvent& event) {
+    if (event.getStatus() != BLE_ERROR_NONE) {
+        printf("BLE connection failed: %d\r\n", event.getStatus());
+        return;
+    }
+    connectionHandle = event.getConnectionHandle();
+    connectionOpened(event.getConnectionInterval().value(), event.getConnectionLatency().value(),
+                     event.getSupervisionTimeout().value());
+}
+
+void BLEManager::onDisconnectionComplete(const ble::DisconnectionCompleteEvent& event) {
+    (void)event;
+    connectionClosed();
+}
+
+void BLEManager::onConnectionParametersUpdateComplete(
+    const ble::ConnectionParametersUpdateCompleteEvent& event) {
+    connectionUpdated(event.getStatus() == BLE_ERROR_NONE, event.getConnectionInterval().value(),
+                      event.getSlaveLatency().value(), event.getSupervisionTimeout().value());
+}
+
+void BLEManager::onAdvertisingEnd(const ble::AdvertisingEndEvent& event) {
+    // A connection ending advertising is handled by onConnectionComplete()
+    if (!event.isConnected()) {
+        advertisingEnded();
+    }
+}
+#endif
+
+uint8_t BLEManager::intensityByte(float intensity) {
+    if (!(intensity > 0.0f)) {
+        return 0;  // Also NaN
+    }
+    if (intensity >= 1.0f) {
+        return 255;
+    }
+    return (uint8_t)(intensity * 255.0f + 0.5f);
+}
+
+/**
+ * @brief Serialize a result record (little-endian, as BLE uses)
+ * @param record Record to pack
+ * @param out Buffer of at least RESULT_RECORD_SIZE bytes
+ */
+void BLEManager::packResult(const ResultRecord& record, uint8_t* out) {
+    out[0] = record.flags;
+    out[1] = record.tremorIntensity;
+    out[2] = record.dyskinesiaIntensity;
+    out[3] = record.fogIntensity;
+    out[4] = (uint8_t)(record.sequence & 0xFF);
+    out[5] = (uint8_t)(record.sequence >> 8);
+    for (int i = 0; i < 4; i++) {
+        out[6 + i] = (uint8_t)(record.timestampMs >> (8 * i));
+    }
+}
+
+uint8_t BLEManager::powerByte(float power) {
+    if (!(power > 0.0f)) {
+        return 0;  // Also NaN
+    }
+    float code = (10.0f * log10f(power) - FEATURE_POWER_FLOOR_DB) / FEATURE_POWER_STEP_DB;
+    if (code <= 0.0f) {
+        return 0;
+    }
+    if (code >= 255.0f) {
+        return 255;
+    }
+    return (uint8_t)(code + 0.5f);
+}
+
+float BLEManager::powerFromByte(uint8_t code) {
+    if (code == 0) {
+        return 0.0f;
+    }
+    return powf(10.0f, (FEATURE_POWER_FLOOR_DB + code * FEATURE_POWER_STEP_DB) / 10.0f);
+}
+
+/**
+ * @brief Quantize spectral features into a feature record
+ * 
+ * Powers get logarithmic codes, since band powers span several decades
+ * between rest and tremor; frequency and cadence are linear and saturate.
+ */
+void BLEManager::quantizeFeatures(const SpectralFeatures& features, uint16_t sequence,
+                                  FeatureRecord& record) {
+    record.sequence = sequence;
+    for (int axis = 0; axis < FEATURE_AXES; axis++) {
+        for (int band = 0; band < FEATURE_BANDS; band++) {
+            record.bandPower[axis][band] = powerByte(features.bandPower[axis][band]);
+        }
+    }
+    float peak = features.peakFrequency * 10.0f;
+    record.peakFrequency = !(peak > 0.0f) ? 0 :
+                           (peak >= 255.0f ? 255 : (uint8_t)(peak + 0.5f));
+    float cadence = features.cadence * 100.0f;
+    record.cadence = !(cadence > 0.0f) ? 0 :
+                     (cadence >= 65535.0f ? 65535 : (uint16_t)(cadence + 0.5f));
+    record.fogVariance = powerByte(features.fogVariance);
+}
+
+void BLEManager::packFeatures(const FeatureRecord& record, uint8_t* out) {
+    out[0] = (uint8_t)(record.sequence & 0xFF);
+    out[1] = (uint8_t)(record.sequence >> 8);
+    for (int axis = 0; axis < FEATURE_AXES; axis++) {
+        for (int band = 0; band < FEATURE_BANDS; band++) {
+            out[2 + axis * FEATURE_BANDS + band] = record.bandPower[axis][band];
+        }
+    }
+    out[14] = record.peakFrequency;
+    out[15] = (uint8_t)(record.cadence & 0xFF);
+    out[16] = (uint8_t)(record.cadence >> 8);
+    out[17] = record.fogVariance;
+}
+
+void BLEManager::unpackFeatures(const uint8_t* in, FeatureRecord& record) {
+    record.sequence = (uint16_t)(in[0] | (in[1] << 8));
+    for (int axis = 0; axis < FEATURE_AXES; axis++) {
+        for (int band = 0; band < FEATURE_BANDS; band++) {
+            record.bandPower[axis][band] = in[2 + axis * FEATURE_BANDS + band];
+        }
+    }
+    record.peakFrequency = in[14];
+    record.cadence = (uint16_t)(in[15] | (in[16] << 8));
+    record.fogVariance = in[17];
+}
+
+void BLEManager::unpackResult(const uint8_t* in, ResultRecord& record) {
+    record.flags = in[0];
+    record.tremorIntensity = in[1];
+    record.dyskinesiaIntensity = in[2];
+    record.fogIntensity = in[3];
+    record.sequence = (uint16_t)(in[4] | (in[5] << 8));
+    record.timestampMs = 0;
+    for (int i = 0; i < 4; i++) {
+        record.timestampMs |= (uint32_t)in[6 + i] << (8 * i);
+    }
 }
 
 // UUID and device name definitions
@@ -293,5 +1410,35 @@ const uint8_t BLEManager::FOG_CHAR_UUID[] = {
     0x19, 0xB1, 0x00, 0x03, 0xE8, 0xF2, 0x53, 0x7E,
     0x4F, 0x6C, 0xD1, 0x04, 0x76, 0x8A, 0x12, 0x14
 };
+
+// Result Record Characteristic UUID: 19B10004-E8F2-537E-4F6C-D104768A1214
+const uint8_t BLEManager::RESULT_CHAR_UUID[] = {
+    0x19, 0xB1, 0x00, 0x04, 0xE8, 0xF2, 0x53, 0x7E,
+    0x4F, 0x6C, 0xD1, 0x04, 0x76, 0x8A, 0x12, 0x14
+};
+
+// Raw IMU Stream Characteristic UUID: 19B10005-E8F2-537E-4F6C-D104768A1214
+const uint8_t BLEManager::RAW_STREAM_CHAR_UUID[] = {
+    0x19, 0xB1, 0x00, 0x05, 0xE8, 0xF2, 0x53, 0x7E,
+    0x4F, 0x6C, 0xD1, 0x04, 0x76, 0x8A, 0x12, 0x14
+};
+
+// Bulk Control Characteristic UUID: 19B10006-E8F2-537E-4F6C-D104768A1214
+const uint8_t BLEManager::BULK_CONTROL_CHAR_UUID[] = {
+    0x19, 0xB1, 0x00, 0x06, 0xE8, 0xF2, 0x53, 0x7E,
+    0x4F, 0x6C, 0xD1, 0x04, 0x76, 0x8A, 0x12, 0x14
+};
+
+// Bulk Data Characteristic UUID: 19B10007-E8F2-537E-4F6C-D104768A1214
+const uint8_t BLEManager::BULK_DATA_CHAR_UUID[] = {
+    0x19, 0xB1, 0x00, 0x07, 0xE8, 0xF2, 0x53, 0x7E,
+    0x4F, 0x6C, 0xD1, 0x04, 0x76, 0x8A, 0x12, 0x14
+};
+
+// Spectral Feature Characteristic UUID: 19B10008-E8F2-537E-4F6C-D104768A1214
+const uint8_t BLEManager::FEATURE_CHAR_UUID[] = {
+    0x19, 0xB1, 0x00, 0x08, 0xE8, 0xF2, 0x53, 0x7E,
+    0x4F, 0x6C, 0xD1, 0x04, 0x76, 0x8A, 0x12, 0x14
+};
 #endif
 
@@ -9,7 +9,51 @@
  * BLE Architecture:
  * - Service: Container for related characteristics
  * - Characteristics: Individual data points (tremor, dyskinesia, FOG)
+ *   plus one packed result record per window
  * - Notifications: Push updates to connected devices
+ * 
+ * Only the result record notifies: one radio event per window instead of
+ * three. The per-symptom status characteristics are read-only (no
+ * NOTIFY property).
+ * 
+ * Records can be batched: several windows are queued and sent together
+ * in one notification, as many as the negotiated ATT MTU allows (up to
+ * 24 records in 244 bytes, one LE Data Length Extension packet). The
+ * queue is flushed when it reaches a window count or age bound.
+ * 
+ * With the change-only policy, a window is only sent when a detection
+ * changes state, an intensity moves by more than a set delta since the
+ * last record sent, or a keep-alive interval has passed. Detection
+ * changes are sent at once, bypassing the batch bounds.
+ * 
+ * Phone-side models can subscribe to a per-window feature vector
+ * (FeatureRecord): quantized band powers per axis, peak frequency,
+ * cadence and FOG variance from the detector's spectra.
+ * 
+ * For clinical sessions the raw 6-axis samples can be streamed on a
+ * separate characteristic, delta and bit-packed by ImuStreamCodec.
+ * Streaming runs while the phone is subscribed to that characteristic.
+ * 
+ * Every window's record is also kept in a history log (the last hour)
+ * that the phone downloads in pages through the bulk transfer protocol
+ * (BulkTransfer.h): requests and credits on the bulk control
+ * characteristic, pages on the bulk data characteristic. A download cut
+ * by a disconnect resumes where it stopped.
+ * 
+ * Connection parameters follow the traffic (ConnectionParamManager): a
+ * long interval with slave latency while only results flow, short
+ * intervals while streaming or downloading.
+ * 
+ * Advertising runs fast for 30 s after boot or a disconnect, then slow
+ * (AdvertisingScheduler); once bonded it can stop when idle until a
+ * detection wakes it. The time to connect is recorded.
+ * 
+ * Stack events are processed on demand: the stack signals pending work
+ * through the event callback (which posts a task), and update() then
+ * processes it. Nothing polls the stack.
+ * 
+ * Native builds can send the notifications through a simulated link
+ * (GattServerSim) to measure throughput and latency per transmission mode.
  */
 
 #ifndef BLE_MANAGER_H
@@ -24,6 +68,120 @@
 #else
 #include "mbed_compat.h"
 #endif
+#include "ImuStreamCodec.h"
+#include "BulkTransfer.h"
+#include "ConnectionParamManager.h"
+#include "AdvertisingScheduler.h"
+#include "SymptomDetector.h"
+#ifdef NATIVE_TEST_MODE
+#include "GattServerSim.h"
+#endif
+
+/**
+ * @struct ResultRecord
+ * @brief One window's results as carried by the result characteristic
+ * 
+ * Wire format (RESULT_RECORD_SIZE bytes, little-endian):
+ * | 0     | 1       | 2          | 3   | 4-5      | 6-9         |
+ * | flags | tremor  | dyskinesia | FOG | sequence | timestampMs |
+ */
+struct ResultRecord {
+    uint8_t flags;                  // RESULT_TREMOR | RESULT_DYSKINESIA | RESULT_FOG
+    uint8_t tremorIntensity;        // 0-255 (0.0-1.0)
+    uint8_t dyskinesiaIntensity;    // 0-255 (0.0-1.0)
+    uint8_t fogIntensity;           // 0-255 (0.0-1.0)
+    uint16_t sequence;              // Window sequence number (wraps)
+    uint32_t timestampMs;           // Device time at the window end (ms, wraps)
+};
+
+// Detection bits of ResultRecord::flags
+const uint8_t RESULT_TREMOR = 0x01;
+const uint8_t RESULT_DYSKINESIA = 0x02;
+const uint8_t RESULT_FOG = 0x04;
+
+const int RESULT_RECORD_SIZE = 10;  // Packed ResultRecord size (bytes)
+
+/**
+ * @struct FeatureRecord
+ * @brief One window's spectral features as carried by the feature characteristic
+ * 
+ * Wire format (FEATURE_RECORD_SIZE bytes, little-endian):
+ * | 0-1      | 2-13                        | 14        | 15-16   | 17      |
+ * | sequence | band powers X, Y, Z (4 each) | peak freq | cadence | FOG var |
+ * 
+ * Powers are logarithmic codes (BLEManager::powerByte()): 0.5 dB steps
+ * from FEATURE_POWER_FLOOR_DB (re 1 g^2), 0 meaning at or below the floor.
+ */
+struct FeatureRecord {
+    uint16_t sequence;                              // Sequence number of the window's ResultRecord
+    uint8_t bandPower[FEATURE_AXES][FEATURE_BANDS]; // 0-2, 3-5, 5-7, 7-12 Hz power codes per axis
+    uint8_t peakFrequency;                          // Peak frequency (0.1 Hz units, up to 25.5 Hz)
+    uint16_t cadence;                               // Cadence (0.01 steps/s)
+    uint8_t fogVariance;                            // FOG variance power code
+};
+
+const int FEATURE_RECORD_SIZE = 18;             // Packed FeatureRecord size (bytes)
+const float FEATURE_POWER_FLOOR_DB = -100.0f;   // Power of code 0 (dB re 1 g^2)
+const float FEATURE_POWER_STEP_DB = 0.5f;       // Power code step (dB)
+
+const int BLE_INIT_TIMEOUT_MS = 1000;   // Longest wait for the stack to come up in begin() (ms)
+const int ATT_DEFAULT_MTU = 23;         // ATT MTU before an MTU exchange (bytes)
+const int MAX_NOTIFY_PAYLOAD = 244;     // Payload filling one 251-byte DLE packet (bytes)
+const int MAX_BATCH_RECORDS = MAX_NOTIFY_PAYLOAD / RESULT_RECORD_SIZE;  // Records per notification
+const int NOTIFY_BUFFERS = 4;           // Notifications in flight at once (controller ACL buffers)
+
+#ifdef NATIVE_TEST_MODE
+// Characteristic ids in GattServerSim frames (byte 3 of the characteristic UUID)
+const uint8_t SIM_CHAR_RESULT = 0x04;       // Result records
+const uint8_t SIM_CHAR_RAW_STREAM = 0x05;   // Raw IMU stream packets
+const uint8_t SIM_CHAR_BULK_DATA = 0x07;    // Bulk transfer pages
+const uint8_t SIM_CHAR_FEATURE = 0x08;      // Feature records
+#endif
+
+/**
+ * @struct BleStats
+ * @brief Result transmission counters
+ */
+struct BleStats {
+    uint32_t windows;           // Windows passed to updateCharacteristics()
+    uint32_t notifications;     // Result notifications accepted by the stack
+    uint32_t bytesSent;         // Result notification payload (bytes)
+    uint32_t refused;           // Result notifications refused (records kept queued)
+    uint32_t dropped;           // Queued records lost while refused (still in the history)
+    uint32_t suppressed;        // Windows not sent by the change-only policy
+    uint32_t eventSignals;      // Times the stack signalled pending events
+    uint32_t eventRuns;         // update() calls that processed stack events
+    uint32_t featureNotifications;  // Feature records notified
+    uint32_t pagesRefused;      // Bulk pages refused (sent again later)
+};
+
+/**
+ * @brief Called when the BLE stack has events to process
+ * 
+ * May run in interrupt context: only post work (e.g.
+ * Scheduler::postFromInterrupt()) that later calls BLEManager::update().
+ */
+typedef void (*BleEventCallback)();
+
+const int HISTORY_RECORDS = 1200;       // Windows kept for bulk download (1 hour at 3s hops)
+
+const int STREAM_BUFFER_FRAMES = 64;    // Raw frames buffered before a packet is forced
+
+/**
+ * @struct StreamStats
+ * @brief Raw IMU stream counters
+ */
+struct StreamStats {
+    uint32_t frames;            // Frames sent
+    uint32_t packets;           // Stream notifications accepted by the stack
+    uint32_t refused;           // Stream notifications refused (frames kept buffered)
+    uint32_t accelOnly;         // Frames sent without the gyroscope (MTU too small for 6 axes)
+    uint32_t bytesSent;         // Encoded payload (bytes)
+    uint32_t rawBytes;          // Payload as plain int16 frames (bytes)
+    uint32_t dropped;           // Frames dropped (MTU too small, or buffer full while refused)
+    uint32_t firstUs;           // Time of the first frame sent (us)
+    uint32_t lastUs;            // Time of the last frame sent (us)
+};
 
 /**
  * @class BLEManager
@@ -32,10 +190,24 @@
  * Creates and manages a BLE service with three characteristics for
  * transmitting detection results wirelessly to mobile devices.
  */
-class BLEManager {
+class BLEManager : public BulkChannel
+#ifdef MBED_OS
+    , public ble::GattServer::EventHandler, public ble::Gap::EventHandler
+#endif
+{
 public:
     BLEManager();
     
+    /**
+     * @brief Set the callback signalling pending stack events
+     * 
+     * Must be set before begin(), which already produces events. Without
+     * a callback, update() has to be called periodically.
+     * 
+     * @param callback Function posting a call to update(), or nullptr
+     */
+    void setEventCallback(BleEventCallback callback);
+    
     /**
      * @brief Initialize BLE and create service/characteristics
      * @return true if initialization successful, false otherwise
@@ -43,26 +215,438 @@ public:
     bool begin();
     
     /**
-     * @brief Process BLE events (must be called regularly)
+     * @brief Process pending BLE events
      * 
      * Handles BLE stack events such as connections, disconnections,
-     * and data transmission. Should be called in main loop.
+     * and data transmission, and requests the summary connection
+     * parameters once their relax delay has passed. Call it in thread
+     * context each time the event callback fired; the callback also
+     * fires when the relax delay ends, so the link relaxes even while no
+     * windows arrive.
      */
     void update();
     
     /**
      * @brief Update BLE characteristics with latest detection results
      * 
-     * Converts detection results to bytes and writes to BLE characteristics.
-     * Connected devices will receive notifications if subscribed.
+     * Packs the results into the next ResultRecord and, unless the
+     * change-only policy suppresses it, queues it; the queue is sent when a
+     * batching bound is reached (immediately by default). The status
+     * characteristics are updated without notifying.
      * 
      * @param tremorDetected, tremorIntensity Tremor detection result
      * @param dyskinesiaDetected, dyskinesiaIntensity Dyskinesia detection result
      * @param fogDetected, fogIntensity FOG detection result
+     * @param timestampMs Device time at the end of the window (ms)
      */
     void updateCharacteristics(bool tremorDetected, float tremorIntensity,
                                bool dyskinesiaDetected, float dyskinesiaIntensity,
-                               bool fogDetected, float fogIntensity);
+                               bool fogDetected, float fogIntensity,
+                               uint32_t timestampMs);
+    
+    /**
+     * @brief Get the most recent result record
+     * @return Record of the last updateCharacteristics() call
+     */
+    const ResultRecord& getLastRecord() const { return lastRecord; }
+    
+    /**
+     * @brief Publish the spectral features of the latest window
+     * 
+     * Call after updateCharacteristics() for the same window; the record
+     * carries that window's sequence number. The value is always updated
+     * (readable); it is notified while the phone is subscribed.
+     * 
+     * @param features Features from SymptomDetector::getFeatures()
+     */
+    void updateFeatures(const SpectralFeatures& features);
+    
+    /**
+     * @brief Get the most recent feature record
+     * @return Record of the last updateFeatures() call
+     */
+    const FeatureRecord& getLastFeatures() const { return lastFeatures; }
+    
+    /**
+     * @brief Start or stop feature notifications
+     * 
+     * Called when the phone subscribes to or unsubscribes from the feature
+     * characteristic; usable natively to emulate it.
+     * 
+     * @param enabled true to notify every window's features
+     */
+    void setFeatureNotify(bool enabled);
+    
+    bool isFeatureNotify() const { return featureNotify; }
+    
+    /**
+     * @brief Configure result batching
+     * 
+     * Queued records are sent when maxRecords windows are queued or the
+     * oldest queued window is maxDelayMs older than the newest. A batch
+     * larger than the MTU allows is split over several notifications.
+     * 
+     * @param maxRecords Windows per batch (1 = send every window, at most MAX_BATCH_RECORDS)
+     * @param maxDelayMs Maximum age of a queued window (ms)
+     */
+    void setBatching(int maxRecords, uint32_t maxDelayMs);
+    
+    /**
+     * @brief Configure the change-only notification policy
+     * 
+     * A window is sent when a detection flag differs from the last record
+     * sent (sent immediately), when an intensity differs from it by more
+     * than intensityDelta, or when keepAliveMs have passed since it.
+     * Other windows are counted as suppressed; their sequence numbers
+     * are skipped. A delta of 0 sends every window (the default).
+     * 
+     * @param intensityDelta Intensity change that triggers a send (0.0-1.0)
+     * @param keepAliveMs Longest interval without a record (ms)
+     */
+    void setNotificationPolicy(float intensityDelta, uint32_t keepAliveMs);
+    
+    /**
+     * @brief Send all queued records now
+     * 
+     * Call before a long pause in results (e.g. activity gating), since
+     * the age bound is only checked when a window arrives. Records
+     * refused for lack of stack buffers stay queued and are sent again
+     * by notificationsSent() or the next flush.
+     */
+    void flush();
+    
+    /**
+     * @brief Set the negotiated ATT MTU
+     * 
+     * Called from the MTU exchange event; bounds the records per
+     * notification. Usable natively to emulate a negotiated link.
+     * 
+     * @param mtu ATT MTU (bytes, 23 until an exchange)
+     */
+    void setAttMtu(uint16_t mtu);
+    
+    uint16_t getAttMtu() const { return attMtu; }
+    
+    /**
+     * @brief Records that fit in one notification at the current MTU
+     * @return Records per notification (at least 1)
+     */
+    int getBatchCapacity() const;
+    
+    const BleStats& getStats() const { return stats; }
+    
+    /**
+     * @brief Print transmission statistics on one line
+     */
+    void printStats() const;
+    
+    /**
+     * @brief Start or stop the raw IMU stream
+     * 
+     * Called when the phone subscribes to or unsubscribes from the raw
+     * stream characteristic; usable natively to emulate it. Stopping
+     * sends the frames still buffered.
+     * 
+     * @param enabled true to stream
+     */
+    void setStreaming(bool enabled);
+    
+    bool isStreaming() const { return streaming; }
+    
+    /**
+     * @brief Add samples to the raw IMU stream
+     * 
+     * Samples are converted to sensor counts and buffered; a packet is sent
+     * as soon as the next frame would not fit in one notification, or
+     * STREAM_BUFFER_FRAMES frames are buffered. Ignored while not streaming.
+     * 
+     * A packet with one 6-axis frame does not fit in a notification at the
+     * default 23-byte MTU, so until the phone exchanges a larger MTU only
+     * the accelerometer is streamed (3-channel packets, counted in
+     * StreamStats::accelOnly).
+     * 
+     * @param accelX, accelY, accelZ Accelerometer samples (g)
+     * @param gyroX, gyroY, gyroZ Gyroscope samples (deg/s), nullptr while it is off
+     * @param timestampUs Sample times (us), may be nullptr
+     * @param count Number of samples
+     * @param rateHz Sample rate (Hz)
+     */
+    void streamSamples(const float* accelX, const float* accelY, const float* accelZ,
+                       const float* gyroX, const float* gyroY, const float* gyroZ,
+                       const uint32_t* timestampUs, int count, float rateHz);
+    
+    /**
+     * @brief Send the buffered raw frames now
+     */
+    void flushStream();
+    
+    const StreamStats& getStreamStats() const { return streamStats; }
+    
+    /**
+     * @brief Achieved raw stream throughput
+     * @return Encoded bytes per second of sample time, 0 before two frames were sent
+     */
+    float getStreamRate() const;
+    
+    /**
+     * @brief Start or stop the bulk history transfer channel
+     * 
+     * Called when the phone subscribes to or unsubscribes from the bulk
+     * data characteristic; usable natively to emulate it. Stopping ends
+     * the transfer in progress (the phone resumes it with a new REQUEST).
+     * 
+     * @param enabled true while the phone can receive pages
+     */
+    void setBulkTransfer(bool enabled);
+    
+    /**
+     * @brief Handle a bulk transfer control message (REQUEST, CREDIT, ABORT)
+     * 
+     * Called for writes to the bulk control characteristic; usable
+     * natively to emulate them.
+     * 
+     * @param data Message
+     * @param length Message length (bytes)
+     * @return false if the message is malformed or the channel is stopped
+     */
+    bool handleBulkControl(const uint8_t* data, int length);
+    
+    const RecordLog& getHistory() const { return history; }
+    const BulkStats& getBulkStats() const { return bulkServer.getStats(); }
+    
+    /**
+     * @brief Largest bulk page: one notification at the current MTU
+     * @return SDU size (bytes)
+     */
+    int getMaxSdu() const override;
+    
+    /**
+     * @brief Send one bulk page on the bulk data characteristic
+     * @param data SDU
+     * @param length SDU length (bytes)
+     * @return false if the stack did not accept the notification
+     */
+    bool sendSdu(const uint8_t* data, int length) override;
+    
+    /**
+     * @brief A connection was opened
+     * 
+     * Called from the GAP connection event; usable natively to emulate
+     * one. Requests the parameters the current traffic needs.
+     * 
+     * @param interval Connection interval (1.25 ms units)
+     * @param latency Slave latency
+     * @param timeout Supervision timeout (10 ms units)
+     */
+    void connectionOpened(uint16_t interval, uint16_t latency, uint16_t timeout);
+    
+    /**
+     * @brief The connection was closed
+     * 
+     * Stops the raw stream and the bulk transfer (subscriptions end with
+     * the connection), returns to the default MTU and advertises again.
+     */
+    void connectionClosed();
+    
+    /**
+     * @brief Outcome of a connection parameter update
+     * 
+     * Called from the GAP update event, also when the central changed the
+     * parameters on its own; usable natively to emulate the central.
+     * 
+     * @param accepted false if the central refused the request
+     * @param interval, latency, timeout Parameters now in use
+     */
+    void connectionUpdated(bool accepted, uint16_t interval, uint16_t latency, uint16_t timeout);
+    
+    bool isConnected() const { return linkManager.isConnected(); }
+    const ConnectionParamManager& getLinkManager() const { return linkManager; }
+    
+    /**
+     * @brief The stack ended advertising at the end of a phase
+     * 
+     * Called from the GAP advertising end event; usable natively to
+     * emulate the timeout. Continues with slow advertising after the fast
+     * phase, or stops when bonded and idle.
+     */
+    void advertisingEnded();
+    
+    /**
+     * @brief Whether a phone is bonded, allowing advertising to stop when idle
+     * 
+     * Set by the pairing code; takes effect at the next advertising phase.
+     * 
+     * @param bonded true once a bond exists
+     */
+    void setBonded(bool bonded);
+    
+    /**
+     * @brief Stop slow advertising after a while when bonded
+     * 
+     * A detection restarts advertising (fast).
+     * 
+     * @param idleStopMs Slow advertising time before stopping (ms, 0 = never)
+     */
+    void setAdvertisingIdleStop(uint32_t idleStopMs);
+    
+    const AdvertisingScheduler& getAdvertising() const { return advScheduler; }
+    
+    /**
+     * @brief Notifications left the stack's buffers
+     * 
+     * Called from the data sent event, and natively after the simulated
+     * link delivered notifications. The stack accepts every write() and
+     * drops the notification when the controller has no buffer left, so
+     * BLEManager counts the notifications in flight and refuses them
+     * itself once NOTIFY_BUFFERS are out. Frees the buffers, then resends
+     * the result records, raw stream packets and bulk page refused
+     * earlier, in that order.
+     * 
+     * @param count Notifications sent
+     */
+    void notificationsSent(int count);
+    
+    #ifdef NATIVE_TEST_MODE
+    /**
+     * @brief Send notifications through a simulated link
+     * 
+     * Result, raw stream, feature and bulk data notifications go to the
+     * simulator, which drops them as the stack would when its buffers
+     * are full; the notification budget becomes the simulator's buffer
+     * count and the ATT MTU its MTU. Connection parameter
+     * requests go to it too, in place of the central. Open the connection
+     * with connectionOpened() as usual.
+     * 
+     * @param sim Simulated link, or nullptr to only count notifications
+     */
+    void setGattServerSim(GattServerSim* sim);
+    
+    /**
+     * @brief Drive the clock of the link and advertising timing by hand
+     * 
+     * Lets tests run the relax delay without waiting. While a simulator
+     * is attached its time is used instead.
+     * 
+     * @param ms Current time (ms)
+     */
+    void setClockMs(uint32_t ms);
+    #endif
+    
+    #ifdef MBED_OS
+    /**
+     * @brief GattServer event: the client and server agreed on an ATT MTU
+     * @param connectionHandle Connection the MTU applies to
+     * @param attMtuSize New ATT MTU (bytes)
+     */
+    void onAttMtuChange(ble::connection_handle_t connectionHandle, uint16_t attMtuSize) override;
+    
+    /**
+     * @brief GattServer event: the client subscribed to a characteristic
+     * @param params Connection and value handle of the characteristic
+     */
+    void onUpdatesEnabled(const GattUpdatesEnabledCallbackParams& params) override;
+    
+    /**
+     * @brief GattServer event: the client unsubscribed from a characteristic
+     * @param params Connection and value handle of the characteristic
+     */
+    void onUpdatesDisabled(const GattUpdatesDisabledCallbackParams& params) override;
+    
+    /**
+     * @brief GattServer event: the client wrote a characteristic
+     * @param params Handle and value written
+     */
+    void onDataWritten(const GattWriteCallbackParams& params) override;
+    
+    /**
+     * @brief GattServer event: a notification left the stack's buffers
+     * @param params Connection and handle of the notified characteristic
+     */
+    void onDataSent(const GattDataSentCallbackParams& params) override;
+    
+    /**
+     * @brief Gap event: a connection was opened (or failed)
+     * @param event Status, handle and initial parameters
+     */
+    void onConnectionComplete(const ble::ConnectionCompleteEvent& event) override;
+    
+    /**
+     * @brief Gap event: the connection was closed
+     * @param event Handle and reason
+     */
+    void onDisconnectionComplete(const ble::DisconnectionCompleteEvent& event) override;
+    
+    /**
+     * @brief Gap event: connection parameters changed or an update failed
+     * @param event Status and parameters in use
+     */
+    void onConnectionParametersUpdateComplete(
+        const ble::ConnectionParametersUpdateCompleteEvent& event) override;
+    
+    /**
+     * @brief Gap event: advertising ended (timeout or connection)
+     * @param event Whether a connection ended it
+     */
+    void onAdvertisingEnd(const ble::AdvertisingEndEvent& event) override;
+    #endif
+    
+    /**
+     * @brief Serialize a result record into the wire format
+     * @param record Record to pack
+     * @param out Buffer of at least RESULT_RECORD_SIZE bytes
+     */
+    static void packResult(const ResultRecord& record, uint8_t* out);
+    
+    /**
+     * @brief Parse a result record from the wire format
+     * @param in Buffer of at least RESULT_RECORD_SIZE bytes
+     * @param record Parsed record
+     */
+    static void unpackResult(const uint8_t* in, ResultRecord& record);
+    
+    /**
+     * @brief Convert an intensity to its byte encoding
+     * @param intensity Intensity (0.0-1.0; clamped, NaN gives 0)
+     * @return Rounded byte (0-255)
+     */
+    static uint8_t intensityByte(float intensity);
+    
+    /**
+     * @brief Quantize spectral features into a feature record
+     * @param features Features of one window
+     * @param sequence Sequence number of the window's ResultRecord
+     * @param record Quantized record
+     */
+    static void quantizeFeatures(const SpectralFeatures& features, uint16_t sequence,
+                                 FeatureRecord& record);
+    
+    /**
+     * @brief Serialize a feature record into the wire format
+     * @param record Record to pack
+     * @param out Buffer of at least FEATURE_RECORD_SIZE bytes
+     */
+    static void packFeatures(const FeatureRecord& record, uint8_t* out);
+    
+    /**
+     * @brief Parse a feature record from the wire format
+     * @param in Buffer of at least FEATURE_RECORD_SIZE bytes
+     * @param record Parsed record
+     */
+    static void unpackFeatures(const uint8_t* in, FeatureRecord& record);
+    
+    /**
+     * @brief Convert a power to its logarithmic code
+     * @param power Power (g^2; 0 and NaN give 0)
+     * @return Code 0-255 in FEATURE_POWER_STEP_DB steps above FEATURE_POWER_FLOOR_DB
+     */
+    static uint8_t powerByte(float power);
+    
+    /**
+     * @brief Convert a power code back to a power
+     * @param code Code from powerByte()
+     * @return Power (g^2), 0 for code 0
+     */
+    static float powerFromByte(uint8_t code);
     
 private:
     bool initialized;        // Flag indicating if BLE is initialized
@@ -76,10 +660,86 @@ private:
     uint8_t fogStatus;              // FOG detection status (0 or 1)
     uint8_t fogIntensityByte;       // FOG intensity (0-255)
     
+    ResultRecord lastRecord;                    // Last record sent
+    uint16_t nextSequence;                      // Sequence number of the next record
+    uint8_t resultValue[MAX_NOTIFY_PAYLOAD];    // Packed records (characteristic value)
+    
+    // Batching state
+    ResultRecord pending[MAX_BATCH_RECORDS];    // Records waiting to be sent
+    int pendingCount;                           // Queued records
+    bool resultsRefused;                        // Queued records wait for stack buffers
+    int batchRecords;                           // Count bound of a batch
+    uint32_t batchDelayMs;                      // Age bound of a batch (ms)
+    uint16_t attMtu;                            // Negotiated ATT MTU (bytes)
+    int notifyInFlight;                         // Notifications written, not reported sent yet
+    int notifyBudget;                           // Notifications the stack can hold
+    BleStats stats;                             // Transmission counters
+    
+    // Change-only policy state
+    uint8_t deltaByte;                          // Intensity delta (0-255 scale, 0 = off)
+    uint32_t keepAliveMs;                       // Keep-alive interval (ms)
+    bool haveSent;                              // lastSent is valid
+    ResultRecord lastSent;                      // Last record queued for sending
+    
+    // Spectral features
+    FeatureRecord lastFeatures;                 // Last feature record
+    uint8_t featureValue[FEATURE_RECORD_SIZE];  // Packed record (characteristic value)
+    bool featureNotify;                         // Phone subscribed to the features
+    
+    // Raw IMU stream state
+    bool streaming;                                         // Phone subscribed to the stream
+    int16_t streamFrames[STREAM_BUFFER_FRAMES][IMU_MAX_CHANNELS];  // Buffered frames (counts)
+    uint32_t streamTimes[STREAM_BUFFER_FRAMES];             // Buffered frame times (us)
+    int streamBuffered;                                     // Buffered frames
+    bool streamRefused;                                     // A packet waits for stack buffers
+    int streamChannels;                                     // Channels of the buffered frames
+    uint8_t streamRateHz;                                   // Rate of the buffered frames
+    uint16_t streamSequence;                                // Sequence number of the next packet
+    uint8_t streamValue[MAX_NOTIFY_PAYLOAD];                // Encoded packet (characteristic value)
+    StreamStats streamStats;                                // Stream counters
+    
+    // History log and bulk transfer (declared in initialization order)
+    uint8_t historyStorage[HISTORY_RECORDS * RESULT_RECORD_SIZE];   // Packed records
+    RecordLog history;                          // Every window's record
+    BulkTransferServer bulkServer;              // Pages the history out
+    bool bulkEnabled;                           // Phone subscribed to bulk data
+    bool bulkRefused;                           // A page waits for stack buffers
+    uint8_t bulkControlValue[BULK_CONTROL_MAX]; // Bulk control characteristic value
+    uint8_t bulkDataValue[MAX_NOTIFY_PAYLOAD];  // Bulk data characteristic value
+    
+    // Connection state
+    ConnectionParamManager linkManager;         // Connection parameter policy
+    AdvertisingScheduler advScheduler;          // Advertising phases and time to connect
+    LowPowerTimer clock;                        // Time base for link and advertising timing (runs in deep sleep)
+    
+    bool notifyResults(int length);
+    bool notifyBufferFree() const;
+    void sendStreamPackets();
+    bool sendStreamPacket(int frames);
+    void removeStreamFrames(int frames);
+    int payloadCapacity() const;
+    bool worthSending(const ResultRecord& record) const;
+    void updateLinkProfile();
+    void requestLinkParams(const ConnectionParams& params);
+    bool startAdvertising();
+    uint32_t clockMs();
+    
+    BleEventCallback eventCallback;             // Signals pending stack events
+    #ifdef NATIVE_TEST_MODE
+    GattServerSim* gattSim;                     // Simulated link (not owned), nullptr for none
+    bool manualClock;                           // clockMs() returns manualClockMs
+    uint32_t manualClockMs;                     // Time set by setClockMs() (ms)
+    #endif
+    
     // Hardware-specific BLE objects (only compiled for MBED_OS)
     // Using void* to avoid header inclusion issues, cast in .cpp file
     #ifdef MBED_OS
     void* ble;  // BLE instance pointer (cast to ble::BLE* in implementation)
+    ble::connection_handle_t connectionHandle;  // Handle of the open connection
+    bool resultNotify;                          // Phone subscribed to the results
+    
+    void onEventsToProcess(ble::BLE::OnEventsToProcessCallbackContext* context);
+    LowPowerTimeout linkTimer;  // Signals an event when the relax delay ends
     
     // BLE Service and Characteristic UUIDs (128-bit UUIDs)
     // Service UUID: Main container for all characteristics
@@ -89,11 +749,21 @@ private:
     static const uint8_t TREMOR_CHAR_UUID[];
     static const uint8_t DYSKINESIA_CHAR_UUID[];
     static const uint8_t FOG_CHAR_UUID[];
+    static const uint8_t RESULT_CHAR_UUID[];
+    static const uint8_t RAW_STREAM_CHAR_UUID[];
+    static const uint8_t BULK_CONTROL_CHAR_UUID[];
+    static const uint8_t BULK_DATA_CHAR_UUID[];
+    static const uint8_t FEATURE_CHAR_UUID[];
     
     // GATT objects for BLE communication (cast in implementation)
     void* tremorChar;      // Tremor characteristic (cast to ble::GattCharacteristic*)
     void* dyskinesiaChar;  // Dyskinesia characteristic
     void* fogChar;          // FOG characteristic
+    void* resultChar;       // Packed result record characteristic
+    void* rawStreamChar;    // Raw IMU stream characteristic
+    void* bulkControlChar;  // Bulk transfer control characteristic
+    void* bulkDataChar;     // Bulk transfer data characteristic
+    void* featureChar;      // Spectral feature characteristic
     void* symptomService;  // Main service (cast to ble::GattService*)
     #endif
 };
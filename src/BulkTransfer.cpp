@@ -0,0 +1,338 @@
+/**
+ * @file BulkTransfer.cpp
+ * @brief Implementation of the paged bulk log transfer
+ */
+
+#include "BulkTransfer.h"
+#include <cstdio>
+#include <cstring>
+
+static void putU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint32_t getU32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) |
+           ((uint32_t)in[3] << 24);
+}
+
+RecordLog::RecordLog(uint8_t* storage, int recordSize, int capacity)
+    : storage(storage), recordSize(recordSize), capacity(capacity), held(0), endIndex(0) {
+}
+
+void RecordLog::append(const uint8_t* record) {
+    memcpy(storage + (endIndex % capacity) * recordSize, record, recordSize);
+    endIndex++;
+    if (held < capacity) {
+        held++;
+    }
+}
+
+int RecordLog::read(uint32_t index, uint8_t* out, int count) const {
+    if (index < getFirstIndex() || index >= endIndex) {
+        return 0;
+    }
+    uint32_t available = endIndex - index;
+    if ((uint32_t)count > available) {
+        count = (int)available;
+    }
+    for (int i = 0; i < count; i++) {
+        memcpy(out + i * recordSize, storage + ((index + i) % capacity) * recordSize, recordSize);
+    }
+    return count;
+}
+
+BulkTransferServer::BulkTransferServer(const RecordLog& log)
+    : log(log), channel(nullptr), active(false), nextIndex(0), credits(0) {
+    memset(sdu, 0, sizeof(sdu));
+    memset(&stats, 0, sizeof(stats));
+}
+
+void BulkTransferServer::setChannel(BulkChannel* channel) {
+    this->channel = channel;
+    if (!channel) {
+        active = false;
+        credits = 0;
+    }
+}
+
+/**
+ * @brief Handle a control message from the client
+ * 
+ * A REQUEST replaces any transfer in progress, so a client that lost
+ * track of its state can always start over.
+ */
+bool BulkTransferServer::handleControl(const uint8_t* data, int length) {
+    if (!channel || length < 1) {
+        return false;
+    }
+    switch (data[0]) {
+        case BULK_OP_REQUEST:
+            if (length != 7) {
+                return false;
+            }
+            nextIndex = getU32(data + 1);
+            credits = (uint16_t)(data[5] | (data[6] << 8));
+            active = true;
+            stats.transfers++;
+            break;
+        case BULK_OP_CREDIT: {
+            if (length != 3) {
+                return false;
+            }
+            uint32_t total = credits + (uint32_t)(data[1] | (data[2] << 8));
+            credits = (total > 0xFFFF) ? 0xFFFF : (uint16_t)total;
+            break;
+        }
+        case BULK_OP_ABORT:
+            active = false;
+            credits = 0;
+            return true;
+        default:
+            return false;
+    }
+    pump();
+    return true;
+}
+
+/**
+ * @brief Send pages while credits remain and the channel accepts them
+ * 
+ * Each page carries as many records as fit in one SDU. Records
+ * overwritten since the request are skipped. Once every record up to the
+ * current end of the log is sent, an END (which also costs a credit)
+ * finishes the transfer.
+ */
+void BulkTransferServer::pump() {
+    while (active && channel) {
+        if (credits == 0) {
+            stats.creditStalls++;
+            return;
+        }
+        if (nextIndex < log.getFirstIndex()) {
+            nextIndex = log.getFirstIndex();
+        }
+        
+        int length;
+        int count = 0;
+        if (nextIndex >= log.getEndIndex()) {
+            sdu[0] = BULK_OP_END;
+            putU32(sdu + 1, log.getEndIndex());
+            length = BULK_END_SIZE;
+        } else {
+            int maxSdu = channel->getMaxSdu();
+            if (maxSdu > BULK_MAX_SDU) maxSdu = BULK_MAX_SDU;
+            int room = (maxSdu - BULK_PAGE_HEADER_SIZE) / log.getRecordSize();
+            if (room > 255) room = 255;
+            if (room < 1) {
+                printf("Bulk transfer: SDU of %d bytes cannot hold a record\r\n", maxSdu);
+                active = false;
+                return;
+            }
+            count = log.read(nextIndex, sdu + BULK_PAGE_HEADER_SIZE, room);
+            sdu[0] = BULK_OP_PAGE;
+            putU32(sdu + 1, nextIndex);
+            sdu[5] = (uint8_t)count;
+            sdu[6] = (uint8_t)log.getRecordSize();
+            length = BULK_PAGE_HEADER_SIZE + count * log.getRecordSize();
+        }
+        
+        // A refused SDU is sent again on the next pump()
+        if (!channel->sendSdu(sdu, length)) {
+            return;
+        }
+        credits--;
+        stats.bytesSent += length;
+        if (count > 0) {
+            nextIndex += count;
+            stats.pages++;
+            stats.records += count;
+        } else {
+            active = false;
+            stats.completed++;
+        }
+    }
+}
+
+BulkTransferClient::BulkTransferClient(uint8_t* storage, int recordSize, int capacity,
+                                       uint16_t creditWindow)
+    : storage(storage), recordSize(recordSize), capacity(capacity),
+      creditWindow(creditWindow < 1 ? 1 : creditWindow), outstanding(0), received(0),
+      nextIndex(0), skipped(0), duplicates(0), complete(false) {
+}
+
+int BulkTransferClient::request(uint8_t* out) {
+    outstanding = creditWindow;
+    complete = false;
+    out[0] = BULK_OP_REQUEST;
+    putU32(out + 1, nextIndex);
+    out[5] = (uint8_t)(creditWindow & 0xFF);
+    out[6] = (uint8_t)(creditWindow >> 8);
+    return 7;
+}
+
+/**
+ * @brief Consume one data SDU
+ * 
+ * Records before the expected index (sent again after a resume) are
+ * counted as duplicates and dropped; a jump forward is counted as
+ * skipped records. Once half the credit window is used, a CREDIT
+ * restores it.
+ */
+int BulkTransferClient::receive(const uint8_t* sdu, int length, uint8_t* reply) {
+    if (length < 1) {
+        return -1;
+    }
+    if (outstanding > 0) {
+        outstanding--;
+    }
+    if (sdu[0] == BULK_OP_END) {
+        if (length != BULK_END_SIZE) {
+            return -1;
+        }
+        complete = true;
+        return 0;
+    }
+    if (sdu[0] != BULK_OP_PAGE || length < BULK_PAGE_HEADER_SIZE) {
+        return -1;
+    }
+    uint32_t first = getU32(sdu + 1);
+    int count = sdu[5];
+    if (sdu[6] != recordSize || length != BULK_PAGE_HEADER_SIZE + count * recordSize) {
+        return -1;
+    }
+    
+    const uint8_t* record = sdu + BULK_PAGE_HEADER_SIZE;
+    for (int i = 0; i < count; i++, record += recordSize) {
+        uint32_t index = first + i;
+        if (index < nextIndex) {
+            duplicates++;
+            continue;
+        }
+        skipped += index - nextIndex;
+        if (received < capacity) {
+            memcpy(storage + received * recordSize, record, recordSize);
+            received++;
+        }
+        nextIndex = index + 1;
+    }
+    
+    if (outstanding > creditWindow / 2) {
+        return 0;
+    }
+    uint16_t grant = creditWindow - outstanding;
+    outstanding = creditWindow;
+    reply[0] = BULK_OP_CREDIT;
+    reply[1] = (uint8_t)(grant & 0xFF);
+    reply[2] = (uint8_t)(grant >> 8);
+    return 3;
+}
+
+#ifndef MBED_OS
+LoopbackBulkChannel::LoopbackBulkChannel(const LinkModel& link, BulkTransferServer& server,
+                                         BulkTransferClient& client)
+    : link(link), server(server), client(client), connected(false), queueHead(0),
+      queueCount(0), headFragments(0), refused(false), controlCount(0), elapsedUs(0), packets(0) {
+}
+
+int LoopbackBulkChannel::getMaxSdu() const {
+    return (link.maxSdu > BULK_MAX_SDU) ? BULK_MAX_SDU : link.maxSdu;
+}
+
+bool LoopbackBulkChannel::sendSdu(const uint8_t* data, int length) {
+    if (!connected || length > getMaxSdu()) {
+        return false;
+    }
+    if (queueCount == LOOPBACK_QUEUE_SDUS) {
+        refused = true;
+        return false;
+    }
+    int slot = (queueHead + queueCount) % LOOPBACK_QUEUE_SDUS;
+    memcpy(queue[slot], data, length);
+    queueLength[slot] = length;
+    queueCount++;
+    return true;
+}
+
+void LoopbackBulkChannel::connect() {
+    connected = true;
+    server.setChannel(this);
+    uint8_t message[BULK_CONTROL_MAX];
+    queueControl(message, client.request(message));
+}
+
+void LoopbackBulkChannel::disconnect() {
+    connected = false;
+    queueCount = 0;
+    headFragments = 0;
+    refused = false;
+    controlCount = 0;
+    server.setChannel(nullptr);
+}
+
+/**
+ * @brief LL packets needed for one SDU
+ * 
+ * Each packet carries one K-frame: llPayload minus the 4-byte L2CAP
+ * header of SDU data, the first also carrying the 2-byte SDU length.
+ */
+int LoopbackBulkChannel::fragments(int length) const {
+    int perPacket = link.llPayload - 4;
+    return (length + 2 + perPacket - 1) / perPacket;
+}
+
+void LoopbackBulkChannel::queueControl(const uint8_t* data, int length) {
+    if (length <= 0 || controlCount == LOOPBACK_CONTROL_QUEUE) {
+        return;
+    }
+    memcpy(control[controlCount], data, length);
+    controlLength[controlCount] = length;
+    controlCount++;
+}
+
+uint32_t LoopbackBulkChannel::run(uint32_t maxEvents) {
+    uint32_t events = 0;
+    while (connected && events < maxEvents && !client.isComplete()) {
+        events++;
+        elapsedUs += link.connectionIntervalUs;
+        
+        // The central's packets open the event: last event's replies
+        int replies = controlCount;
+        uint8_t pending[LOOPBACK_CONTROL_QUEUE][BULK_CONTROL_MAX];
+        int pendingLength[LOOPBACK_CONTROL_QUEUE];
+        memcpy(pending, control, sizeof(pending));
+        memcpy(pendingLength, controlLength, sizeof(pendingLength));
+        controlCount = 0;
+        for (int i = 0; i < replies; i++) {
+            server.handleControl(pending[i], pendingLength[i]);
+        }
+        
+        // Then up to packetsPerEvent packets of queued SDUs
+        int budget = link.packetsPerEvent;
+        while (budget > 0 && queueCount > 0) {
+            int remaining = fragments(queueLength[queueHead]) - headFragments;
+            int sent = (remaining < budget) ? remaining : budget;
+            budget -= sent;
+            packets += sent;
+            headFragments += sent;
+            if (sent < remaining) {
+                break;
+            }
+            uint8_t reply[BULK_CONTROL_MAX];
+            queueControl(reply, client.receive(queue[queueHead], queueLength[queueHead], reply));
+            queueHead = (queueHead + 1) % LOOPBACK_QUEUE_SDUS;
+            queueCount--;
+            headFragments = 0;
+        }
+        
+        // Freed queue slots take the SDU the channel refused
+        if (refused && queueCount < LOOPBACK_QUEUE_SDUS) {
+            refused = false;
+            server.pump();
+        }
+    }
+    return events;
+}
+#endif
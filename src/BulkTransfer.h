@@ -0,0 +1,308 @@
+/**
+ * @file BulkTransfer.h
+ * @brief Paged, resumable bulk download of on-device logs
+ * 
+ * A RecordLog keeps the most recent fixed-size records (e.g. every
+ * window's ResultRecord, including those the change-only policy did not
+ * notify). A BulkTransferServer pages a log out over a BulkChannel with
+ * credit-based flow control, framed as on an LE credit-based L2CAP
+ * channel: every SDU the server sends costs one credit, and the client
+ * grants credits as it consumes pages.
+ * 
+ * Records are addressed by a log index that counts every record ever
+ * appended, so a transfer cut by a disconnect resumes by requesting the
+ * index after the last record received. Records overwritten in the
+ * meantime are skipped; the gap shows in the page's first index.
+ * 
+ * Control messages (client to server, little-endian):
+ * - REQUEST: | 0x01 | fromIndex (4) | credits (2) |  start or resume
+ * - CREDIT:  | 0x02 | credits (2) |                  grant more SDUs
+ * - ABORT:   | 0x03 |                              stop the transfer
+ * 
+ * Data SDUs (server to client):
+ * - PAGE: | 0x81 | firstIndex (4) | count | recordSize | count records |
+ * - END:  | 0x82 | endIndex (4) |  all records before endIndex were sent
+ * 
+ * Mbed OS 6 does not expose L2CAP connection-oriented channels in its
+ * BLE API, so on target BLEManager carries the same messages over a
+ * control and a data characteristic. Natively, LoopbackBulkChannel
+ * connects a server and a BulkTransferClient through a model of the
+ * link layer, so transfer throughput can be measured without a radio.
+ */
+
+#ifndef BULK_TRANSFER_H
+#define BULK_TRANSFER_H
+
+#include <cstdint>
+
+const int BULK_MAX_SDU = 512;           // Largest page SDU (bytes)
+const int BULK_PAGE_HEADER_SIZE = 7;    // Bytes before the records of a PAGE
+const int BULK_END_SIZE = 5;            // END SDU (bytes)
+const int BULK_CONTROL_MAX = 7;         // Longest control message (REQUEST, bytes)
+
+// Message opcodes
+const uint8_t BULK_OP_REQUEST = 0x01;
+const uint8_t BULK_OP_CREDIT = 0x02;
+const uint8_t BULK_OP_ABORT = 0x03;
+const uint8_t BULK_OP_PAGE = 0x81;
+const uint8_t BULK_OP_END = 0x82;
+
+/**
+ * @class RecordLog
+ * @brief Ring of fixed-size records addressed by a running index
+ * 
+ * The storage is supplied by the owner (recordSize x capacity bytes);
+ * once full, each append overwrites the oldest record.
+ */
+class RecordLog {
+public:
+    /**
+     * @param storage Buffer of recordSize x capacity bytes
+     * @param recordSize Bytes per record
+     * @param capacity Records kept
+     */
+    RecordLog(uint8_t* storage, int recordSize, int capacity);
+    
+    /**
+     * @brief Append one record, overwriting the oldest when full
+     * @param record recordSize bytes
+     */
+    void append(const uint8_t* record);
+    
+    /**
+     * @brief Copy consecutive records
+     * @param index Log index of the first record (at least getFirstIndex())
+     * @param out Destination for count x recordSize bytes
+     * @param count Records wanted
+     * @return Records copied (fewer at the end of the log, 0 if index is not held)
+     */
+    int read(uint32_t index, uint8_t* out, int count) const;
+    
+    uint32_t getFirstIndex() const { return endIndex - held; }   // Oldest record held
+    uint32_t getEndIndex() const { return endIndex; }            // Index of the next append
+    int getRecordSize() const { return recordSize; }
+    int getCapacity() const { return capacity; }
+    
+private:
+    uint8_t* storage;       // Ring buffer (recordSize x capacity bytes)
+    int recordSize;         // Bytes per record
+    int capacity;           // Records kept
+    int held;               // Records currently held
+    uint32_t endIndex;      // Records ever appended
+};
+
+/**
+ * @class BulkChannel
+ * @brief Transport for data SDUs of a bulk transfer
+ */
+class BulkChannel {
+public:
+    virtual ~BulkChannel() {}
+    
+    /**
+     * @brief Largest SDU the channel carries
+     * @return SDU size (bytes)
+     */
+    virtual int getMaxSdu() const = 0;
+    
+    /**
+     * @brief Send one SDU
+     * @param data SDU
+     * @param length SDU length (bytes)
+     * @return false if the transport cannot take it now (retried later)
+     */
+    virtual bool sendSdu(const uint8_t* data, int length) = 0;
+};
+
+/**
+ * @struct BulkStats
+ * @brief Bulk transfer counters
+ */
+struct BulkStats {
+    uint32_t transfers;         // REQUESTs served
+    uint32_t completed;         // Transfers that reached END
+    uint32_t pages;             // PAGE SDUs sent
+    uint32_t records;           // Records sent
+    uint32_t bytesSent;         // SDU bytes sent
+    uint32_t creditStalls;      // Times sending stopped for lack of credits
+};
+
+/**
+ * @class BulkTransferServer
+ * @brief Pages a RecordLog out over a BulkChannel
+ */
+class BulkTransferServer {
+public:
+    explicit BulkTransferServer(const RecordLog& log);
+    
+    /**
+     * @brief Attach or detach the transport
+     * 
+     * Detaching (nullptr, e.g. on disconnect) ends the transfer; the
+     * client resumes it with a new REQUEST.
+     * 
+     * @param channel Transport, or nullptr
+     */
+    void setChannel(BulkChannel* channel);
+    
+    /**
+     * @brief Handle a control message from the client and send what the credits allow
+     * @param data Message
+     * @param length Message length (bytes)
+     * @return false if the message is malformed or no channel is attached
+     */
+    bool handleControl(const uint8_t* data, int length);
+    
+    /**
+     * @brief Send pages while credits remain and the channel accepts them
+     * 
+     * Called after a control message and whenever the transport has
+     * room again.
+     */
+    void pump();
+    
+    bool isActive() const { return active; }
+    uint32_t getNextIndex() const { return nextIndex; }
+    uint16_t getCredits() const { return credits; }
+    const BulkStats& getStats() const { return stats; }
+    
+private:
+    const RecordLog& log;       // Log being transferred
+    BulkChannel* channel;       // Transport (nullptr while disconnected)
+    bool active;                // Transfer in progress
+    uint32_t nextIndex;         // Log index of the next record to send
+    uint16_t credits;           // SDUs the client can still accept
+    uint8_t sdu[BULK_MAX_SDU];  // SDU being sent
+    BulkStats stats;            // Transfer counters
+};
+
+/**
+ * @class BulkTransferClient
+ * @brief Receiving side of a bulk transfer (reference for the phone app)
+ * 
+ * Stores the records received in order, tracks the index to resume from
+ * and grants credits: the full window at the start, and again up to the
+ * window once half of it is used.
+ */
+class BulkTransferClient {
+public:
+    /**
+     * @param storage Buffer of recordSize x capacity bytes for received records
+     * @param recordSize Bytes per record
+     * @param capacity Records storage holds
+     * @param creditWindow SDUs granted ahead (1 = one page per round trip)
+     */
+    BulkTransferClient(uint8_t* storage, int recordSize, int capacity, uint16_t creditWindow);
+    
+    /**
+     * @brief Build the REQUEST that starts or resumes the transfer at getNextIndex()
+     * @param out Buffer of at least BULK_CONTROL_MAX bytes
+     * @return Message length (bytes)
+     */
+    int request(uint8_t* out);
+    
+    /**
+     * @brief Consume one data SDU
+     * @param sdu SDU
+     * @param length SDU length (bytes)
+     * @param reply Buffer of at least BULK_CONTROL_MAX bytes for a CREDIT
+     * @return Length of the reply to send (0 for none), -1 if the SDU is malformed
+     */
+    int receive(const uint8_t* sdu, int length, uint8_t* reply);
+    
+    const uint8_t* getRecord(int i) const { return storage + i * recordSize; }
+    int getReceived() const { return received; }        // Records stored
+    uint32_t getNextIndex() const { return nextIndex; } // Index to resume from
+    uint32_t getSkipped() const { return skipped; }     // Records overwritten before they were sent
+    uint32_t getDuplicates() const { return duplicates; } // Records received twice (resume overlap)
+    bool isComplete() const { return complete; }
+    
+private:
+    uint8_t* storage;           // Received records
+    int recordSize;             // Bytes per record
+    int capacity;               // Records storage holds
+    uint16_t creditWindow;      // Credits granted ahead
+    uint16_t outstanding;       // Credits granted and not yet used
+    int received;               // Records stored
+    uint32_t nextIndex;         // Log index expected next
+    uint32_t skipped;           // Records missing from the log
+    uint32_t duplicates;        // Records already stored
+    bool complete;              // END received
+};
+
+#ifndef MBED_OS
+const int LOOPBACK_QUEUE_SDUS = 32;     // SDUs queued in the loopback link
+const int LOOPBACK_CONTROL_QUEUE = 8;   // Control messages queued towards the server
+
+/**
+ * @struct LinkModel
+ * @brief Link-layer parameters of the loopback channel
+ */
+struct LinkModel {
+    uint32_t connectionIntervalUs;  // Connection interval (us)
+    int packetsPerEvent;            // LL data packets per connection event
+    int llPayload;                  // LL payload per packet (27, or 251 with DLE)
+    int maxSdu;                     // Negotiated SDU size (bytes, up to BULK_MAX_SDU)
+};
+
+/**
+ * @class LoopbackBulkChannel
+ * @brief Native stand-in for the radio between server and client
+ * 
+ * SDUs are segmented as on a credit-based L2CAP channel: one K-frame per
+ * LL packet, a 4-byte L2CAP header on every frame and the 2-byte SDU
+ * length on the first. Each connection event carries packetsPerEvent
+ * packets; SDUs completed in an event reach the client at its end, and
+ * the client's replies reach the server at the start of the next event.
+ */
+class LoopbackBulkChannel : public BulkChannel {
+public:
+    LoopbackBulkChannel(const LinkModel& link, BulkTransferServer& server,
+                        BulkTransferClient& client);
+    
+    int getMaxSdu() const override;
+    bool sendSdu(const uint8_t* data, int length) override;
+    
+    /**
+     * @brief Attach to the server and send the client's REQUEST
+     */
+    void connect();
+    
+    /**
+     * @brief Drop the link: queued SDUs and control messages are lost
+     */
+    void disconnect();
+    
+    /**
+     * @brief Run connection events until the client completes or maxEvents pass
+     * @param maxEvents Event limit
+     * @return Events run
+     */
+    uint32_t run(uint32_t maxEvents);
+    
+    uint32_t getElapsedUs() const { return elapsedUs; }     // Link time of all events run
+    uint32_t getPackets() const { return packets; }         // LL packets sent
+    
+private:
+    LinkModel link;                 // Link parameters
+    BulkTransferServer& server;     // Sending side
+    BulkTransferClient& client;     // Receiving side
+    bool connected;                 // Link up
+    uint8_t queue[LOOPBACK_QUEUE_SDUS][BULK_MAX_SDU];   // SDUs in flight
+    int queueLength[LOOPBACK_QUEUE_SDUS];               // SDU lengths
+    int queueHead;                  // Oldest SDU
+    int queueCount;                 // SDUs queued
+    int headFragments;              // Packets of the oldest SDU already sent
+    bool refused;                   // An SDU was refused for a full queue
+    uint8_t control[LOOPBACK_CONTROL_QUEUE][BULK_CONTROL_MAX];  // Replies in flight
+    int controlLength[LOOPBACK_CONTROL_QUEUE];                  // Reply lengths
+    int controlCount;               // Replies queued
+    uint32_t elapsedUs;             // Link time (us)
+    uint32_t packets;               // LL packets sent
+    
+    int fragments(int length) const;
+    void queueControl(const uint8_t* data, int length);
+};
+#endif
+
+#endif
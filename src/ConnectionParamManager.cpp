@@ -0,0 +1,114 @@
+/**
+ * @file ConnectionParamManager.cpp
+ * @brief Implementation of the connection parameter manager
+ */
+
+#include "ConnectionParamManager.h"
+#include <cstring>
+
+// Indexed by LinkProfile
+static const ConnectionParams PROFILE_PARAMS[LINK_PROFILES] = {
+    {240, 256, 5, 600},     // Summary: 300-320 ms, latency 5, 6 s timeout
+    {24, 40, 0, 400},       // Streaming: 30-50 ms, 4 s timeout
+    {12, 24, 0, 400},       // Bulk: 15-30 ms, 4 s timeout
+};
+
+ConnectionParamManager::ConnectionParamManager()
+    : linkUp(false), pending(false), demand(LINK_SUMMARY), requested(LINK_NONE),
+      stampDemand(false), demandSinceMs(0), interval(0), latency(0), timeout(0) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+const ConnectionParams& ConnectionParamManager::getProfileParams(LinkProfile profile) {
+    if (profile < LINK_SUMMARY || profile >= LINK_PROFILES) {
+        profile = LINK_SUMMARY;
+    }
+    return PROFILE_PARAMS[profile];
+}
+
+bool ConnectionParamManager::satisfies(LinkProfile profile, uint16_t interval, uint16_t latency) {
+    const ConnectionParams& params = getProfileParams(profile);
+    return interval >= params.minInterval && interval <= params.maxInterval &&
+           latency == params.slaveLatency;
+}
+
+void ConnectionParamManager::connected(uint16_t interval, uint16_t latency, uint16_t timeout) {
+    linkUp = true;
+    pending = false;
+    requested = LINK_NONE;
+    stampDemand = true;     // No time here: the relax delay starts at the next nextRequest()
+    this->interval = interval;
+    this->latency = latency;
+    this->timeout = timeout;
+    stats.connections++;
+}
+
+void ConnectionParamManager::disconnected() {
+    linkUp = false;
+    pending = false;
+    requested = LINK_NONE;
+}
+
+void ConnectionParamManager::updated(bool accepted, uint16_t interval, uint16_t latency,
+                                     uint16_t timeout) {
+    pending = false;
+    if (!accepted) {
+        stats.rejected++;
+        return;
+    }
+    this->interval = interval;
+    this->latency = latency;
+    this->timeout = timeout;
+    stats.updates++;
+}
+
+void ConnectionParamManager::setDemand(bool streaming, bool bulk, uint32_t nowMs) {
+    LinkProfile next = bulk ? LINK_BULK : (streaming ? LINK_STREAMING : LINK_SUMMARY);
+    if (next != demand) {
+        demand = next;
+        requested = LINK_NONE;
+        demandSinceMs = nowMs;
+        stampDemand = false;
+    }
+}
+
+/**
+ * @brief Decide whether to request new parameters now
+ * 
+ * Nothing is requested while an update is outstanding, when the link
+ * already satisfies the demand, or when the demand was already requested
+ * (accepted or not). LINK_SUMMARY additionally waits for the relax delay.
+ */
+bool ConnectionParamManager::nextRequest(uint32_t nowMs, ConnectionParams& params) {
+    if (!linkUp || pending) {
+        return false;
+    }
+    if (stampDemand) {
+        demandSinceMs = nowMs;
+        stampDemand = false;
+    }
+    if (requested == demand) {
+        return false;
+    }
+    if (satisfies(demand, interval, latency)) {
+        requested = demand;
+        return false;
+    }
+    if (demand == LINK_SUMMARY && nowMs - demandSinceMs < LINK_RELAX_DELAY_MS) {
+        return false;
+    }
+    params = getProfileParams(demand);
+    requested = demand;
+    pending = true;
+    stats.requests++;
+    return true;
+}
+
+int32_t ConnectionParamManager::msUntilRequest(uint32_t nowMs) const {
+    if (!linkUp || pending || stampDemand || demand != LINK_SUMMARY || requested == demand ||
+        satisfies(demand, interval, latency)) {
+        return -1;
+    }
+    uint32_t elapsedMs = nowMs - demandSinceMs;
+    return (elapsedMs >= LINK_RELAX_DELAY_MS) ? 0 : (int32_t)(LINK_RELAX_DELAY_MS - elapsedMs);
+}
@@ -0,0 +1,160 @@
+/**
+ * @file ConnectionParamManager.h
+ * @brief Chooses BLE connection parameters from the current data rate
+ * 
+ * The phone picks the connection interval when it connects, typically
+ * 30-50 ms without slave latency, and keeps it. Summary results only need
+ * one small notification every few seconds, so the radio wakes far more
+ * often than the data requires. The manager asks for one of three
+ * profiles instead:
+ * - LINK_SUMMARY: 300-320 ms with a slave latency of 5; the peripheral
+ *   can sleep through up to 5 events with nothing to send
+ * - LINK_STREAMING: 30-50 ms without latency for the raw IMU stream
+ * - LINK_BULK: 15-30 ms without latency for a history download
+ * 
+ * All profiles follow the Apple accessory guidelines that bind most
+ * phones: interval max x (latency + 1) <= 2 s, min + 15 ms <= max and a
+ * supervision timeout above 3 x interval max x (latency + 1).
+ * 
+ * Faster profiles are requested at once. Going back to LINK_SUMMARY
+ * waits LINK_RELAX_DELAY_MS after the demand dropped (and after a
+ * connection opened, leaving service discovery on the fast interval), so
+ * a short pause in a download does not bounce the interval. Each profile
+ * is requested once per demand change: when the central rejects it or
+ * picks other values, the manager does not insist.
+ * 
+ * Intervals are in 1.25 ms units and supervision timeouts in 10 ms units,
+ * as on the air.
+ */
+
+#ifndef CONNECTION_PARAM_MANAGER_H
+#define CONNECTION_PARAM_MANAGER_H
+
+#include <cstdint>
+
+const uint32_t LINK_RELAX_DELAY_MS = 10000;     // Demand must stay low this long before LINK_SUMMARY
+
+/**
+ * @enum LinkProfile
+ * @brief Connection parameter sets by data rate
+ */
+enum LinkProfile {
+    LINK_SUMMARY = 0,   // Result records only
+    LINK_STREAMING,     // Raw IMU stream
+    LINK_BULK,          // History download
+    LINK_PROFILES,      // Number of profiles
+    LINK_NONE = LINK_PROFILES
+};
+
+/**
+ * @struct ConnectionParams
+ * @brief Requested connection parameters
+ */
+struct ConnectionParams {
+    uint16_t minInterval;           // Lowest acceptable interval (1.25 ms units)
+    uint16_t maxInterval;           // Highest acceptable interval (1.25 ms units)
+    uint16_t slaveLatency;          // Events the peripheral may skip
+    uint16_t supervisionTimeout;    // Link loss timeout (10 ms units)
+};
+
+/**
+ * @struct LinkStats
+ * @brief Connection parameter counters
+ */
+struct LinkStats {
+    uint32_t connections;       // Connections opened
+    uint32_t requests;          // Parameter updates requested
+    uint32_t rejected;          // Updates the central refused
+    uint32_t updates;           // Parameter changes reported by the stack
+};
+
+/**
+ * @class ConnectionParamManager
+ * @brief Tracks the link and decides when to request which parameters
+ */
+class ConnectionParamManager {
+public:
+    ConnectionParamManager();
+    
+    /**
+     * @brief Parameters requested for a profile
+     * @param profile LINK_SUMMARY, LINK_STREAMING or LINK_BULK
+     */
+    static const ConnectionParams& getProfileParams(LinkProfile profile);
+    
+    /**
+     * @brief A connection was opened with the central's parameters
+     */
+    void connected(uint16_t interval, uint16_t latency, uint16_t timeout);
+    
+    /**
+     * @brief The connection was closed
+     */
+    void disconnected();
+    
+    /**
+     * @brief The stack reported the outcome of a parameter update
+     * @param accepted false if the central refused the request
+     * @param interval, latency, timeout Parameters now in use
+     */
+    void updated(bool accepted, uint16_t interval, uint16_t latency, uint16_t timeout);
+    
+    /**
+     * @brief Set what the link currently carries
+     * @param streaming Raw IMU stream running
+     * @param bulk History download in progress
+     * @param nowMs Current time (ms), starts the relax delay when demand drops
+     */
+    void setDemand(bool streaming, bool bulk, uint32_t nowMs);
+    
+    /**
+     * @brief Decide whether to request new parameters now
+     * 
+     * Returns true at most once per needed change; the caller sends the
+     * request and reports the outcome through updated().
+     * 
+     * @param nowMs Current time (ms)
+     * @param params Parameters to request
+     * @return true if a request should be sent
+     */
+    bool nextRequest(uint32_t nowMs, ConnectionParams& params);
+    
+    /**
+     * @brief Time until a request waiting for the relax delay is due
+     * 
+     * Lets the caller wake up for the request when nothing else calls
+     * nextRequest() (e.g. no windows while activity gating).
+     * 
+     * @param nowMs Current time (ms)
+     * @return Milliseconds until nextRequest() returns it (0 if due now),
+     *         -1 if no request waits for the delay
+     */
+    int32_t msUntilRequest(uint32_t nowMs) const;
+    
+    bool isConnected() const { return linkUp; }
+    LinkProfile getDemand() const { return demand; }
+    uint16_t getInterval() const { return interval; }
+    uint16_t getLatency() const { return latency; }
+    uint16_t getTimeout() const { return timeout; }
+    const LinkStats& getStats() const { return stats; }
+    
+    /**
+     * @brief Whether parameters satisfy a profile
+     * @return true if the interval is in the profile's range and the latency matches
+     */
+    static bool satisfies(LinkProfile profile, uint16_t interval, uint16_t latency);
+    
+private:
+    bool linkUp;                // Connection open
+    bool pending;               // Request sent, outcome not reported yet
+    LinkProfile demand;         // Profile the traffic needs
+    LinkProfile requested;      // Profile last requested (LINK_NONE after a demand change)
+    bool stampDemand;           // Start the relax delay at the next nextRequest()
+    uint32_t demandSinceMs;     // When the demand last changed (ms)
+    uint16_t interval;          // Interval in use (1.25 ms units)
+    uint16_t latency;           // Slave latency in use
+    uint16_t timeout;           // Supervision timeout in use (10 ms units)
+    LinkStats stats;            // Counters
+};
+
+#endif
@@ -14,7 +14,7 @@
  *
  * Initializes FFT result buffer to null and size to zero.
  */
-FFTProcessor::FFTProcessor() : fftResult(nullptr), fftSize(0)
+FFTProcessor::FFTProcessor() : fftResult(nullptr), fftSize(0), transformSize(0)
 {
 }
 
@@ -63,7 +63,10 @@ void FFTProcessor::process(float *data, int size, float samplingFreq)
         fftResult[i] = std::complex<float>(data[i], 0.0f);
     }
 
-    // Perform FFT transformation
+    // Perform FFT transformation (zero-padded to a power of 2)
+    transformSize = 1;
+    while (transformSize < size)
+        transformSize *= 2;
     fft(fftResult, size);
 }
 
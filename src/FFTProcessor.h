@@ -56,9 +56,20 @@ public:
      */
     float getMagnitude(int bin);
     
+    /**
+     * @brief Get the length actually transformed
+     * 
+     * Inputs are zero-padded to a power of 2, so bin k lies at
+     * k * samplingFreq / getTransformSize() Hz.
+     * 
+     * @return Transform length (0 before process())
+     */
+    int getTransformSize() const { return transformSize; }
+    
 private:
     std::complex<float>* fftResult;  // FFT output (complex numbers)
     int fftSize;                      // Size of FFT (number of samples)
+    int transformSize;                // Zero-padded length transformed
     
     // FFT implementation using Cooley-Tukey algorithm (divide and conquer)
     void fft(std::complex<float>* x, int n);
@@ -0,0 +1,308 @@
+/**
+ * @file GattServerSim.cpp
+ * @brief Implementation of the simulated GATT server and link
+ */
+
+#ifdef NATIVE_TEST_MODE
+
+#include "GattServerSim.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// 1M PHY: preamble, access address, header and CRC around the payload,
+// then T_IFS, the empty acknowledgement and T_IFS again
+static const int LL_PACKET_OVERHEAD = 10;   // Bytes on air besides the payload
+static const uint32_t LL_ACK_US = 150 + 80 + 150;
+
+GattServerSim::GattServerSim(const GattLinkParams& link) : link(link),
+    intervalUs(link.connectionIntervalUs), nowUs(0), nextEventUs(0), queueHead(0),
+    queueCount(0), random(0x2545F491), listenFd(-1), subscriberCount(0) {
+    if (this->link.txBuffers > GATT_SIM_MAX_BUFFERS) {
+        this->link.txBuffers = GATT_SIM_MAX_BUFFERS;
+    }
+    if (this->link.attMtu > GATT_SIM_MAX_PAYLOAD + 3) {
+        this->link.attMtu = GATT_SIM_MAX_PAYLOAD + 3;
+    }
+    memset(&stats, 0, sizeof(stats));
+    path[0] = '\0';
+}
+
+GattServerSim::~GattServerSim() {
+    close();
+}
+
+bool GattServerSim::listen(const char* path) {
+    close();
+    strncpy(this->path, path, sizeof(this->path) - 1);
+    this->path[sizeof(this->path) - 1] = '\0';
+    unlink(this->path);
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", this->path);
+    if (listenFd < 0 || bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        ::listen(listenFd, GATT_SIM_MAX_SUBSCRIBERS) != 0) {
+        printf("GattServerSim: cannot listen on %s\n", this->path);
+        close();
+        return false;
+    }
+    fcntl(listenFd, F_SETFL, fcntl(listenFd, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+void GattServerSim::close() {
+    for (int i = 0; i < subscriberCount; i++) {
+        ::close(subscribers[i]);
+    }
+    subscriberCount = 0;
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        listenFd = -1;
+        unlink(path);
+    }
+}
+
+bool GattServerSim::notify(uint8_t characteristic, const uint8_t* data, int length) {
+    if (length <= 0 || length > link.attMtu - 3) {
+        printf("GattServerSim: %d-byte notification exceeds the %u-byte MTU\n",
+               length, link.attMtu);
+        return false;
+    }
+    if (queueCount >= link.txBuffers) {
+        stats.dropped++;
+        return true;
+    }
+    TxBuffer& buffer = queue[(queueHead + queueCount) % GATT_SIM_MAX_BUFFERS];
+    buffer.characteristic = characteristic;
+    buffer.length = length;
+    buffer.sentBytes = 0;
+    buffer.queuedUs = nowUs;
+    memcpy(buffer.data, data, length);
+    queueCount++;
+    return true;
+}
+
+bool GattServerSim::requestInterval(uint32_t intervalUs) {
+    if (!link.acceptUpdates) {
+        return false;
+    }
+    this->intervalUs = intervalUs;
+    stats.parameterUpdates++;
+    return true;
+}
+
+/**
+ * @brief Run the connection events up to a time
+ * 
+ * Events without queued data only move the anchor: the empty packets
+ * exchanged to keep the connection are not counted.
+ */
+int GattServerSim::advanceTo(uint32_t nowUs) {
+    acceptSubscribers();
+    int delivered = 0;
+    while ((int32_t)(nowUs - nextEventUs) >= 0) {
+        delivered += runEvent(nextEventUs);
+        nextEventUs += intervalUs;
+    }
+    this->nowUs = nowUs;
+    return delivered;
+}
+
+uint32_t GattServerSim::packetTimeUs(int payload) {
+    return (LL_PACKET_OVERHEAD + payload) * 8 + LL_ACK_US;
+}
+
+int GattServerSim::packetsFor(int length, int llPayload) {
+    return (length + GATT_SIM_PDU_OVERHEAD + llPayload - 1) / llPayload;
+}
+
+/**
+ * @brief Send queued packets in one connection event
+ * 
+ * Packets go out back to back until packetsPerEvent are sent or the next
+ * one would not end before the next event; the first packet is always
+ * sent. A notification is delivered when its last packet is acknowledged.
+ * 
+ * @param eventUs Anchor of the event (us)
+ * @return Notifications delivered
+ */
+int GattServerSim::runEvent(uint32_t eventUs) {
+    if (queueCount == 0) {
+        return 0;
+    }
+    stats.events++;
+    uint32_t elapsedUs = 0;
+    int delivered = 0;
+    for (int slot = 0; slot < link.packetsPerEvent && queueCount > 0; slot++) {
+        TxBuffer& buffer = queue[queueHead];
+        int pduBytes = buffer.length + GATT_SIM_PDU_OVERHEAD;
+        int payload = pduBytes - buffer.sentBytes;
+        if (payload > link.llPayload) {
+            payload = link.llPayload;
+        }
+        uint32_t slotUs = packetTimeUs(payload);
+        if (slot > 0 && elapsedUs + slotUs > intervalUs) {
+            break;
+        }
+        elapsedUs += slotUs;
+        stats.packets++;
+        if (lost()) {
+            stats.retransmissions++;
+            continue;
+        }
+        buffer.sentBytes += payload;
+        if (buffer.sentBytes == pduBytes) {
+            deliver(buffer, eventUs + elapsedUs);
+            queueHead = (queueHead + 1) % GATT_SIM_MAX_BUFFERS;
+            queueCount--;
+            delivered++;
+        }
+    }
+    return delivered;
+}
+
+/**
+ * @brief Draw a packet loss (xorshift32)
+ */
+bool GattServerSim::lost() {
+    if (link.dropRate <= 0.0f) {
+        return false;
+    }
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    return (random >> 8) * (1.0f / 16777216.0f) < link.dropRate;
+}
+
+/**
+ * @brief Count a delivered notification and pass it to the subscribers
+ * 
+ * Sends never block: a subscriber whose socket buffer is full is
+ * disconnected rather than stalling the simulation.
+ */
+void GattServerSim::deliver(const TxBuffer& buffer, uint32_t deliveredUs) {
+    uint32_t queueUs = deliveredUs - buffer.queuedUs;
+    stats.notifications++;
+    stats.bytes += buffer.length;
+    stats.totalQueueUs += queueUs;
+    if (queueUs > stats.maxQueueUs) {
+        stats.maxQueueUs = queueUs;
+    }
+    if (subscriberCount == 0) {
+        return;
+    }
+    
+    uint8_t frame[GATT_SIM_HEADER_SIZE + GATT_SIM_MAX_PAYLOAD];
+    uint32_t words[2] = {deliveredUs, buffer.queuedUs};
+    for (int w = 0; w < 2; w++) {
+        for (int b = 0; b < 4; b++) {
+            frame[w * 4 + b] = (uint8_t)(words[w] >> (8 * b));
+        }
+    }
+    frame[8] = buffer.characteristic;
+    frame[9] = 0;
+    frame[10] = (uint8_t)(buffer.length & 0xFF);
+    frame[11] = (uint8_t)(buffer.length >> 8);
+    memcpy(frame + GATT_SIM_HEADER_SIZE, buffer.data, buffer.length);
+    int frameLength = GATT_SIM_HEADER_SIZE + buffer.length;
+    
+    for (int i = 0; i < subscriberCount; ) {
+        ssize_t sent = send(subscribers[i], frame, frameLength, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent == frameLength) {
+            i++;
+            continue;
+        }
+        ::close(subscribers[i]);
+        subscribers[i] = subscribers[--subscriberCount];
+        stats.subscriberDrops++;
+    }
+}
+
+void GattServerSim::acceptSubscribers() {
+    while (listenFd >= 0 && subscriberCount < GATT_SIM_MAX_SUBSCRIBERS) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            break;
+        }
+        subscribers[subscriberCount++] = fd;
+    }
+}
+
+GattSimSubscriber::GattSimSubscriber() : fd(-1), buffered(0) {
+}
+
+GattSimSubscriber::~GattSimSubscriber() {
+    close();
+}
+
+bool GattSimSubscriber::connect(const char* path) {
+    close();
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (fd < 0 || ::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        printf("GattSimSubscriber: cannot connect to %s\n", path);
+        close();
+        return false;
+    }
+    buffered = 0;
+    return true;
+}
+
+void GattSimSubscriber::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+/**
+ * @brief Parse the next frame, receiving more bytes if it is incomplete
+ * 
+ * Frames still buffered are returned after the simulator closed the
+ * socket.
+ */
+bool GattSimSubscriber::receive(GattSimNotification& notification) {
+    while (true) {
+        if (buffered >= GATT_SIM_HEADER_SIZE) {
+            int length = buffer[10] | (buffer[11] << 8);
+            int frameLength = GATT_SIM_HEADER_SIZE + length;
+            if (buffered >= frameLength) {
+                notification.deliveredUs = buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) |
+                                           ((uint32_t)buffer[3] << 24);
+                notification.queuedUs = buffer[4] | (buffer[5] << 8) | (buffer[6] << 16) |
+                                        ((uint32_t)buffer[7] << 24);
+                notification.characteristic = buffer[8];
+                notification.length = (uint16_t)length;
+                memcpy(notification.data, buffer + GATT_SIM_HEADER_SIZE, length);
+                buffered -= frameLength;
+                memmove(buffer, buffer + frameLength, buffered);
+                return true;
+            }
+        }
+        if (fd < 0) {
+            return false;
+        }
+        ssize_t received = recv(fd, buffer + buffered, sizeof(buffer) - buffered, MSG_DONTWAIT);
+        if (received == 0) {
+            close();
+        }
+        if (received <= 0) {
+            return false;
+        }
+        buffered += (int)received;
+    }
+}
+
+#endif // NATIVE_TEST_MODE
@@ -0,0 +1,229 @@
+/**
+ * @file GattServerSim.h
+ * @brief Native model of the BLE link behind BLEManager's notifications
+ * 
+ * Native builds have no radio, so BLEManager only counts and prints what
+ * it would send. Attached to a GattServerSim (BLEManager::setGattServerSim()),
+ * its notifications go through a model of the link instead:
+ * - Each notification holds one of txBuffers stack buffers until it is
+ *   sent; with none free it is dropped, yet notify() succeeds, as the
+ *   stack's write() does once the value is stored. The sender counts
+ *   the notifications in flight against advanceTo()'s deliveries.
+ * - A notification is an ATT PDU (3-byte header) in an L2CAP frame
+ *   (4-byte header), split into LL packets of at most llPayload bytes
+ * - Connection events every connectionIntervalUs carry up to
+ *   packetsPerEvent packets, fewer if their air time does not fit the
+ *   interval (1M PHY, each packet acknowledged by an empty one)
+ * - Each packet is lost with probability dropRate and sent again in the
+ *   next slot, as the link layer does, so loss shows as delay
+ * - Connection parameter requests are accepted or refused (acceptUpdates),
+ *   a new interval applies from the next event
+ * 
+ * A notification is delivered when its last packet is acknowledged. Time
+ * is simulated: the caller moves it forward with advanceTo() while it
+ * feeds data, so a session runs far faster than real time.
+ * 
+ * Delivered notifications go to local subscribers on a Unix domain socket
+ * (listen()), each as a GATT_SIM_HEADER_SIZE-byte header followed by the
+ * payload; GattSimSubscriber is the receiving side. A subscriber that
+ * falls a socket buffer behind is disconnected.
+ */
+
+#ifndef GATT_SERVER_SIM_H
+#define GATT_SERVER_SIM_H
+
+#ifdef NATIVE_TEST_MODE
+
+#include <cstdint>
+
+const int GATT_SIM_MAX_PAYLOAD = 244;    // Largest notification payload (ATT MTU 247)
+const int GATT_SIM_MAX_BUFFERS = 16;     // Most stack buffers modelled
+const int GATT_SIM_MAX_SUBSCRIBERS = 4;  // Socket subscribers served
+const int GATT_SIM_HEADER_SIZE = 12;     // Frame header on the socket (bytes)
+const int GATT_SIM_PDU_OVERHEAD = 7;     // ATT (3) and L2CAP (4) headers per notification
+
+/**
+ * @struct GattLinkParams
+ * @brief Link configuration of the simulated connection
+ */
+struct GattLinkParams {
+    uint32_t connectionIntervalUs;  // Interval at connection (us)
+    int packetsPerEvent;            // LL data packets per connection event
+    int llPayload;                  // LL payload per packet (27, or 251 with DLE)
+    uint16_t attMtu;                // Negotiated ATT MTU (bytes, at most 247)
+    int txBuffers;                  // Notifications the stack can hold (at most GATT_SIM_MAX_BUFFERS)
+    float dropRate;                 // Probability that a packet is lost (0.0-1.0)
+    bool acceptUpdates;             // Central accepts connection parameter requests
+};
+
+/**
+ * @struct GattSimNotification
+ * @brief One delivered notification, as a subscriber receives it
+ * 
+ * Socket frame (little-endian): deliveredUs (4), queuedUs (4),
+ * characteristic (1), reserved (1), length (2), payload.
+ */
+struct GattSimNotification {
+    uint32_t deliveredUs;           // Time the last packet was acknowledged (us)
+    uint32_t queuedUs;              // Time the server wrote the notification (us)
+    uint8_t characteristic;         // Characteristic id given to notify()
+    uint16_t length;                // Payload length (bytes)
+    uint8_t data[GATT_SIM_MAX_PAYLOAD];  // Payload
+};
+
+/**
+ * @struct GattSimStats
+ * @brief Link counters
+ */
+struct GattSimStats {
+    uint32_t notifications;     // Notifications delivered
+    uint32_t bytes;             // Payload bytes delivered
+    uint32_t dropped;           // Notifications dropped (no free buffer)
+    uint32_t events;            // Connection events that carried data
+    uint32_t packets;           // LL packets sent, retransmissions included
+    uint32_t retransmissions;   // LL packets sent again after a loss
+    uint32_t totalQueueUs;      // Sum of write-to-delivery times (us)
+    uint32_t maxQueueUs;        // Longest write-to-delivery time (us)
+    uint32_t parameterUpdates;  // Connection parameter requests accepted
+    uint32_t subscriberDrops;   // Subscribers disconnected for falling behind
+};
+
+/**
+ * @class GattServerSim
+ * @brief Simulated GATT server and link for native benchmarks
+ */
+class GattServerSim {
+public:
+    explicit GattServerSim(const GattLinkParams& link);
+    ~GattServerSim();
+    
+    /**
+     * @brief Serve delivered notifications on a Unix domain socket
+     * 
+     * Subscribers may connect at any time; they are accepted at the next
+     * advanceTo().
+     * 
+     * @param path Socket path (replaced if it exists)
+     * @return false if the socket cannot be created
+     */
+    bool listen(const char* path);
+    
+    /**
+     * @brief Close the socket and disconnect all subscribers
+     */
+    void close();
+    
+    /**
+     * @brief Queue a notification at the current time
+     * @param characteristic Characteristic id passed on to subscribers
+     * @param data Payload
+     * @param length Payload length (bytes, at most ATT MTU - 3)
+     * @return false if the payload exceeds the MTU; true otherwise, also
+     *         when the notification is dropped for lack of a buffer
+     */
+    bool notify(uint8_t characteristic, const uint8_t* data, int length);
+    
+    /**
+     * @brief Ask for a new connection interval
+     * @param intervalUs Interval (us)
+     * @return true if the central accepted (applies from the next event)
+     */
+    bool requestInterval(uint32_t intervalUs);
+    
+    /**
+     * @brief Run the connection events up to a time and deliver what they carry
+     * @param nowUs New current time (us, not before the current one)
+     * @return Notifications delivered (their buffers are free again)
+     */
+    int advanceTo(uint32_t nowUs);
+    
+    uint32_t getNowUs() const { return nowUs; }
+    uint32_t getIntervalUs() const { return intervalUs; }   // Interval in use (us)
+    const GattLinkParams& getLink() const { return link; }
+    int getQueued() const { return queueCount; }            // Notifications waiting
+    int getSubscribers() const { return subscriberCount; }
+    const GattSimStats& getStats() const { return stats; }
+    
+    /**
+     * @brief Air time of one LL packet and its acknowledgement on the 1M PHY
+     * @param payload LL payload (bytes)
+     * @return Time (us), inter-frame spaces included
+     */
+    static uint32_t packetTimeUs(int payload);
+    
+    /**
+     * @brief LL packets one notification needs, without losses
+     * @param length Notification payload (bytes)
+     * @param llPayload LL payload per packet (bytes)
+     */
+    static int packetsFor(int length, int llPayload);
+    
+private:
+    /**
+     * @brief Notification held in a stack buffer
+     */
+    struct TxBuffer {
+        uint8_t characteristic;                 // Characteristic id
+        int length;                             // Payload length (bytes)
+        int sentBytes;                          // PDU bytes acknowledged so far
+        uint32_t queuedUs;                      // Time of the write (us)
+        uint8_t data[GATT_SIM_MAX_PAYLOAD];     // Payload
+    };
+    
+    GattLinkParams link;            // Link configuration
+    uint32_t intervalUs;            // Connection interval in use (us)
+    uint32_t nowUs;                 // Current time (us)
+    uint32_t nextEventUs;           // Anchor of the next connection event (us)
+    TxBuffer queue[GATT_SIM_MAX_BUFFERS];   // Notifications in flight, oldest first
+    int queueHead;                  // Oldest notification
+    int queueCount;                 // Buffers in use
+    uint32_t random;                // Loss generator state (fixed seed, repeatable runs)
+    GattSimStats stats;             // Counters
+    
+    char path[108];                 // Socket path (sun_path size)
+    int listenFd;                   // Listening socket, -1 when closed
+    int subscribers[GATT_SIM_MAX_SUBSCRIBERS];  // Connected subscribers
+    int subscriberCount;            // Subscribers connected
+    
+    int runEvent(uint32_t eventUs);
+    bool lost();
+    void deliver(const TxBuffer& buffer, uint32_t deliveredUs);
+    void acceptSubscribers();
+};
+
+/**
+ * @class GattSimSubscriber
+ * @brief Receiving end of the simulator's notification socket
+ */
+class GattSimSubscriber {
+public:
+    GattSimSubscriber();
+    ~GattSimSubscriber();
+    
+    /**
+     * @brief Connect to a simulator's socket
+     * @param path Socket path given to GattServerSim::listen()
+     * @return false if the connection failed
+     */
+    bool connect(const char* path);
+    
+    void close();
+    
+    /**
+     * @brief Take the next delivered notification, without blocking
+     * @param notification Received notification
+     * @return false if no complete notification has arrived
+     */
+    bool receive(GattSimNotification& notification);
+    
+    bool isConnected() const { return fd >= 0; }
+    
+private:
+    int fd;                         // Connected socket, -1 when closed
+    uint8_t buffer[4096];           // Received bytes not yet parsed
+    int buffered;                   // Bytes in buffer
+};
+
+#endif // NATIVE_TEST_MODE
+
+#endif // GATT_SERVER_SIM_H
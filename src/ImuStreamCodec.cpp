@@ -0,0 +1,194 @@
+/**
+ * @file ImuStreamCodec.cpp
+ * @brief Implementation of the raw IMU stream codec
+ */
+
+#include "ImuStreamCodec.h"
+#include <cmath>
+
+/**
+ * @brief Zigzag-code the wrapped 16-bit difference of two samples
+ * 
+ * The difference is taken modulo 2^16, so any pair of int16 values has a
+ * delta that fits in 16 bits; the decoder adds it back modulo 2^16.
+ */
+static uint16_t zigzagDelta(int16_t previous, int16_t current) {
+    int16_t delta = (int16_t)(uint16_t)((uint16_t)current - (uint16_t)previous);
+    return (uint16_t)(((uint16_t)delta << 1) ^ (uint16_t)(delta >> 15));
+}
+
+static int16_t unzigzagDelta(int16_t previous, uint16_t code) {
+    uint16_t delta = (uint16_t)((code >> 1) ^ (uint16_t)-(int16_t)(code & 1));
+    return (int16_t)(uint16_t)((uint16_t)previous + delta);
+}
+
+int ImuStreamCodec::deltaWidth(int16_t previous, int16_t current) {
+    uint16_t code = zigzagDelta(previous, current);
+    int width = 0;
+    while (code) {
+        width++;
+        code >>= 1;
+    }
+    return width;
+}
+
+int ImuStreamCodec::packetSize(int frames, int channels, int widthSum) {
+    return IMU_STREAM_HEADER_SIZE + 3 * channels + ((frames - 1) * widthSum + 7) / 8;
+}
+
+/**
+ * @brief Number of leading frames that fit in one packet
+ * 
+ * Widths only grow as frames are added, so the first frame that does
+ * not fit ends the packet.
+ */
+int ImuStreamCodec::fitFrames(const int16_t frames[][IMU_MAX_CHANNELS], int count,
+                              int channels, int capacity) {
+    if (count <= 0 || packetSize(1, channels, 0) > capacity) {
+        return 0;
+    }
+    int widths[IMU_MAX_CHANNELS] = {0};
+    int fit = 1;
+    while (fit < count && fit < IMU_STREAM_MAX_FRAMES) {
+        int next[IMU_MAX_CHANNELS];
+        int sum = 0;
+        for (int c = 0; c < channels; c++) {
+            int w = deltaWidth(frames[fit - 1][c], frames[fit][c]);
+            next[c] = (w > widths[c]) ? w : widths[c];
+            sum += next[c];
+        }
+        if (packetSize(fit + 1, channels, sum) > capacity) {
+            break;
+        }
+        for (int c = 0; c < channels; c++) {
+            widths[c] = next[c];
+        }
+        fit++;
+    }
+    return fit;
+}
+
+int ImuStreamCodec::encode(const ImuStreamHeader& header, const int16_t frames[][IMU_MAX_CHANNELS],
+                           int count, uint8_t* out, int capacity) {
+    int channels = header.channels;
+    if (count < 1 || count > IMU_STREAM_MAX_FRAMES || channels < 1 || channels > IMU_MAX_CHANNELS) {
+        return 0;
+    }
+    
+    // Widths of the packet: the largest delta per channel
+    uint8_t widths[IMU_MAX_CHANNELS] = {0};
+    int widthSum = 0;
+    for (int c = 0; c < channels; c++) {
+        for (int i = 1; i < count; i++) {
+            int w = deltaWidth(frames[i - 1][c], frames[i][c]);
+            if (w > widths[c]) widths[c] = (uint8_t)w;
+        }
+        widthSum += widths[c];
+    }
+    int length = packetSize(count, channels, widthSum);
+    if (length > capacity) {
+        return 0;
+    }
+    
+    // Header and key frame
+    out[0] = (uint8_t)(header.sequence & 0xFF);
+    out[1] = (uint8_t)(header.sequence >> 8);
+    for (int i = 0; i < 4; i++) {
+        out[2 + i] = (uint8_t)(header.timestampUs >> (8 * i));
+    }
+    out[6] = (uint8_t)count;
+    out[7] = (uint8_t)channels;
+    out[8] = header.rateHz;
+    uint8_t* p = out + IMU_STREAM_HEADER_SIZE;
+    for (int c = 0; c < channels; c++) {
+        *p++ = (uint8_t)((uint16_t)frames[0][c] & 0xFF);
+        *p++ = (uint8_t)((uint16_t)frames[0][c] >> 8);
+    }
+    for (int c = 0; c < channels; c++) {
+        *p++ = widths[c];
+    }
+    
+    // Bit-packed deltas, LSB first
+    uint32_t bits = 0;
+    int bitCount = 0;
+    for (int i = 1; i < count; i++) {
+        for (int c = 0; c < channels; c++) {
+            bits |= (uint32_t)zigzagDelta(frames[i - 1][c], frames[i][c]) << bitCount;
+            bitCount += widths[c];
+            while (bitCount >= 8) {
+                *p++ = (uint8_t)bits;
+                bits >>= 8;
+                bitCount -= 8;
+            }
+        }
+    }
+    if (bitCount > 0) {
+        *p++ = (uint8_t)bits;
+    }
+    return length;
+}
+
+int ImuStreamCodec::decode(const uint8_t* in, int length, ImuStreamHeader& header,
+                           int16_t frames[][IMU_MAX_CHANNELS], int maxFrames) {
+    if (length < IMU_STREAM_HEADER_SIZE) {
+        return -1;
+    }
+    header.sequence = (uint16_t)(in[0] | (in[1] << 8));
+    header.timestampUs = 0;
+    for (int i = 0; i < 4; i++) {
+        header.timestampUs |= (uint32_t)in[2 + i] << (8 * i);
+    }
+    header.frames = in[6];
+    header.channels = in[7];
+    header.rateHz = in[8];
+    int count = header.frames;
+    int channels = header.channels;
+    if (count < 1 || count > maxFrames || channels < 1 || channels > IMU_MAX_CHANNELS) {
+        return -1;
+    }
+    
+    if (length < IMU_STREAM_HEADER_SIZE + 3 * channels) {
+        return -1;
+    }
+    const uint8_t* p = in + IMU_STREAM_HEADER_SIZE;
+    for (int c = 0; c < channels; c++) {
+        frames[0][c] = (int16_t)(uint16_t)(p[0] | (p[1] << 8));
+        p += 2;
+    }
+    int widths[IMU_MAX_CHANNELS];
+    int widthSum = 0;
+    for (int c = 0; c < channels; c++) {
+        widths[c] = *p++;
+        if (widths[c] > 16) {
+            return -1;
+        }
+        widthSum += widths[c];
+    }
+    if (length != packetSize(count, channels, widthSum)) {
+        return -1;
+    }
+    
+    uint32_t bits = 0;
+    int bitCount = 0;
+    for (int i = 1; i < count; i++) {
+        for (int c = 0; c < channels; c++) {
+            while (bitCount < widths[c]) {
+                bits |= (uint32_t)*p++ << bitCount;
+                bitCount += 8;
+            }
+            uint16_t code = (uint16_t)(bits & ((1u << widths[c]) - 1));
+            bits >>= widths[c];
+            bitCount -= widths[c];
+            frames[i][c] = unzigzagDelta(frames[i - 1][c], code);
+        }
+    }
+    return count;
+}
+
+int16_t ImuStreamCodec::toCounts(float value, float countsPerUnit) {
+    float counts = value * countsPerUnit;
+    if (!(counts == counts)) return 0;  // NaN
+    if (counts >= 32767.0f) return 32767;
+    if (counts <= -32768.0f) return -32768;
+    return (int16_t)lrintf(counts);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file ImuStreamCodec.h
+ * @brief Delta and bit-packing codec for the raw IMU stream
+ * 
+ * Raw samples are sent as int16 sensor counts (accelerometer 0.061 mg/LSB,
+ * gyroscope 8.75 mdps/LSB at the default ranges). Consecutive samples of
+ * a 52Hz IMU differ by far less than the full 16-bit range, so each
+ * packet carries one key frame followed by per-channel deltas, zigzag
+ * coded and bit-packed at the width the largest delta of that channel in
+ * the packet needs.
+ * 
+ * Packet layout (little-endian):
+ * | 0-1      | 2-5         | 6      | 7        | 8      |
+ * | sequence | timestampUs | frames | channels | rateHz |
+ * followed by the key frame (channels x int16), one width byte per
+ * channel, and (frames - 1) x channels deltas, LSB-first, channel by
+ * channel within a frame.
+ * 
+ * Every packet decodes on its own, so a lost packet only loses its own
+ * samples; gaps show up in the sequence number.
+ */
+
+#ifndef IMU_STREAM_CODEC_H
+#define IMU_STREAM_CODEC_H
+
+#include <cstdint>
+
+const int IMU_MAX_CHANNELS = 6;             // Accelerometer X/Y/Z, gyroscope X/Y/Z
+const int IMU_STREAM_HEADER_SIZE = 9;       // Bytes before the key frame
+const int IMU_STREAM_MAX_FRAMES = 255;      // Frames per packet (8-bit count)
+
+// Sensor counts per physical unit at the default ranges (±2g, ±250dps)
+const float IMU_ACCEL_COUNTS_PER_G = 1000.0f / 0.061f;
+const float IMU_GYRO_COUNTS_PER_DPS = 1000.0f / 8.75f;
+
+/**
+ * @struct ImuStreamHeader
+ * @brief Packet header of the raw IMU stream
+ */
+struct ImuStreamHeader {
+    uint16_t sequence;      // Packet sequence number (wraps)
+    uint32_t timestampUs;   // Time of the key frame (us, wraps)
+    uint8_t frames;         // Frames in the packet
+    uint8_t channels;       // 3 (accelerometer) or 6 (with gyroscope)
+    uint8_t rateHz;         // Sample rate of the frames (Hz)
+};
+
+/**
+ * @class ImuStreamCodec
+ * @brief Encodes and decodes raw IMU stream packets
+ * 
+ * Frames are arrays of IMU_MAX_CHANNELS int16 counts; only the first
+ * `channels` entries are used.
+ */
+class ImuStreamCodec {
+public:
+    /**
+     * @brief Size of a packet
+     * @param frames Frames in the packet (at least 1)
+     * @param channels Channels per frame
+     * @param widthSum Sum of the per-channel delta widths (bits)
+     * @return Packet length (bytes); packetSize(1, channels, 0) is the
+     *         smallest packet of that channel count
+     */
+    static int packetSize(int frames, int channels, int widthSum);
+    
+    /**
+     * @brief Number of leading frames that fit in one packet
+     * @param frames Frames to send
+     * @param count Frames available
+     * @param channels Channels per frame (1-6)
+     * @param capacity Packet capacity (bytes)
+     * @return Frames that fit (0 if not even the key frame fits)
+     */
+    static int fitFrames(const int16_t frames[][IMU_MAX_CHANNELS], int count,
+                         int channels, int capacity);
+    
+    /**
+     * @brief Encode frames into one packet
+     * @param header Packet header (frames is taken from count)
+     * @param frames Frames to encode
+     * @param count Frames to encode (1 to IMU_STREAM_MAX_FRAMES)
+     * @param out Output buffer
+     * @param capacity Output buffer size (bytes)
+     * @return Packet length in bytes, 0 if the frames do not fit
+     */
+    static int encode(const ImuStreamHeader& header, const int16_t frames[][IMU_MAX_CHANNELS],
+                      int count, uint8_t* out, int capacity);
+    
+    /**
+     * @brief Decode one packet
+     * @param in Packet
+     * @param length Packet length (bytes)
+     * @param header Decoded header
+     * @param frames Decoded frames
+     * @param maxFrames Room in frames
+     * @return Frames decoded, -1 if the packet is malformed or too long for frames
+     */
+    static int decode(const uint8_t* in, int length, ImuStreamHeader& header,
+                      int16_t frames[][IMU_MAX_CHANNELS], int maxFrames);
+    
+    /**
+     * @brief Convert a physical value to saturated sensor counts
+     * @param value Value in g or deg/s
+     * @param countsPerUnit IMU_ACCEL_COUNTS_PER_G or IMU_GYRO_COUNTS_PER_DPS
+     * @return Rounded counts, clamped to int16
+     */
+    static int16_t toCounts(float value, float countsPerUnit);
+    
+private:
+    static int deltaWidth(int16_t previous, int16_t current);
+};
+
+#endif
@@ -3,7 +3,7 @@
  * @brief Implementation of LSM6DSL sensor driver
  */
 
-#ifdef MBED_OS
+#if defined(MBED_OS) || defined(NATIVE_TEST_MODE)
 
 #include "LSM6DSL.h"
 #include <cstdio>
@@ -17,7 +17,8 @@
  */
 LSM6DSL::LSM6DSL(I2C* i2c) : _i2c(i2c), _address(LSM6DSL_I2C_ADDRESS),
     _accelSensitivity(LSM6DSL_ACCEL_SENSITIVITY_2G),
-    _gyroSensitivity(LSM6DSL_GYRO_SENSITIVITY_250DPS) {
+    _gyroSensitivity(LSM6DSL_GYRO_SENSITIVITY_250DPS),
+    _ctrl1Xl(0), _ctrl2G(0), _ctrl8Xl(0), _ctrl10C(0), _int1Ctrl(0) {
 }
 
 /**
@@ -57,8 +58,9 @@ bool LSM6DSL::init() {
     
     // Configure accelerometer: ±2g full-scale, 52Hz output data rate
     // CTRL1_XL format: [ODR3:ODR0][FS1_XL:FS0_XL][BW1_XL:BW0_XL]
-    uint8_t ctrl1_xl = (LSM6DSL_ODR_52_HZ << 4) | (LSM6DSL_ACCEL_FS_2G << 2);
-    if (!writeRegister(LSM6DSL_CTRL1_XL, ctrl1_xl)) {
+    // The FS constants are already in register position (bits 3:2)
+    _ctrl1Xl = (LSM6DSL_ODR_52_HZ << 4) | LSM6DSL_ACCEL_FS_2G;
+    if (!writeRegister(LSM6DSL_CTRL1_XL, _ctrl1Xl)) {
         printf("LSM6DSL: Cannot configure accelerometer\r\n");
         return false;
     }
@@ -66,8 +68,8 @@ bool LSM6DSL::init() {
     
     // Configure gyroscope: ±250dps full-scale, 52Hz output data rate
     // CTRL2_G format: [ODR3_G:ODR0_G][FS1_G:FS0_G][FS_125]
-    uint8_t ctrl2_g = (LSM6DSL_ODR_52_HZ << 4) | (LSM6DSL_GYRO_FS_250DPS << 2);
-    if (!writeRegister(LSM6DSL_CTRL2_G, ctrl2_g)) {
+    _ctrl2G = (LSM6DSL_ODR_52_HZ << 4) | LSM6DSL_GYRO_FS_250DPS;
+    if (!writeRegister(LSM6DSL_CTRL2_G, _ctrl2G)) {
         printf("LSM6DSL: Cannot configure gyroscope\r\n");
         return false;
     }
@@ -141,7 +143,8 @@ bool LSM6DSL::readGyro(float& x, float& y, float& z) {
  * @brief Check if new sensor data is ready to be read
  * 
  * Reads the status register and checks data ready flags for both
- * accelerometer and gyroscope. Both must be ready for valid readings.
+ * accelerometer and gyroscope. Both must be ready for valid readings;
+ * only the accelerometer flag is checked while the gyroscope is powered down.
  * 
  * @return true if both accelerometer and gyroscope data are ready
  */
@@ -151,8 +154,342 @@ bool LSM6DSL::dataReady() {
         return false;
     }
     // Check accelerometer (bit 0) and gyroscope (bit 1) data ready flags
-    // Both bits must be set (0x03) for data to be ready
-    return (status & 0x03) == 0x03;
+    // Both bits must be set (0x03) for data to be ready, unless the
+    // gyroscope is powered down, in which case GDA never rises
+    uint8_t mask = (getGyroODR() == LSM6DSL_ODR_POWER_DOWN) ? 0x01 : 0x03;
+    return (status & mask) == mask;
+}
+
+/**
+ * @brief Set accelerometer output data rate
+ * 
+ * Rewrites CTRL1_XL from the shadow copy with a new ODR field, keeping the
+ * current full-scale selection. The shadow is only updated on success.
+ * 
+ * @param odr ODR code (LSM6DSL_ODR_POWER_DOWN ... LSM6DSL_ODR_6_66K_HZ)
+ * @return true if write successful, false otherwise
+ */
+bool LSM6DSL::setAccelODR(uint8_t odr) {
+    if (odr > LSM6DSL_ODR_6_66K_HZ) {
+        return false;
+    }
+    uint8_t value = (_ctrl1Xl & 0x0F) | (odr << 4);
+    if (!writeRegister(LSM6DSL_CTRL1_XL, value)) {
+        return false;
+    }
+    _ctrl1Xl = value;
+    return true;
+}
+
+/**
+ * @brief Set gyroscope output data rate
+ * 
+ * Rewrites CTRL2_G from the shadow copy with a new ODR field, keeping the
+ * current full-scale selection.
+ * 
+ * @param odr ODR code (LSM6DSL_ODR_POWER_DOWN ... LSM6DSL_ODR_6_66K_HZ)
+ * @return true if write successful, false otherwise
+ */
+bool LSM6DSL::setGyroODR(uint8_t odr) {
+    if (odr > LSM6DSL_ODR_6_66K_HZ) {
+        return false;
+    }
+    uint8_t value = (_ctrl2G & 0x0F) | (odr << 4);
+    if (!writeRegister(LSM6DSL_CTRL2_G, value)) {
+        return false;
+    }
+    _ctrl2G = value;
+    return true;
+}
+
+/**
+ * @brief Set accelerometer full-scale range
+ * 
+ * Updates the FS_XL field of CTRL1_XL and switches the conversion
+ * sensitivity so readAccel() keeps returning values in g.
+ * 
+ * @param fs Full-scale code (LSM6DSL_ACCEL_FS_2G/4G/8G/16G)
+ * @return true if write successful, false for unknown codes or I2C errors
+ */
+bool LSM6DSL::setAccelRange(uint8_t fs) {
+    float sensitivity;
+    switch (fs) {
+        case LSM6DSL_ACCEL_FS_2G:  sensitivity = LSM6DSL_ACCEL_SENSITIVITY_2G;  break;
+        case LSM6DSL_ACCEL_FS_4G:  sensitivity = LSM6DSL_ACCEL_SENSITIVITY_4G;  break;
+        case LSM6DSL_ACCEL_FS_8G:  sensitivity = LSM6DSL_ACCEL_SENSITIVITY_8G;  break;
+        case LSM6DSL_ACCEL_FS_16G: sensitivity = LSM6DSL_ACCEL_SENSITIVITY_16G; break;
+        default: return false;
+    }
+    uint8_t value = (_ctrl1Xl & 0xF3) | fs;
+    if (!writeRegister(LSM6DSL_CTRL1_XL, value)) {
+        return false;
+    }
+    _ctrl1Xl = value;
+    _accelSensitivity = sensitivity;
+    return true;
+}
+
+/**
+ * @brief Set gyroscope full-scale range
+ * 
+ * Updates the FS_G and FS_125 fields of CTRL2_G and switches the
+ * conversion sensitivity so readGyro() keeps returning values in deg/s.
+ * 
+ * @param fs Full-scale code (LSM6DSL_GYRO_FS_125DPS ... LSM6DSL_GYRO_FS_2000DPS)
+ * @return true if write successful, false for unknown codes or I2C errors
+ */
+bool LSM6DSL::setGyroRange(uint8_t fs) {
+    float sensitivity;
+    switch (fs) {
+        case LSM6DSL_GYRO_FS_125DPS:  sensitivity = LSM6DSL_GYRO_SENSITIVITY_125DPS;  break;
+        case LSM6DSL_GYRO_FS_250DPS:  sensitivity = LSM6DSL_GYRO_SENSITIVITY_250DPS;  break;
+        case LSM6DSL_GYRO_FS_500DPS:  sensitivity = LSM6DSL_GYRO_SENSITIVITY_500DPS;  break;
+        case LSM6DSL_GYRO_FS_1000DPS: sensitivity = LSM6DSL_GYRO_SENSITIVITY_1000DPS; break;
+        case LSM6DSL_GYRO_FS_2000DPS: sensitivity = LSM6DSL_GYRO_SENSITIVITY_2000DPS; break;
+        default: return false;
+    }
+    uint8_t value = (_ctrl2G & 0xF1) | fs;
+    if (!writeRegister(LSM6DSL_CTRL2_G, value)) {
+        return false;
+    }
+    _ctrl2G = value;
+    _gyroSensitivity = sensitivity;
+    return true;
+}
+
+/**
+ * @brief Convert an ODR code to its sampling frequency
+ * 
+ * @param odr ODR code (upper nibble of CTRL1_XL / CTRL2_G)
+ * @return Frequency in Hz, 0 for power-down or invalid codes
+ */
+float LSM6DSL::odrToHz(uint8_t odr) {
+    switch (odr) {
+        case LSM6DSL_ODR_12_5_HZ:  return 12.5f;
+        case LSM6DSL_ODR_26_HZ:    return 26.0f;
+        case LSM6DSL_ODR_52_HZ:    return 52.0f;
+        case LSM6DSL_ODR_104_HZ:   return 104.0f;
+        case LSM6DSL_ODR_208_HZ:   return 208.0f;
+        case LSM6DSL_ODR_416_HZ:   return 416.0f;
+        case LSM6DSL_ODR_833_HZ:   return 833.0f;
+        case LSM6DSL_ODR_1_66K_HZ: return 1660.0f;
+        case LSM6DSL_ODR_3_33K_HZ: return 3330.0f;
+        case LSM6DSL_ODR_6_66K_HZ: return 6660.0f;
+        default: return 0.0f;
+    }
+}
+
+/**
+ * @brief Route accelerometer output through the on-chip high-pass filter
+ * 
+ * CTRL8_XL = HPCF | HP_SLOPE_XL_EN | INPUT_COMPOSITE. The output registers
+ * (and FIFO) then carry gravity-free acceleration.
+ * 
+ * @param cutoff HPCF code (LSM6DSL_XL_HPCF_00 ... LSM6DSL_XL_HPCF_11)
+ * @return true if write successful, false otherwise
+ */
+bool LSM6DSL::enableAccelHighPass(uint8_t cutoff) {
+    uint8_t value = (cutoff & 0x60) | LSM6DSL_CTRL8_HP_SLOPE_XL_EN |
+                    LSM6DSL_CTRL8_INPUT_COMPOSITE;
+    if (!writeRegister(LSM6DSL_CTRL8_XL, value)) {
+        return false;
+    }
+    _ctrl8Xl = value;
+    return true;
+}
+
+/**
+ * @brief Route accelerometer output through the LPF2 low-pass filter
+ * 
+ * @param cutoff HPCF code (LSM6DSL_XL_HPCF_00 ... LSM6DSL_XL_HPCF_11)
+ * @return true if write successful, false otherwise
+ */
+bool LSM6DSL::enableAccelLowPass2(uint8_t cutoff) {
+    uint8_t value = (cutoff & 0x60) | LSM6DSL_CTRL8_LPF2_XL_EN |
+                    LSM6DSL_CTRL8_INPUT_COMPOSITE;
+    if (!writeRegister(LSM6DSL_CTRL8_XL, value)) {
+        return false;
+    }
+    _ctrl8Xl = value;
+    return true;
+}
+
+/**
+ * @brief Restore the unfiltered accelerometer output path
+ * 
+ * @return true if write successful, false otherwise
+ */
+bool LSM6DSL::disableAccelFilters() {
+    if (!writeRegister(LSM6DSL_CTRL8_XL, 0x00)) {
+        return false;
+    }
+    _ctrl8Xl = 0x00;
+    return true;
+}
+
+/**
+ * @brief Toggle only the HP_SLOPE_XL_EN output routing bit
+ * 
+ * @param enabled true to output high-passed data, false for unfiltered
+ * @return true if write successful, false otherwise
+ */
+bool LSM6DSL::setAccelHighPassOutput(bool enabled) {
+    uint8_t value = enabled ? (_ctrl8Xl | LSM6DSL_CTRL8_HP_SLOPE_XL_EN)
+                            : (_ctrl8Xl & ~LSM6DSL_CTRL8_HP_SLOPE_XL_EN);
+    if (!writeRegister(LSM6DSL_CTRL8_XL, value)) {
+        return false;
+    }
+    _ctrl8Xl = value;
+    return true;
+}
+
+/**
+ * @brief Enable the embedded pedometer (step counter)
+ * 
+ * Sets FUNC_EN and PEDO_EN in CTRL10_C after pulsing PEDO_RST_STEP so the
+ * counter starts from zero. Optionally routes the step detector to INT1.
+ * 
+ * @param routeToInt1 true to raise INT1 on every detected step
+ * @return true if configuration successful, false otherwise
+ */
+bool LSM6DSL::enablePedometer(bool routeToInt1) {
+    uint8_t ctrl10 = _ctrl10C | LSM6DSL_CTRL10_FUNC_EN | LSM6DSL_CTRL10_PEDO_EN;
+    if (!writeRegister(LSM6DSL_CTRL10_C, ctrl10 | LSM6DSL_CTRL10_PEDO_RST_STEP) ||
+        !writeRegister(LSM6DSL_CTRL10_C, ctrl10)) {
+        return false;
+    }
+    _ctrl10C = ctrl10;
+    
+    uint8_t int1 = routeToInt1 ? (_int1Ctrl | LSM6DSL_INT1_STEP_DETECTOR)
+                               : (_int1Ctrl & ~LSM6DSL_INT1_STEP_DETECTOR);
+    if (int1 != _int1Ctrl) {
+        if (!writeRegister(LSM6DSL_INT1_CTRL, int1)) {
+            return false;
+        }
+        _int1Ctrl = int1;
+    }
+    return true;
+}
+
+/**
+ * @brief Enable embedded significant motion detection
+ * 
+ * Significant motion is built on the pedometer, so PEDO_EN is set as well.
+ * 
+ * @param routeToInt1 true to raise INT1 on significant motion
+ * @return true if configuration successful, false otherwise
+ */
+bool LSM6DSL::enableSignificantMotion(bool routeToInt1) {
+    uint8_t ctrl10 = _ctrl10C | LSM6DSL_CTRL10_FUNC_EN | LSM6DSL_CTRL10_PEDO_EN |
+                     LSM6DSL_CTRL10_SIGN_MOTION_EN;
+    if (!writeRegister(LSM6DSL_CTRL10_C, ctrl10)) {
+        return false;
+    }
+    _ctrl10C = ctrl10;
+    
+    uint8_t int1 = routeToInt1 ? (_int1Ctrl | LSM6DSL_INT1_SIGN_MOT)
+                               : (_int1Ctrl & ~LSM6DSL_INT1_SIGN_MOT);
+    if (int1 != _int1Ctrl) {
+        if (!writeRegister(LSM6DSL_INT1_CTRL, int1)) {
+            return false;
+        }
+        _int1Ctrl = int1;
+    }
+    return true;
+}
+
+/**
+ * @brief Disable pedometer and significant motion
+ * 
+ * @return true if write successful, false otherwise
+ */
+bool LSM6DSL::disableEmbeddedFunctions() {
+    uint8_t ctrl10 = _ctrl10C & ~(LSM6DSL_CTRL10_FUNC_EN | LSM6DSL_CTRL10_PEDO_EN |
+                                  LSM6DSL_CTRL10_SIGN_MOTION_EN);
+    if (!writeRegister(LSM6DSL_CTRL10_C, ctrl10)) {
+        return false;
+    }
+    _ctrl10C = ctrl10;
+    return true;
+}
+
+/**
+ * @brief Set pedometer minimum threshold
+ * 
+ * @param threshold CONFIG_PEDO_THS_MIN value (bits 4:0, LSB = 16mg at PEDO_FS = 0)
+ * @return true if write successful, false otherwise
+ */
+bool LSM6DSL::setPedometerThreshold(uint8_t threshold) {
+    return writeEmbeddedRegister(LSM6DSL_CONFIG_PEDO_THS_MIN, threshold);
+}
+
+/**
+ * @brief Read the 16-bit hardware step counter
+ * 
+ * Both bytes are fetched in a single burst so low and high byte belong
+ * to the same count.
+ * 
+ * @param steps Reference to store the step count
+ * @return true if read successful, false otherwise
+ */
+bool LSM6DSL::readStepCount(uint16_t& steps) {
+    uint8_t data[2];
+    if (!readRegisters(LSM6DSL_STEP_COUNTER_L, data, 2)) {
+        return false;
+    }
+    steps = (uint16_t)((data[1] << 8) | data[0]);
+    return true;
+}
+
+/**
+ * @brief Clear the hardware step counter
+ * 
+ * @return true if write successful, false otherwise
+ */
+bool LSM6DSL::resetStepCounter() {
+    return writeRegister(LSM6DSL_CTRL10_C, _ctrl10C | LSM6DSL_CTRL10_PEDO_RST_STEP) &&
+           writeRegister(LSM6DSL_CTRL10_C, _ctrl10C);
+}
+
+/**
+ * @brief Read embedded function status (FUNC_SRC1)
+ * 
+ * @param source Reference to store FUNC_SRC1 flags
+ * @return true if read successful, false otherwise
+ */
+bool LSM6DSL::readFunctionSource(uint8_t& source) {
+    return readRegister(LSM6DSL_FUNC_SRC1, source);
+}
+
+/**
+ * @brief Configure wake-up and inactivity detection
+ * 
+ * Programs WAKE_UP_THS, WAKE_UP_DUR, TAP_CFG (interrupt enable, inactivity
+ * mode, slope filter) and routes the inactivity state to INT1 via MD1_CFG.
+ * 
+ * @param wakeThreshold WK_THS (bits 5:0, LSB = full-scale / 64)
+ * @param wakeDuration WAKE_DUR (0-3, LSB = 1 ODR period)
+ * @param sleepDuration SLEEP_DUR (0-15, LSB = 512 ODR periods)
+ * @param inactMode LSM6DSL_INACT_EN_* (accel/gyro behaviour while asleep)
+ * @return true if configuration successful, false otherwise
+ */
+bool LSM6DSL::configureActivityDetection(uint8_t wakeThreshold, uint8_t wakeDuration,
+                                         uint8_t sleepDuration, uint8_t inactMode) {
+    uint8_t wakeUpDur = (uint8_t)(((wakeDuration & 0x03) << 5) | (sleepDuration & 0x0F));
+    return writeRegister(LSM6DSL_WAKE_UP_THS, wakeThreshold & 0x3F) &&
+           writeRegister(LSM6DSL_WAKE_UP_DUR, wakeUpDur) &&
+           writeRegister(LSM6DSL_TAP_CFG, LSM6DSL_TAP_CFG_INTERRUPTS_ENABLE | (inactMode & 0x60)) &&
+           writeRegister(LSM6DSL_MD1_CFG, LSM6DSL_MD1_INT1_INACT_STATE);
+}
+
+/**
+ * @brief Read wake-up source (WAKE_UP_SRC)
+ * 
+ * @param source Reference to store WAKE_UP_SRC flags
+ * @return true if read successful, false otherwise
+ */
+bool LSM6DSL::readWakeUpSource(uint8_t& source) {
+    return readRegister(LSM6DSL_WAKE_UP_SRC, source);
 }
 
 /**
@@ -163,13 +500,31 @@ bool LSM6DSL::dataReady() {
  * @return true if write successful, false otherwise
  */
 bool LSM6DSL::writeRegister(uint8_t reg, uint8_t value) {
-    char data[2] = {reg, value};
+    char data[2] = {(char)reg, (char)value};
     if (_i2c->write(_address, data, 2) != 0) {
         return false;
     }
     return true;
 }
 
+/**
+ * @brief Write a register in embedded functions bank A
+ * 
+ * Opens the bank via FUNC_CFG_ACCESS, writes the register and always
+ * closes the bank again so normal register access is restored.
+ * 
+ * @param reg Bank A register address
+ * @param value Value to write
+ * @return true if write successful, false otherwise
+ */
+bool LSM6DSL::writeEmbeddedRegister(uint8_t reg, uint8_t value) {
+    if (!writeRegister(LSM6DSL_FUNC_CFG_ACCESS, 0x80)) {
+        return false;
+    }
+    bool ok = writeRegister(reg, value);
+    return writeRegister(LSM6DSL_FUNC_CFG_ACCESS, 0x00) && ok;
+}
+
 /**
  * @brief Read a value from a sensor register via I2C
  * 
@@ -238,5 +593,5 @@ int16_t LSM6DSL::read16BitRegister(uint8_t regLow) {
     return (int16_t)((high << 8) | low);
 }
 
-#endif // MBED_OS
+#endif // MBED_OS || NATIVE_TEST_MODE
 
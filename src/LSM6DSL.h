@@ -14,14 +14,26 @@
 #ifndef LSM6DSL_H
 #define LSM6DSL_H
 
-#ifdef MBED_OS
-#include "mbed.h"
+#include <cstdint>
+
+// Register map and bit definitions are shared with the native register
+// model (LSM6DSLSim). The driver class builds against Mbed's I2C on target
+// and against the I2C stand-in from mbed_compat.h in native test builds.
 
 // LSM6DSL register addresses (from datasheet)
+#define LSM6DSL_FUNC_CFG_ACCESS  0x01  // Embedded functions register bank access
+#define LSM6DSL_FIFO_CTRL1       0x06  // FIFO threshold FTH[7:0] (16-bit words)
+#define LSM6DSL_FIFO_CTRL2       0x07  // FIFO threshold FTH[10:8] (bits 2:0)
+#define LSM6DSL_FIFO_CTRL3       0x08  // FIFO decimation: DEC_FIFO_GYRO (bits 5:3), DEC_FIFO_XL (bits 2:0)
+#define LSM6DSL_FIFO_CTRL4       0x09  // FIFO decimation for third/fourth data sets (unused)
+#define LSM6DSL_FIFO_CTRL5       0x0A  // FIFO ODR (bits 6:3) and FIFO mode (bits 2:0)
+#define LSM6DSL_INT1_CTRL        0x0D  // INT1 pin routing (step detector, significant motion)
 #define LSM6DSL_WHO_AM_I         0x0F  // Device identification register (should read 0x6A)
 #define LSM6DSL_CTRL1_XL         0x10  // Accelerometer control register (ODR and full-scale)
 #define LSM6DSL_CTRL2_G          0x11  // Gyroscope control register (ODR and full-scale)
 #define LSM6DSL_CTRL3_C          0x12  // Control register 3 (BDU, IF_INC, etc.)
+#define LSM6DSL_CTRL8_XL         0x17  // Accelerometer filter control (HPF / LPF2 path)
+#define LSM6DSL_WAKE_UP_SRC      0x1B  // Wake-up source (sleep state, wake-up event)
 #define LSM6DSL_STATUS_REG       0x1E  // Status register (data ready flags)
 #define LSM6DSL_OUTX_L_XL        0x28  // Accelerometer X-axis output (low byte)
 #define LSM6DSL_OUTX_H_XL        0x29  // Accelerometer X-axis output (high byte)
@@ -35,6 +47,25 @@
 #define LSM6DSL_OUTY_H_G         0x25  // Gyroscope Y-axis output (high byte)
 #define LSM6DSL_OUTZ_L_G         0x26  // Gyroscope Z-axis output (low byte)
 #define LSM6DSL_OUTZ_H_G         0x27  // Gyroscope Z-axis output (high byte)
+#define LSM6DSL_FIFO_STATUS1     0x3A  // Unread FIFO words DIFF_FIFO[7:0]
+#define LSM6DSL_FIFO_STATUS2     0x3B  // FIFO flags and DIFF_FIFO[10:8]
+#define LSM6DSL_FIFO_STATUS3     0x3C  // Pattern index of the next word FIFO_PATTERN[7:0]
+#define LSM6DSL_FIFO_STATUS4     0x3D  // Pattern index FIFO_PATTERN[9:8]
+#define LSM6DSL_FIFO_DATA_OUT_L  0x3E  // FIFO data output (low byte)
+#define LSM6DSL_FIFO_DATA_OUT_H  0x3F  // FIFO data output (high byte)
+#define LSM6DSL_CTRL10_C         0x19  // Embedded functions enable (pedometer, significant motion)
+#define LSM6DSL_STEP_COUNTER_L   0x4B  // Step counter output (low byte)
+#define LSM6DSL_STEP_COUNTER_H   0x4C  // Step counter output (high byte)
+#define LSM6DSL_FUNC_SRC1        0x53  // Embedded functions status (step detected, significant motion)
+#define LSM6DSL_TAP_CFG          0x58  // Interrupt enable, inactivity mode, slope filter select
+#define LSM6DSL_WAKE_UP_THS      0x5B  // Wake-up threshold (bits 5:0, LSB = FS/64)
+#define LSM6DSL_WAKE_UP_DUR      0x5C  // Wake-up duration (bits 6:5) and sleep duration (bits 3:0)
+#define LSM6DSL_MD1_CFG          0x5E  // INT1 routing of wake-up / inactivity events
+
+// Embedded functions register bank A (accessed with FUNC_CFG_ACCESS = 0x80)
+#define LSM6DSL_CONFIG_PEDO_THS_MIN 0x0F  // Pedometer minimum threshold (bits 4:0) and PEDO_FS (bit 7)
+#define LSM6DSL_SM_THS           0x13  // Significant motion threshold (steps)
+#define LSM6DSL_PEDO_DEB_REG     0x14  // Pedometer debounce: DEB_TIME (bits 7:3, 80ms), DEB_STEP (bits 2:0)
 
 // LSM6DSL I2C addresses
 // Note: B-L475E-IOT01A1 board may use 0xD6 or 0xD4 depending on SA0 pin configuration
@@ -79,6 +110,77 @@
 #define LSM6DSL_ODR_3_33K_HZ     0x09  // 3.33 kHz output data rate
 #define LSM6DSL_ODR_6_66K_HZ     0x0A  // 6.66 kHz output data rate
 
+// CTRL3_C bits
+#define LSM6DSL_CTRL3_BDU              0x40  // Block data update
+#define LSM6DSL_CTRL3_IF_INC           0x04  // Register address auto-increment on multi-byte access
+
+// FIFO_CTRL5 FIFO_MODE[2:0] (bits 2:0); FIFO ODR uses the LSM6DSL_ODR_* codes in bits 6:3
+#define LSM6DSL_FIFO_MODE_BYPASS       0x00  // FIFO disabled and emptied
+#define LSM6DSL_FIFO_MODE_FIFO         0x01  // Stop collecting when full
+#define LSM6DSL_FIFO_MODE_CONTINUOUS   0x06  // Overwrite oldest data when full
+
+// FIFO_CTRL3 decimation codes (DEC_FIFO_XL bits 2:0, DEC_FIFO_GYRO bits 5:3)
+#define LSM6DSL_FIFO_DEC_NOT_IN_FIFO   0x00  // Sensor not stored in FIFO
+#define LSM6DSL_FIFO_DEC_NONE          0x01  // Stored at FIFO ODR without decimation
+
+// FIFO_STATUS2 bits
+#define LSM6DSL_FIFO_STATUS2_WATERM    0x80  // Unread words reached FTH threshold
+#define LSM6DSL_FIFO_STATUS2_OVER_RUN  0x40  // FIFO overwritten (continuous) or full (FIFO mode)
+#define LSM6DSL_FIFO_STATUS2_FULL_SMART 0x20 // Next data set would not fit
+#define LSM6DSL_FIFO_STATUS2_EMPTY     0x10  // FIFO empty
+
+#define LSM6DSL_FIFO_SIZE_WORDS        2048  // 4KB FIFO in 16-bit words
+
+// CTRL8_XL bits: accelerometer composite filter configuration
+#define LSM6DSL_CTRL8_LPF2_XL_EN       0x80  // Route output through LPF2
+#define LSM6DSL_CTRL8_HP_REF_MODE      0x10  // HPF reference mode
+#define LSM6DSL_CTRL8_INPUT_COMPOSITE  0x08  // Composite filter input (0 = ODR/2 path, 1 = ODR/4)
+#define LSM6DSL_CTRL8_HP_SLOPE_XL_EN   0x04  // Route output through HPF / slope filter
+
+// CTRL8_XL HPCF_XL[1:0] cutoff selection (bits 6:5)
+// With HP_SLOPE_XL_EN: slope (ODR/4), ODR/100, ODR/9, ODR/400 high-pass
+// With LPF2_XL_EN:     ODR/50, ODR/100, ODR/9, ODR/400 low-pass
+#define LSM6DSL_XL_HPCF_00       0x00  // HP: slope filter (ODR/4) | LPF2: ODR/50
+#define LSM6DSL_XL_HPCF_01       0x20  // HP: ODR/100              | LPF2: ODR/100
+#define LSM6DSL_XL_HPCF_10       0x40  // HP: ODR/9                | LPF2: ODR/9
+#define LSM6DSL_XL_HPCF_11       0x60  // HP: ODR/400              | LPF2: ODR/400
+
+// CTRL10_C bits
+#define LSM6DSL_CTRL10_PEDO_EN         0x10  // Pedometer algorithm enable
+#define LSM6DSL_CTRL10_FUNC_EN         0x04  // Embedded functions enable
+#define LSM6DSL_CTRL10_PEDO_RST_STEP   0x02  // Reset step counter
+#define LSM6DSL_CTRL10_SIGN_MOTION_EN  0x01  // Significant motion detection enable
+
+// FUNC_SRC1 bits
+#define LSM6DSL_FUNC_SRC1_SIGN_MOTION_IA 0x40  // Significant motion detected
+#define LSM6DSL_FUNC_SRC1_STEP_DETECTED  0x10  // Step detected
+#define LSM6DSL_FUNC_SRC1_STEP_OVERFLOW  0x08  // Step counter overflowed
+
+// INT1_CTRL bits
+#define LSM6DSL_INT1_STEP_DETECTOR     0x80  // Step detector interrupt on INT1
+#define LSM6DSL_INT1_SIGN_MOT          0x40  // Significant motion interrupt on INT1
+
+// TAP_CFG bits
+#define LSM6DSL_TAP_CFG_INTERRUPTS_ENABLE 0x80  // Enable wake-up / activity interrupts
+#define LSM6DSL_INACT_EN_XL_12_5HZ     0x20  // Inactivity: accel to 12.5Hz, gyro unchanged
+#define LSM6DSL_INACT_EN_GYRO_SLEEP    0x40  // Inactivity: accel to 12.5Hz, gyro sleep
+#define LSM6DSL_INACT_EN_GYRO_PD       0x60  // Inactivity: accel to 12.5Hz, gyro power-down
+
+// WAKE_UP_SRC bits
+#define LSM6DSL_WAKE_UP_SRC_SLEEP_STATE_IA 0x10  // Device is in sleep (inactivity) state
+#define LSM6DSL_WAKE_UP_SRC_WU_IA      0x08  // Wake-up event detected
+
+// MD1_CFG bits
+#define LSM6DSL_MD1_INT1_INACT_STATE   0x80  // Inactivity state on INT1 (level)
+#define LSM6DSL_MD1_INT1_WU            0x20  // Wake-up event on INT1
+
+#if defined(MBED_OS) || defined(NATIVE_TEST_MODE)
+#ifdef MBED_OS
+#include "mbed.h"
+#else
+#include "mbed_compat.h"  // Native I2C stand-in, typically attached to LSM6DSLSim
+#endif
+
 /**
  * @class LSM6DSL
  * @brief Driver class for LSM6DSL accelerometer and gyroscope sensor
@@ -99,7 +201,7 @@ public:
      * @brief Initialize sensor and configure registers
      * 
      * Configures accelerometer and gyroscope for 52Hz ODR and appropriate
-     * full-scale ranges. Verifies sensor presence by reading WHO_AM_I register.
+     * full-scale ranges (changeable later via setAccelODR/setAccelRange etc.). Verifies sensor presence by reading WHO_AM_I register.
      * 
      * @return true if initialization successful, false otherwise
      */
@@ -129,20 +231,176 @@ public:
      */
     bool dataReady();
     
+    /**
+     * @brief Set accelerometer output data rate
+     * 
+     * Only the ODR field of CTRL1_XL is changed; the full-scale selection
+     * is preserved from the shadow copy, so no read-back is needed.
+     * 
+     * @param odr ODR code (LSM6DSL_ODR_POWER_DOWN ... LSM6DSL_ODR_6_66K_HZ)
+     * @return true if write successful, false otherwise
+     */
+    bool setAccelODR(uint8_t odr);
+    
+    /**
+     * @brief Set gyroscope output data rate
+     * @param odr ODR code (LSM6DSL_ODR_POWER_DOWN ... LSM6DSL_ODR_6_66K_HZ)
+     * @return true if write successful, false otherwise
+     */
+    bool setGyroODR(uint8_t odr);
+    
+    /**
+     * @brief Set accelerometer full-scale range and matching sensitivity
+     * @param fs Full-scale code (LSM6DSL_ACCEL_FS_2G ... LSM6DSL_ACCEL_FS_16G)
+     * @return true if write successful, false otherwise
+     */
+    bool setAccelRange(uint8_t fs);
+    
+    /**
+     * @brief Set gyroscope full-scale range and matching sensitivity
+     * @param fs Full-scale code (LSM6DSL_GYRO_FS_125DPS ... LSM6DSL_GYRO_FS_2000DPS)
+     * @return true if write successful, false otherwise
+     */
+    bool setGyroRange(uint8_t fs);
+    
+    /**
+     * @brief Convert an ODR code to its sampling frequency
+     * @param odr ODR code
+     * @return Frequency in Hz (0 for power-down or invalid codes)
+     */
+    static float odrToHz(uint8_t odr);
+    
+    /**
+     * @brief Route accelerometer output through the on-chip high-pass filter
+     * 
+     * Removes gravity and offset in hardware (CTRL8_XL HP_SLOPE_XL_EN).
+     * 
+     * @param cutoff HPCF code (LSM6DSL_XL_HPCF_00 ... LSM6DSL_XL_HPCF_11)
+     * @return true if write successful, false otherwise
+     */
+    bool enableAccelHighPass(uint8_t cutoff);
+    
+    /**
+     * @brief Route accelerometer output through the LPF2 low-pass filter
+     * @param cutoff HPCF code (LSM6DSL_XL_HPCF_00 ... LSM6DSL_XL_HPCF_11)
+     * @return true if write successful, false otherwise
+     */
+    bool enableAccelLowPass2(uint8_t cutoff);
+    
+    /**
+     * @brief Restore the unfiltered accelerometer output path
+     * @return true if write successful, false otherwise
+     */
+    bool disableAccelFilters();
+    
+    /**
+     * @brief Toggle only the high-pass output routing bit
+     * 
+     * Keeps the configured cutoff so the unfiltered output can be sampled
+     * briefly (e.g. to refresh a gravity reference) and then restored.
+     * 
+     * @param enabled true to output high-passed data, false for unfiltered
+     * @return true if write successful, false otherwise
+     */
+    bool setAccelHighPassOutput(bool enabled);
+    
+    /**
+     * @brief Enable the embedded pedometer (step counter)
+     * 
+     * Requires an accelerometer ODR of at least 26Hz. The step counter is
+     * cleared on enable and then counts continuously (16-bit, wraps).
+     * 
+     * @param routeToInt1 true to raise INT1 on every detected step
+     * @return true if configuration successful, false otherwise
+     */
+    bool enablePedometer(bool routeToInt1);
+    
+    /**
+     * @brief Enable embedded significant motion detection
+     * @param routeToInt1 true to raise INT1 on significant motion
+     * @return true if configuration successful, false otherwise
+     */
+    bool enableSignificantMotion(bool routeToInt1);
+    
+    /**
+     * @brief Disable pedometer and significant motion
+     * @return true if write successful, false otherwise
+     */
+    bool disableEmbeddedFunctions();
+    
+    /**
+     * @brief Set pedometer minimum threshold (embedded bank A)
+     * @param threshold CONFIG_PEDO_THS_MIN value (bits 4:0, LSB = 16mg at PEDO_FS = 0)
+     * @return true if write successful, false otherwise
+     */
+    bool setPedometerThreshold(uint8_t threshold);
+    
+    /**
+     * @brief Read the 16-bit hardware step counter
+     * @param steps Reference to store the step count
+     * @return true if read successful, false otherwise
+     */
+    bool readStepCount(uint16_t& steps);
+    
+    /**
+     * @brief Clear the hardware step counter (CTRL10_C PEDO_RST_STEP)
+     * @return true if write successful, false otherwise
+     */
+    bool resetStepCounter();
+    
+    /**
+     * @brief Read embedded function status (FUNC_SRC1)
+     * @param source Reference to store FUNC_SRC1 flags
+     * @return true if read successful, false otherwise
+     */
+    bool readFunctionSource(uint8_t& source);
+    
+    /**
+     * @brief Configure wake-up and inactivity detection
+     * 
+     * The sensor enters its sleep state after sleepDuration of motion below
+     * wakeThreshold and wakes on the first slope above it. The sleep state
+     * is routed to INT1 as a level so the MCU can gate on a pin read.
+     * 
+     * @param wakeThreshold WK_THS (bits 5:0, LSB = full-scale / 64)
+     * @param wakeDuration WAKE_DUR (0-3, LSB = 1 ODR period)
+     * @param sleepDuration SLEEP_DUR (0-15, LSB = 512 ODR periods)
+     * @param inactMode LSM6DSL_INACT_EN_* (accel/gyro behaviour while asleep)
+     * @return true if configuration successful, false otherwise
+     */
+    bool configureActivityDetection(uint8_t wakeThreshold, uint8_t wakeDuration,
+                                    uint8_t sleepDuration, uint8_t inactMode);
+    
+    /**
+     * @brief Read wake-up source (WAKE_UP_SRC)
+     * @param source Reference to store WAKE_UP_SRC flags
+     * @return true if read successful, false otherwise
+     */
+    bool readWakeUpSource(uint8_t& source);
+    
+    uint8_t getAccelODR() const { return _ctrl1Xl >> 4; }
+    uint8_t getGyroODR() const { return _ctrl2G >> 4; }
+    
 private:
     I2C* _i2c;                    // I2C interface pointer
     uint8_t _address;              // I2C device address
     float _accelSensitivity;      // Accelerometer sensitivity (mg/LSB) for current range
     float _gyroSensitivity;       // Gyroscope sensitivity (mdps/LSB) for current range
+    uint8_t _ctrl1Xl;             // Shadow copy of CTRL1_XL (accel ODR + full-scale)
+    uint8_t _ctrl2G;              // Shadow copy of CTRL2_G (gyro ODR + full-scale)
+    uint8_t _ctrl8Xl;             // Shadow copy of CTRL8_XL (accel filter path)
+    uint8_t _ctrl10C;             // Shadow copy of CTRL10_C (embedded functions)
+    uint8_t _int1Ctrl;            // Shadow copy of INT1_CTRL (interrupt routing)
     
     // I2C register access methods
     bool writeRegister(uint8_t reg, uint8_t value);              // Write single register
+    bool writeEmbeddedRegister(uint8_t reg, uint8_t value);      // Write embedded bank A register
     bool readRegister(uint8_t reg, uint8_t& value);              // Read single register
     bool readRegisters(uint8_t reg, uint8_t* data, int length);  // Read multiple registers
     int16_t read16BitRegister(uint8_t regLow);                    // Read 16-bit register (low byte address)
 };
 
-#endif // LSM6DSL_H
+#endif // MBED_OS || NATIVE_TEST_MODE
 
-#endif // MBED_OS
+#endif // LSM6DSL_H
 
@@ -0,0 +1,588 @@
+/**
+ * @file LSM6DSLSim.cpp
+ * @brief Implementation of the simulated LSM6DSL register model
+ */
+
+#ifdef NATIVE_TEST_MODE
+
+#include "LSM6DSLSim.h"
+#include <cmath>
+#include <cstring>
+
+/**
+ * @brief Convert an ODR code to a rate
+ * @param odr ODR code (LSM6DSL_ODR_*)
+ * @return Rate in Hz (0 when powered down or invalid)
+ */
+static float odrCodeToHz(uint8_t odr) {
+    static const float rates[] = {0.0f, 12.5f, 26.0f, 52.0f, 104.0f, 208.0f,
+                                  416.0f, 833.0f, 1660.0f, 3330.0f, 6660.0f};
+    return (odr <= LSM6DSL_ODR_6_66K_HZ) ? rates[odr] : 0.0f;
+}
+
+/**
+ * @brief Constructor - Start from power-on defaults
+ */
+LSM6DSLSim::LSM6DSLSim() {
+    reset();
+}
+
+/**
+ * @brief Restore power-on register defaults and clear engine state
+ * 
+ * Defaults follow the datasheet: WHO_AM_I = 0x6A, IF_INC set in CTRL3_C,
+ * CONFIG_PEDO_THS_MIN = 0x10, SM_THS = 0x06, PEDO_DEB_REG = 0x6E.
+ */
+void LSM6DSLSim::reset() {
+    memset(regs, 0, sizeof(regs));
+    memset(bankA, 0, sizeof(bankA));
+    regs[LSM6DSL_WHO_AM_I] = 0x6A;
+    regs[LSM6DSL_CTRL3_C] = 0x04;
+    bankA[LSM6DSL_CONFIG_PEDO_THS_MIN] = 0x10;
+    bankA[LSM6DSL_SM_THS] = 0x06;
+    bankA[LSM6DSL_PEDO_DEB_REG] = 0x6E;
+    
+    baseline = 1.0f;  // 1g at rest
+    stepArmed = true;
+    sampleCount = 0;
+    lastStepSample = -1;
+    pendingSteps = 0;
+    counting = false;
+    motionSteps = -1;
+    
+    prevAccel[0] = prevAccel[1] = prevAccel[2] = 0.0f;
+    wakeCount = 0;
+    quietCount = 0;
+    
+    regPointer = 0;
+    source = nullptr;
+    sourceContext = nullptr;
+    simTime = 0.0;
+    nextSampleTime = 0.0;
+    clearFifo();
+}
+
+/**
+ * @brief Read a register
+ * 
+ * FUNC_SRC1 event flags are cleared on read. Reads while the embedded
+ * bank is open return bank A contents.
+ * 
+ * @param reg Register address
+ * @return Register value
+ */
+uint8_t LSM6DSLSim::readRegister(uint8_t reg) {
+    if (regs[LSM6DSL_FUNC_CFG_ACCESS] & 0x80) {
+        return (reg < sizeof(bankA)) ? bankA[reg] : 0;
+    }
+    if (reg >= sizeof(regs)) {
+        return 0;
+    }
+    if (reg >= LSM6DSL_FIFO_STATUS1 && reg <= LSM6DSL_FIFO_STATUS4) {
+        return readFifoStatus(reg);
+    }
+    if (reg == LSM6DSL_FIFO_DATA_OUT_L || reg == LSM6DSL_FIFO_DATA_OUT_H) {
+        if (fifoCount == 0) {
+            return 0;
+        }
+        uint16_t word = fifo[fifoHead];
+        if (reg == LSM6DSL_FIFO_DATA_OUT_L) {
+            return (uint8_t)(word & 0xFF);
+        }
+        // Reading the high byte consumes the word
+        fifoHead = (fifoHead + 1) % LSM6DSL_FIFO_SIZE_WORDS;
+        fifoCount--;
+        fifoPattern = (fifoPattern + 1) % fifoPatternLength();
+        fifoOverrun = false;
+        return (uint8_t)(word >> 8);
+    }
+    
+    uint8_t value = regs[reg];
+    if (reg >= LSM6DSL_OUTX_L_G && reg <= LSM6DSL_OUTZ_H_G) {
+        regs[LSM6DSL_STATUS_REG] &= ~0x02;  // GDA cleared once output is read
+    } else if (reg >= LSM6DSL_OUTX_L_XL && reg <= LSM6DSL_OUTZ_H_XL) {
+        regs[LSM6DSL_STATUS_REG] &= ~0x01;  // XLDA cleared once output is read
+    } else if (reg == LSM6DSL_FUNC_SRC1) {
+        regs[reg] = 0;
+    } else if (reg == LSM6DSL_WAKE_UP_SRC) {
+        // Wake-up event is latched until read; sleep state is a level
+        regs[reg] &= LSM6DSL_WAKE_UP_SRC_SLEEP_STATE_IA;
+    }
+    return value;
+}
+
+/**
+ * @brief Write a register
+ * 
+ * Handles side effects of CTRL10_C: PEDO_RST_STEP clears the step counter
+ * and a rising SIGN_MOTION_EN arms significant motion detection. Selecting
+ * bypass mode in FIFO_CTRL5 empties the FIFO.
+ * 
+ * @param reg Register address
+ * @param value Value to write
+ */
+void LSM6DSLSim::writeRegister(uint8_t reg, uint8_t value) {
+    if (reg == LSM6DSL_FUNC_CFG_ACCESS) {
+        regs[reg] = value;
+        return;
+    }
+    if (regs[LSM6DSL_FUNC_CFG_ACCESS] & 0x80) {
+        if (reg < sizeof(bankA)) {
+            bankA[reg] = value;
+        }
+        return;
+    }
+    if (reg >= sizeof(regs) || reg == LSM6DSL_WHO_AM_I) {
+        return;
+    }
+    
+    if (reg == LSM6DSL_FIFO_CTRL5 && (value & 0x07) == LSM6DSL_FIFO_MODE_BYPASS) {
+        clearFifo();
+    } else if (reg == LSM6DSL_FIFO_CTRL3 && value != regs[reg]) {
+        clearFifo();  // Pattern layout changes with the data sets stored
+    }
+    
+    if (reg == LSM6DSL_CTRL10_C) {
+        if (value & LSM6DSL_CTRL10_PEDO_RST_STEP) {
+            regs[LSM6DSL_STEP_COUNTER_L] = 0;
+            regs[LSM6DSL_STEP_COUNTER_H] = 0;
+            pendingSteps = 0;
+            counting = false;
+            lastStepSample = -1;
+        }
+        if ((value & LSM6DSL_CTRL10_SIGN_MOTION_EN) &&
+            !(regs[reg] & LSM6DSL_CTRL10_SIGN_MOTION_EN)) {
+            motionSteps = 0;
+        }
+    }
+    regs[reg] = value;
+}
+
+/**
+ * @brief Feed one output data period to the model
+ * 
+ * @param ax, ay, az Acceleration in g
+ * @param gx, gy, gz Angular rate in deg/s
+ */
+void LSM6DSLSim::pushSample(float ax, float ay, float az, float gx, float gy, float gz) {
+    if ((regs[LSM6DSL_CTRL1_XL] >> 4) != LSM6DSL_ODR_POWER_DOWN) {
+        float sensitivity;
+        switch (regs[LSM6DSL_CTRL1_XL] & 0x0C) {
+            case LSM6DSL_ACCEL_FS_4G:  sensitivity = LSM6DSL_ACCEL_SENSITIVITY_4G;  break;
+            case LSM6DSL_ACCEL_FS_8G:  sensitivity = LSM6DSL_ACCEL_SENSITIVITY_8G;  break;
+            case LSM6DSL_ACCEL_FS_16G: sensitivity = LSM6DSL_ACCEL_SENSITIVITY_16G; break;
+            default:                   sensitivity = LSM6DSL_ACCEL_SENSITIVITY_2G;  break;
+        }
+        writeRaw16(LSM6DSL_OUTX_L_XL, ax * 1000.0f, sensitivity);
+        writeRaw16(LSM6DSL_OUTY_L_XL, ay * 1000.0f, sensitivity);
+        writeRaw16(LSM6DSL_OUTZ_L_XL, az * 1000.0f, sensitivity);
+        regs[LSM6DSL_STATUS_REG] |= 0x01;
+        
+        // Pedometer needs the accelerometer running at 26Hz or more
+        uint8_t ctrl10 = regs[LSM6DSL_CTRL10_C];
+        if ((ctrl10 & LSM6DSL_CTRL10_FUNC_EN) && (ctrl10 & LSM6DSL_CTRL10_PEDO_EN) &&
+            odrHz() >= 26.0f) {
+            runPedometer(sqrtf(ax*ax + ay*ay + az*az));
+        }
+        if (regs[LSM6DSL_TAP_CFG] & LSM6DSL_TAP_CFG_INTERRUPTS_ENABLE) {
+            runActivity(ax, ay, az);
+        }
+        prevAccel[0] = ax;
+        prevAccel[1] = ay;
+        prevAccel[2] = az;
+    }
+    
+    if ((regs[LSM6DSL_CTRL2_G] >> 4) != LSM6DSL_ODR_POWER_DOWN) {
+        float sensitivity;
+        switch (regs[LSM6DSL_CTRL2_G] & 0x0E) {
+            case LSM6DSL_GYRO_FS_125DPS:  sensitivity = LSM6DSL_GYRO_SENSITIVITY_125DPS;  break;
+            case LSM6DSL_GYRO_FS_500DPS:  sensitivity = LSM6DSL_GYRO_SENSITIVITY_500DPS;  break;
+            case LSM6DSL_GYRO_FS_1000DPS: sensitivity = LSM6DSL_GYRO_SENSITIVITY_1000DPS; break;
+            case LSM6DSL_GYRO_FS_2000DPS: sensitivity = LSM6DSL_GYRO_SENSITIVITY_2000DPS; break;
+            default:                      sensitivity = LSM6DSL_GYRO_SENSITIVITY_250DPS;  break;
+        }
+        writeRaw16(LSM6DSL_OUTX_L_G, gx * 1000.0f, sensitivity);
+        writeRaw16(LSM6DSL_OUTY_L_G, gy * 1000.0f, sensitivity);
+        writeRaw16(LSM6DSL_OUTZ_L_G, gz * 1000.0f, sensitivity);
+        regs[LSM6DSL_STATUS_REG] |= 0x02;
+    }
+    
+    // FIFO samples at ODR_FIFO, decimated from the sensor data rate
+    uint8_t fifoOdr = (regs[LSM6DSL_FIFO_CTRL5] >> 3) & 0x0F;
+    float sensorHz = odrHz();
+    if (sensorHz <= 0.0f) {
+        sensorHz = odrCodeToHz(regs[LSM6DSL_CTRL2_G] >> 4);
+    }
+    if ((regs[LSM6DSL_FIFO_CTRL5] & 0x07) != LSM6DSL_FIFO_MODE_BYPASS && fifoOdr != 0 &&
+        sensorHz > 0.0f) {
+        fifoPhase += odrCodeToHz(fifoOdr) / sensorHz;
+        if (fifoPhase >= 1.0f) {
+            fifoPhase = (fifoPhase >= 2.0f) ? 0.0f : fifoPhase - 1.0f;
+            storeFifo(&regs[LSM6DSL_OUTX_L_G], &regs[LSM6DSL_OUTX_L_XL]);
+        }
+    }
+    
+    sampleCount++;
+}
+
+/**
+ * @brief Get the step counter value
+ * @return Current 16-bit step count
+ */
+uint16_t LSM6DSLSim::getStepCount() const {
+    return (uint16_t)((regs[LSM6DSL_STEP_COUNTER_H] << 8) | regs[LSM6DSL_STEP_COUNTER_L]);
+}
+
+/**
+ * @brief Attach a signal source used by advance()
+ * @param source Signal callback (nullptr generates a sensor at rest)
+ * @param context User pointer passed to the callback
+ */
+void LSM6DSLSim::setSignalSource(LSM6DSLSignalSource source, void* context) {
+    this->source = source;
+    sourceContext = context;
+}
+
+/**
+ * @brief Advance simulated time, generating samples at the accelerometer ODR
+ * 
+ * Sampling follows the accelerometer ODR (the gyroscope ODR when the
+ * accelerometer is powered down), re-read after every sample so rate
+ * changes made between calls take effect immediately.
+ * 
+ * @param seconds Time to advance
+ * @return Number of samples generated
+ */
+int LSM6DSLSim::advance(double seconds) {
+    double end = simTime + seconds;
+    int generated = 0;
+    
+    while (true) {
+        float rate = odrHz();
+        if (rate <= 0.0f) {
+            rate = odrCodeToHz(regs[LSM6DSL_CTRL2_G] >> 4);
+        }
+        if (rate <= 0.0f) {
+            nextSampleTime = end;  // Powered down: resume sampling from now
+            break;
+        }
+        if (nextSampleTime > end) {
+            break;
+        }
+        
+        simTime = nextSampleTime;
+        float accel[3] = {0.0f, 0.0f, 1.0f};
+        float gyro[3] = {0.0f, 0.0f, 0.0f};
+        if (source != nullptr) {
+            source(simTime, accel, gyro, sourceContext);
+        }
+        pushSample(accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2]);
+        generated++;
+        nextSampleTime += 1.0 / rate;
+    }
+    
+    simTime = end;
+    return generated;
+}
+
+/**
+ * @brief Get simulated time
+ * @return Seconds since reset
+ */
+double LSM6DSLSim::getTime() const {
+    return simTime;
+}
+
+/**
+ * @brief Get the number of unread words in the FIFO
+ * @return Unread 16-bit words
+ */
+int LSM6DSLSim::getFifoLevel() const {
+    return fifoCount;
+}
+
+/**
+ * @brief I2C write from the bus master
+ * 
+ * The first byte sets the register pointer; further bytes are written to
+ * consecutive registers when IF_INC is set in CTRL3_C.
+ * 
+ * @param data Bytes written by the master
+ * @param length Number of bytes
+ * @param repeated Master keeps the bus for a repeated start (unused)
+ * @return true (the model always acknowledges)
+ */
+bool LSM6DSLSim::i2cWrite(const char* data, int length, bool repeated) {
+    (void)repeated;
+    if (length <= 0) {
+        return true;  // Address-only probe
+    }
+    regPointer = (uint8_t)data[0] & 0x7F;
+    for (int i = 1; i < length; i++) {
+        writeRegister(regPointer, (uint8_t)data[i]);
+        if (regs[LSM6DSL_CTRL3_C] & LSM6DSL_CTRL3_IF_INC) {
+            regPointer = (regPointer + 1) & 0x7F;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief I2C read from the bus master
+ * 
+ * Reads consecutive registers from the register pointer when IF_INC is set.
+ * FIFO_DATA_OUT_H wraps back to FIFO_DATA_OUT_L so the whole FIFO can be
+ * drained in a single burst.
+ * 
+ * @param data Buffer for the bytes read
+ * @param length Number of bytes
+ * @return true (the model always acknowledges)
+ */
+bool LSM6DSLSim::i2cRead(char* data, int length) {
+    for (int i = 0; i < length; i++) {
+        data[i] = (char)readRegister(regPointer);
+        if (regs[LSM6DSL_CTRL3_C] & LSM6DSL_CTRL3_IF_INC) {
+            regPointer = (regPointer == LSM6DSL_FIFO_DATA_OUT_H) ?
+                         LSM6DSL_FIFO_DATA_OUT_L : ((regPointer + 1) & 0x7F);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Accelerometer output data rate from CTRL1_XL
+ * @return ODR in Hz (0 when powered down)
+ */
+float LSM6DSLSim::odrHz() const {
+    return odrCodeToHz(regs[LSM6DSL_CTRL1_XL] >> 4);
+}
+
+/**
+ * @brief Convert a value to raw LSBs and store it little-endian
+ * 
+ * @param regLow Low byte register address
+ * @param value Value in milli-units (mg or mdps)
+ * @param sensitivity Milli-units per LSB
+ */
+void LSM6DSLSim::writeRaw16(uint8_t regLow, float value, float sensitivity) {
+    float raw = value / sensitivity;
+    if (raw > 32767.0f) raw = 32767.0f;
+    if (raw < -32768.0f) raw = -32768.0f;
+    int16_t r = (int16_t)lrintf(raw);
+    regs[regLow] = (uint8_t)(r & 0xFF);
+    regs[regLow + 1] = (uint8_t)((r >> 8) & 0xFF);
+}
+
+/**
+ * @brief Embedded pedometer engine
+ * 
+ * Behavioural model, not a bit-exact copy of the silicon: a step is a rise
+ * of the acceleration magnitude above a slow baseline by more than
+ * CONFIG_PEDO_THS_MIN (16mg or 32mg LSB depending on PEDO_FS), re-armed
+ * once the magnitude falls back below half the threshold, with a 250ms
+ * refractory period.
+ * 
+ * @param magnitude Acceleration magnitude in g
+ */
+void LSM6DSLSim::runPedometer(float magnitude) {
+    baseline += 0.02f * (magnitude - baseline);
+    
+    uint8_t ths = bankA[LSM6DSL_CONFIG_PEDO_THS_MIN];
+    float threshold = (ths & 0x1F) * ((ths & 0x80) ? 0.032f : 0.016f);
+    float deviation = magnitude - baseline;
+    long refractory = (long)(0.25f * odrHz());
+    
+    if (stepArmed && deviation > threshold &&
+        (lastStepSample < 0 || sampleCount - lastStepSample >= refractory)) {
+        stepArmed = false;
+        countStep();
+    } else if (deviation < threshold * 0.5f) {
+        stepArmed = true;
+    }
+}
+
+/**
+ * @brief Wake-up / inactivity engine
+ * 
+ * Uses the slope filter (difference of consecutive samples) like the device
+ * with SLOPE_FDS = 0. Any axis above WK_THS (full-scale / 64 LSB) for more
+ * than WAKE_DUR samples wakes the device; SLEEP_DUR x 512 samples below it
+ * (16 samples when SLEEP_DUR = 0) enter the sleep state.
+ * 
+ * @param ax, ay, az Acceleration in g
+ */
+void LSM6DSLSim::runActivity(float ax, float ay, float az) {
+    static const float fullScale[] = {2.0f, 16.0f, 4.0f, 8.0f};
+    float threshold = (regs[LSM6DSL_WAKE_UP_THS] & 0x3F) *
+                      fullScale[(regs[LSM6DSL_CTRL1_XL] >> 2) & 0x03] / 64.0f;
+    int wakeDur = (regs[LSM6DSL_WAKE_UP_DUR] >> 5) & 0x03;
+    int sleepDur = regs[LSM6DSL_WAKE_UP_DUR] & 0x0F;
+    long sleepSamples = sleepDur ? sleepDur * 512L : 16L;
+    
+    bool moving = fabsf(ax - prevAccel[0]) > threshold ||
+                  fabsf(ay - prevAccel[1]) > threshold ||
+                  fabsf(az - prevAccel[2]) > threshold;
+    if (moving) {
+        quietCount = 0;
+        if (++wakeCount > wakeDur) {
+            regs[LSM6DSL_WAKE_UP_SRC] = (regs[LSM6DSL_WAKE_UP_SRC] & ~LSM6DSL_WAKE_UP_SRC_SLEEP_STATE_IA) |
+                                        LSM6DSL_WAKE_UP_SRC_WU_IA;
+        }
+    } else {
+        wakeCount = 0;
+        if (++quietCount >= sleepSamples) {
+            regs[LSM6DSL_WAKE_UP_SRC] |= LSM6DSL_WAKE_UP_SRC_SLEEP_STATE_IA;
+        }
+    }
+}
+
+/**
+ * @brief Register a detected step
+ * 
+ * Implements DEB_STEP/DEB_TIME debouncing: after a pause longer than
+ * DEB_TIME (80ms LSB) the counter holds steps back until DEB_STEP
+ * consecutive steps have been seen, then adds them all at once.
+ */
+void LSM6DSLSim::countStep() {
+    uint8_t deb = bankA[LSM6DSL_PEDO_DEB_REG];
+    long debTime = (long)(((deb >> 3) & 0x1F) * 0.08f * odrHz());
+    int debStep = deb & 0x07;
+    
+    if (lastStepSample >= 0 && sampleCount - lastStepSample > debTime) {
+        counting = false;
+        pendingSteps = 0;
+    }
+    lastStepSample = sampleCount;
+    regs[LSM6DSL_FUNC_SRC1] |= LSM6DSL_FUNC_SRC1_STEP_DETECTED;
+    
+    int add = 0;
+    if (counting) {
+        add = 1;
+    } else if (++pendingSteps >= debStep) {
+        add = pendingSteps;
+        pendingSteps = 0;
+        counting = true;
+    }
+    
+    if (add > 0) {
+        uint32_t count = (uint32_t)getStepCount() + add;
+        if (count > 0xFFFF) {
+            regs[LSM6DSL_FUNC_SRC1] |= LSM6DSL_FUNC_SRC1_STEP_OVERFLOW;
+        }
+        regs[LSM6DSL_STEP_COUNTER_L] = (uint8_t)(count & 0xFF);
+        regs[LSM6DSL_STEP_COUNTER_H] = (uint8_t)((count >> 8) & 0xFF);
+    }
+    
+    // Significant motion fires once after SM_THS steps, then disarms
+    if ((regs[LSM6DSL_CTRL10_C] & LSM6DSL_CTRL10_SIGN_MOTION_EN) && motionSteps >= 0) {
+        if (++motionSteps >= bankA[LSM6DSL_SM_THS]) {
+            regs[LSM6DSL_FUNC_SRC1] |= LSM6DSL_FUNC_SRC1_SIGN_MOTION_IA;
+            motionSteps = -1;
+        }
+    }
+}
+
+/**
+ * @brief Number of words in one FIFO data set
+ * 
+ * Gyroscope words (x, y, z) come first, then accelerometer words, as on the
+ * device. Decimation factors other than "not in FIFO" are treated as no
+ * decimation.
+ * 
+ * @return Words per data set (at least 1)
+ */
+int LSM6DSLSim::fifoPatternLength() const {
+    uint8_t ctrl3 = regs[LSM6DSL_FIFO_CTRL3];
+    int length = 0;
+    if ((ctrl3 >> 3) & 0x07) length += 3;
+    if (ctrl3 & 0x07) length += 3;
+    return length ? length : 1;
+}
+
+/**
+ * @brief Store one data set in the FIFO
+ * 
+ * In FIFO mode storage stops when the FIFO is full; in continuous mode the
+ * oldest data set is dropped. Both set OVER_RUN.
+ * 
+ * @param gyroRaw Raw gyroscope output (6 bytes, little-endian x, y, z)
+ * @param accelRaw Raw accelerometer output (6 bytes, little-endian x, y, z)
+ */
+void LSM6DSLSim::storeFifo(const uint8_t* gyroRaw, const uint8_t* accelRaw) {
+    uint8_t ctrl3 = regs[LSM6DSL_FIFO_CTRL3];
+    bool storeGyro = ((ctrl3 >> 3) & 0x07) != LSM6DSL_FIFO_DEC_NOT_IN_FIFO;
+    bool storeAccel = (ctrl3 & 0x07) != LSM6DSL_FIFO_DEC_NOT_IN_FIFO;
+    if (!storeGyro && !storeAccel) {
+        return;
+    }
+    
+    int length = fifoPatternLength();
+    if (fifoCount + length > LSM6DSL_FIFO_SIZE_WORDS) {
+        fifoOverrun = true;
+        if ((regs[LSM6DSL_FIFO_CTRL5] & 0x07) == LSM6DSL_FIFO_MODE_FIFO) {
+            return;
+        }
+        // Continuous: drop the oldest data set to keep the pattern aligned
+        int drop = length - fifoPattern;
+        if (drop > fifoCount) drop = fifoCount;
+        fifoHead = (fifoHead + drop) % LSM6DSL_FIFO_SIZE_WORDS;
+        fifoCount -= drop;
+        fifoPattern = 0;
+    }
+    
+    for (int axis = 0; storeGyro && axis < 3; axis++) {
+        pushFifoWord((uint16_t)(gyroRaw[2 * axis] | (gyroRaw[2 * axis + 1] << 8)));
+    }
+    for (int axis = 0; storeAccel && axis < 3; axis++) {
+        pushFifoWord((uint16_t)(accelRaw[2 * axis] | (accelRaw[2 * axis + 1] << 8)));
+    }
+}
+
+/**
+ * @brief Append a word at the FIFO tail
+ * @param word Raw 16-bit sample
+ */
+void LSM6DSLSim::pushFifoWord(uint16_t word) {
+    fifo[(fifoHead + fifoCount) % LSM6DSL_FIFO_SIZE_WORDS] = word;
+    fifoCount++;
+}
+
+/**
+ * @brief Compose FIFO_STATUS1-4
+ * @param reg FIFO_STATUS register address
+ * @return Register value
+ */
+uint8_t LSM6DSLSim::readFifoStatus(uint8_t reg) const {
+    switch (reg) {
+        case LSM6DSL_FIFO_STATUS1:
+            return (uint8_t)(fifoCount & 0xFF);
+        case LSM6DSL_FIFO_STATUS2: {
+            int threshold = regs[LSM6DSL_FIFO_CTRL1] | ((regs[LSM6DSL_FIFO_CTRL2] & 0x07) << 8);
+            uint8_t value = (uint8_t)((fifoCount >> 8) & 0x07);
+            if (threshold > 0 && fifoCount >= threshold) value |= LSM6DSL_FIFO_STATUS2_WATERM;
+            if (fifoOverrun) value |= LSM6DSL_FIFO_STATUS2_OVER_RUN;
+            if (fifoCount + fifoPatternLength() > LSM6DSL_FIFO_SIZE_WORDS) {
+                value |= LSM6DSL_FIFO_STATUS2_FULL_SMART;
+            }
+            if (fifoCount == 0) value |= LSM6DSL_FIFO_STATUS2_EMPTY;
+            return value;
+        }
+        case LSM6DSL_FIFO_STATUS3:
+            return (uint8_t)(fifoPattern & 0xFF);
+        default:
+            return (uint8_t)((fifoPattern >> 8) & 0x03);
+    }
+}
+
+/**
+ * @brief Empty the FIFO and clear its flags
+ */
+void LSM6DSLSim::clearFifo() {
+    fifoHead = 0;
+    fifoCount = 0;
+    fifoPattern = 0;
+    fifoOverrun = false;
+    fifoPhase = 0.0f;
+}
+
+#endif // NATIVE_TEST_MODE
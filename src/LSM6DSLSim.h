@@ -0,0 +1,168 @@
+/**
+ * @file LSM6DSLSim.h
+ * @brief Register-level model of the LSM6DSL for native testing
+ * 
+ * Emulates the parts of the LSM6DSL register map the firmware relies on so
+ * register-driven code paths can be exercised without hardware:
+ * - WHO_AM_I, CTRL1_XL/CTRL2_G (ODR and full-scale), STATUS_REG
+ * - Accelerometer and gyroscope output registers
+ * - Embedded functions: pedometer (STEP_COUNTER, DEB_STEP/DEB_TIME debounce),
+ *   step detector and significant motion flags (FUNC_SRC1)
+ * - Wake-up / inactivity detection (WAKE_UP_THS, WAKE_UP_DUR, WAKE_UP_SRC)
+ * - FIFO (FIFO_CTRL1-5, FIFO_STATUS1-4, FIFO_DATA_OUT) in bypass, FIFO and
+ *   continuous modes with decimation and watermark
+ * 
+ * The model is also an I2C target: attached to the native I2C stand-in from
+ * mbed_compat.h it serves the real LSM6DSL driver with register pointer
+ * auto-increment (IF_INC) and FIFO_DATA_OUT wrap-around, so transaction and
+ * byte counts of driver code paths can be measured on the host.
+ * 
+ * Samples are pushed in physical units and converted to raw register values
+ * using the currently configured full-scale range, either one at a time with
+ * pushSample() or generated at the configured ODR from a signal source with
+ * advance().
+ */
+
+#ifndef LSM6DSL_SIM_H
+#define LSM6DSL_SIM_H
+
+#ifdef NATIVE_TEST_MODE
+
+#include "LSM6DSL.h"
+
+/**
+ * @brief Signal source for the simulated sensor
+ * @param t Time since the source was attached in seconds
+ * @param accel Output acceleration in g (x, y, z)
+ * @param gyro Output angular rate in deg/s (x, y, z)
+ * @param context User pointer passed to setSignalSource()
+ */
+typedef void (*LSM6DSLSignalSource)(double t, float accel[3], float gyro[3], void* context);
+
+/**
+ * @class LSM6DSLSim
+ * @brief Simulated LSM6DSL register file with embedded pedometer engine
+ */
+class LSM6DSLSim : public I2CTarget {
+public:
+    LSM6DSLSim();
+    
+    /**
+     * @brief Restore power-on register defaults and clear engine state
+     */
+    void reset();
+    
+    /**
+     * @brief Read a register (FUNC_SRC1 is cleared on read, as on the device)
+     * @param reg Register address
+     * @return Register value
+     */
+    uint8_t readRegister(uint8_t reg);
+    
+    /**
+     * @brief Write a register (routed to bank A while FUNC_CFG_ACCESS is set)
+     * @param reg Register address
+     * @param value Value to write
+     */
+    void writeRegister(uint8_t reg, uint8_t value);
+    
+    /**
+     * @brief Feed one output data period to the model
+     * 
+     * Updates output registers and data-ready flags and runs the embedded
+     * pedometer when enabled.
+     * 
+     * @param ax, ay, az Acceleration in g
+     * @param gx, gy, gz Angular rate in deg/s
+     */
+    void pushSample(float ax, float ay, float az, float gx, float gy, float gz);
+    
+    /**
+     * @brief Get the step counter value (STEP_COUNTER_H:L)
+     * @return Current 16-bit step count
+     */
+    uint16_t getStepCount() const;
+    
+    /**
+     * @brief Attach a signal source used by advance()
+     * @param source Signal callback (nullptr generates a sensor at rest)
+     * @param context User pointer passed to the callback
+     */
+    void setSignalSource(LSM6DSLSignalSource source, void* context);
+    
+    /**
+     * @brief Advance simulated time, generating samples at the accelerometer ODR
+     * 
+     * Does nothing but move the clock while the accelerometer is powered down.
+     * 
+     * @param seconds Time to advance
+     * @return Number of samples generated
+     */
+    int advance(double seconds);
+    
+    /**
+     * @brief Get simulated time
+     * @return Seconds since reset
+     */
+    double getTime() const;
+    
+    /**
+     * @brief Get the number of unread words in the FIFO
+     * @return Unread 16-bit words
+     */
+    int getFifoLevel() const;
+    
+    // I2CTarget interface
+    bool i2cWrite(const char* data, int length, bool repeated) override;
+    bool i2cRead(char* data, int length) override;
+    
+private:
+    uint8_t regs[0x80];      // Main register bank
+    uint8_t bankA[0x40];     // Embedded functions bank A
+    
+    // Pedometer engine state
+    float baseline;          // Slow magnitude tracker (gravity + offset)
+    bool stepArmed;          // Magnitude fell back below the re-arm level
+    long sampleCount;        // Samples since reset (time base)
+    long lastStepSample;     // Sample index of the last detected step
+    int pendingSteps;        // Steps held back by DEB_STEP debounce
+    bool counting;           // DEB_STEP satisfied, steps counted directly
+    int motionSteps;         // Steps since significant motion was armed
+    
+    // Wake-up / inactivity engine state
+    float prevAccel[3];      // Previous sample for the slope filter
+    int wakeCount;           // Consecutive samples above wake-up threshold
+    long quietCount;         // Consecutive samples below wake-up threshold
+    
+    // I2C interface state
+    uint8_t regPointer;      // Register address for the next data byte
+    
+    // Signal generation
+    LSM6DSLSignalSource source;  // Sample generator for advance()
+    void* sourceContext;
+    double simTime;          // Simulated time in seconds
+    double nextSampleTime;   // Time of the next generated sample
+    
+    // FIFO state
+    uint16_t fifo[LSM6DSL_FIFO_SIZE_WORDS];  // Circular buffer of 16-bit words
+    int fifoHead;            // Index of the oldest unread word
+    int fifoCount;           // Unread words
+    int fifoPattern;         // Pattern position of the oldest unread word
+    bool fifoOverrun;        // Data was lost since the last FIFO read
+    float fifoPhase;         // FIFO ODR / sensor ODR accumulator
+    
+    float odrHz() const;                    // Accelerometer ODR from CTRL1_XL
+    void writeRaw16(uint8_t regLow, float value, float sensitivity);
+    void runPedometer(float magnitude);
+    void runActivity(float ax, float ay, float az);
+    void countStep();
+    int fifoPatternLength() const;          // Words per gyro+accel data set
+    void storeFifo(const uint8_t* gyroRaw, const uint8_t* accelRaw);
+    void pushFifoWord(uint16_t word);
+    uint8_t readFifoStatus(uint8_t reg) const;
+    void clearFifo();
+};
+
+#endif // NATIVE_TEST_MODE
+
+#endif // LSM6DSL_SIM_H
@@ -0,0 +1,135 @@
+/**
+ * @file PowerMonitor.cpp
+ * @brief Implementation of sleep-state accounting
+ */
+
+#include "PowerMonitor.h"
+#ifdef MBED_OS
+#include "mbed_stats.h"
+#else
+#include <ctime>
+#endif
+
+// Typical STM32L475 supply currents at 3V (datasheet): run at 80MHz from
+// flash, sleep at 80MHz, Stop 2 with the LPTIM low-power ticker running
+static const float DEFAULT_RUN_MA = 9.0f;
+static const float DEFAULT_SLEEP_MA = 2.5f;
+static const float DEFAULT_DEEP_SLEEP_MA = 0.0015f;
+static const float DEFAULT_BATTERY_MAH = 250.0f;
+
+static const char* const STATE_NAMES[POWER_STATE_COUNT] = {"run", "sleep", "deep sleep"};
+
+/**
+ * @brief Constructor - Start the first interval with default currents
+ */
+PowerMonitor::PowerMonitor() : batteryMah(DEFAULT_BATTERY_MAH) {
+    stateCurrentMa[POWER_RUN] = DEFAULT_RUN_MA;
+    stateCurrentMa[POWER_SLEEP] = DEFAULT_SLEEP_MA;
+    stateCurrentMa[POWER_DEEP_SLEEP] = DEFAULT_DEEP_SLEEP_MA;
+    #ifndef MBED_OS
+    clock.start();
+    #endif
+    reset();
+}
+
+/**
+ * @brief Read the platform counters since boot
+ * 
+ * Mbed reports uptime, sleep and deep-sleep time; everything else is run
+ * time. Natively the process CPU time is run time and the rest of the
+ * wall-clock time is idle.
+ * 
+ * @return Time per state since boot (or since the native monitor started)
+ */
+PowerStats PowerMonitor::readCounters() {
+    PowerStats counters;
+    #ifdef MBED_OS
+    mbed_stats_cpu_t cpu;
+    mbed_stats_cpu_get(&cpu);
+    counters.totalUs = cpu.uptime;
+    counters.timeUs[POWER_SLEEP] = cpu.sleep_time;
+    counters.timeUs[POWER_DEEP_SLEEP] = cpu.deep_sleep_time;
+    #else
+    counters.totalUs = (uint64_t)clock.read_us();
+    uint64_t cpuUs = (uint64_t)((double)std::clock() * 1e6 / CLOCKS_PER_SEC);
+    counters.timeUs[POWER_SLEEP] = 0;
+    counters.timeUs[POWER_DEEP_SLEEP] = (cpuUs < counters.totalUs) ? counters.totalUs - cpuUs : 0;
+    #endif
+    uint64_t asleep = counters.timeUs[POWER_SLEEP] + counters.timeUs[POWER_DEEP_SLEEP];
+    counters.timeUs[POWER_RUN] = (asleep < counters.totalUs) ? counters.totalUs - asleep : 0;
+    return counters;
+}
+
+void PowerMonitor::reset() {
+    baseline = readCounters();
+}
+
+/**
+ * @brief Get the state residency since the interval started
+ * @return Time per state over the interval
+ */
+PowerStats PowerMonitor::read() {
+    PowerStats now = readCounters();
+    PowerStats stats;
+    stats.totalUs = now.totalUs - baseline.totalUs;
+    for (int s = 0; s < POWER_STATE_COUNT; s++) {
+        stats.timeUs[s] = now.timeUs[s] - baseline.timeUs[s];
+    }
+    return stats;
+}
+
+void PowerMonitor::setStateCurrent(PowerState state, float milliamps) {
+    if (state >= 0 && state < POWER_STATE_COUNT && milliamps >= 0.0f) {
+        stateCurrentMa[state] = milliamps;
+    }
+}
+
+void PowerMonitor::setBatteryCapacity(float milliampHours) {
+    if (milliampHours > 0.0f) {
+        batteryMah = milliampHours;
+    }
+}
+
+/**
+ * @brief Average current over an interval
+ * 
+ * @param stats Residency from read()
+ * @return Average current in mA
+ */
+float PowerMonitor::averageCurrent(const PowerStats& stats) const {
+    uint64_t accounted = 0;
+    double chargeMaUs = 0.0;
+    for (int s = 0; s < POWER_STATE_COUNT; s++) {
+        chargeMaUs += (double)stats.timeUs[s] * stateCurrentMa[s];
+        accounted += stats.timeUs[s];
+    }
+    return accounted ? (float)(chargeMaUs / accounted) : 0.0f;
+}
+
+/**
+ * @brief Battery life at the interval's average current
+ * 
+ * @param stats Residency from read()
+ * @return Hours until the battery is empty
+ */
+float PowerMonitor::batteryLifeHours(const PowerStats& stats) const {
+    float current = averageCurrent(stats);
+    return (current > 0.0f) ? batteryMah / current : 0.0f;
+}
+
+void PowerMonitor::print() {
+    PowerStats stats = read();
+    if (stats.totalUs == 0) {
+        printf("Power: no sleep statistics (build with MBED_CPU_STATS_ENABLED)\r\n");
+        return;
+    }
+    printf("Power:");
+    for (int s = 0; s < POWER_STATE_COUNT; s++) {
+        printf(" %s %.1f%%", STATE_NAMES[s], 100.0 * stats.timeUs[s] / stats.totalUs);
+    }
+    printf(", avg %.3f mA, ~%.0f h on %.0f mAh\r\n",
+           averageCurrent(stats), batteryLifeHours(stats), batteryMah);
+    if (stats.timeUs[POWER_SLEEP] > 0 && stats.timeUs[POWER_DEEP_SLEEP] == 0) {
+        printf("WARNING: no deep sleep, a driver holds the deep-sleep lock\r\n");
+    }
+}
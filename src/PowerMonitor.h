@@ -0,0 +1,113 @@
+/**
+ * @file PowerMonitor.h
+ * @brief Sleep-state accounting and battery life estimate
+ * 
+ * On Mbed the RTOS idle thread enters sleep or, when no driver holds the
+ * deep-sleep lock, deep sleep (Stop 2 on the STM32L475) until the next
+ * timer or interrupt. With MBED_CPU_STATS_ENABLED the platform accumulates
+ * the time spent in each state; PowerMonitor turns these counters into
+ * per-state shares and an average current for the measured interval.
+ * 
+ * Native builds have no sleep states: time the process is not running on
+ * a CPU is counted as deep sleep, i.e. the best case tickless idle could
+ * reach with the same workload.
+ */
+
+#ifndef POWER_MONITOR_H
+#define POWER_MONITOR_H
+
+#include "mbed_compat.h"
+#include <cstdint>
+
+/**
+ * @enum PowerState
+ * @brief MCU power states distinguished by the accounting
+ */
+enum PowerState {
+    POWER_RUN,          // Executing code (threads, interrupts, idle overhead)
+    POWER_SLEEP,        // Core stopped, clocks and peripherals running
+    POWER_DEEP_SLEEP,   // Stop mode, only the low-power ticker and wake-up sources run
+    POWER_STATE_COUNT
+};
+
+/**
+ * @struct PowerStats
+ * @brief Time spent in each power state over a measurement interval
+ */
+struct PowerStats {
+    uint64_t timeUs[POWER_STATE_COUNT];  // Time per state (us)
+    uint64_t totalUs;                    // Length of the interval (us)
+};
+
+/**
+ * @class PowerMonitor
+ * @brief Measures sleep-state residency and estimates battery life
+ * 
+ * The interval starts at construction or reset(). Currents per state
+ * default to typical STM32L475 datasheet values (80MHz, 3V, MCU only);
+ * set measured board currents for a realistic battery estimate.
+ */
+class PowerMonitor {
+public:
+    PowerMonitor();
+    
+    /**
+     * @brief Start a new measurement interval
+     */
+    void reset();
+    
+    /**
+     * @brief Get the state residency since the interval started
+     * @return Time per state; all zero if the platform keeps no statistics
+     */
+    PowerStats read();
+    
+    /**
+     * @brief Set the current drawn in a power state
+     * @param state Power state
+     * @param milliamps Current in mA
+     */
+    void setStateCurrent(PowerState state, float milliamps);
+    
+    /**
+     * @brief Set the battery capacity used by the life estimate
+     * @param milliampHours Capacity in mAh
+     */
+    void setBatteryCapacity(float milliampHours);
+    
+    /**
+     * @brief Average current over an interval, weighted by state residency
+     * @param stats Residency from read()
+     * @return Average current in mA (0 for an empty interval)
+     */
+    float averageCurrent(const PowerStats& stats) const;
+    
+    /**
+     * @brief Battery life if the interval's duty cycle continued
+     * @param stats Residency from read()
+     * @return Hours until the battery is empty (0 for an empty interval)
+     */
+    float batteryLifeHours(const PowerStats& stats) const;
+    
+    /**
+     * @brief Print state shares, average current and battery life
+     * 
+     * Warns when the MCU slept but never reached deep sleep, which means a
+     * driver held the deep-sleep lock (build with MBED_SLEEP_TRACING_ENABLED
+     * to see which).
+     */
+    void print();
+    
+private:
+    float stateCurrentMa[POWER_STATE_COUNT];  // Current per state (mA)
+    float batteryMah;                         // Battery capacity (mAh)
+    PowerStats baseline;                      // Counters at the start of the interval
+    
+    #ifndef MBED_OS
+    Timer clock;                              // Wall-clock uptime for native accounting
+    #endif
+    
+    PowerStats readCounters();
+};
+
+#endif
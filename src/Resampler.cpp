@@ -0,0 +1,138 @@
+/**
+ * @file Resampler.cpp
+ * @brief Implementation of uniform-grid resampling
+ */
+
+#include "Resampler.h"
+#include <cmath>
+
+/**
+ * @brief Constructor - Cubic interpolation, no buffers allocated yet
+ */
+Resampler::Resampler() : method(RESAMPLE_CUBIC), capacity(0), gridSize(0), inputCount(0),
+    segment(nullptr), fraction(nullptr), spacing(nullptr), maxJitterUs(0.0f) {
+}
+
+/**
+ * @brief Destructor - Free grid buffers
+ */
+Resampler::~Resampler() {
+    delete[] segment;
+    delete[] fraction;
+    delete[] spacing;
+}
+
+/**
+ * @brief Make sure the grid buffers hold count entries
+ * 
+ * Buffers only grow, so steady-state windows do not allocate.
+ * 
+ * @param count Required entries
+ * @return true if the buffers are large enough, false on allocation failure
+ */
+bool Resampler::reserve(int count) {
+    if (count <= capacity) {
+        return true;
+    }
+    delete[] segment;
+    delete[] fraction;
+    delete[] spacing;
+    segment = new int[count];
+    fraction = new float[count];
+    spacing = new float[count];
+    if (segment == nullptr || fraction == nullptr || spacing == nullptr) {
+        capacity = 0;
+        return false;
+    }
+    capacity = count;
+    return true;
+}
+
+/**
+ * @brief Build a uniform grid covering the window
+ * 
+ * Timestamps are taken relative to the first sample with unsigned
+ * subtraction, so a wrap of the 32-bit microsecond clock inside the window
+ * is harmless.
+ * 
+ * @param timestampsUs Sample times in microseconds (wrapping, increasing)
+ * @param count Number of samples
+ * @param sampleRate Nominal sample rate of the grid in Hz
+ * @return Number of grid points (0 if the timestamps are unusable)
+ */
+int Resampler::setGrid(const uint32_t* timestampsUs, int count, float sampleRate) {
+    gridSize = 0;
+    inputCount = 0;
+    maxJitterUs = 0.0f;
+    if (count < 2 || sampleRate <= 0.0f || !reserve(count)) {
+        return 0;
+    }
+    
+    float periodUs = 1e6f / sampleRate;
+    float previous = 0.0f;
+    for (int k = 1; k < count; k++) {
+        float t = (float)(uint32_t)(timestampsUs[k] - timestampsUs[0]);
+        spacing[k - 1] = t - previous;
+        if (spacing[k - 1] <= 0.0f) {
+            return 0;  // Timestamps must increase
+        }
+        maxJitterUs = fmaxf(maxJitterUs, fabsf(t - k * periodUs));
+        previous = t;
+    }
+    spacing[count - 1] = spacing[count - 2];
+    
+    // 1us tolerance: timestamps are truncated to whole microseconds
+    int points = (int)((previous + 1.0f) / periodUs) + 1;
+    gridSize = (points < count) ? points : count;
+    inputCount = count;
+    
+    // Walk input segments and grid points together
+    int k = 0;
+    float segmentStart = 0.0f;
+    for (int i = 0; i < gridSize; i++) {
+        float t = i * periodUs;
+        while (k < count - 2 && segmentStart + spacing[k] <= t) {
+            segmentStart += spacing[k];
+            k++;
+        }
+        segment[i] = k;
+        float f = (t - segmentStart) / spacing[k];
+        fraction[i] = (f < 0.0f) ? 0.0f : (f > 1.0f) ? 1.0f : f;
+    }
+    return gridSize;
+}
+
+/**
+ * @brief Interpolate one channel onto the grid
+ * 
+ * Cubic tangents use the actual spacing of the neighbouring samples and
+ * fall back to the segment slope at the window edges.
+ * 
+ * @param input Samples at the timestamps passed to setGrid()
+ * @param output Destination for getGridSize() values (must not alias input)
+ */
+void Resampler::resample(const float* input, float* output) const {
+    for (int i = 0; i < gridSize; i++) {
+        int k = segment[i];
+        float s = fraction[i];
+        float p1 = input[k];
+        float p2 = input[k + 1];
+        
+        if (method == RESAMPLE_LINEAR) {
+            output[i] = p1 + s * (p2 - p1);
+            continue;
+        }
+        
+        // Tangents in units per segment length h = spacing[k]
+        float h = spacing[k];
+        float m1 = (k > 0) ?
+            (p2 - input[k - 1]) * h / (spacing[k - 1] + h) : (p2 - p1);
+        float m2 = (k + 2 < inputCount) ?
+            (input[k + 2] - p1) * h / (h + spacing[k + 1]) : (p2 - p1);
+        
+        float s2 = s * s;
+        float s3 = s2 * s;
+        output[i] = (2 * s3 - 3 * s2 + 1) * p1 + (s3 - 2 * s2 + s) * m1 +
+                    (-2 * s3 + 3 * s2) * p2 + (s3 - s2) * m2;
+    }
+}
@@ -0,0 +1,104 @@
+/**
+ * @file Resampler.h
+ * @brief Resampling of jittered sensor samples onto a uniform time grid
+ * 
+ * Samples polled by the acquisition task are not exactly 1/ODR apart:
+ * releases are delayed by interrupt latency and by other tasks, and the
+ * MCU clock drifts against the sensor ODR. Spectral analysis assumes uniform spacing, so
+ * each window is interpolated onto a uniform grid at the nominal sample
+ * rate before the FFT, which keeps bin frequencies exact.
+ * 
+ * Two interpolators are provided:
+ * - Linear: cheapest, slight attenuation of the 3-7Hz bands at 52Hz
+ * - Cubic: Catmull-Rom (cubic Hermite with finite-difference tangents
+ *   that account for non-uniform spacing), flatter passband
+ */
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include "mbed_compat.h"
+#include <cstdint>
+
+/**
+ * @enum ResampleMethod
+ * @brief Interpolation used by Resampler
+ */
+enum ResampleMethod {
+    RESAMPLE_LINEAR,    // Two-point linear interpolation
+    RESAMPLE_CUBIC      // Four-point cubic Hermite (Catmull-Rom) interpolation
+};
+
+/**
+ * @class Resampler
+ * @brief Interpolates timestamped samples onto a uniform grid
+ * 
+ * Usage per window: setGrid() once from the window's timestamps, then
+ * resample() for every channel. The grid search is done once in setGrid()
+ * and reused for all channels.
+ */
+class Resampler {
+public:
+    Resampler();
+    ~Resampler();
+    
+    /**
+     * @brief Select the interpolation method
+     * @param method RESAMPLE_LINEAR or RESAMPLE_CUBIC
+     */
+    void setMethod(ResampleMethod method) { this->method = method; }
+    
+    ResampleMethod getMethod() const { return method; }
+    
+    /**
+     * @brief Build a uniform grid covering the window
+     * 
+     * The grid starts at the first timestamp and steps by 1/sampleRate.
+     * It holds as many points as fit before the last timestamp (at most
+     * count), so no point is extrapolated.
+     * 
+     * @param timestampsUs Sample times in microseconds (wrapping, increasing)
+     * @param count Number of samples
+     * @param sampleRate Nominal sample rate of the grid in Hz
+     * @return Number of grid points (0 if the timestamps are unusable)
+     */
+    int setGrid(const uint32_t* timestampsUs, int count, float sampleRate);
+    
+    /**
+     * @brief Interpolate one channel onto the grid
+     * 
+     * @param input Samples at the timestamps passed to setGrid()
+     * @param output Destination for getGridSize() values (must not alias input)
+     */
+    void resample(const float* input, float* output) const;
+    
+    /**
+     * @brief Get the number of grid points from the last setGrid()
+     * @return Grid size
+     */
+    int getGridSize() const { return gridSize; }
+    
+    /**
+     * @brief Get the largest deviation of a sample from its ideal time
+     * 
+     * Measured against a grid anchored at the first sample, in the last
+     * setGrid() call. Useful to report loop jitter and drift.
+     * 
+     * @return Maximum timing error in microseconds
+     */
+    float getMaxJitterUs() const { return maxJitterUs; }
+    
+private:
+    ResampleMethod method;   // Interpolation method
+    int capacity;            // Allocated grid entries
+    int gridSize;            // Grid points in use
+    int inputCount;          // Samples passed to setGrid()
+    int* segment;            // Input index k with t[k] <= grid point < t[k+1]
+    float* fraction;         // Position of the grid point within the segment (0..1)
+    float* spacing;          // Input spacing t[k+1] - t[k] (us), indexed by input
+    float maxJitterUs;       // Largest deviation from the ideal sample time
+    
+    bool reserve(int count);
+};
+
+#endif
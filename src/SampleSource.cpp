@@ -0,0 +1,329 @@
+/**
+ * @file SampleSource.cpp
+ * @brief Implementation of the sample source back-ends
+ */
+
+#include "SampleSource.h"
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#if defined(MBED_OS) || defined(NATIVE_TEST_MODE)
+#include "LSM6DSL.h"
+#endif
+#ifdef MBED_OS
+#include <chrono>
+#endif
+#ifdef NATIVE_TEST_MODE
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+/**
+ * @brief Parse one recorded/streamed sample line
+ * 
+ * Accepts comma, semicolon or whitespace separated numbers. With seven
+ * values the first is the timestamp in milliseconds.
+ * 
+ * @param line Text line
+ * @param sample Parsed sample
+ * @param timestamped Set to true if the line had a t_ms column
+ * @return true if the line holds a sample, false for comments or bad lines
+ */
+bool SampleSource::parseLine(const char* line, SensorData& sample, bool& timestamped) {
+    double values[7];   // double: t_ms of multi-hour recordings needs more than 24 bits
+    int count = 0;
+    const char* p = line;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p == '#' || *p == '\0' || *p == '\r' || *p == '\n') {
+        return false;
+    }
+    
+    while (count < 7) {
+        char* end;
+        double v = strtod(p, &end);
+        if (end == p) {
+            break;
+        }
+        values[count++] = v;
+        p = end;
+        while (*p == ',' || *p == ';' || *p == ' ' || *p == '\t') p++;
+    }
+    
+    if (count != 6 && count != 7) {
+        return false;
+    }
+    timestamped = (count == 7);
+    sample.timestampUs = timestamped ? (uint32_t)llround(values[0] * 1000.0) : 0;
+    const double* v = values + (count - 6);
+    sample.accelX = (float)v[0];
+    sample.accelY = (float)v[1];
+    sample.accelZ = (float)v[2];
+    sample.gyroX = (float)v[3];
+    sample.gyroY = (float)v[4];
+    sample.gyroZ = (float)v[5];
+    return true;
+}
+
+/**
+ * @brief Constructor - Defaults reproduce the former built-in simulation
+ * 
+ * 4Hz tone of 0.1g on accel X/Y, 0.1g on accel Z, ±0.01g noise, 52Hz.
+ */
+GeneratorSampleSource::GeneratorSampleSource() : sampleRate(52.0f), frequency(4.0f),
+    amplitude(0.1f), offsetZ(0.1f), noise(0.01f), duration(0.0f), sampleIndex(0) {
+}
+
+/**
+ * @brief Generate a block of samples
+ * 
+ * @param buffer Destination for up to maxSamples samples
+ * @param maxSamples Capacity of buffer
+ * @return Number of samples generated
+ */
+int GeneratorSampleSource::readSamples(SensorData* buffer, int maxSamples) {
+    int count = 0;
+    while (count < maxSamples && !isFinished()) {
+        float t = sampleIndex / sampleRate;
+        float n = noise * ((rand() % 20 - 10) / 10.0f);
+        
+        SensorData& data = buffer[count++];
+        data.accelX = amplitude * sinf(2.0f * (float)M_PI * frequency * t) + n;
+        data.accelY = amplitude * sinf(2.0f * (float)M_PI * frequency * t + (float)M_PI / 4) + n;
+        data.accelZ = offsetZ + n;
+        data.gyroX = n * 10;
+        data.gyroY = n * 10;
+        data.gyroZ = n * 10;
+        sampleIndex++;
+    }
+    return count;
+}
+
+bool GeneratorSampleSource::isFinished() const {
+    return duration > 0.0f && sampleIndex >= (long)(duration * sampleRate);
+}
+
+/**
+ * @brief Follow the applied output data rate
+ * 
+ * The elapsed signal time is preserved so the tone stays continuous.
+ * 
+ * @param hz Sampling frequency in Hz
+ */
+void GeneratorSampleSource::setSampleRate(float hz) {
+    if (hz <= 0.0f) {
+        return;
+    }
+    sampleIndex = (long)(sampleIndex * hz / sampleRate);
+    sampleRate = hz;
+}
+
+void GeneratorSampleSource::setTone(float frequency, float amplitude) {
+    this->frequency = frequency;
+    this->amplitude = amplitude;
+}
+
+void GeneratorSampleSource::setDuration(float seconds) {
+    duration = seconds;
+    sampleIndex = 0;
+}
+
+#if defined(MBED_OS) || defined(NATIVE_TEST_MODE)
+HardwareSampleSource::HardwareSampleSource(LSM6DSL* imu) : imu(imu), gyroEnabled(true) {
+    clock.start();
+}
+
+/**
+ * @brief Read the current output registers
+ * 
+ * @param buffer Destination (one sample is written)
+ * @param maxSamples Capacity of buffer
+ * @return 1 on success, 0 if the accelerometer read failed
+ */
+int HardwareSampleSource::readSamples(SensorData* buffer, int maxSamples) {
+    if (imu == nullptr || maxSamples < 1) {
+        return 0;
+    }
+    
+    SensorData& data = buffer[0];
+    #ifdef MBED_OS
+    data.timestampUs = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        clock.elapsed_time()).count();
+    #else
+    data.timestampUs = (uint32_t)clock.read_us();
+    #endif
+    if (!imu->readAccel(data.accelX, data.accelY, data.accelZ)) {
+        return 0;
+    }
+    // Gyroscope failures keep the accelerometer sample
+    if (!gyroEnabled || !imu->readGyro(data.gyroX, data.gyroY, data.gyroZ)) {
+        data.gyroX = data.gyroY = data.gyroZ = 0;
+    }
+    return 1;
+}
+#endif
+
+#ifdef NATIVE_TEST_MODE
+FileSampleSource::FileSampleSource(const char* path, bool loop) : file(nullptr), loop(loop),
+    finished(false), timestamped(false), loopOffsetUs(0), firstTimestampUs(0),
+    lastTimestampUs(0), lastGapUs(0), haveTimestamp(false) {
+    strncpy(this->path, path, sizeof(this->path) - 1);
+    this->path[sizeof(this->path) - 1] = '\0';
+}
+
+FileSampleSource::~FileSampleSource() {
+    close();
+}
+
+bool FileSampleSource::open() {
+    close();
+    file = fopen(path, "r");
+    finished = (file == nullptr);
+    loopOffsetUs = 0;
+    lastTimestampUs = 0;
+    lastGapUs = 0;
+    haveTimestamp = false;
+    if (finished) {
+        printf("FileSampleSource: cannot open %s\n", path);
+    }
+    return !finished;
+}
+
+void FileSampleSource::close() {
+    if (file != nullptr) {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+/**
+ * @brief Read up to maxSamples parsed lines
+ * 
+ * When looping, timestamps of the next pass continue one sample gap after
+ * the last sample of the previous pass so they keep increasing.
+ * 
+ * @param buffer Destination for up to maxSamples samples
+ * @param maxSamples Capacity of buffer
+ * @return Number of samples read (0 at end of file without loop)
+ */
+int FileSampleSource::readSamples(SensorData* buffer, int maxSamples) {
+    char line[256];
+    int count = 0;
+    bool rewound = false;
+    while (file != nullptr && count < maxSamples) {
+        if (fgets(line, sizeof(line), file) == nullptr) {
+            // Rewind once per call so a file without samples cannot spin
+            if (loop && !rewound) {
+                rewind(file);
+                rewound = true;
+                loopOffsetUs = lastTimestampUs + lastGapUs - firstTimestampUs;
+                continue;
+            }
+            finished = !loop;
+            break;
+        }
+        if (parseLine(line, buffer[count], timestamped)) {
+            if (timestamped) {
+                if (!haveTimestamp) {
+                    firstTimestampUs = buffer[count].timestampUs;
+                    haveTimestamp = true;
+                } else {
+                    lastGapUs = buffer[count].timestampUs + loopOffsetUs - lastTimestampUs;
+                }
+                buffer[count].timestampUs += loopOffsetUs;
+                lastTimestampUs = buffer[count].timestampUs;
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+SocketSampleSource::SocketSampleSource(const char* path) : timestamped(false), fd(-1),
+    finished(false), lineLength(0) {
+    strncpy(this->path, path, sizeof(this->path) - 1);
+    this->path[sizeof(this->path) - 1] = '\0';
+}
+
+SocketSampleSource::~SocketSampleSource() {
+    close();
+}
+
+bool SocketSampleSource::open() {
+    close();
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        printf("SocketSampleSource: cannot connect to %s\n", path);
+        close();
+        finished = true;
+        return false;
+    }
+    finished = false;
+    lineLength = 0;
+    return true;
+}
+
+void SocketSampleSource::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+/**
+ * @brief Receive and parse streamed samples
+ * 
+ * @param buffer Destination for up to maxSamples samples
+ * @param maxSamples Capacity of buffer
+ * @return Number of samples delivered (0 once the peer has closed)
+ */
+int SocketSampleSource::readSamples(SensorData* buffer, int maxSamples) {
+    int count = parseBuffered(buffer, maxSamples);
+    while (count == 0 && fd >= 0) {
+        ssize_t received = recv(fd, lineBuffer + lineLength,
+                                sizeof(lineBuffer) - 1 - lineLength, 0);
+        if (received <= 0) {
+            close();
+            finished = true;
+            break;
+        }
+        lineLength += (int)received;
+        count = parseBuffered(buffer, maxSamples);
+    }
+    return count;
+}
+
+/**
+ * @brief Parse complete lines from the receive buffer
+ * 
+ * Unparsed bytes are moved to the front of the buffer. An over-long line
+ * that fills the buffer is discarded.
+ * 
+ * @param buffer Destination for up to maxSamples samples
+ * @param maxSamples Capacity of buffer
+ * @return Number of samples parsed
+ */
+int SocketSampleSource::parseBuffered(SensorData* buffer, int maxSamples) {
+    int count = 0;
+    int start = 0;
+    for (int i = 0; i < lineLength && count < maxSamples; i++) {
+        if (lineBuffer[i] == '\n') {
+            lineBuffer[i] = '\0';
+            if (parseLine(lineBuffer + start, buffer[count], timestamped)) {
+                count++;
+            }
+            start = i + 1;
+        }
+    }
+    if (start == 0 && lineLength >= (int)sizeof(lineBuffer) - 1) {
+        start = lineLength;
+    }
+    memmove(lineBuffer, lineBuffer + start, lineLength - start);
+    lineLength -= start;
+    return count;
+}
+#endif // NATIVE_TEST_MODE
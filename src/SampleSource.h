@@ -0,0 +1,304 @@
+/**
+ * @file SampleSource.h
+ * @brief Pluggable sources of accelerometer and gyroscope samples
+ * 
+ * SensorManager pulls samples in blocks from a SampleSource, so the same
+ * pipeline can run on:
+ * - HardwareSampleSource: the LSM6DSL driver (on target, or on the host
+ *   against the simulated I2C bus)
+ * - GeneratorSampleSource: synthetic sine + noise signal on a sample-index
+ *   time base, independent of wall-clock pacing
+ * - FileSampleSource: recorded CSV data (native builds)
+ * - SocketSampleSource: CSV lines streamed over a local Unix socket
+ *   (native builds)
+ * - RingSampleSource: samples pushed from an interrupt handler or another
+ *   thread through a lock-free ring (SpscRingBuffer.h)
+ * 
+ * Recorded and streamed data use one sample per line, either
+ * "ax,ay,az,gx,gy,gz" or "t_ms,ax,ay,az,gx,gy,gz" (accel in g, gyro in
+ * deg/s). Lines starting with '#' and lines that do not parse are skipped.
+ * The optional t_ms column becomes the sample timestamp.
+ */
+
+#ifndef SAMPLE_SOURCE_H
+#define SAMPLE_SOURCE_H
+
+#include "mbed_compat.h"
+#include "SpscRingBuffer.h"
+
+/**
+ * @struct SensorData
+ * @brief Structure containing accelerometer and gyroscope readings
+ * 
+ * All values are in standard units:
+ * - Accelerometer: g (gravitational acceleration, 1g = 9.81 m/s²)
+ * - Gyroscope: deg/s (degrees per second)
+ */
+struct SensorData {
+    float accelX, accelY, accelZ;  // Accelerometer data in g (X, Y, Z axes)
+    float gyroX, gyroY, gyroZ;     // Gyroscope data in deg/s (X, Y, Z axes)
+    uint32_t timestampUs;          // Sample time in microseconds (wraps after ~71 minutes)
+};
+
+/**
+ * @class SampleSource
+ * @brief Interface for block-oriented sample providers
+ */
+class SampleSource {
+public:
+    virtual ~SampleSource() {}
+    
+    /**
+     * @brief Prepare the source for reading (open file, connect socket)
+     * @return true if the source is ready, false otherwise
+     */
+    virtual bool open() { return true; }
+    
+    /**
+     * @brief Release resources acquired by open()
+     */
+    virtual void close() {}
+    
+    /**
+     * @brief Read a block of samples
+     * 
+     * @param buffer Destination for up to maxSamples samples
+     * @param maxSamples Capacity of buffer
+     * @return Number of samples delivered (0 if none are available)
+     */
+    virtual int readSamples(SensorData* buffer, int maxSamples) = 0;
+    
+    /**
+     * @brief Check whether the source has run out of data
+     * @return true once no further samples will be delivered
+     */
+    virtual bool isFinished() const { return false; }
+    
+    /**
+     * @brief Notify the source of the applied output data rate
+     * @param hz Sampling frequency in Hz
+     */
+    virtual void setSampleRate(float hz) { (void)hz; }
+    
+    /**
+     * @brief Check whether samples arrive in real time
+     * 
+     * A paced source (the sensor) only has new data once per output period,
+     * so consumers pull it once per poll. Unpaced sources (generator, file,
+     * socket) can be drained as fast as the consumer runs.
+     * 
+     * @return true for real-time sources
+     */
+    virtual bool isPaced() const { return false; }
+    
+    /**
+     * @brief Check whether delivered samples carry their own timestamps
+     * 
+     * Untimed sources leave SensorData::timestampUs unset and SensorManager
+     * stamps them from its nominal sample clock.
+     * 
+     * @return true if timestampUs is valid
+     */
+    virtual bool isTimestamped() const { return false; }
+    
+    /**
+     * @brief Parse one recorded/streamed sample line
+     * 
+     * @param line Text line ("ax,ay,az,gx,gy,gz" or "t_ms,ax,ay,az,gx,gy,gz")
+     * @param sample Parsed sample (timestampUs set from t_ms when present)
+     * @param timestamped Set to true if the line had a t_ms column
+     * @return true if the line holds a sample, false for comments or bad lines
+     */
+    static bool parseLine(const char* line, SensorData& sample, bool& timestamped);
+};
+
+/**
+ * @class GeneratorSampleSource
+ * @brief Synthetic test signal (the former built-in simulation signal)
+ * 
+ * Accel X/Y carry a sine tone (Y shifted by 45°), accel Z a constant
+ * offset, and all axes share uniform noise. Time advances by one sample
+ * period per sample, so the tone frequency is exact however fast samples
+ * are pulled.
+ */
+class GeneratorSampleSource : public SampleSource {
+public:
+    GeneratorSampleSource();
+    
+    int readSamples(SensorData* buffer, int maxSamples) override;
+    bool isFinished() const override;
+    void setSampleRate(float hz) override;
+    
+    /**
+     * @brief Set the oscillation added to accel X/Y
+     * @param frequency Tone frequency in Hz
+     * @param amplitude Tone amplitude in g
+     */
+    void setTone(float frequency, float amplitude);
+    
+    /**
+     * @brief Set the constant accel Z component
+     * @param offset Offset in g
+     */
+    void setOffsetZ(float offset) { offsetZ = offset; }
+    
+    /**
+     * @brief Set uniform noise amplitude (gyro noise is 10x, in deg/s)
+     * @param amplitude Peak noise in g
+     */
+    void setNoise(float amplitude) { noise = amplitude; }
+    
+    /**
+     * @brief Limit the generated length
+     * @param seconds Duration in seconds (0 for an endless signal)
+     */
+    void setDuration(float seconds);
+    
+private:
+    float sampleRate;        // Sample rate of the generated signal (Hz)
+    float frequency;         // Tone frequency (Hz)
+    float amplitude;         // Tone amplitude (g)
+    float offsetZ;           // Constant accel Z (g)
+    float noise;             // Peak noise (g)
+    float duration;          // Generated length in seconds (0 = endless)
+    long sampleIndex;        // Samples generated so far
+};
+
+/**
+ * @class RingSampleSource
+ * @brief Samples pushed by another context through a lock-free ring
+ * 
+ * The producer (an interrupt handler, a sensor thread or a socket reader)
+ * calls push() with stamped samples; SensorManager pulls them on its own
+ * schedule without taking a lock. Samples pushed while the ring is full
+ * are dropped and counted.
+ */
+class RingSampleSource : public SampleSource {
+public:
+    static const uint32_t CAPACITY = 64;   // Samples buffered (~1.2s at 52Hz)
+    
+    /**
+     * @brief Queue one sample (producer side only, interrupt-safe)
+     * @param sample Sample with timestampUs set
+     * @return true if queued, false if the ring was full
+     */
+    bool push(const SensorData& sample) { return ring.push(sample); }
+    
+    int readSamples(SensorData* buffer, int maxSamples) override {
+        return ring.popBlock(buffer, maxSamples);
+    }
+    bool isPaced() const override { return true; }
+    bool isTimestamped() const override { return true; }
+    
+    /**
+     * @brief Get the number of samples lost because the consumer fell behind
+     * @return Dropped sample count
+     */
+    uint32_t getDropped() const { return ring.getDropped(); }
+    
+private:
+    SpscRingBuffer<SensorData, CAPACITY> ring;  // Producer-to-SensorManager queue
+};
+
+#if defined(MBED_OS) || defined(NATIVE_TEST_MODE)
+class LSM6DSL;
+
+/**
+ * @class HardwareSampleSource
+ * @brief Samples read from the LSM6DSL driver
+ * 
+ * Delivers one sample per call (the polling loop paces reads). Gyroscope
+ * registers are skipped while the gyroscope is powered down. Each sample is
+ * stamped with the low-power timer when its output registers are read; a
+ * microsecond Timer would keep the MCU out of deep sleep.
+ */
+class HardwareSampleSource : public SampleSource {
+public:
+    explicit HardwareSampleSource(LSM6DSL* imu);
+    
+    int readSamples(SensorData* buffer, int maxSamples) override;
+    bool isPaced() const override { return true; }
+    bool isTimestamped() const override { return true; }
+    
+    /**
+     * @brief Tell the source whether gyroscope registers hold valid data
+     * @param enabled false while the gyroscope is powered down
+     */
+    void setGyroEnabled(bool enabled) { gyroEnabled = enabled; }
+    
+private:
+    LSM6DSL* imu;            // Driver instance (not owned)
+    bool gyroEnabled;        // Read gyroscope registers
+    LowPowerTimer clock;     // Free-running timestamp clock (~30us steps, runs in deep sleep)
+};
+#endif
+
+#ifdef NATIVE_TEST_MODE
+#include <cstdio>
+
+/**
+ * @class FileSampleSource
+ * @brief Samples replayed from a recorded CSV file
+ */
+class FileSampleSource : public SampleSource {
+public:
+    /**
+     * @param path File to replay (copied)
+     * @param loop Restart from the beginning at end of file
+     */
+    FileSampleSource(const char* path, bool loop);
+    ~FileSampleSource();
+    
+    bool open() override;
+    void close() override;
+    int readSamples(SensorData* buffer, int maxSamples) override;
+    bool isFinished() const override { return finished; }
+    bool isTimestamped() const override { return timestamped; }
+    
+private:
+    char path[256];          // File path
+    FILE* file;              // Open file, nullptr when closed
+    bool loop;               // Rewind at end of file
+    bool finished;           // End of file reached (without loop) or open failed
+    bool timestamped;        // Recording has a t_ms column
+    uint32_t loopOffsetUs;   // Added to t_ms after each rewind
+    uint32_t firstTimestampUs;  // Recorded timestamp of the first sample
+    uint32_t lastTimestampUs;   // Last delivered timestamp
+    uint32_t lastGapUs;         // Spacing of the last two samples
+    bool haveTimestamp;         // A timestamped sample was delivered since open()
+};
+
+/**
+ * @class SocketSampleSource
+ * @brief Samples streamed as CSV lines over a local (Unix domain) socket
+ * 
+ * readSamples() blocks until at least one complete line has arrived and
+ * returns every complete line already buffered, up to maxSamples.
+ */
+class SocketSampleSource : public SampleSource {
+public:
+    /**
+     * @param path Socket path to connect to (copied)
+     */
+    explicit SocketSampleSource(const char* path);
+    ~SocketSampleSource();
+    
+    bool open() override;
+    void close() override;
+    int readSamples(SensorData* buffer, int maxSamples) override;
+    bool isFinished() const override { return finished; }
+    bool isTimestamped() const override { return timestamped; }
+    
+private:
+    bool timestamped;        // Stream has a t_ms column
+    char path[108];          // Socket path (sun_path size)
+    int fd;                  // Connected socket, -1 when closed
+    bool finished;           // Peer closed the connection or connect failed
+    char lineBuffer[1024];   // Received bytes not yet parsed
+    int lineLength;          // Bytes in lineBuffer
+    
+    int parseBuffered(SensorData* buffer, int maxSamples);
+};
+#endif // NATIVE_TEST_MODE
+
+#endif // SAMPLE_SOURCE_H
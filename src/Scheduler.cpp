@@ -0,0 +1,281 @@
+/**
+ * @file Scheduler.cpp
+ * @brief Implementation of the hardware-timed task scheduler
+ */
+
+#include "Scheduler.h"
+#include <chrono>
+
+static const TaskStats NO_STATS = {0, 0, 0, 0, 0};
+
+/**
+ * @brief Convert a rate to a fixed-point period
+ * @param rateHz Rate in Hz
+ * @return Period in 1/65536 us (0 for rates <= 0)
+ */
+static uint64_t periodFromRate(float rateHz) {
+    if (rateHz <= 0.0f) {
+        return 0;
+    }
+    return (uint64_t)(1e6 * 65536.0 / rateHz + 0.5);
+}
+
+/**
+ * @brief Constructor - Empty task table
+ */
+Scheduler::Scheduler() : taskCount(0), running(false) {
+    clock.start();
+}
+
+uint64_t Scheduler::nowUs() {
+    #ifdef MBED_OS
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        clock.elapsed_time()).count();
+    #else
+    return (uint64_t)clock.read_us();
+    #endif
+}
+
+/**
+ * @brief Register a task
+ * 
+ * @param name Name used in printStats() (must outlive the scheduler)
+ * @param function Task body
+ * @param rateHz Release rate in Hz (0 for an event-only task)
+ * @return Task id, or -1 if the task table is full
+ */
+int Scheduler::addTask(const char* name, TaskFunction function, float rateHz) {
+    if (taskCount >= MAX_TASKS || function == nullptr) {
+        printf("Scheduler: cannot add task %s\r\n", name);
+        return -1;
+    }
+    Task& task = tasks[taskCount];
+    task.name = name;
+    task.function = function;
+    task.periodQ16 = periodFromRate(rateHz);
+    task.releaseQ16 = (nowUs() << 16) + task.periodQ16;
+    task.pending = false;
+    task.stats = NO_STATS;
+    return taskCount++;
+}
+
+/**
+ * @brief Change the release rate of a task
+ * 
+ * @param task Task id from addTask()
+ * @param rateHz New rate in Hz (0 makes the task event-only)
+ * @return true if the task exists
+ */
+bool Scheduler::setRate(int task, float rateHz) {
+    if (task < 0 || task >= taskCount) {
+        return false;
+    }
+    uint64_t period = periodFromRate(rateHz);
+    if (tasks[task].periodQ16 == 0) {
+        tasks[task].releaseQ16 = (nowUs() << 16) + period;
+    }
+    tasks[task].periodQ16 = period;
+    return true;
+}
+
+/**
+ * @brief Request one execution of a task as soon as possible
+ * @param task Task id from addTask()
+ */
+void Scheduler::post(int task) {
+    if (task < 0 || task >= taskCount) {
+        return;
+    }
+    tasks[task].pending = true;
+    #ifdef MBED_OS
+    queue.call(callback(this, &Scheduler::dispatch));
+    #else
+    wake();
+    #endif
+}
+
+/**
+ * @brief Request one execution of a task from an interrupt handler
+ * @param task Task id from addTask()
+ */
+void Scheduler::postFromInterrupt(int task) {
+    #ifdef MBED_OS
+    queue.call(this, &Scheduler::post, task);
+    #else
+    post(task);
+    #endif
+}
+
+/**
+ * @brief Dispatch tasks until stop() is called
+ * 
+ * Releases are re-based on the current time, so time spent before run()
+ * is not counted as lateness.
+ */
+void Scheduler::run() {
+    uint64_t start = nowUs() << 16;
+    for (int i = 0; i < taskCount; i++) {
+        tasks[i].releaseQ16 = start + tasks[i].periodQ16;
+    }
+    running = true;
+    
+    #ifdef MBED_OS
+    dispatch();
+    queue.dispatch_forever();
+    #else
+    while (running) {
+        runDueTasks();
+        int64_t wait = timeToNextReleaseUs();
+        if (wait < 0) {
+            break;  // Nothing periodic and nothing posted
+        }
+        if (running && wait > 0) {
+            std::unique_lock<std::mutex> lock(wakeLock);
+            wakeSignal.wait_for(lock, std::chrono::microseconds(wait),
+                                [this] { return anyPending() || !running; });
+        }
+    }
+    running = false;
+    #endif
+}
+
+void Scheduler::stop() {
+    running = false;
+    #ifdef MBED_OS
+    wakeup.detach();
+    queue.break_dispatch();
+    #else
+    wake();
+    #endif
+}
+
+const TaskStats& Scheduler::getStats(int task) const {
+    if (task < 0 || task >= taskCount) {
+        return NO_STATS;
+    }
+    return tasks[task].stats;
+}
+
+void Scheduler::resetStats() {
+    for (int i = 0; i < taskCount; i++) {
+        tasks[i].stats = NO_STATS;
+    }
+}
+
+void Scheduler::printStats() const {
+    for (int i = 0; i < taskCount; i++) {
+        const TaskStats& s = tasks[i].stats;
+        printf("Task %s: %lu runs, %lu overruns, %lu missed, max latency %.2f ms, max run %.2f ms\r\n",
+               tasks[i].name, s.runs, s.overruns, s.missedDeadlines,
+               s.maxLatencyUs / 1000.0f, s.maxRunTimeUs / 1000.0f);
+    }
+}
+
+/**
+ * @brief Run due tasks and, on Mbed, re-arm the wake-up interrupt
+ */
+void Scheduler::dispatch() {
+    runDueTasks();
+    #ifdef MBED_OS
+    int64_t wait = timeToNextReleaseUs();
+    if (running && wait >= 0) {
+        wakeup.attach(callback(this, &Scheduler::onWakeup), std::chrono::microseconds(wait));
+    }
+    #endif
+}
+
+#ifdef MBED_OS
+/**
+ * @brief Timeout interrupt: defer the dispatch to thread context
+ */
+void Scheduler::onWakeup() {
+    queue.call(callback(this, &Scheduler::dispatch));
+}
+#endif
+
+/**
+ * @brief Run every task whose release time has passed or that was posted
+ * 
+ * A periodic task that starts a whole period or more after its release
+ * skips the missed releases instead of running back to back, so a stall
+ * does not turn into a burst of catch-up executions.
+ */
+void Scheduler::runDueTasks() {
+    for (int i = 0; i < taskCount; i++) {
+        Task& task = tasks[i];
+        uint64_t startQ16 = nowUs() << 16;
+        bool released = task.periodQ16 > 0 && startQ16 >= task.releaseQ16;
+        if (!released && !task.pending) {
+            continue;
+        }
+        
+        if (released) {
+            uint64_t lateQ16 = startQ16 - task.releaseQ16;
+            uint32_t latencyUs = (uint32_t)(lateQ16 >> 16);
+            if (latencyUs > task.stats.maxLatencyUs) {
+                task.stats.maxLatencyUs = latencyUs;
+            }
+            uint64_t skipped = lateQ16 / task.periodQ16;
+            task.stats.missedDeadlines += (unsigned long)skipped;
+            task.releaseQ16 += (skipped + 1) * task.periodQ16;
+        }
+        task.pending = false;
+        
+        task.function();
+        task.stats.runs++;
+        
+        uint64_t endQ16 = nowUs() << 16;
+        uint32_t runTimeUs = (uint32_t)((endQ16 - startQ16) >> 16);
+        if (runTimeUs > task.stats.maxRunTimeUs) {
+            task.stats.maxRunTimeUs = runTimeUs;
+        }
+        if (released && endQ16 >= task.releaseQ16) {
+            task.stats.overruns++;
+        }
+    }
+}
+
+#ifndef MBED_OS
+bool Scheduler::anyPending() const {
+    for (int i = 0; i < taskCount; i++) {
+        if (tasks[i].pending) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Wake run() from its wait
+ * 
+ * Taking the lock orders the caller's update before run() checks its wait
+ * condition, so a post between the check and the wait is not lost.
+ */
+void Scheduler::wake() {
+    {
+        std::lock_guard<std::mutex> lock(wakeLock);
+    }
+    wakeSignal.notify_one();
+}
+#endif
+
+/**
+ * @brief Time until the earliest release
+ * @return Microseconds (0 if a task is due or posted, -1 if nothing is scheduled)
+ */
+int64_t Scheduler::timeToNextReleaseUs() {
+    uint64_t earliest = UINT64_MAX;
+    for (int i = 0; i < taskCount; i++) {
+        if (tasks[i].pending) {
+            return 0;
+        }
+        if (tasks[i].periodQ16 > 0 && tasks[i].releaseQ16 < earliest) {
+            earliest = tasks[i].releaseQ16;
+        }
+    }
+    if (earliest == UINT64_MAX) {
+        return -1;
+    }
+    uint64_t now = nowUs() << 16;
+    return (earliest > now) ? (int64_t)((earliest - now + 0xFFFF) >> 16) : 0;
+}
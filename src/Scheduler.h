@@ -0,0 +1,169 @@
+/**
+ * @file Scheduler.h
+ * @brief Hardware-timed periodic task scheduler for the acquisition loop
+ * 
+ * Tasks are released at absolute times kept in 1/65536 microsecond fixed
+ * point, so a period that is not a whole number of microseconds (e.g.
+ * 19230.77us at 52Hz) accumulates its fraction and the average rate is
+ * exact. Lateness never shifts later releases.
+ * 
+ * On Mbed a one-shot LowPowerTimeout is armed for the earliest release;
+ * its interrupt posts the dispatch to an EventQueue, so task bodies run in
+ * thread context and the CPU sleeps between releases. The low-power
+ * ticker keeps running in Stop mode and, unlike the microsecond ticker,
+ * does not hold the deep-sleep lock, so tickless idle can enter deep sleep
+ * between releases. In native builds run() waits on a condition variable
+ * until the next release instead, and post() from another thread wakes
+ * it.
+ * 
+ * Per task the scheduler counts overruns (the task was still running at
+ * its next release) and missed deadlines (whole periods skipped because
+ * the task started more than one period late).
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "mbed_compat.h"
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Task body; runs in thread context
+ */
+typedef void (*TaskFunction)();
+
+/**
+ * @struct TaskStats
+ * @brief Timing statistics of one scheduled task
+ */
+struct TaskStats {
+    unsigned long runs;             // Completed executions
+    unsigned long overruns;         // Executions still running at the next release
+    unsigned long missedDeadlines;  // Releases skipped because the task started a period late
+    uint32_t maxLatencyUs;          // Worst delay from release to start
+    uint32_t maxRunTimeUs;          // Worst execution time
+};
+
+/**
+ * @class Scheduler
+ * @brief Releases periodic and posted tasks at exact times
+ * 
+ * Tasks run in the order they were added when several are due at once.
+ * A task with rate 0 is event-only and runs after post().
+ */
+class Scheduler {
+public:
+    static const int MAX_TASKS = 4;
+    
+    Scheduler();
+    
+    /**
+     * @brief Register a task
+     * 
+     * The first release of a periodic task is one period after run() (or
+     * after adding it, if the scheduler is already running).
+     * 
+     * @param name Name used in printStats() (must outlive the scheduler)
+     * @param function Task body
+     * @param rateHz Release rate in Hz (0 for an event-only task)
+     * @return Task id, or -1 if the task table is full
+     */
+    int addTask(const char* name, TaskFunction function, float rateHz);
+    
+    /**
+     * @brief Change the release rate of a task
+     * 
+     * The release already scheduled is kept; later releases use the new
+     * period.
+     * 
+     * @param task Task id from addTask()
+     * @param rateHz New rate in Hz (0 makes the task event-only)
+     * @return true if the task exists
+     */
+    bool setRate(int task, float rateHz);
+    
+    /**
+     * @brief Request one execution of a task as soon as possible
+     * 
+     * Must be called from thread context (a task or another thread).
+     * 
+     * @param task Task id from addTask()
+     */
+    void post(int task);
+    
+    /**
+     * @brief Request one execution of a task from an interrupt handler
+     * 
+     * The request is queued and applied in thread context, so it never
+     * races with the dispatch. Natively there are no interrupts and this
+     * is post().
+     * 
+     * @param task Task id from addTask()
+     */
+    void postFromInterrupt(int task);
+    
+    /**
+     * @brief Dispatch tasks until stop() is called
+     * 
+     * On Mbed this dispatches the EventQueue forever.
+     */
+    void run();
+    
+    /**
+     * @brief Make run() return after the current dispatch
+     */
+    void stop();
+    
+    /**
+     * @brief Get the timing statistics of a task
+     * @param task Task id from addTask()
+     * @return Statistics (all zero for an unknown id)
+     */
+    const TaskStats& getStats(int task) const;
+    
+    /**
+     * @brief Clear the statistics of all tasks
+     */
+    void resetStats();
+    
+    /**
+     * @brief Print one statistics line per task
+     */
+    void printStats() const;
+    
+private:
+    struct Task {
+        const char* name;       // Name for printStats()
+        TaskFunction function;  // Task body
+        uint64_t periodQ16;     // Period in 1/65536 us (0 for event-only)
+        uint64_t releaseQ16;    // Next release in 1/65536 us since start
+        std::atomic<bool> pending;  // Posted for immediate execution (set by other threads)
+        TaskStats stats;        // Timing statistics
+    };
+    
+    Task tasks[MAX_TASKS];      // Registered tasks, in priority order
+    int taskCount;              // Entries in use
+    std::atomic<bool> running;  // Inside run()
+    LowPowerTimer clock;        // Time base for releases (runs in deep sleep)
+    
+    #ifdef MBED_OS
+    EventQueue queue;           // Runs dispatch() in thread context
+    LowPowerTimeout wakeup;     // One-shot interrupt at the next release
+    
+    void onWakeup();
+    #else
+    std::mutex wakeLock;        // Orders post() against run()'s wait
+    std::condition_variable wakeSignal;  // Wakes run() on post() or stop()
+    
+    bool anyPending() const;
+    void wake();
+    #endif
+    
+    uint64_t nowUs();
+    void dispatch();
+    void runDueTasks();
+    int64_t timeToNextReleaseUs();
+};
+
+#endif
@@ -6,9 +6,6 @@
 #include "SensorManager.h"
 #include <cstdlib>
 #include <cmath>
-#ifdef NATIVE_TEST_MODE
-#include <sys/time.h>
-#endif
 #ifdef MBED_OS
 #include "LSM6DSL.h"
 #endif
@@ -17,18 +14,28 @@
  * @brief Constructor - Initialize sensor manager
  * 
  * Sets up simulation mode flags and initializes hardware pointers to null.
- * For native test mode, initializes simulation timer.
+ * The sample source is selected in begin().
  */
-SensorManager::SensorManager() : simulationMode(false) {
-    simulatedData = {0, 0, 0, 0, 0, 0};
+SensorManager::SensorManager() : simulationMode(false), sampleRate(52.0f),
+    accelRangeG(2), gyroRangeDps(250), odrIndex(2),
+    gyroPolicy(GYRO_ALWAYS_ON), gyroActive(true), gyroHoldWindows(0),
+    gravityRemoval(false), gravityPending(false), pedometerEnabled(false), activityGating(false),
+    source(nullptr), blockPosition(0), blockCount(0), sampleClockUs(0) {
+    simulatedData = {0, 0, 0, 0, 0, 0, 0};
+    gravity[0] = gravity[1] = gravity[2] = 0;
+    gravitySum[0] = gravitySum[1] = gravitySum[2] = 0;
+    gravitySamples = 0;
+    gravityTarget = 1;
     #ifdef NATIVE_TEST_MODE
-    simTimerStarted = false;
-    gettimeofday(&simStartTime, nullptr);
-    simTimerStarted = true;
+    simRaw[0] = simRaw[1] = simRaw[2] = 0;
+    simLowPass[0] = simLowPass[1] = simLowPass[2] = 0;
+    simHighPassOutput = true;
     #endif
     #ifdef MBED_OS
     i2c = nullptr;
     lsm6dsl = nullptr;
+    int1Pin = nullptr;
+    hardwareSource = nullptr;
     #endif
 }
 
@@ -44,6 +51,9 @@ bool SensorManager::begin() {
     #ifdef MBED_OS
         // Initialize STM32 hardware (I2C and LSM6DSL sensor)
         initHardware();
+        if (source == nullptr) {
+            setSampleSource(nullptr);
+        }
         return true;
     #else
         // Native mode (computer testing) - use simulated data
@@ -53,6 +63,14 @@ bool SensorManager::begin() {
         printf("Running in simulation mode (computer testing)\r\n");
         #endif
         simulationMode = true;
+        #ifdef NATIVE_TEST_MODE
+        // Register model mirrors the configuration LSM6DSL::init() applies
+        registerModel.writeRegister(LSM6DSL_CTRL1_XL, (LSM6DSL_ODR_52_HZ << 4) | LSM6DSL_ACCEL_FS_2G);
+        registerModel.writeRegister(LSM6DSL_CTRL2_G, (LSM6DSL_ODR_52_HZ << 4) | LSM6DSL_GYRO_FS_250DPS);
+        if (source == nullptr) {
+            setSampleSource(nullptr);
+        }
+        #endif
         return true;
     #endif
 }
@@ -71,75 +89,627 @@ void SensorManager::setSimulationData(float accelX, float accelY, float accelZ,
     simulatedData.gyroZ = gyroZ;
 }
 
+/**
+ * @brief Replace the sample source
+ * 
+ * Samples still buffered from the previous source are discarded.
+ * 
+ * @param source Sample source, or nullptr for the default
+ * @return true if the source was opened, false otherwise
+ */
+bool SensorManager::setSampleSource(SampleSource* source) {
+    if (source == nullptr) {
+        source = defaultSource();
+    }
+    this->source = source;
+    blockPosition = 0;
+    blockCount = 0;
+    if (source == nullptr) {
+        return false;
+    }
+    source->setSampleRate(sampleRate);
+    return source->open();
+}
+
+bool SensorManager::isSourceFinished() const {
+    return blockPosition >= blockCount && (source == nullptr || source->isFinished());
+}
+
+/**
+ * @brief Default source for the build
+ * @return Hardware source on target, generator in native mode, else nullptr
+ */
+SampleSource* SensorManager::defaultSource() {
+    #ifdef MBED_OS
+    return hardwareSource;
+    #elif defined(NATIVE_TEST_MODE)
+    return &generatorSource;
+    #else
+    return nullptr;
+    #endif
+}
+
+/**
+ * @brief Pop the next sample, pulling a new block from the source when empty
+ * 
+ * @param data Reference to store the sample
+ * @return true if a sample was available, false otherwise
+ */
+bool SensorManager::nextSample(SensorData& data) {
+    if (blockPosition >= blockCount) {
+        blockPosition = 0;
+        blockCount = (source != nullptr) ? source->readSamples(sourceBlock, SOURCE_BLOCK_SIZE) : 0;
+        if (blockCount <= 0) {
+            blockCount = 0;
+            return false;
+        }
+    }
+    data = sourceBlock[blockPosition++];
+    return true;
+}
+
+/**
+ * @brief Change accelerometer and gyroscope output data rate
+ * 
+ * Snaps the requested rate to the nearest supported LSM6DSL ODR and applies
+ * it to both sensors. In simulation mode only the bookkeeping is updated.
+ * 
+ * @param hz Requested sampling frequency in Hz
+ * @return true if the rate was applied, false otherwise
+ */
+bool SensorManager::setSampleRate(float hz) {
+    // Supported ODRs in CTRL1_XL/CTRL2_G code order (code = index + 1)
+    static const float rates[] = {12.5f, 26.0f, 52.0f, 104.0f, 208.0f,
+                                  416.0f, 833.0f, 1660.0f, 3330.0f, 6660.0f};
+    const int rateCount = sizeof(rates) / sizeof(rates[0]);
+    if (hz <= 0.0f) {
+        return false;
+    }
+    
+    int best = 0;
+    for (int i = 1; i < rateCount; i++) {
+        if (fabsf(rates[i] - hz) < fabsf(rates[best] - hz)) {
+            best = i;
+        }
+    }
+    
+    #ifdef MBED_OS
+    if (!simulationMode && lsm6dsl != nullptr) {
+        uint8_t odr = (uint8_t)(LSM6DSL_ODR_12_5_HZ + best);
+        if (!lsm6dsl->setAccelODR(odr)) {
+            return false;
+        }
+        // A powered-down gyroscope picks up the new ODR when it is woken
+        if (gyroActive && !lsm6dsl->setGyroODR(odr)) {
+            return false;
+        }
+    }
+    #endif
+    
+    #ifdef NATIVE_TEST_MODE
+    // Embedded engine timing follows the simulated CTRL1_XL ODR
+    registerModel.writeRegister(LSM6DSL_CTRL1_XL, (uint8_t)(((LSM6DSL_ODR_12_5_HZ + best) << 4) |
+                                                             (registerModel.readRegister(LSM6DSL_CTRL1_XL) & 0x0F)));
+    #endif
+    
+    sampleRate = rates[best];
+    odrIndex = best;
+    if (source != nullptr) {
+        source->setSampleRate(sampleRate);
+    }
+    return true;
+}
+
+/**
+ * @brief Change accelerometer full-scale range
+ * 
+ * @param rangeG Full-scale range in g (2, 4, 8 or 16)
+ * @return true if the range was applied, false for unsupported values
+ */
+bool SensorManager::setAccelRange(int rangeG) {
+    if (rangeG != 2 && rangeG != 4 && rangeG != 8 && rangeG != 16) {
+        return false;
+    }
+    #ifdef MBED_OS
+    if (!simulationMode && lsm6dsl != nullptr) {
+        uint8_t fs = (rangeG == 2) ? LSM6DSL_ACCEL_FS_2G :
+                     (rangeG == 4) ? LSM6DSL_ACCEL_FS_4G :
+                     (rangeG == 8) ? LSM6DSL_ACCEL_FS_8G : LSM6DSL_ACCEL_FS_16G;
+        if (!lsm6dsl->setAccelRange(fs)) {
+            return false;
+        }
+    }
+    #endif
+    accelRangeG = rangeG;
+    return true;
+}
+
+/**
+ * @brief Change gyroscope full-scale range
+ * 
+ * @param rangeDps Full-scale range in deg/s (125, 250, 500, 1000 or 2000)
+ * @return true if the range was applied, false for unsupported values
+ */
+bool SensorManager::setGyroRange(int rangeDps) {
+    if (rangeDps != 125 && rangeDps != 250 && rangeDps != 500 &&
+        rangeDps != 1000 && rangeDps != 2000) {
+        return false;
+    }
+    #ifdef MBED_OS
+    if (!simulationMode && lsm6dsl != nullptr) {
+        uint8_t fs = (rangeDps == 125) ? LSM6DSL_GYRO_FS_125DPS :
+                     (rangeDps == 250) ? LSM6DSL_GYRO_FS_250DPS :
+                     (rangeDps == 500) ? LSM6DSL_GYRO_FS_500DPS :
+                     (rangeDps == 1000) ? LSM6DSL_GYRO_FS_1000DPS : LSM6DSL_GYRO_FS_2000DPS;
+        if (!lsm6dsl->setGyroRange(fs)) {
+            return false;
+        }
+    }
+    #endif
+    gyroRangeDps = rangeDps;
+    return true;
+}
+
+/**
+ * @brief Select the gyroscope power policy
+ * 
+ * @param policy Gyroscope power policy
+ */
+void SensorManager::setGyroPowerPolicy(GyroPowerPolicy policy) {
+    gyroPolicy = policy;
+    gyroHoldWindows = 0;
+    // Always-on wakes the gyroscope now; walking policy waits for cadence
+    setGyroPowered(policy == GYRO_ALWAYS_ON);
+}
+
+/**
+ * @brief Apply the gyroscope power policy for the next window
+ * 
+ * Uses the same walking threshold as FOG detection (0.3 steps/sec). Once
+ * woken, the gyroscope stays on for two further windows so the freezing
+ * phase following a walk is captured with gyroscope data.
+ * 
+ * @param cadence Cadence of the last window (steps per second)
+ */
+void SensorManager::updateGyroPower(float cadence) {
+    if (gyroPolicy == GYRO_ALWAYS_ON) {
+        return;
+    }
+    
+    if (cadence > 0.3f) {
+        gyroHoldWindows = 2;
+        if (!gyroActive) {
+            setGyroPowered(true);
+        }
+    } else if (gyroHoldWindows > 0) {
+        gyroHoldWindows--;
+    } else if (gyroActive) {
+        setGyroPowered(false);
+    }
+}
+
+/**
+ * @brief Power the gyroscope up (at the current ODR) or down
+ * 
+ * @param powered true to run the gyroscope, false for power-down
+ * @return true if the new state was applied, false otherwise
+ */
+bool SensorManager::setGyroPowered(bool powered) {
+    #ifdef MBED_OS
+    if (!simulationMode && lsm6dsl != nullptr) {
+        uint8_t odr = powered ? (uint8_t)(LSM6DSL_ODR_12_5_HZ + odrIndex)
+                              : (uint8_t)LSM6DSL_ODR_POWER_DOWN;
+        if (!lsm6dsl->setGyroODR(odr)) {
+            return false;
+        }
+    }
+    if (hardwareSource != nullptr) {
+        hardwareSource->setGyroEnabled(powered);
+    }
+    #endif
+    #ifdef NATIVE_TEST_MODE
+    registerModel.writeRegister(LSM6DSL_CTRL2_G, powered ?
+        (uint8_t)(((LSM6DSL_ODR_12_5_HZ + odrIndex) << 4) | LSM6DSL_GYRO_FS_250DPS) :
+        (uint8_t)LSM6DSL_GYRO_FS_250DPS);
+    #endif
+    gyroActive = powered;
+    return true;
+}
+
+/**
+ * @brief Enable or disable hardware gravity removal
+ * 
+ * A single unfiltered sample seeds the gravity reference, and a refresh
+ * starts at once, so the first window's reference is averaged like the
+ * later ones.
+ * 
+ * @param enabled true for high-pass filtered acceleration
+ * @return true if the mode was applied, false otherwise
+ */
+bool SensorManager::setGravityRemoval(bool enabled) {
+    if (enabled == gravityRemoval) {
+        return true;
+    }
+    
+    #ifdef MBED_OS
+    if (!simulationMode && lsm6dsl != nullptr) {
+        if (enabled) {
+            if (!lsm6dsl->readAccel(gravity[0], gravity[1], gravity[2]) ||
+                !lsm6dsl->enableAccelHighPass(LSM6DSL_XL_HPCF_11)) {
+                return false;
+            }
+        } else if (!lsm6dsl->disableAccelFilters()) {
+            return false;
+        }
+    }
+    #endif
+    
+    #ifdef NATIVE_TEST_MODE
+    // Simulated filter starts settled on the current input
+    for (int i = 0; i < 3; i++) {
+        gravity[i] = simRaw[i];
+        simLowPass[i] = simRaw[i];
+    }
+    simHighPassOutput = true;
+    #endif
+    
+    gravityPending = false;
+    gravityRemoval = enabled;
+    if (enabled) {
+        refreshGravity();
+    }
+    return true;
+}
+
+/**
+ * @brief Re-sample the gravity vector removed by the high-pass filter
+ * 
+ * Only the HP_SLOPE_XL_EN routing bit is toggled; the cutoff stays
+ * configured and the filter keeps running. Called from the acquisition
+ * task, so it must not wait for the unfiltered output: conditionSample()
+ * averages the next samples and switches the filter output back on.
+ * 
+ * @return true if the refresh was started, false otherwise
+ */
+bool SensorManager::refreshGravity() {
+    if (!gravityRemoval || gravityPending) {
+        return false;
+    }
+    if (!setHighPassOutput(false)) {
+        return false;
+    }
+    gravitySum[0] = gravitySum[1] = gravitySum[2] = 0;
+    gravitySamples = 0;
+    gravityTarget = (int)(sampleRate * GRAVITY_AVERAGE_S + 0.5f);
+    if (gravityTarget < 1) {
+        gravityTarget = 1;
+    }
+    gravityPending = true;
+    return true;
+}
+
+/**
+ * @brief Route the accelerometer output through the high-pass filter or not
+ * 
+ * In native test mode the emulated filter's routing is switched.
+ * 
+ * @param enabled true for filtered output
+ * @return true if the routing was applied, false otherwise
+ */
+bool SensorManager::setHighPassOutput(bool enabled) {
+    #ifdef MBED_OS
+    if (simulationMode || lsm6dsl == nullptr) {
+        return false;
+    }
+    return lsm6dsl->setAccelHighPassOutput(enabled);
+    #else
+    simHighPassOutput = enabled;
+    return true;
+    #endif
+}
+
+/**
+ * @brief Take one unfiltered sample of a gravity refresh
+ * 
+ * The sample is added to the average and delivered minus the current
+ * reference, so the acceleration stays high-passed while the output is
+ * off. After GRAVITY_AVERAGE_S of samples the mean becomes the reference
+ * and the filter output is switched back on; if that fails, averaging
+ * starts over and the switch is retried at the end.
+ * 
+ * @param data Unfiltered sample, modified in place
+ */
+void SensorManager::averageGravity(SensorData& data) {
+    gravitySum[0] += data.accelX;
+    gravitySum[1] += data.accelY;
+    gravitySum[2] += data.accelZ;
+    data.accelX -= gravity[0];
+    data.accelY -= gravity[1];
+    data.accelZ -= gravity[2];
+    if (++gravitySamples < gravityTarget) {
+        return;
+    }
+    
+    for (int i = 0; i < 3; i++) {
+        gravity[i] = gravitySum[i] / gravitySamples;
+        gravitySum[i] = 0;
+    }
+    gravitySamples = 0;
+    gravityPending = !setHighPassOutput(true);
+}
+
+void SensorManager::getGravity(float& gx, float& gy, float& gz) const {
+    gx = gravity[0];
+    gy = gravity[1];
+    gz = gravity[2];
+}
+
+/**
+ * @brief Enable the LSM6DSL embedded pedometer and significant motion
+ * 
+ * The step detector is not routed to INT1; the counter is polled once per
+ * window, which is all cadence estimation needs.
+ * 
+ * @return true if the embedded functions were enabled, false otherwise
+ */
+bool SensorManager::enablePedometer() {
+    #ifdef MBED_OS
+    if (!simulationMode && lsm6dsl != nullptr) {
+        if (!lsm6dsl->enablePedometer(false) || !lsm6dsl->enableSignificantMotion(false)) {
+            return false;
+        }
+        pedometerEnabled = true;
+        return true;
+    }
+    #endif
+    
+    #ifdef NATIVE_TEST_MODE
+    // Configure the register model the same way the driver configures the chip
+    registerModel.writeRegister(LSM6DSL_CTRL10_C, LSM6DSL_CTRL10_FUNC_EN | LSM6DSL_CTRL10_PEDO_EN |
+                                LSM6DSL_CTRL10_PEDO_RST_STEP);
+    registerModel.writeRegister(LSM6DSL_CTRL10_C, LSM6DSL_CTRL10_FUNC_EN | LSM6DSL_CTRL10_PEDO_EN |
+                                LSM6DSL_CTRL10_SIGN_MOTION_EN);
+    pedometerEnabled = true;
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+/**
+ * @brief Read the hardware step counter
+ * 
+ * @param steps Reference to store the 16-bit (wrapping) step count
+ * @return true if read successful, false otherwise
+ */
+bool SensorManager::readStepCount(uint16_t& steps) {
+    if (!pedometerEnabled) {
+        return false;
+    }
+    #ifdef MBED_OS
+    if (lsm6dsl != nullptr) {
+        return lsm6dsl->readStepCount(steps);
+    }
+    return false;
+    #elif defined(NATIVE_TEST_MODE)
+    steps = (uint16_t)((registerModel.readRegister(LSM6DSL_STEP_COUNTER_H) << 8) |
+                       registerModel.readRegister(LSM6DSL_STEP_COUNTER_L));
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+/**
+ * @brief Check (and clear) the significant motion event flag
+ * 
+ * FUNC_SRC1 is clear-on-read, so each event is reported once.
+ * 
+ * @return true if significant motion was detected since the last check
+ */
+bool SensorManager::significantMotionDetected() {
+    if (!pedometerEnabled) {
+        return false;
+    }
+    uint8_t source = 0;
+    #ifdef MBED_OS
+    if (lsm6dsl == nullptr || !lsm6dsl->readFunctionSource(source)) {
+        return false;
+    }
+    #elif defined(NATIVE_TEST_MODE)
+    source = registerModel.readRegister(LSM6DSL_FUNC_SRC1);
+    #endif
+    return (source & LSM6DSL_FUNC_SRC1_SIGN_MOTION_IA) != 0;
+}
+
+/**
+ * @brief Enable LSM6DSL wake-up / inactivity detection
+ * 
+ * WK_THS = 1 (31.25mg at ±2g) keeps a small resting tremor above the wake
+ * threshold; SLEEP_DUR = 1 (512 samples, ~10s at 52Hz) means a freeze is
+ * analyzed well before the pipeline is gated.
+ * 
+ * @return true if activity detection was enabled, false otherwise
+ */
+bool SensorManager::enableActivityGating() {
+    #ifdef MBED_OS
+    if (!simulationMode && lsm6dsl != nullptr) {
+        if (!lsm6dsl->configureActivityDetection(1, 0, 1, LSM6DSL_INACT_EN_XL_12_5HZ)) {
+            return false;
+        }
+        // LSM6DSL INT1 is wired to PD11 on the B-L475E-IOT01A
+        int1Pin = new InterruptIn(PD_11);
+        activityGating = true;
+        return true;
+    }
+    return false;
+    #elif defined(NATIVE_TEST_MODE)
+    registerModel.writeRegister(LSM6DSL_WAKE_UP_THS, 1);
+    registerModel.writeRegister(LSM6DSL_WAKE_UP_DUR, 0x01);
+    registerModel.writeRegister(LSM6DSL_TAP_CFG, LSM6DSL_TAP_CFG_INTERRUPTS_ENABLE |
+                                LSM6DSL_INACT_EN_XL_12_5HZ);
+    registerModel.writeRegister(LSM6DSL_MD1_CFG, LSM6DSL_MD1_INT1_INACT_STATE);
+    activityGating = true;
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+/**
+ * @brief Check whether the sensor reports the inactivity (sleep) state
+ * 
+ * @return true while the wearer is still, false when moving or gating disabled
+ */
+bool SensorManager::isInactive() {
+    if (!activityGating) {
+        return false;
+    }
+    #ifdef MBED_OS
+    if (int1Pin != nullptr) {
+        return int1Pin->read() != 0;
+    }
+    uint8_t source;
+    return lsm6dsl != nullptr && lsm6dsl->readWakeUpSource(source) &&
+           (source & LSM6DSL_WAKE_UP_SRC_SLEEP_STATE_IA) != 0;
+    #elif defined(NATIVE_TEST_MODE)
+    return (registerModel.readRegister(LSM6DSL_WAKE_UP_SRC) & LSM6DSL_WAKE_UP_SRC_SLEEP_STATE_IA) != 0;
+    #else
+    return false;
+    #endif
+}
+
+/**
+ * @brief Call a handler when the sensor leaves its inactivity state
+ * 
+ * @param handler Interrupt handler, nullptr to detach
+ * @return true if a wake-up interrupt is available, false otherwise
+ */
+bool SensorManager::setActivityWakeup(void (*handler)()) {
+    #ifdef MBED_OS
+    if (int1Pin == nullptr) {
+        return false;
+    }
+    int1Pin->fall(handler);  // A null handler detaches
+    return true;
+    #else
+    (void)handler;
+    return false;
+    #endif
+}
+
 /**
  * @brief Read current sensor data
  * 
- * Returns data from either hardware sensor or simulation mode.
- * In simulation mode, generates test signals with different frequencies
- * for algorithm validation.
+ * Returns the next sample from the active sample source (hardware sensor,
+ * generator, file or socket). Zero data is returned when the source has
+ * nothing to deliver. In native test mode every sample is also fed to the
+ * register model so embedded functions see the same signal.
  * 
  * @return SensorData structure with accelerometer and gyroscope readings
  */
 SensorData SensorManager::read() {
+    #ifndef NATIVE_TEST_MODE
     if (simulationMode) {
-        #ifdef NATIVE_TEST_MODE
-            // Generate simulated sensor data with different frequency signals for testing
-            // This allows testing detection algorithms without hardware
-            int timeMs = getSimTimeMs();
-            
-            // Base value + noise for realistic simulation
-            float noise = (rand() % 20 - 10) / 1000.0f;
-            
-            SensorData data;
-            // Generate test signals at different frequencies:
-            // - 4Hz signal for tremor testing
-            // - 6Hz signal for dyskinesia testing
-            // Add phase offset for Y-axis to simulate 3D movement
-            data.accelX = 0.1f * sin(2.0f * M_PI * 4.0f * timeMs / 1000.0f) + noise;
-            data.accelY = 0.1f * sin(2.0f * M_PI * 4.0f * timeMs / 1000.0f + M_PI/4) + noise;
-            data.accelZ = 0.1f + noise;  // Gravity component + noise
-            data.gyroX = noise * 10;      // Small gyroscope noise
-            data.gyroY = noise * 10;
-            data.gyroZ = noise * 10;
-            
-            return data;
-        #else
-            // Return simulated data with added noise for realism
-            SensorData data = simulatedData;
-            // Add small random noise to simulate sensor noise
-            data.accelX += (rand() % 20 - 10) / 1000.0f;
-            data.accelY += (rand() % 20 - 10) / 1000.0f;
-            data.accelZ += (rand() % 20 - 10) / 1000.0f;
-            return data;
-        #endif
+        // Return simulated data with added noise for realism
+        SensorData data = simulatedData;
+        // Add small random noise to simulate sensor noise
+        data.accelX += (rand() % 20 - 10) / 1000.0f;
+        data.accelY += (rand() % 20 - 10) / 1000.0f;
+        data.accelZ += (rand() % 20 - 10) / 1000.0f;
+        return data;
     }
+    #endif
     
-    #ifdef MBED_OS
-        // Read from actual hardware sensor (LSM6DSL)
-        if (lsm6dsl == nullptr) {
-            // Sensor not initialized, return zero data
-            SensorData data = {0, 0, 0, 0, 0, 0};
-            return data;
+    SensorData data;
+    if (!nextSample(data)) {
+        // Source failed or has no data, return zero data
+        data = {0, 0, 0, 0, 0, 0, 0};
+        return data;
+    }
+    conditionSample(data);
+    return data;
+}
+
+/**
+ * @brief Read up to maxSamples samples into structure-of-arrays buffers
+ * 
+ * @param block Destination arrays
+ * @param maxSamples Maximum number of samples to deliver
+ * @return Number of samples written
+ */
+int SensorManager::readBlock(const SensorBlock& block, int maxSamples) {
+    if (source == nullptr || maxSamples <= 0) {
+        return 0;
+    }
+    
+    bool paced = source->isPaced();
+    bool pulled = false;
+    int count = 0;
+    while (count < maxSamples) {
+        // A paced source has at most one new block per poll
+        if (blockPosition >= blockCount) {
+            if (paced && pulled) {
+                break;
+            }
+            pulled = true;
         }
-        
         SensorData data;
-        // Read accelerometer data (X, Y, Z axes in g)
-        if (!lsm6dsl->readAccel(data.accelX, data.accelY, data.accelZ)) {
-            // Read failed, return zero data
-            data = {0, 0, 0, 0, 0, 0};
-            return data;
+        if (!nextSample(data)) {
+            break;
         }
+        conditionSample(data);
         
-        // Read gyroscope data (X, Y, Z axes in deg/s)
-        if (!lsm6dsl->readGyro(data.gyroX, data.gyroY, data.gyroZ)) {
-            // Read failed, set gyroscope to zero but keep accelerometer data
-            data.gyroX = data.gyroY = data.gyroZ = 0;
+        block.accelX[count] = data.accelX;
+        block.accelY[count] = data.accelY;
+        block.accelZ[count] = data.accelZ;
+        if (block.gyroX != nullptr) {
+            block.gyroX[count] = data.gyroX;
+            block.gyroY[count] = data.gyroY;
+            block.gyroZ[count] = data.gyroZ;
         }
-        
-        return data;
-    #else
-        return simulatedData;
+        if (block.timestampUs != nullptr) {
+            block.timestampUs[count] = data.timestampUs;
+        }
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Per-sample processing shared by read() and readBlock()
+ * 
+ * Stamps untimed samples from the sample clock (timed samples resync it)
+ * and zeroes gyroscope data while it is powered down. In native test mode
+ * the sample is also fed to the register model and the on-chip high-pass
+ * filter is emulated. Samples read during a gravity refresh are averaged
+ * into the new reference.
+ * 
+ * @param data Sample, modified in place
+ */
+void SensorManager::conditionSample(SensorData& data) {
+    if (source != nullptr && source->isTimestamped()) {
+        sampleClockUs = data.timestampUs;
+    } else {
+        data.timestampUs = (uint32_t)(uint64_t)sampleClockUs;
+    }
+    sampleClockUs += 1e6 / sampleRate;
+    
+    // Gyroscope samples are meaningless while it is powered down
+    if (!gyroActive) {
+        data.gyroX = data.gyroY = data.gyroZ = 0;
+    }
+    
+    #ifdef NATIVE_TEST_MODE
+    registerModel.pushSample(data.accelX, data.accelY, data.accelZ,
+                             data.gyroX, data.gyroY, data.gyroZ);
+    simulateHighPass(data);
     #endif
+    
+    // Samples after refreshGravity() are unfiltered
+    if (gravityPending) {
+        averageGravity(data);
+    }
 }
 
 #ifdef MBED_OS
@@ -198,39 +768,41 @@ void SensorManager::initHardware() {
         }
     }
     
+    hardwareSource = new HardwareSampleSource(lsm6dsl);
+    hardwareSource->setGyroEnabled(gyroActive);
     printf("Sensor initialization successful (I2C address: 0x%02X)\r\n", LSM6DSL_I2C_ADDRESS);
 }
 #endif
 
 #ifdef NATIVE_TEST_MODE
 /**
- * @brief Get elapsed simulation time in milliseconds
- * 
- * Used for generating time-based test signals in simulation mode.
- * 
- * @return Elapsed time in milliseconds since simulation started
- */
-int SensorManager::getSimTimeMs() {
-    if (!simTimerStarted) return 0;
-    struct timeval currentTime;
-    gettimeofday(&currentTime, nullptr);
-    return (currentTime.tv_sec - simStartTime.tv_sec) * 1000 + 
-           (currentTime.tv_usec - simStartTime.tv_usec) / 1000;
-}
-
-/**
- * @brief Generate simulated sensor value with sinusoidal signal
+ * @brief Emulate the LSM6DSL ODR/400 high-pass filter on simulated data
  * 
- * Creates a sine wave signal for testing detection algorithms.
+ * A one-pole low-pass tracks the gravity component; its output is
+ * subtracted from the sample when gravity removal is enabled. Like the
+ * chip's filter it keeps running while its output is switched off, and
+ * the gravity reference is averaged by refreshGravity() as on hardware,
+ * not read from the filter state.
  * 
- * @param base Base value (DC offset)
- * @param amplitude Signal amplitude
- * @param frequency Signal frequency in Hz
- * @param timeMs Current time in milliseconds
- * @return Generated signal value
+ * @param data Simulated sample, filtered in place
  */
-float SensorManager::generateSimulatedValue(float base, float amplitude, 
-                                            float frequency, int timeMs) {
-    return base + amplitude * sin(2.0f * M_PI * frequency * timeMs / 1000.0f);
+void SensorManager::simulateHighPass(SensorData& data) {
+    simRaw[0] = data.accelX;
+    simRaw[1] = data.accelY;
+    simRaw[2] = data.accelZ;
+    if (!gravityRemoval) {
+        return;
+    }
+    
+    // Cutoff ODR/400 -> alpha = 2*pi*fc/fs = 2*pi/400
+    const float alpha = 2.0f * (float)M_PI / 400.0f;
+    for (int i = 0; i < 3; i++) {
+        simLowPass[i] += alpha * (simRaw[i] - simLowPass[i]);
+    }
+    if (simHighPassOutput) {
+        data.accelX -= simLowPass[0];
+        data.accelY -= simLowPass[1];
+        data.accelZ -= simLowPass[2];
+    }
 }
 #endif
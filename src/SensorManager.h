@@ -7,27 +7,52 @@
  * - Simulation: Generated test data for algorithm development and testing
  * 
  * The class automatically handles initialization, data reading, and provides
- * simulation mode for testing without hardware.
+ * simulation mode for testing without hardware. Samples are pulled in blocks
+ * from a SampleSource (see SampleSource.h); recorded or streamed data can be
+ * run through the pipeline by installing a different source.
  */
 
 #ifndef SENSOR_MANAGER_H
 #define SENSOR_MANAGER_H
 
 #include "mbed_compat.h"
+#include "SampleSource.h"
+#ifdef NATIVE_TEST_MODE
+#include "LSM6DSLSim.h"
+#endif
 
 /**
- * @struct SensorData
- * @brief Structure containing accelerometer and gyroscope readings
+ * @struct SensorBlock
+ * @brief Caller-provided structure-of-arrays buffers for readBlock()
  * 
- * All values are in standard units:
- * - Accelerometer: g (gravitational acceleration, 1g = 9.81 m/s²)
- * - Gyroscope: deg/s (degrees per second)
+ * Each non-null pointer addresses an array with room for the requested
+ * number of samples. Gyroscope and timestamp arrays may be nullptr when
+ * they are not needed (e.g. while the gyroscope is powered down).
  */
-struct SensorData {
-    float accelX, accelY, accelZ;  // Accelerometer data in g (X, Y, Z axes)
-    float gyroX, gyroY, gyroZ;     // Gyroscope data in deg/s (X, Y, Z axes)
+struct SensorBlock {
+    float* accelX;              // Accelerometer X (g)
+    float* accelY;              // Accelerometer Y (g)
+    float* accelZ;              // Accelerometer Z (g)
+    float* gyroX;               // Gyroscope X (deg/s), optional
+    float* gyroY;               // Gyroscope Y (deg/s), optional
+    float* gyroZ;               // Gyroscope Z (deg/s), optional
+    uint32_t* timestampUs;      // Sample time in microseconds (wraps), optional
 };
 
+/**
+ * @enum GyroPowerPolicy
+ * @brief Power policy for the gyroscope
+ * 
+ * The gyroscope is only consumed by FOG detection, so it can stay in
+ * power-down (CTRL2_G ODR = 0) until the wearer starts walking.
+ */
+enum GyroPowerPolicy {
+    GYRO_ALWAYS_ON,     // Gyroscope runs at the accelerometer ODR at all times
+    GYRO_ON_WALKING     // Gyroscope powered only while cadence suggests walking
+};
+
+const float GRAVITY_AVERAGE_S = 0.5f;  // Unfiltered span averaged into a gravity reference (s)
+
 /**
  * @class SensorManager
  * @brief Manages sensor initialization and data acquisition
@@ -52,6 +77,25 @@ public:
      */
     SensorData read();
     
+    /**
+     * @brief Read up to maxSamples samples into structure-of-arrays buffers
+     * 
+     * Samples are written channel by channel into the caller's arrays, so
+     * window buffers can be filled in place without per-sample copies.
+     * Paced sources (the sensor) are pulled once per call and return what
+     * is available; unpaced sources (generator, file, socket) are drained
+     * until maxSamples are delivered or the source runs dry.
+     * 
+     * Timestamps come from the source when it provides them (MCU timer for
+     * the sensor, t_ms column for recordings); otherwise from the sample
+     * clock, which advances one period of the applied sample rate per sample.
+     * 
+     * @param block Destination arrays
+     * @param maxSamples Maximum number of samples to deliver
+     * @return Number of samples written
+     */
+    int readBlock(const SensorBlock& block, int maxSamples);
+    
     /**
      * @brief Enable or disable simulation mode
      * @param enabled true to enable simulation, false for hardware mode
@@ -66,23 +110,239 @@ public:
     void setSimulationData(float accelX, float accelY, float accelZ,
                           float gyroX, float gyroY, float gyroZ);
     
+    /**
+     * @brief Replace the sample source
+     * 
+     * The source is opened and told the current sample rate. The caller
+     * keeps ownership; pass nullptr to restore the default source (the
+     * LSM6DSL on hardware, the built-in generator in native test mode).
+     * 
+     * @param source Sample source, or nullptr for the default
+     * @return true if the source was opened, false otherwise
+     */
+    bool setSampleSource(SampleSource* source);
+    
+    /**
+     * @brief Check whether the sample source has run out of data
+     * 
+     * Recorded sources end; native runs use this to stop the pipeline.
+     * 
+     * @return true once no buffered or pending samples remain
+     */
+    bool isSourceFinished() const;
+    
+    /**
+     * @brief Change accelerometer and gyroscope output data rate
+     * 
+     * The requested rate is snapped to the nearest supported LSM6DSL ODR
+     * (12.5Hz ... 6.66kHz). Use getSampleRate() to obtain the applied value
+     * and propagate it to SymptomDetector::setSampleRate().
+     * 
+     * @param hz Requested sampling frequency in Hz
+     * @return true if the rate was applied, false otherwise
+     */
+    bool setSampleRate(float hz);
+    
+    /**
+     * @brief Get the currently applied sampling frequency
+     * @return Sampling frequency in Hz
+     */
+    float getSampleRate() const { return sampleRate; }
+    
+    /**
+     * @brief Change accelerometer full-scale range
+     * @param rangeG Full-scale range in g (2, 4, 8 or 16)
+     * @return true if the range was applied, false for unsupported values
+     */
+    bool setAccelRange(int rangeG);
+    
+    /**
+     * @brief Change gyroscope full-scale range
+     * @param rangeDps Full-scale range in deg/s (125, 250, 500, 1000 or 2000)
+     * @return true if the range was applied, false for unsupported values
+     */
+    bool setGyroRange(int rangeDps);
+    
+    /**
+     * @brief Select the gyroscope power policy
+     * 
+     * Switching to GYRO_ALWAYS_ON powers the gyroscope immediately.
+     * With GYRO_ON_WALKING the gyroscope is powered down until
+     * updateGyroPower() sees a walking cadence.
+     * 
+     * @param policy Gyroscope power policy
+     */
+    void setGyroPowerPolicy(GyroPowerPolicy policy);
+    
+    /**
+     * @brief Apply the gyroscope power policy for the next window
+     * 
+     * Call once per analysis window (after SymptomDetector::analyze) so the
+     * gyroscope state is constant for the whole of each window. The gyroscope
+     * is woken when cadence exceeds the walking threshold and kept on for a
+     * few windows afterwards so a walk-to-freeze transition is still seen.
+     * 
+     * @param cadence Cadence of the last window (steps per second)
+     */
+    void updateGyroPower(float cadence);
+    
+    /**
+     * @brief Check whether gyroscope samples are being acquired
+     * @return true if the gyroscope is powered, false if in power-down
+     */
+    bool isGyroActive() const { return gyroActive; }
+    
+    /**
+     * @brief Enable or disable hardware gravity removal
+     * 
+     * Routes the accelerometer through the LSM6DSL high-pass filter
+     * (cutoff ODR/400) so read() delivers gravity-removed acceleration.
+     * A gravity reference is averaged from the first samples read after
+     * enable (see refreshGravity()); pass it to
+     * SymptomDetector::setGravityReference() for the magnitude path.
+     * 
+     * @param enabled true for high-pass filtered acceleration
+     * @return true if the mode was applied, false otherwise
+     */
+    bool setGravityRemoval(bool enabled);
+    
+    bool isGravityRemoved() const { return gravityRemoval; }
+    
+    /**
+     * @brief Re-sample the gravity vector removed by the high-pass filter
+     * 
+     * The filter output is switched off here, and the samples read in
+     * the next GRAVITY_AVERAGE_S are unfiltered: their mean (over a whole
+     * gait or tremor cycle, so motion averages out) becomes the new
+     * reference and the output is switched back on.
+     * Those samples are delivered minus the current reference, so the
+     * acceleration stays high-passed without a step. Native builds run the
+     * same sequence on the emulated filter. Never blocks. Intended to be
+     * called once per analysis window.
+     * 
+     * @return true if the refresh was started, false otherwise (e.g. a
+     *         refresh is still averaging)
+     */
+    bool refreshGravity();
+    
+    /**
+     * @brief Get the latest gravity reference
+     * @param gx, gy, gz References to store gravity components (g)
+     */
+    void getGravity(float& gx, float& gy, float& gz) const;
+    
+    /**
+     * @brief Enable the LSM6DSL embedded pedometer and significant motion
+     * 
+     * Once enabled, readStepCount() returns the hardware step counter; pass
+     * it to SymptomDetector::setStepCount() to replace software step
+     * detection. In native test mode the simulated register model counts.
+     * 
+     * @return true if the embedded functions were enabled, false otherwise
+     */
+    bool enablePedometer();
+    
+    bool isPedometerEnabled() const { return pedometerEnabled; }
+    
+    /**
+     * @brief Read the hardware step counter
+     * @param steps Reference to store the 16-bit (wrapping) step count
+     * @return true if read successful, false otherwise
+     */
+    bool readStepCount(uint16_t& steps);
+    
+    /**
+     * @brief Check (and clear) the significant motion event flag
+     * @return true if significant motion was detected since the last check
+     */
+    bool significantMotionDetected();
+    
+    /**
+     * @brief Enable LSM6DSL wake-up / inactivity detection for pipeline gating
+     * 
+     * The sensor drops into its sleep state (accelerometer at 12.5Hz) after
+     * about 10s without motion above ~31mg and wakes on the next movement.
+     * On hardware the sleep state is routed to INT1 so isInactive() is a pin
+     * read rather than an I2C transaction.
+     * 
+     * @return true if activity detection was enabled, false otherwise
+     */
+    bool enableActivityGating();
+    
+    /**
+     * @brief Check whether the sensor reports the inactivity (sleep) state
+     * @return true while the wearer is still, false when moving or gating disabled
+     */
+    bool isInactive();
+    
+    /**
+     * @brief Call a handler when the wearer starts moving again
+     * 
+     * On hardware the handler runs in interrupt context on the falling edge
+     * of INT1 (the sensor leaving its inactivity state), so while the
+     * pipeline is gated the MCU can stay in deep sleep instead of polling
+     * isInactive(). Requires enableActivityGating().
+     * 
+     * @param handler Interrupt handler, nullptr to detach
+     * @return true if a wake-up interrupt is available, false if isInactive() must be polled
+     */
+    bool setActivityWakeup(void (*handler)());
+    
 private:
     bool simulationMode;        // Flag indicating if simulation mode is active
+    float sampleRate;           // Applied output data rate (Hz)
+    int accelRangeG;            // Applied accelerometer full-scale (g)
+    int gyroRangeDps;           // Applied gyroscope full-scale (deg/s)
+    int odrIndex;               // Index of sampleRate in the supported ODR table
+    
+    // Gyroscope power policy state
+    GyroPowerPolicy gyroPolicy; // Active gyroscope power policy
+    bool gyroActive;            // true while the gyroscope is powered
+    int gyroHoldWindows;        // Windows left before the gyroscope may power down
+    bool setGyroPowered(bool powered);  // Apply gyroscope ODR / power-down
+    
+    // Hardware gravity removal state
+    bool gravityRemoval;        // true while accelerometer output is high-passed
+    float gravity[3];           // Gravity reference removed by the filter (g)
+    bool gravityPending;        // High-pass output off while the reference is averaged
+    float gravitySum[3];        // Sum of the unfiltered samples averaged so far (g)
+    int gravitySamples;         // Unfiltered samples averaged so far
+    int gravityTarget;          // Samples in GRAVITY_AVERAGE_S at the current rate
+    bool setHighPassOutput(bool enabled);    // Route the accelerometer through the filter or not
+    void averageGravity(SensorData& data);   // Accumulate one unfiltered sample of a refresh
+    
+    bool pedometerEnabled;      // Embedded pedometer running
+    bool activityGating;        // Wake-up / inactivity detection running
     SensorData simulatedData;    // Stored simulated data values
     
+    // Sample source and block buffer
+    static const int SOURCE_BLOCK_SIZE = 32;
+    SampleSource* source;        // Active sample source (not owned)
+    SensorData sourceBlock[SOURCE_BLOCK_SIZE];  // Samples pulled from source
+    int blockPosition;           // Next unread sample in sourceBlock
+    int blockCount;              // Valid samples in sourceBlock
+    bool nextSample(SensorData& data);  // Pop a sample, refilling the block
+    void conditionSample(SensorData& data);  // Timestamp, gyro gating, register model, HPF emulation
+    double sampleClockUs;        // Time of the next sample on the sample clock
+    SampleSource* defaultSource();      // Hardware or generator source
+    
     // Hardware-specific members (only compiled for MBED_OS)
     #ifdef MBED_OS
     void initHardware();         // Initialize I2C and LSM6DSL sensor
     I2C* i2c;                    // I2C interface pointer
     class LSM6DSL* lsm6dsl;      // LSM6DSL sensor driver instance
+    InterruptIn* int1Pin;        // LSM6DSL INT1 (inactivity state level, wake-up edge)
+    HardwareSampleSource* hardwareSource;  // Default source reading the driver
     #endif
     
     // Simulation mode helpers (only compiled for native test mode)
     #ifdef NATIVE_TEST_MODE
-    float generateSimulatedValue(float base, float amplitude, float frequency, int timeMs);
-    struct timeval simStartTime; // Start time for simulation timer
-    bool simTimerStarted;        // Flag indicating if simulation timer is active
-    int getSimTimeMs();          // Get elapsed time in milliseconds for simulation
+    GeneratorSampleSource generatorSource;  // Default simulation signal
+    void simulateHighPass(SensorData& data);  // Emulate the ODR/400 on-chip HPF
+    float simRaw[3];             // Last unfiltered simulated acceleration
+    float simLowPass[3];         // State of the emulated filter (what it removes)
+    bool simHighPassOutput;      // Emulated HP_SLOPE_XL_EN: output filtered
+    LSM6DSLSim registerModel;    // Simulated register file for embedded functions
     #endif
 };
 
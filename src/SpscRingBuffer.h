@@ -0,0 +1,155 @@
+/**
+ * @file SpscRingBuffer.h
+ * @brief Wait-free single-producer/single-consumer ring buffer
+ * 
+ * One context pushes (e.g. an interrupt handler or an acquisition thread),
+ * one other context pops (e.g. the analysis thread). No locks are taken and
+ * neither side ever waits: push() fails when the ring is full and pop()
+ * fails when it is empty.
+ * 
+ * Each index is written by one side only and read by the other. The
+ * producer publishes a slot by storing head after the data (release); the
+ * consumer reads head before the data (acquire), and the reverse for tail.
+ * Indices run freely and wrap at 2^32, so all N slots are usable.
+ * 
+ * On Mbed the indices are accessed with the mbed_atomic.h primitives,
+ * which are safe between interrupt and thread context. Native builds use
+ * std::atomic and keep the indices on separate cache lines.
+ */
+
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include "mbed_compat.h"
+#include <cstdint>
+#ifndef MBED_OS
+#include <atomic>
+#endif
+
+#ifdef MBED_OS
+#define SPSC_INDEX_ALIGN
+#else
+#define SPSC_INDEX_ALIGN alignas(64)  // Avoid false sharing between producer and consumer cores
+#endif
+
+/**
+ * @class SpscRingBuffer
+ * @brief Fixed-capacity lock-free FIFO for one producer and one consumer
+ * 
+ * @tparam T Element type (copied by assignment)
+ * @tparam N Capacity, a power of two
+ */
+template <typename T, uint32_t N>
+class SpscRingBuffer {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRingBuffer capacity must be a power of two");
+    
+public:
+    SpscRingBuffer() : head(0), dropped(0), tail(0) {}
+    
+    /**
+     * @brief Append one element (producer only)
+     * 
+     * Wait-free and interrupt-safe.
+     * 
+     * @param item Element to copy into the ring
+     * @return true if stored, false if the ring was full (counted as dropped)
+     */
+    bool push(const T& item) {
+        uint32_t h = load(head);
+        if (h - loadAcquire(tail) >= N) {
+            store(dropped, load(dropped) + 1);
+            return false;
+        }
+        slots[h & (N - 1)] = item;
+        storeRelease(head, h + 1);
+        return true;
+    }
+    
+    /**
+     * @brief Remove the oldest element (consumer only)
+     * 
+     * @param item Destination for the element
+     * @return true if an element was removed, false if the ring was empty
+     */
+    bool pop(T& item) {
+        uint32_t t = load(tail);
+        if (loadAcquire(head) == t) {
+            return false;
+        }
+        item = slots[t & (N - 1)];
+        storeRelease(tail, t + 1);
+        return true;
+    }
+    
+    /**
+     * @brief Remove up to maxItems elements at once (consumer only)
+     * 
+     * Publishes the new tail once for the whole block, which frees the
+     * slots with a single atomic store.
+     * 
+     * @param items Destination for up to maxItems elements
+     * @param maxItems Capacity of items
+     * @return Number of elements removed
+     */
+    int popBlock(T* items, int maxItems) {
+        if (maxItems <= 0) {
+            return 0;
+        }
+        uint32_t t = load(tail);
+        uint32_t available = loadAcquire(head) - t;
+        uint32_t count = (available < (uint32_t)maxItems) ? available : (uint32_t)maxItems;
+        for (uint32_t i = 0; i < count; i++) {
+            items[i] = slots[(t + i) & (N - 1)];
+        }
+        if (count > 0) {
+            storeRelease(tail, t + count);
+        }
+        return (int)count;
+    }
+    
+    /**
+     * @brief Number of stored elements
+     * 
+     * Exact from either side for its own view; may be stale by the other
+     * side's concurrent operation.
+     * 
+     * @return Elements currently in the ring
+     */
+    uint32_t size() const {
+        return loadAcquire(head) - loadAcquire(tail);
+    }
+    
+    bool empty() const { return size() == 0; }
+    
+    static uint32_t capacity() { return N; }
+    
+    /**
+     * @brief Get the number of push() calls rejected because the ring was full
+     * @return Dropped element count
+     */
+    uint32_t getDropped() const { return load(dropped); }
+    
+private:
+    #ifdef MBED_OS
+    typedef volatile uint32_t Index;
+    
+    static uint32_t load(const Index& index) { return core_util_atomic_load_u32(&index); }
+    static uint32_t loadAcquire(const Index& index) { return core_util_atomic_load_u32(&index); }
+    static void store(Index& index, uint32_t value) { core_util_atomic_store_u32(&index, value); }
+    static void storeRelease(Index& index, uint32_t value) { core_util_atomic_store_u32(&index, value); }
+    #else
+    typedef std::atomic<uint32_t> Index;
+    
+    static uint32_t load(const Index& index) { return index.load(std::memory_order_relaxed); }
+    static uint32_t loadAcquire(const Index& index) { return index.load(std::memory_order_acquire); }
+    static void store(Index& index, uint32_t value) { index.store(value, std::memory_order_relaxed); }
+    static void storeRelease(Index& index, uint32_t value) { index.store(value, std::memory_order_release); }
+    #endif
+    
+    SPSC_INDEX_ALIGN Index head;     // Next slot to write; written by the producer only
+    Index dropped;                   // Rejected pushes; written by the producer only
+    SPSC_INDEX_ALIGN Index tail;     // Next slot to read; written by the consumer only
+    SPSC_INDEX_ALIGN T slots[N];     // Element storage
+};
+
+#endif
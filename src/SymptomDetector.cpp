@@ -12,13 +12,62 @@
 #include "FFTProcessor.h"
 #include <cmath>
 #include <algorithm>
+#include <cstring>
+
+// Feature band edges (Hz), indexed like SpectralFeatures::bandPower
+static const float FEATURE_BAND_EDGES[FEATURE_BANDS][2] = {
+    {0.0f, 2.0f}, {3.0f, 5.0f}, {5.0f, 7.0f}, {7.0f, 12.0f}
+};
 
 /**
  * @brief Constructor - Initialize symptom detector
  * 
  * Initializes gait analysis variables to zero.
  */
-SymptomDetector::SymptomDetector() : lastStepTime(0), stepCount(0), cadence(0) {
+SymptomDetector::SymptomDetector() : sampleRate(52.0f), gravityRemovedInput(false),
+    gravityX(0), gravityY(0), gravityZ(0), cadenceSource(CADENCE_SOFTWARE),
+    stepCounter(0), lastStepCounter(0), stepCounterFresh(false), stepCounterPrimed(false),
+    lastStepTime(0), stepCount(0), cadence(0), stage(STAGE_IDLE), analysisSize(0),
+    accelMagnitude(nullptr), bufferCapacity(0), tremorBand(0), backgroundBand(0),
+    dyskinesiaBand(0), peakMagnitude(0), stagedResults() {
+    memset(&stagedFeatures, 0, sizeof(stagedFeatures));
+    for (int axis = 0; axis < 3; axis++) {
+        input[axis] = nullptr;
+        inputGyro[axis] = nullptr;
+        processed[axis] = nullptr;
+    }
+}
+
+/**
+ * @brief Destructor - Free analysis buffers
+ */
+SymptomDetector::~SymptomDetector() {
+    for (int axis = 0; axis < 3; axis++) {
+        delete[] processed[axis];
+    }
+    delete[] accelMagnitude;
+}
+
+/**
+ * @brief Make sure the analysis buffers hold size samples
+ * 
+ * Buffers only grow, so steady-state windows do not allocate.
+ * 
+ * @param size Required samples per buffer
+ * @return true if the buffers are large enough
+ */
+bool SymptomDetector::reserveBuffers(int size) {
+    if (size <= bufferCapacity) {
+        return true;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        delete[] processed[axis];
+        processed[axis] = new float[size];
+    }
+    delete[] accelMagnitude;
+    accelMagnitude = new float[size];
+    bufferCapacity = size;
+    return true;
 }
 
 /**
@@ -30,6 +79,55 @@ void SymptomDetector::begin() {
     lastStepTime = 0;
     stepCount = 0;
     cadence = 0;
+    stepCounterFresh = false;
+    stepCounterPrimed = false;
+}
+
+/**
+ * @brief Set the sampling frequency of analyzed windows
+ * 
+ * @param hz Sampling frequency in Hz; non-positive values are ignored
+ */
+void SymptomDetector::setSampleRate(float hz) {
+    if (hz > 0.0f) {
+        sampleRate = hz;
+    }
+}
+
+/**
+ * @brief Set the gravity vector removed by the hardware high-pass filter
+ * 
+ * @param gx, gy, gz Gravity components in g
+ */
+void SymptomDetector::setGravityReference(float gx, float gy, float gz) {
+    gravityX = gx;
+    gravityY = gy;
+    gravityZ = gz;
+}
+
+/**
+ * @brief Select how cadence is estimated
+ * 
+ * @param source Cadence source
+ */
+void SymptomDetector::setCadenceSource(CadenceSource source) {
+    cadenceSource = source;
+    stepCounterFresh = false;
+    stepCounterPrimed = false;
+}
+
+/**
+ * @brief Provide the hardware step counter value for the next analyze()
+ * 
+ * @param count 16-bit step counter read from the LSM6DSL
+ */
+void SymptomDetector::setStepCount(uint16_t count) {
+    stepCounter = count;
+    stepCounterFresh = true;
+}
+
+void SymptomDetector::resetStepBaseline() {
+    stepCounterPrimed = false;
 }
 
 /**
@@ -38,90 +136,163 @@ void SymptomDetector::begin() {
  * This is the core function that processes a 3-second data window and detects
  * all three symptoms. The analysis pipeline:
  * 
- * 1. Data Preprocessing: Remove DC component (mean) from accelerometer data
+ * 1. Data Preprocessing: Remove DC component (mean) from accelerometer data,
+ *    unless the sensor's high-pass filter already did (setGravityRemovedInput)
  * 2. Magnitude Calculation: Compute acceleration magnitude for gait analysis
  * 3. Tremor Detection: FFT analysis in 3-5Hz range with background noise comparison
  * 4. Dyskinesia Detection: FFT analysis in 5-7Hz range with background noise comparison
  * 5. Gait Analysis: Detect steps and calculate cadence
  * 6. FOG Detection: Analyze gait pattern and sudden movement stop
  * 
+ * Runs the incremental analysis steps back to back.
+ * 
  * @param accelX, accelY, accelZ Accelerometer data arrays (g)
- * @param gyroX, gyroY, gyroZ Gyroscope data arrays (deg/s)
+ * @param gyroX, gyroY, gyroZ Gyroscope data arrays (deg/s), nullptr if gyroscope off
  * @param windowSize Number of samples (156 for 3 seconds at 52Hz)
  * @return SymptomResults structure with detection results and intensities
  */
 SymptomResults SymptomDetector::analyze(float* accelX, float* accelY, float* accelZ,
                                         float* gyroX, float* gyroY, float* gyroZ,
                                         int windowSize) {
-    // Initialize results structure (all false, intensities 0.0)
-    SymptomResults results = {false, 0.0f, false, 0.0f, false, 0.0f};
-    
-    // Step 1: Data Preprocessing - Remove DC component (mean removal)
-    // This removes gravity and sensor offset, leaving only AC signal for FFT analysis
-    float* processedX = new float[windowSize];
-    float* processedY = new float[windowSize];
-    float* processedZ = new float[windowSize];
-    
-    // Calculate mean (DC component) for each axis
-    float meanX = 0.0f, meanY = 0.0f, meanZ = 0.0f;
-    for (int i = 0; i < windowSize; i++) {
-        meanX += accelX[i];
-        meanY += accelY[i];
-        meanZ += accelZ[i];
+    beginAnalysis(accelX, accelY, accelZ, gyroX, gyroY, gyroZ, windowSize);
+    while (!stepAnalysis()) {
     }
-    meanX /= windowSize;
-    meanY /= windowSize;
-    meanZ /= windowSize;
+    return stagedResults;
+}
+
+/**
+ * @brief Start an incremental analysis of a window
+ * 
+ * @param accelX, accelY, accelZ Accelerometer data arrays (g)
+ * @param gyroX, gyroY, gyroZ Gyroscope data arrays (deg/s), nullptr if gyroscope off
+ * @param windowSize Number of samples
+ */
+void SymptomDetector::beginAnalysis(float* accelX, float* accelY, float* accelZ,
+                                    float* gyroX, float* gyroY, float* gyroZ,
+                                    int windowSize) {
+    input[0] = accelX;
+    input[1] = accelY;
+    input[2] = accelZ;
+    inputGyro[0] = gyroX;
+    inputGyro[1] = gyroY;
+    inputGyro[2] = gyroZ;
+    analysisSize = windowSize;
+    tremorBand = 0.0f;
+    backgroundBand = 0.0f;
+    dyskinesiaBand = 0.0f;
+    peakMagnitude = 0.0f;
     
-    // Subtract mean to remove DC component
-    for (int i = 0; i < windowSize; i++) {
-        processedX[i] = accelX[i] - meanX;
-        processedY[i] = accelY[i] - meanY;
-        processedZ[i] = accelZ[i] - meanZ;
+    // Initialize results structure (all false, intensities 0.0)
+    SymptomResults empty = {false, 0.0f, false, 0.0f, false, 0.0f};
+    stagedResults = empty;
+    memset(&stagedFeatures, 0, sizeof(stagedFeatures));
+    stage = (windowSize > 0 && reserveBuffers(windowSize)) ? STAGE_PREPROCESS : STAGE_IDLE;
+}
+
+const char* SymptomDetector::getAnalysisStepName(int step) {
+    static const char* const names[ANALYSIS_STEPS] = {
+        "preprocess", "magnitude", "spectrum x", "spectrum y", "spectrum z", "gait", "fog"
+    };
+    return (step >= 0 && step < ANALYSIS_STEPS) ? names[step] : "?";
+}
+
+/**
+ * @brief Run the next step of the incremental analysis
+ * 
+ * Each step does O(n) work or a single FFT, which bounds the time spent
+ * per call.
+ * 
+ * @return true once the analysis is complete (or none is in progress)
+ */
+bool SymptomDetector::stepAnalysis() {
+    int size = analysisSize;
+    switch (stage) {
+    case STAGE_IDLE:
+        return true;
+        
+    case STAGE_PREPROCESS:
+        // Remove DC component (mean removal): this removes gravity and sensor
+        // offset, leaving only AC signal for FFT analysis. Skipped when the
+        // sensor's on-chip high-pass filter already removed it.
+        for (int axis = 0; axis < 3; axis++) {
+            if (gravityRemovedInput) {
+                continue;
+            }
+            float mean = 0.0f;
+            for (int i = 0; i < size; i++) {
+                mean += input[axis][i];
+            }
+            mean /= size;
+            for (int i = 0; i < size; i++) {
+                processed[axis][i] = input[axis][i] - mean;
+            }
+        }
+        stage = STAGE_MAGNITUDE;
+        return false;
+        
+    case STAGE_MAGNITUDE: {
+        // Magnitude = sqrt(X² + Y² + Z²) - represents overall movement intensity
+        // High-passed input gets the gravity reference added back so the
+        // magnitude path still sees unfiltered acceleration
+        float gx = gravityRemovedInput ? gravityX : 0.0f;
+        float gy = gravityRemovedInput ? gravityY : 0.0f;
+        float gz = gravityRemovedInput ? gravityZ : 0.0f;
+        for (int i = 0; i < size; i++) {
+            float x = input[0][i] + gx;
+            float y = input[1][i] + gy;
+            float z = input[2][i] + gz;
+            accelMagnitude[i] = sqrt(x*x + y*y + z*z);
+        }
+        stage = STAGE_SPECTRUM_X;
+        return false;
     }
-    
-    // Step 2: Calculate acceleration magnitude for gait analysis
-    // Magnitude = sqrt(X² + Y² + Z²) - represents overall movement intensity
-    float* accelMagnitude = new float[windowSize];
-    for (int i = 0; i < windowSize; i++) {
-        accelMagnitude[i] = sqrt(accelX[i]*accelX[i] + 
-                                accelY[i]*accelY[i] + 
-                                accelZ[i]*accelZ[i]);
+        
+    case STAGE_SPECTRUM_X:
+    case STAGE_SPECTRUM_Y:
+    case STAGE_SPECTRUM_Z: {
+        // One FFT per axis serves all bands; the window intensity of a band
+        // is the maximum over the axes, so a symptom in any direction counts
+        int axis = stage - STAGE_SPECTRUM_X;
+        float* data = gravityRemovedInput ? input[axis] : processed[axis];
+        FFTProcessor fft;
+        fft.process(data, size, sampleRate);
+        tremorBand = std::max(tremorBand, bandIntensity(fft, size, 3.0f, 5.0f));
+        backgroundBand = std::max(backgroundBand, bandIntensity(fft, size, 0.0f, 2.0f));
+        dyskinesiaBand = std::max(dyskinesiaBand, bandIntensity(fft, size, 5.0f, 7.0f));
+        accumulateFeatures(fft, size, axis);
+        if (stage != STAGE_SPECTRUM_Z) {
+            stage = (AnalysisStage)(stage + 1);
+            return false;
+        }
+            
+        // Tremor (3-5Hz) and dyskinesia (5-7Hz) detection criteria:
+        // intensity > 0.25 AND > 1.2x background noise (0-2Hz)
+        stagedResults.tremorIntensity = tremorBand;
+        stagedResults.tremorDetected = (tremorBand > 0.25f) &&
+                                       (tremorBand > backgroundBand * 1.2f);
+        stagedResults.dyskinesiaIntensity = dyskinesiaBand;
+        stagedResults.dyskinesiaDetected = (dyskinesiaBand > 0.25f) &&
+                                           (dyskinesiaBand > backgroundBand * 1.2f);
+        stage = STAGE_GAIT;
+        return false;
     }
-    
-    // Step 3: Tremor Detection (3-5Hz frequency range)
-    // Calculate energy in tremor frequency band
-    results.tremorIntensity = calculateIntensity(processedX, processedY, processedZ, windowSize, 3.0f, 5.0f);
-    // Calculate background noise (0-2Hz) for comparison
-    float backgroundNoise = calculateIntensity(processedX, processedY, processedZ, windowSize, 0.0f, 2.0f);
-    // Detection criteria: intensity > 0.25 AND > 1.2x background noise
-    results.tremorDetected = (results.tremorIntensity > 0.25f) && 
-                            (results.tremorIntensity > backgroundNoise * 1.2f);
-    
-    // Step 4: Dyskinesia Detection (5-7Hz frequency range)
-    // Calculate energy in dyskinesia frequency band
-    results.dyskinesiaIntensity = calculateIntensity(processedX, processedY, processedZ, windowSize, 5.0f, 7.0f);
-    // Detection criteria: intensity > 0.25 AND > 1.2x background noise
-    results.dyskinesiaDetected = (results.dyskinesiaIntensity > 0.25f) && 
-                                (results.dyskinesiaIntensity > backgroundNoise * 1.2f);
-    
-    // Step 5: Gait Analysis
-    // Detect steps and calculate cadence (steps per second)
-    analyzeGait(accelX, accelY, accelZ, windowSize);
-    
-    // Step 6: Freezing of Gait Detection
-    // Analyze gait pattern and detect sudden movement stop
-    results.fogDetected = detectFOG(accelX, accelY, accelZ, 
-                                   gyroX, gyroY, gyroZ, windowSize);
-    results.fogIntensity = calculateFOGIntensity(accelMagnitude, windowSize);
-    
-    // Clean up allocated memory
-    delete[] processedX;
-    delete[] processedY;
-    delete[] processedZ;
-    delete[] accelMagnitude;
-    
-    return results;
+        
+    case STAGE_GAIT:
+        // Detect steps and calculate cadence (steps per second)
+        analyzeGait(accelMagnitude, size);
+        stagedFeatures.cadence = cadence;
+        stage = STAGE_FOG;
+        return false;
+        
+    case STAGE_FOG:
+        // Analyze gait pattern and detect sudden movement stop
+        stagedResults.fogDetected = detectFOG(accelMagnitude, inputGyro[0], inputGyro[1],
+                                              inputGyro[2], size);
+        stagedResults.fogIntensity = calculateFOGIntensity(accelMagnitude, size);
+        stage = STAGE_IDLE;
+        return true;
+    }
+    return true;
 }
 
 /**
@@ -169,12 +340,18 @@ bool SymptomDetector::detectDyskinesia(float* accelX, float* accelY, float* acce
  * - Middle third: Transition phase
  * - Last third: Potential freezing phase (low variance expected)
  * 
- * @param accelX, accelY, accelZ Accelerometer data arrays
- * @param gyroX, gyroY, gyroZ Gyroscope data arrays
+ * Without gyroscope data (powered down by GYRO_ON_WALKING because the
+ * previous windows showed no walking) nothing confirms that the body
+ * stopped turning, so the accelerometer criteria are tightened instead:
+ * the last third must be twice as still and fall to a quarter of the
+ * first third.
+ * 
+ * @param accelMagnitude Acceleration magnitude array (unfiltered, includes gravity)
+ * @param gyroX, gyroY, gyroZ Gyroscope data arrays (nullptr if gyroscope off)
  * @param size Number of samples
  * @return true if FOG detected, false otherwise
  */
-bool SymptomDetector::detectFOG(float* accelX, float* accelY, float* accelZ,
+bool SymptomDetector::detectFOG(float* accelMagnitude,
                                 float* gyroX, float* gyroY, float* gyroZ, int size) {
     // FOG Detection Logic:
     // 1. Previous gait activity (cadence > 0.3 steps/sec)
@@ -186,30 +363,32 @@ bool SymptomDetector::detectFOG(float* accelX, float* accelY, float* accelZ,
     
     // Calculate variance of first third (walking phase)
     // High variance indicates active movement
-    float* accelXFirst = accelX;
-    float* accelYFirst = accelY;
-    float* accelZFirst = accelZ;
-    float accelVarianceFirst = calculateVariance(accelXFirst, accelYFirst, accelZFirst, thirdSize);
+    float accelVarianceFirst = calculateVariance(accelMagnitude, thirdSize);
     
     // Calculate variance of last third (potential freezing phase)
     // Low variance indicates minimal movement (freezing)
-    float* accelXLast = accelX + 2 * thirdSize;
-    float* accelYLast = accelY + 2 * thirdSize;
-    float* accelZLast = accelZ + 2 * thirdSize;
-    float* gyroXLast = gyroX + 2 * thirdSize;
-    float* gyroYLast = gyroY + 2 * thirdSize;
-    float* gyroZLast = gyroZ + 2 * thirdSize;
-    
-    float accelVarianceLast = calculateVariance(accelXLast, accelYLast, accelZLast, thirdSize);
-    float gyroVarianceLast = calculateVariance(gyroXLast, gyroYLast, gyroZLast, thirdSize);
+    float accelVarianceLast = calculateVariance(accelMagnitude + 2 * thirdSize, thirdSize);
+    
+    // Gyroscope may be powered down for this window (no walking detected);
+    // in that case the freeze check relies on stricter accelerometer
+    // thresholds alone
+    bool withGyro = (gyroX != nullptr && gyroY != nullptr && gyroZ != nullptr);
+    float gyroVarianceLast = 0.0f;
+    if (withGyro) {
+        gyroVarianceLast = calculateVariance(gyroX + 2 * thirdSize,
+                                             gyroY + 2 * thirdSize,
+                                             gyroZ + 2 * thirdSize, thirdSize);
+    }
+    float frozenVariance = withGyro ? 0.01f : 0.005f;
+    float stopRatio = withGyro ? 0.5f : 0.25f;
     
     // Three conditions must all be true for FOG detection:
     // 1. Was walking: Cadence > 0.3 steps/second (lowered threshold)
-    // 2. Is frozen: Very low variance in last third (< 0.01)
-    // 3. Sudden stop: Last third variance < 50% of first third variance (relaxed requirement)
+    // 2. Is frozen: Very low variance in last third (< 0.01, < 0.005 without gyroscope)
+    // 3. Sudden stop: Last third variance < 50% of first third variance (25% without gyroscope)
     bool wasWalking = (cadence > 0.3f);
-    bool isFrozen = (accelVarianceLast < 0.01f && gyroVarianceLast < 0.01f);
-    bool suddenStop = (accelVarianceLast < accelVarianceFirst * 0.5f);
+    bool isFrozen = (accelVarianceLast < frozenVariance && gyroVarianceLast < 0.01f);
+    bool suddenStop = (accelVarianceLast < accelVarianceFirst * stopRatio);
     
     return wasWalking && isFrozen && suddenStop;
 }
@@ -229,7 +408,23 @@ bool SymptomDetector::detectFOG(float* accelX, float* accelY, float* accelZ,
 float SymptomDetector::calculateIntensity(float* data, int size, float minFreq, float maxFreq) {
     // Use FFT to calculate energy in specified frequency range (single axis)
     FFTProcessor fft;
-    fft.process(data, size, 52.0f); // 52Hz sampling rate
+    fft.process(data, size, sampleRate);
+    return bandIntensity(fft, size, minFreq, maxFreq);
+}
+
+/**
+ * @brief Calculate signal intensity in a frequency range of a computed spectrum
+ * 
+ * @param fft Processor holding the spectrum of size samples
+ * @param size Number of samples transformed
+ * @param minFreq Minimum frequency of interest (Hz)
+ * @param maxFreq Maximum frequency of interest (Hz)
+ * @return Normalized intensity value (0.0 - 1.0)
+ */
+float SymptomDetector::bandIntensity(FFTProcessor& fft, int size, float minFreq, float maxFreq) {
+    // FFT magnitudes grow with the number of samples; rescale to the
+    // 156-sample reference window so thresholds hold at other sample rates
+    float windowScale = (float)REFERENCE_WINDOW_SIZE / size;
     
     float maxEnergy = 0.0f;    // Peak energy in frequency range
     float totalEnergy = 0.0f;  // Total energy in frequency range
@@ -237,9 +432,9 @@ float SymptomDetector::calculateIntensity(float* data, int size, float minFreq,
     
     // Iterate through FFT bins and accumulate energy in target frequency range
     for (int i = 0; i < size / 2; i++) {
-        float freq = fft.getFrequency(i, 52.0f, size);
+        float freq = fft.getFrequency(i, sampleRate, size);
         if (freq >= minFreq && freq <= maxFreq) {
-            float magnitude = fft.getMagnitude(i);
+            float magnitude = fft.getMagnitude(i) * windowScale;
             totalEnergy += magnitude;
             maxEnergy = std::max(maxEnergy, magnitude);
             count++;
@@ -258,6 +453,45 @@ float SymptomDetector::calculateIntensity(float* data, int size, float minFreq,
     return std::min(1.0f, combinedEnergy / 1.2f);
 }
 
+/**
+ * @brief Add one axis' spectrum to the window's features
+ * 
+ * A single pass over the bins: each bin's mean-square contribution goes
+ * to the bands containing it, and the largest non-DC bin over all axes
+ * gives the peak frequency. The samples are zero-padded to M bins, so a
+ * bin lies at k * rate / M and contributes 2|X|^2 / (M * N) (half that
+ * for DC), which sums to the signal's mean square over the N samples.
+ * 
+ * @param fft Processor holding the spectrum of size samples
+ * @param size Number of samples transformed
+ * @param axis Accelerometer axis (0 = X, 1 = Y, 2 = Z)
+ */
+void SymptomDetector::accumulateFeatures(FFTProcessor& fft, int size, int axis) {
+    float* bands = stagedFeatures.bandPower[axis];
+    int transformSize = fft.getTransformSize();
+    float binHz = sampleRate / transformSize;
+    float scale = 2.0f / ((float)transformSize * size);
+    float highestEdge = FEATURE_BAND_EDGES[FEATURE_BANDS - 1][1];
+    int bins = std::min(size, transformSize / 2);    // Bins kept by the processor
+    for (int i = 0; i < bins; i++) {
+        float freq = i * binHz;
+        float magnitude = fft.getMagnitude(i);
+        if (i > 0 && magnitude > peakMagnitude) {
+            peakMagnitude = magnitude;
+            stagedFeatures.peakFrequency = freq;
+        }
+        if (freq > highestEdge) {
+            continue;
+        }
+        float power = magnitude * magnitude * (i == 0 ? scale * 0.5f : scale);
+        for (int band = 0; band < FEATURE_BANDS; band++) {
+            if (freq >= FEATURE_BAND_EDGES[band][0] && freq <= FEATURE_BAND_EDGES[band][1]) {
+                bands[band] += power;
+            }
+        }
+    }
+}
+
 /**
  * @brief Calculate signal intensity in a specific frequency range (three axes)
  * 
@@ -327,6 +561,7 @@ float SymptomDetector::calculateFOGIntensity(float* accelMagnitude, int size) {
         varianceHalf += diff * diff;
     }
     varianceHalf /= (size - size / 2);
+    stagedFeatures.fogVariance = varianceHalf;  // Reported as a feature
     
     // Use latter half variance for stricter detection
     // Invert and normalize: variance 0.005 -> intensity 1.0, variance > 0.005 -> intensity 0.0
@@ -336,30 +571,34 @@ float SymptomDetector::calculateFOGIntensity(float* accelMagnitude, int size) {
 /**
  * @brief Analyze gait pattern and calculate cadence
  * 
- * Detects steps in the acceleration magnitude signal and calculates
- * cadence (steps per second). This is used for FOG detection to determine
- * if there was previous walking activity.
+ * Detects steps in the acceleration magnitude signal (or takes them from the
+ * hardware step counter) and calculates cadence (steps per second). This is
+ * used for FOG detection to determine if there was previous walking activity.
  * 
- * @param accelX, accelY, accelZ Accelerometer data arrays
+ * @param accelMagnitude Acceleration magnitude array (computed once in analyze())
  * @param size Number of samples
  */
-void SymptomDetector::analyzeGait(float* accelX, float* accelY, float* accelZ, int size) {
-    // Calculate acceleration magnitude (overall movement intensity)
-    float* accelMagnitude = new float[size];
-    for (int i = 0; i < size; i++) {
-        accelMagnitude[i] = sqrt(accelX[i]*accelX[i] + 
-                                accelY[i]*accelY[i] + 
-                                accelZ[i]*accelZ[i]);
+void SymptomDetector::analyzeGait(float* accelMagnitude, int size) {
+    int steps;
+    if (cadenceSource == CADENCE_STEP_COUNTER && stepCounterFresh && stepCounterPrimed) {
+        // Hardware pedometer: steps = counter delta since the previous window
+        // (unsigned subtraction handles 16-bit wraparound)
+        steps = (uint16_t)(stepCounter - lastStepCounter);
+    } else {
+        // Detect steps using peak detection algorithm
+        steps = detectSteps(accelMagnitude, size);
     }
-    
-    // Detect steps using peak detection algorithm
-    int steps = detectSteps(accelMagnitude, size);
+    if (cadenceSource == CADENCE_STEP_COUNTER && stepCounterFresh) {
+        // A window without a baseline only establishes it
+        lastStepCounter = stepCounter;
+        stepCounterPrimed = true;
+        stepCounterFresh = false;
+    }
+    stepCount = steps;
     
     // Calculate cadence (steps per second)
-    // Window is 3 seconds, so cadence = steps / 3.0
-    cadence = steps / 3.0f;
-    
-    delete[] accelMagnitude;
+    // Window duration follows the sampling rate (3 seconds at 52Hz/156 samples)
+    cadence = steps / (size / sampleRate);
 }
 
 /**
@@ -414,6 +653,28 @@ int SymptomDetector::detectSteps(float* accelMagnitude, int size) {
     return steps;
 }
 
+/**
+ * @brief Calculate variance of a single signal
+ * 
+ * @param data Input data array (e.g. acceleration magnitude)
+ * @param size Number of samples
+ * @return Variance value (higher = more variation = more movement)
+ */
+float SymptomDetector::calculateVariance(float* data, int size) {
+    float mean = 0.0f;
+    for (int i = 0; i < size; i++) {
+        mean += data[i];
+    }
+    mean /= size;
+    
+    float variance = 0.0f;
+    for (int i = 0; i < size; i++) {
+        float diff = data[i] - mean;
+        variance += diff * diff;
+    }
+    return variance / size;
+}
+
 /**
  * @brief Calculate variance of 3-axis sensor data
  * 
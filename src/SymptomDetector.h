@@ -9,6 +9,9 @@
  * 
  * The detection is based on frequency domain analysis (FFT) and statistical
  * analysis of accelerometer and gyroscope data.
+ * 
+ * The same spectra also yield a per-window feature vector (band powers per
+ * axis, peak frequency, cadence, FOG variance) for models on the phone.
  */
 
 #ifndef SYMPTOM_DETECTOR_H
@@ -16,6 +19,8 @@
 
 #include "mbed_compat.h"
 
+class FFTProcessor;
+
 /**
  * @struct SymptomResults
  * @brief Structure containing detection results for all three symptoms
@@ -35,6 +40,34 @@ struct SymptomResults {
     float fogIntensity;           // FOG intensity (0.0 - 1.0)
 };
 
+const int FEATURE_AXES = 3;     // Accelerometer axes X, Y, Z
+const int FEATURE_BANDS = 4;    // 0-2, 3-5, 5-7 and 7-12 Hz
+
+/**
+ * @struct SpectralFeatures
+ * @brief Per-window features for phone-side models
+ * 
+ * Taken from the spectra the detection computes anyway, so they cost no
+ * extra transform. Band powers are the mean-square acceleration of the
+ * band (one-sided spectrum, bins on a band edge count in both bands), so
+ * they do not depend on the window length or sample rate.
+ */
+struct SpectralFeatures {
+    float bandPower[FEATURE_AXES][FEATURE_BANDS];  // Band power per axis (g^2): 0-2, 3-5, 5-7, 7-12 Hz
+    float peakFrequency;    // Strongest spectral component over the axes, DC excluded (Hz)
+    float cadence;          // Steps per second
+    float fogVariance;      // Acceleration magnitude variance, latter half of the window (g^2)
+};
+
+/**
+ * @enum CadenceSource
+ * @brief Origin of the step count used for cadence estimation
+ */
+enum CadenceSource {
+    CADENCE_SOFTWARE,       // Peak detection on the acceleration magnitude
+    CADENCE_STEP_COUNTER    // LSM6DSL embedded pedometer (counter delta per window)
+};
+
 /**
  * @class SymptomDetector
  * @brief Main class for symptom detection algorithms
@@ -45,6 +78,7 @@ struct SymptomResults {
 class SymptomDetector {
 public:
     SymptomDetector();
+    ~SymptomDetector();
     
     /**
      * @brief Initialize symptom detector
@@ -64,7 +98,9 @@ public:
      * 5. Analyzes gait and detects FOG
      * 
      * @param accelX, accelY, accelZ Accelerometer data arrays (g)
-     * @param gyroX, gyroY, gyroZ Gyroscope data arrays (deg/s)
+     * @param gyroX, gyroY, gyroZ Gyroscope data arrays (deg/s), or nullptr when
+     *        the gyroscope was powered down for the window (FOG then relies on
+     *        accelerometer variance alone)
      * @param windowSize Number of samples (typically 156 for 3 seconds at 52Hz)
      * @return SymptomResults structure with detection results
      */
@@ -72,27 +108,199 @@ public:
                           float* gyroX, float* gyroY, float* gyroZ,
                           int windowSize);
     
+    /**
+     * @brief Start an incremental analysis of a window
+     * 
+     * Produces the same results as analyze(), but the work is split into
+     * resumable steps of at most one FFT each, so it can be interleaved
+     * with sampling. The arrays must stay unchanged until stepAnalysis()
+     * returns true. Starting a new analysis abandons one in progress.
+     * 
+     * @param accelX, accelY, accelZ Accelerometer data arrays (g)
+     * @param gyroX, gyroY, gyroZ Gyroscope data arrays (deg/s), or nullptr
+     * @param windowSize Number of samples
+     */
+    void beginAnalysis(float* accelX, float* accelY, float* accelZ,
+                       float* gyroX, float* gyroY, float* gyroZ,
+                       int windowSize);
+    
+    /**
+     * @brief Run the next step of the analysis started by beginAnalysis()
+     * 
+     * Steps: mean removal, magnitude, one spectrum per accelerometer axis
+     * (all frequency bands from a single FFT), gait, FOG.
+     * 
+     * @return true once the analysis is complete (or none is in progress)
+     */
+    bool stepAnalysis();
+    
+    /**
+     * @brief Check whether an incremental analysis is in progress
+     * @return true between beginAnalysis() and the final stepAnalysis()
+     */
+    bool isAnalysisPending() const { return stage != STAGE_IDLE; }
+    
+    static const int ANALYSIS_STEPS = 7;  // stepAnalysis() calls per window
+    
+    /**
+     * @brief Get the step the next stepAnalysis() call will run
+     * @return Step index 0 ... ANALYSIS_STEPS-1, or -1 if no analysis is pending
+     */
+    int getAnalysisStep() const { return (int)stage - 1; }
+    
+    /**
+     * @brief Get a short name for an analysis step (for profiling output)
+     * @param step Step index from getAnalysisStep()
+     * @return Step name, "?" for an invalid index
+     */
+    static const char* getAnalysisStepName(int step);
+    
+    /**
+     * @brief Get the results of the last completed analysis
+     * @return SymptomResults of the last analyze() or incremental analysis
+     */
+    const SymptomResults& getAnalysisResults() const { return stagedResults; }
+    
+    /**
+     * @brief Get the spectral features of the last completed analysis
+     * @return SpectralFeatures of the last analyze() or incremental analysis
+     */
+    const SpectralFeatures& getFeatures() const { return stagedFeatures; }
+    
+    /**
+     * @brief Set the sampling frequency of the data passed to analyze()
+     * 
+     * Must track SensorManager::getSampleRate() whenever the sensor ODR is
+     * changed, otherwise FFT bin frequencies and cadence are mis-scaled.
+     * 
+     * @param hz Sampling frequency in Hz (default 52Hz)
+     */
+    void setSampleRate(float hz);
+    
+    float getSampleRate() const { return sampleRate; }
+    
+    /**
+     * @brief Get cadence computed by the most recent analyze() call
+     * @return Steps per second
+     */
+    float getCadence() const { return cadence; }
+    
+    /**
+     * @brief Declare that accelerometer input is already gravity-removed
+     * 
+     * When the LSM6DSL on-chip high-pass filter is active, analyze() skips
+     * software mean removal and feeds the accelerometer arrays straight to
+     * the FFT. The magnitude path (gait, FOG) adds the gravity reference
+     * back so it keeps working on unfiltered acceleration.
+     * 
+     * @param enabled true if analyze() receives high-pass filtered acceleration
+     */
+    void setGravityRemovedInput(bool enabled) { gravityRemovedInput = enabled; }
+    
+    /**
+     * @brief Set the gravity vector removed by the hardware filter
+     * @param gx, gy, gz Gravity components in g (see SensorManager::getGravity)
+     */
+    void setGravityReference(float gx, float gy, float gz);
+    
+    /**
+     * @brief Select how cadence is estimated
+     * 
+     * With CADENCE_STEP_COUNTER, analyze() uses the delta between successive
+     * setStepCount() values instead of software peak detection. Windows
+     * without a fresh counter value fall back to software detection, as
+     * does the window whose value only sets the baseline.
+     * 
+     * @param source Cadence source
+     */
+    void setCadenceSource(CadenceSource source);
+    
+    /**
+     * @brief Provide the hardware step counter value for the next analyze()
+     * @param count 16-bit step counter (wraparound handled)
+     */
+    void setStepCount(uint16_t count);
+    
+    /**
+     * @brief Forget the step counter baseline
+     * 
+     * Call when windows were dropped or discarded since the previous
+     * setStepCount() value, so the next delta does not span their steps.
+     * The next value sets a new baseline.
+     */
+    void resetStepBaseline();
+    
 private:
+    static const int REFERENCE_WINDOW_SIZE = 156;  // Window size intensity thresholds were tuned for
+    
+    /**
+     * @enum AnalysisStage
+     * @brief Next step of an incremental analysis
+     */
+    enum AnalysisStage {
+        STAGE_IDLE,         // No analysis in progress
+        STAGE_PREPROCESS,   // Remove the DC component
+        STAGE_MAGNITUDE,    // Acceleration magnitude for gait/FOG
+        STAGE_SPECTRUM_X,   // FFT of X and its band intensities
+        STAGE_SPECTRUM_Y,   // FFT of Y and its band intensities
+        STAGE_SPECTRUM_Z,   // FFT of Z, band intensities and decisions
+        STAGE_GAIT,         // Step detection and cadence
+        STAGE_FOG           // FOG detection and intensity
+    };
+    
+    float sampleRate;      // Sampling frequency of analyzed windows (Hz)
+    
+    // Hardware high-pass filter support
+    bool gravityRemovedInput;              // Input already high-pass filtered
+    float gravityX, gravityY, gravityZ;    // Gravity reference added back for magnitude
+    
+    // Hardware step counter (embedded pedometer) state
+    CadenceSource cadenceSource;  // Active cadence source
+    uint16_t stepCounter;         // Latest hardware step counter value
+    uint16_t lastStepCounter;     // Counter value at the previous window
+    bool stepCounterFresh;        // stepCounter not yet consumed by analyze()
+    bool stepCounterPrimed;       // lastStepCounter holds a valid baseline
+    
     // Gait analysis variables
     float lastStepTime;    // Timestamp of last detected step
     int stepCount;         // Number of steps detected in current window
     float cadence;         // Steps per second (gait cadence)
     
+    // Incremental analysis state
+    AnalysisStage stage;           // Next step to run
+    float* input[3];               // Accelerometer arrays of the window
+    float* inputGyro[3];           // Gyroscope arrays of the window (may be nullptr)
+    int analysisSize;              // Samples in the window
+    float* processed[3];           // DC-removed accelerometer axes (or the input)
+    float* accelMagnitude;         // Acceleration magnitude including gravity
+    int bufferCapacity;            // Allocated entries per buffer
+    float tremorBand;              // Max 3-5Hz intensity over the axes so far
+    float backgroundBand;          // Max 0-2Hz intensity over the axes so far
+    float dyskinesiaBand;          // Max 5-7Hz intensity over the axes so far
+    float peakMagnitude;           // Largest non-DC bin magnitude over the axes so far
+    SymptomResults stagedResults;  // Results being assembled / last results
+    SpectralFeatures stagedFeatures;  // Features being assembled / last features
+    
     // Detection methods for individual symptoms
     bool detectTremor(float* accelX, float* accelY, float* accelZ, int size);
     bool detectDyskinesia(float* accelX, float* accelY, float* accelZ, int size);
-    bool detectFOG(float* accelX, float* accelY, float* accelZ, 
+    bool detectFOG(float* accelMagnitude,
                   float* gyroX, float* gyroY, float* gyroZ, int size);
     
     // Frequency analysis and intensity calculation
     float calculateIntensity(float* data, int size, float minFreq, float maxFreq);
+    float bandIntensity(FFTProcessor& fft, int size, float minFreq, float maxFreq);
+    void accumulateFeatures(FFTProcessor& fft, int size, int axis);
     float calculateIntensity(float* dataX, float* dataY, float* dataZ, int size, float minFreq, float maxFreq);
     float calculateFOGIntensity(float* accelMagnitude, int size);
+    float calculateVariance(float* data, int size);
     float calculateVariance(float* x, float* y, float* z, int size);
     
     // Gait analysis methods
-    void analyzeGait(float* accelX, float* accelY, float* accelZ, int size);
+    void analyzeGait(float* accelMagnitude, int size);
     int detectSteps(float* accelMagnitude, int size);
+    
+    bool reserveBuffers(int size);
 };
 
 #endif
@@ -0,0 +1,274 @@
+/**
+ * @file WcetHarness.cpp
+ * @brief Implementation of the analysis WCET harness
+ */
+
+#include "WcetHarness.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#ifndef MBED_OS
+#include <chrono>
+#endif
+
+static const char* const INPUT_NAMES[WCET_INPUT_COUNT] = {
+    "constant", "saturated", "noise", "impulses", "tremor", "nan", "inf", "random"
+};
+
+static const float FULL_SCALE_G = 2.0f;       // Accelerometer range of the default configuration
+static const float FULL_SCALE_DPS = 250.0f;   // Gyroscope range of the default configuration
+
+/**
+ * @brief Constructor - Default budgets for a 3s hop at 52Hz
+ * 
+ * The whole window gets a tenth of the hop; each step gets one sample
+ * period.
+ * 
+ * @param detector Detector to measure
+ */
+WcetHarness::WcetHarness(SymptomDetector& detector) : detector(detector),
+    windowBudgetUs(300000), stepBudgetUs(19230), rng(1), runs(0), invalidResults(0) {
+    memset(times, 0, sizeof(times));
+    memset(inputs, 0, sizeof(inputs));
+    startCounter();
+}
+
+void WcetHarness::setBudget(uint32_t windowUs, uint32_t stepUs) {
+    windowBudgetUs = windowUs;
+    stepBudgetUs = stepUs;
+}
+
+const char* WcetHarness::inputName(int input) {
+    return (input >= 0 && input < WCET_INPUT_COUNT) ? INPUT_NAMES[input] : "?";
+}
+
+/**
+ * @brief Enable the cycle counter (target only)
+ */
+void WcetHarness::startCounter() {
+    #ifdef MBED_OS
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    #endif
+}
+
+/**
+ * @brief Read the free-running tick counter
+ * @return CPU cycles on the target, nanoseconds natively (both wrap)
+ */
+uint32_t WcetHarness::readTicks() {
+    #ifdef MBED_OS
+    return DWT->CYCCNT;
+    #else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    #endif
+}
+
+float WcetHarness::ticksPerUs() {
+    #ifdef MBED_OS
+    return SystemCoreClock / 1e6f;
+    #else
+    return 1000.0f;
+    #endif
+}
+
+/**
+ * @brief xorshift32 pseudo-random generator
+ * @return Next pseudo-random value
+ */
+uint32_t WcetHarness::nextRandom() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+float WcetHarness::uniform(float low, float high) {
+    return low + (high - low) * (nextRandom() >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * @brief Fill the window buffers with one input type
+ * @param input WcetInput
+ */
+void WcetHarness::fillWindow(int input) {
+    float scale = 1.0f;
+    if (input == WCET_RANDOM) {
+        input = (int)(nextRandom() % WCET_RANDOM);
+        scale = uniform(0.01f, 1.0f);
+    }
+    float rate = detector.getSampleRate();
+    int spacing = 3 + (int)(nextRandom() % 6);
+    float phase = uniform(0.0f, 6.2832f);
+    for (int i = 0; i < WINDOW_SIZE; i++) {
+        float t = i / rate;
+        for (int axis = 0; axis < 3; axis++) {
+            float a = 0.0f, g = 0.0f;
+            switch (input) {
+            case WCET_CONSTANT:
+                a = (axis == 2) ? 1.0f : 0.0f;
+                break;
+            case WCET_SATURATED:
+                a = (i & 1) ? FULL_SCALE_G : -FULL_SCALE_G;
+                g = (i & 1) ? FULL_SCALE_DPS : -FULL_SCALE_DPS;
+                break;
+            case WCET_IMPULSES:
+                a = (axis == 2) ? 1.0f : 0.0f;
+                if (i % spacing == 0) {
+                    a = (nextRandom() & 1) ? FULL_SCALE_G : -FULL_SCALE_G;
+                    g = FULL_SCALE_DPS;
+                }
+                break;
+            case WCET_TREMOR:
+                a = ((axis == 2) ? 1.0f : 0.0f) + 0.35f * sinf(6.2832f * 1.8f * t) +
+                    0.2f * sinf(6.2832f * 4.0f * t + phase);
+                g = 40.0f * sinf(6.2832f * 1.8f * t);
+                break;
+            default:  // Noise, and the carrier of the NaN/inf inputs
+                a = uniform(-FULL_SCALE_G, FULL_SCALE_G);
+                g = uniform(-FULL_SCALE_DPS, FULL_SCALE_DPS);
+                if (input == WCET_NAN && nextRandom() % 20 == 0) {
+                    a = NAN;
+                    g = NAN;
+                } else if (input == WCET_INF && nextRandom() % 20 == 0) {
+                    a = (nextRandom() & 1) ? INFINITY : -INFINITY;
+                    g = INFINITY;
+                }
+                break;
+            }
+            accel[axis][i] = a * scale;
+            gyro[axis][i] = g * scale;
+        }
+    }
+}
+
+/**
+ * @brief Analyze the current window step by step and record the times
+ * @param input WcetInput of the window
+ * @param withGyro Pass gyroscope data (otherwise nullptr)
+ */
+void WcetHarness::timeWindow(int input, bool withGyro) {
+    uint32_t start = readTicks();
+    detector.beginAnalysis(accel[0], accel[1], accel[2],
+                           withGyro ? gyro[0] : nullptr,
+                           withGyro ? gyro[1] : nullptr,
+                           withGyro ? gyro[2] : nullptr,
+                           WINDOW_SIZE);
+    bool done = false;
+    while (!done) {
+        int step = detector.getAnalysisStep();
+        uint32_t stepStart = readTicks();
+        done = detector.stepAnalysis();
+        uint32_t elapsed = readTicks() - stepStart;
+        if (step >= 0 && step < ROWS - 1) {
+            times[step][runs] = elapsed;
+        }
+    }
+    times[ROWS - 1][runs] = readTicks() - start;
+    inputs[runs] = (uint8_t)input;
+    
+    const SymptomResults& r = detector.getAnalysisResults();
+    float intensities[] = {r.tremorIntensity, r.dyskinesiaIntensity, r.fogIntensity};
+    for (float v : intensities) {
+        if (!(v >= 0.0f && v <= 1.0f)) {
+            invalidResults++;
+            break;
+        }
+    }
+    runs++;
+}
+
+/**
+ * @brief Analyze runsPerInput windows of every input type
+ * 
+ * Inputs are interleaved so caches and branch predictors do not settle
+ * on one input.
+ * 
+ * @param runsPerInput Windows per WcetInput
+ * @param seed Pseudo-random seed (0 is replaced by 1)
+ */
+void WcetHarness::run(int runsPerInput, uint32_t seed) {
+    rng = seed ? seed : 1;
+    runs = 0;
+    invalidResults = 0;
+    for (int r = 0; r < runsPerInput; r++) {
+        for (int input = 0; input < WCET_INPUT_COUNT && runs < MAX_RUNS; input++) {
+            fillWindow(input);
+            timeWindow(input, (r & 1) == 0);
+        }
+    }
+}
+
+/**
+ * @brief Get the timing distribution of a step
+ * @param row Step index, or ROWS-1 for the whole window
+ * @return Statistics in ticks (all zero before run())
+ */
+WcetStats WcetHarness::getStats(int row) const {
+    WcetStats stats = {0, 0, 0, 0, 0};
+    if (row < 0 || row >= ROWS || runs == 0) {
+        return stats;
+    }
+    static uint32_t sorted[MAX_RUNS];
+    uint64_t sum = 0;
+    for (int i = 0; i < runs; i++) {
+        sorted[i] = times[row][i];
+        sum += sorted[i];
+        if (times[row][i] >= stats.max) {
+            stats.max = times[row][i];
+            stats.maxInput = inputs[i];
+        }
+    }
+    std::sort(sorted, sorted + runs);
+    stats.mean = (uint32_t)(sum / runs);
+    stats.median = sorted[runs / 2];
+    stats.p99 = sorted[(runs * 99) / 100 < runs ? (runs * 99) / 100 : runs - 1];
+    return stats;
+}
+
+/**
+ * @brief Print the per-step table and the budget verdict
+ * @return true if every maximum is within its budget
+ */
+bool WcetHarness::report() const {
+    float perUs = ticksPerUs();
+    #ifdef MBED_OS
+    printf("=== Analysis WCET: %d windows of %d samples, ticks = cycles at %.0f MHz ===\r\n",
+           runs, WINDOW_SIZE, perUs);
+    #else
+    printf("=== Analysis WCET: %d windows of %d samples, ticks = ns ===\r\n", runs, WINDOW_SIZE);
+    #endif
+    printf("%-12s %10s %10s %10s %10s %10s  %s\r\n",
+           "step", "mean", "median", "p99", "max", "max us", "worst input");
+    
+    float worstStepUs = 0.0f;
+    int worstStep = 0;
+    for (int row = 0; row < ROWS; row++) {
+        WcetStats s = getStats(row);
+        float maxUs = s.max / perUs;
+        const char* name = (row == ROWS - 1) ? "window" :
+                           SymptomDetector::getAnalysisStepName(row);
+        printf("%-12s %10lu %10lu %10lu %10lu %10.1f  %s\r\n", name,
+               (unsigned long)s.mean, (unsigned long)s.median, (unsigned long)s.p99,
+               (unsigned long)s.max, maxUs, inputName(s.maxInput));
+        if (row < ROWS - 1 && maxUs > worstStepUs) {
+            worstStepUs = maxUs;
+            worstStep = row;
+        }
+    }
+    
+    float windowUs = getStats(ROWS - 1).max / perUs;
+    bool windowOk = windowUs <= windowBudgetUs;
+    bool stepOk = worstStepUs <= stepBudgetUs;
+    printf("Window budget: %.1f us of %lu us %s\r\n", windowUs,
+           (unsigned long)windowBudgetUs, windowOk ? "OK" : "EXCEEDED");
+    printf("Step budget: %.1f us (%s) of %lu us %s\r\n", worstStepUs,
+           SymptomDetector::getAnalysisStepName(worstStep),
+           (unsigned long)stepBudgetUs, stepOk ? "OK" : "EXCEEDED");
+    if (invalidResults > 0) {
+        printf("WARNING: %d windows gave NaN or out-of-range intensities\r\n", invalidResults);
+    }
+    return windowOk && stepOk;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file WcetHarness.h
+ * @brief Worst-case execution time measurement of the window analysis
+ * 
+ * Drives SymptomDetector with adversarial and randomized windows
+ * (constant, saturated, broadband noise, impulses, NaN/inf, random mixes)
+ * and times every analysis step separately through the incremental
+ * interface, plus the whole window. Per step the harness records the
+ * mean, median, 99th percentile and maximum, and checks the maxima
+ * against two budgets:
+ * - window budget: the whole analysis must finish well inside a hop
+ * - step budget: each step must fit in a sample period, so incremental
+ *   analysis never delays the next acquisition release
+ * 
+ * On the target the times are CPU cycles from the DWT cycle counter;
+ * natively they are nanoseconds. Budgets are given in microseconds.
+ */
+
+#ifndef WCET_HARNESS_H
+#define WCET_HARNESS_H
+
+#include "mbed_compat.h"
+#include "SymptomDetector.h"
+#include <cstdint>
+
+/**
+ * @enum WcetInput
+ * @brief Window contents used by the harness
+ */
+enum WcetInput {
+    WCET_CONSTANT,      // Constant 1g, no motion (zero variance)
+    WCET_SATURATED,     // Every axis alternating between the +/-2g rails
+    WCET_NOISE,         // Uniform broadband noise at full scale
+    WCET_IMPULSES,      // Sparse full-scale spikes (many peak candidates)
+    WCET_TREMOR,        // 4Hz tremor on walking-like 1.8Hz bounce
+    WCET_NAN,           // NaN samples scattered through noise
+    WCET_INF,           // +/-inf samples scattered through noise
+    WCET_RANDOM,        // A random mix of the above with random parameters
+    WCET_INPUT_COUNT
+};
+
+/**
+ * @struct WcetStats
+ * @brief Timing distribution of one step (in ticks: cycles or ns)
+ */
+struct WcetStats {
+    uint32_t mean;      // Average
+    uint32_t median;    // 50th percentile
+    uint32_t p99;       // 99th percentile
+    uint32_t max;       // Worst observed
+    int maxInput;       // WcetInput that produced the worst case
+};
+
+/**
+ * @class WcetHarness
+ * @brief Times SymptomDetector steps on adversarial windows
+ */
+class WcetHarness {
+public:
+    static const int WINDOW_SIZE = 156;     // Samples per window (3s at 52Hz)
+    static const int MAX_RUNS = 512;        // Timed windows kept for percentiles
+    static const int ROWS = SymptomDetector::ANALYSIS_STEPS + 1;  // Steps plus the whole window
+    
+    /**
+     * @param detector Detector to measure (its sample rate is used)
+     */
+    explicit WcetHarness(SymptomDetector& detector);
+    
+    /**
+     * @brief Set the budgets checked by report()
+     * @param windowUs Maximum time for a whole window analysis (us)
+     * @param stepUs Maximum time for a single analysis step (us)
+     */
+    void setBudget(uint32_t windowUs, uint32_t stepUs);
+    
+    /**
+     * @brief Analyze runsPerInput windows of every input type
+     * 
+     * At most MAX_RUNS windows are analyzed in total. Windows alternate
+     * between gyroscope data and no gyroscope.
+     * 
+     * @param runsPerInput Windows per WcetInput
+     * @param seed Seed of the pseudo-random generator (runs are reproducible)
+     */
+    void run(int runsPerInput, uint32_t seed);
+    
+    /**
+     * @brief Get the timing distribution of a step
+     * @param row Step index (SymptomDetector::getAnalysisStep()), or ROWS-1 for the whole window
+     * @return Statistics in ticks
+     */
+    WcetStats getStats(int row) const;
+    
+    /**
+     * @brief Number of results with a NaN or out-of-range intensity
+     * @return Invalid result count over all runs
+     */
+    int getInvalidResults() const { return invalidResults; }
+    
+    /**
+     * @brief Print the per-step table and the budget verdict
+     * @return true if every maximum is within its budget
+     */
+    bool report() const;
+    
+    /**
+     * @brief Name of an input type
+     * @param input WcetInput
+     * @return Short name
+     */
+    static const char* inputName(int input);
+    
+private:
+    SymptomDetector& detector;      // Detector under test
+    uint32_t windowBudgetUs;        // Whole-window budget (us)
+    uint32_t stepBudgetUs;          // Per-step budget (us)
+    uint32_t rng;                   // xorshift32 state
+    int runs;                       // Timed windows
+    int invalidResults;             // Results with NaN or out-of-range intensities
+    uint32_t times[ROWS][MAX_RUNS]; // Ticks per row and run
+    uint8_t inputs[MAX_RUNS];       // WcetInput of each run
+    
+    float accel[3][WINDOW_SIZE];    // Window under test
+    float gyro[3][WINDOW_SIZE];     // Gyroscope data of the window
+    
+    uint32_t nextRandom();
+    float uniform(float low, float high);
+    void fillWindow(int input);
+    void timeWindow(int input, bool withGyro);
+    
+    static uint32_t readTicks();
+    static float ticksPerUs();
+    static void startCounter();
+};
+
+#endif
@@ -10,12 +10,25 @@
  * 
  * The system samples sensor data at 52Hz, collects 3-second windows (156 samples),
  * and uses FFT analysis to detect frequency-specific symptoms.
+ * 
+ * Windows are double-buffered: the scheduled acquisition task fills one
+ * buffer while a lower-priority analysis thread processes the other. Built
+ * with INCREMENTAL_ANALYSIS, there is no analysis thread: the analysis runs
+ * in bounded steps between acquisition releases instead.
+ * 
+ * All work is released by timer and sensor interrupts, so between them the
+ * RTOS idle thread lets tickless idle put the MCU into deep sleep; the
+ * time spent in each sleep state is printed with every result.
  */
 
 #include "mbed_compat.h"
 #include "SensorManager.h"
 #include "SymptomDetector.h"
 #include "BLEManager.h"
+#include "Resampler.h"
+#include "Scheduler.h"
+#include "PowerMonitor.h"
+#include <cstring>
 #ifdef MBED_OS
 #include <chrono>
 #endif
@@ -25,27 +38,470 @@ SensorManager sensorManager;
 SymptomDetector symptomDetector;
 BLEManager bleManager;
 
-// Data buffers for storing sensor readings
 // Window size: 3 seconds * 52 Hz = 156 samples
 const int WINDOW_SIZE = 156;
-float accelX[WINDOW_SIZE];  // Accelerometer X-axis data (g)
-float accelY[WINDOW_SIZE];  // Accelerometer Y-axis data (g)
-float accelZ[WINDOW_SIZE];  // Accelerometer Z-axis data (g)
-float gyroX[WINDOW_SIZE];   // Gyroscope X-axis data (deg/s)
-float gyroY[WINDOW_SIZE];   // Gyroscope Y-axis data (deg/s)
-float gyroZ[WINDOW_SIZE];   // Gyroscope Z-axis data (deg/s)
 
-Timer timer;  // Timer for precise sampling rate control
-const int SAMPLE_INTERVAL_MS = 1000 / 52;  // Sampling interval: ~19.23ms for 52Hz
+/**
+ * @struct Window
+ * @brief One analysis window and the per-window context analysis needs
+ * 
+ * Sensor-side context (gravity, step counter) is captured by the
+ * acquisition task so the analysis thread never touches the I2C bus.
+ */
+struct Window {
+    float accelX[WINDOW_SIZE];          // Accelerometer X-axis data (g)
+    float accelY[WINDOW_SIZE];          // Accelerometer Y-axis data (g)
+    float accelZ[WINDOW_SIZE];          // Accelerometer Z-axis data (g)
+    float gyroX[WINDOW_SIZE];           // Gyroscope X-axis data (deg/s)
+    float gyroY[WINDOW_SIZE];           // Gyroscope Y-axis data (deg/s)
+    float gyroZ[WINDOW_SIZE];           // Gyroscope Z-axis data (deg/s)
+    uint32_t sampleTimes[WINDOW_SIZE];  // Per-sample timestamps (us)
+    int length;                         // Samples collected
+    float sampleRate;                   // Rate the window was sampled at (Hz)
+    bool withGyro;                      // Gyroscope channels hold data
+    bool gravityValid;                  // Gravity reference captured
+    float gravityX, gravityY, gravityZ; // Gravity reference for the magnitude path (g)
+    bool stepsValid;                    // Step counter captured
+    uint16_t stepCounter;               // Hardware step counter at window end
+    bool stepsRebase;                   // Windows lost since the previous counter value
+    SymptomResults results;             // Filled by the analysis thread
+    SpectralFeatures features;          // Filled with the results
+    int analysisLength;                 // Uniform samples analyzed
+    uint32_t endTimeMs;                 // Device time at the last release (ms)
+};
+
+// Ping-pong window buffers: acquisition fills one, analysis reads the other
+Window windows[2];
+int fillWindow = 0;             // Buffer being filled by acquisition
+int readyWindow = -1;           // Buffer handed to the analysis thread
+Semaphore windowFull(0);        // Released when a window is handed to analysis
+Semaphore windowFree(1);        // Released when the analysis buffer may be reused
+bool analysisBusy = false;      // A handed-over window has not been reported yet
+#ifndef INCREMENTAL_ANALYSIS
+Thread analysisThread(osPriorityBelowNormal);
+#endif
+unsigned long windowOverruns = 0;  // Windows dropped because analysis was still busy
+
+float resampled[WINDOW_SIZE];       // Scratch channel for uniform-grid resampling
+Resampler resampler;                // Jitter compensation before spectral analysis
+
+LowPowerTimer timer;  // Time base for the gating duty-cycle statistics
+PowerMonitor powerMonitor;  // Sleep-state residency and battery estimate
+
+// Acquisition, reporting and BLE work run as tasks released by the scheduler
+Scheduler scheduler;
+const int BLE_BATCH_WINDOWS = 4;            // Windows per result notification
+const uint32_t BLE_BATCH_MAX_MS = 15000;    // Longest a window result waits to be sent
+const float BLE_INTENSITY_DELTA = 0.1f;     // Intensity change worth a notification
+const uint32_t BLE_KEEPALIVE_MS = 60000;    // Longest interval without a result record
+int acquisitionTask = -1;   // Periodic at the sample rate
+int reportTask = -1;        // Event task, posted when the analysis thread finishes
+int analysisTask = -1;      // Event task running one incremental analysis step
+int bleTask = -1;           // Event task, posted when the BLE stack has events
+
+// Idle rate policy: drop the ODR while the wearer is quiet, restore on activity
+const float WINDOW_SECONDS = 3.0f;          // Analysis window duration
+const float ACTIVE_SAMPLE_RATE = 52.0f;     // Full rate (Hz)
+const float IDLE_SAMPLE_RATE = 26.0f;       // Idle rate (Hz), Nyquist still above 7Hz
+const int IDLE_WINDOWS_BEFORE_DOWNSHIFT = 3; // Quiet windows before dropping the rate
+
+// Duty-cycle statistics for wake-up/inactivity gating of the pipeline
+struct GatingStats {
+    unsigned long activeMs;     // Time spent sampling and analyzing
+    unsigned long suspendedMs;  // Time spent gated (no sampling, no FFTs)
+    int windowsAnalyzed;        // Windows run through SymptomDetector
+    int suspensions;            // Transitions into the suspended state
+};
+GatingStats gatingStats = {0, 0, 0, 0};
+
+/**
+ * @brief Print activity-gating duty-cycle statistics
+ * 
+ * Reports the fraction of time the pipeline was running and how many
+ * analysis windows were avoided while the wearer was inactive.
+ */
+void printGatingStats() {
+    unsigned long totalMs = gatingStats.activeMs + gatingStats.suspendedMs;
+    float dutyCycle = totalMs ? 100.0f * gatingStats.activeMs / totalMs : 100.0f;
+    printf("Gating: duty cycle %.1f%%, %d windows analyzed, ~%lu windows skipped, %d suspensions\r\n",
+           dutyCycle, gatingStats.windowsAnalyzed,
+           (unsigned long)(gatingStats.suspendedMs / (WINDOW_SECONDS * 1000.0f)),
+           gatingStats.suspensions);
+}
+
+/**
+ * @brief Move a window onto a uniform time grid at its sample rate
+ * 
+ * Acquisition releases are delayed by other tasks and the MCU clock drifts
+ * against the sensor ODR; interpolating onto a uniform grid keeps the FFT
+ * bin frequencies exact.
+ * 
+ * @param window Window to resample in place
+ * @return Number of uniform samples now in the window buffers
+ */
+int resampleWindow(Window& window) {
+    int gridSize = resampler.setGrid(window.sampleTimes, window.length, window.sampleRate);
+    if (gridSize < 2) {
+        return window.length;  // Unusable timestamps: analyze the samples as collected
+    }
+    float* channels[] = {window.accelX, window.accelY, window.accelZ,
+                         window.gyroX, window.gyroY, window.gyroZ};
+    int channelCount = window.withGyro ? 6 : 3;
+    for (int c = 0; c < channelCount; c++) {
+        resampler.resample(channels[c], resampled);
+        memcpy(channels[c], resampled, gridSize * sizeof(float));
+    }
+    return gridSize;
+}
+
+// Acquisition state owned by the scheduled tasks
+int sampleIndex = 0;            // Current position in the fill buffer
+int lastSampleTime = 0;         // Time of the last acquisition release (ms)
+int windowLength = WINDOW_SIZE; // Samples per window for the current ODR
+int quietWindows = 0;           // Consecutive windows without activity
+float reportedCadence = 0.0f;   // Cadence of the last reported window (steps/s), for gating
+bool stepsLost = false;         // Samples dropped, discarded or gated since the last handed-over window
+bool gatingEnabled = false;     // Wake-up/inactivity gating available
+bool suspended = false;         // Pipeline currently gated off
+bool acquisitionParked = false; // Acquisition released by the sensor's wake-up interrupt only
+
+/**
+ * @brief Hand the full fill buffer to the analysis thread
+ * 
+ * Captures the sensor-side context of the window first. If the analysis
+ * thread still owns the other buffer, the new window is dropped and
+ * counted as an overrun; acquisition keeps its timing either way.
+ */
+void completeWindow() {
+    Window& window = windows[fillWindow];
+    window.length = sampleIndex;
+    window.endTimeMs = (uint32_t)lastSampleTime;
+    sampleIndex = 0;  // Reset buffer index for next window
+    
+    // Magnitude path needs the gravity the hardware filter removed; the
+    // refresh started here averages the first samples of the next window,
+    // so the reference is the one averaged at the start of this window
+    window.gravityValid = sensorManager.isGravityRemoved();
+    if (window.gravityValid) {
+        sensorManager.refreshGravity();
+        sensorManager.getGravity(window.gravityX, window.gravityY, window.gravityZ);
+    }
+    
+    // Hardware step counter delta gives this window's cadence; after lost
+    // windows the detector takes a new baseline instead of their steps
+    window.stepsValid = sensorManager.readStepCount(window.stepCounter);
+    window.stepsRebase = stepsLost;
+    
+    if (!windowFree.try_acquire()) {
+        windowOverruns++;
+        stepsLost = true;
+        printf("WARNING: analysis overrun, window dropped (%lu total)\r\n", windowOverruns);
+        return;
+    }
+    stepsLost = false;
+    readyWindow = fillWindow;
+    fillWindow = 1 - fillWindow;
+    analysisBusy = true;
+    windowFull.release();
+}
+
+/**
+ * @brief Sensor wake-up interrupt: the wearer moved while gated
+ * 
+ * Runs in interrupt context; the acquisition task resumes sampling.
+ */
+void onActivityWakeup() {
+    scheduler.postFromInterrupt(acquisitionTask);
+}
+
+/**
+ * @brief Stop or restart periodic acquisition releases around a suspension
+ * 
+ * While gated, acquisition is only released by the sensor's wake-up
+ * interrupt when one is available, so the MCU can stay in deep sleep
+ * instead of waking at the sample rate to poll the inactivity state.
+ * 
+ * @param gated true when the pipeline has just been suspended
+ */
+void parkAcquisition(bool gated) {
+    if (gated) {
+        bleManager.flush();  // No more windows until activity resumes
+        if (sensorManager.setActivityWakeup(onActivityWakeup)) {
+            acquisitionParked = true;
+            scheduler.setRate(acquisitionTask, 0.0f);
+            if (!sensorManager.isInactive()) {
+                scheduler.post(acquisitionTask);  // Moved before the handler was attached
+            }
+        }
+    } else if (acquisitionParked) {
+        sensorManager.setActivityWakeup(nullptr);
+        acquisitionParked = false;
+        scheduler.setRate(acquisitionTask, sensorManager.getSampleRate());
+    }
+}
+
+/**
+ * @brief Acquisition task: read the samples due at this release
+ * 
+ * Released at the sample rate; runs at higher priority than the analysis
+ * thread, so sampling continues while a window is being analyzed.
+ */
+void acquireSamples() {
+    // Use elapsed_time() instead of deprecated read_ms()
+    #ifdef MBED_OS
+    int currentTime = std::chrono::duration_cast<std::chrono::milliseconds>(timer.elapsed_time()).count();
+    #else
+    int currentTime = timer.read_ms();
+    #endif
+    
+    // Gating is only decided at window boundaries, so a window in
+    // progress (e.g. a walk-to-freeze transition) is always completed.
+    // A window that still showed walking is followed by one more.
+    if (gatingEnabled && sampleIndex == 0) {
+        bool gate = sensorManager.isInactive() && reportedCadence <= 0.3f;
+        if (gate != suspended) {
+            suspended = gate;
+            if (suspended) {
+                gatingStats.suspensions++;
+                stepsLost = true;
+            }
+            parkAcquisition(suspended);
+            printf("Activity gating: %s\r\n", suspended ? "suspended" : "resumed");
+            printGatingStats();
+        }
+    }
+    
+    if (suspended) {
+        gatingStats.suspendedMs += currentTime - lastSampleTime;
+        lastSampleTime = currentTime;
+        return;
+    }
+    gatingStats.activeMs += currentTime - lastSampleTime;
+    lastSampleTime = currentTime;
+    
+    // Gyroscope state is fixed for the whole window
+    Window& window = windows[fillWindow];
+    if (sampleIndex == 0) {
+        window.withGyro = sensorManager.isGyroActive();
+        window.sampleRate = sensorManager.getSampleRate();
+    }
+    
+    // Read sensor data straight into the window buffers; the sensor
+    // delivers what is available now, recorded sources fill the window
+    SensorBlock block = {
+        window.accelX + sampleIndex, window.accelY + sampleIndex, window.accelZ + sampleIndex,
+        window.withGyro ? window.gyroX + sampleIndex : nullptr,
+        window.withGyro ? window.gyroY + sampleIndex : nullptr,
+        window.withGyro ? window.gyroZ + sampleIndex : nullptr,
+        window.sampleTimes + sampleIndex
+    };
+    int samplesRead = sensorManager.readBlock(block, windowLength - sampleIndex);
+    
+    // Raw samples to the phone while it is subscribed to the stream
+    if (bleManager.isStreaming()) {
+        bleManager.streamSamples(block.accelX, block.accelY, block.accelZ,
+                                 block.gyroX, block.gyroY, block.gyroZ,
+                                 block.timestampUs, samplesRead, window.sampleRate);
+    }
+    sampleIndex += samplesRead;
+    
+    // When buffer is full (3 seconds of data collected), hand it to analysis
+    if (sampleIndex >= windowLength) {
+        completeWindow();
+    }
+    
+    #ifdef INCREMENTAL_ANALYSIS
+    // One analysis step follows each release until the window is reported
+    if (analysisBusy) {
+        scheduler.post(analysisTask);
+    }
+    #endif
+}
+
+/**
+ * @brief Give the detector the window's sensor context and resample it
+ * 
+ * @param window Window handed over by completeWindow()
+ */
+void prepareAnalysis(Window& window) {
+    if (window.gravityValid) {
+        symptomDetector.setGravityReference(window.gravityX, window.gravityY, window.gravityZ);
+    }
+    if (window.stepsValid) {
+        if (window.stepsRebase) {
+            symptomDetector.resetStepBaseline();
+        }
+        symptomDetector.setStepCount(window.stepCounter);
+    }
+    
+    // Compensate polling jitter before spectral analysis
+    window.analysisLength = resampleWindow(window);
+}
+
+#ifdef INCREMENTAL_ANALYSIS
+void reportResults();
+
+/**
+ * @brief Analysis task: run one bounded step of the window analysis
+ * 
+ * Posted after each acquisition release while a window is being analyzed,
+ * so the work (resampling, then one SymptomDetector step of at most one
+ * FFT per release) is spread over the following sample periods instead of
+ * delaying samples and BLE events with a single burst.
+ */
+void analysisStep() {
+    Window& window = windows[readyWindow];
+    if (!symptomDetector.isAnalysisPending()) {
+        if (!windowFull.try_acquire()) {
+            return;
+        }
+        prepareAnalysis(window);
+        
+        // Gyroscope arrays are omitted when it was powered down
+        symptomDetector.beginAnalysis(
+            window.accelX, window.accelY, window.accelZ,
+            window.withGyro ? window.gyroX : nullptr,
+            window.withGyro ? window.gyroY : nullptr,
+            window.withGyro ? window.gyroZ : nullptr,
+            window.analysisLength
+        );
+        return;
+    }
+    if (symptomDetector.stepAnalysis()) {
+        window.results = symptomDetector.getAnalysisResults();
+        window.features = symptomDetector.getFeatures();
+        reportResults();
+    }
+}
+#else
+/**
+ * @brief Analysis thread: detect symptoms in each window handed over
+ * 
+ * Runs below the scheduler's priority. Results are reported by the
+ * report task, which also returns the buffer.
+ */
+void analysisLoop() {
+    while (true) {
+        windowFull.acquire();
+        Window& window = windows[readyWindow];
+        prepareAnalysis(window);
+        
+        // Gyroscope arrays are omitted when it was powered down
+        window.results = symptomDetector.analyze(
+            window.accelX, window.accelY, window.accelZ,
+            window.withGyro ? window.gyroX : nullptr,
+            window.withGyro ? window.gyroY : nullptr,
+            window.withGyro ? window.gyroZ : nullptr,
+            window.analysisLength
+        );
+        window.features = symptomDetector.getFeatures();
+        
+        scheduler.post(reportTask);
+    }
+}
+#endif
+
+/**
+ * @brief Report task: publish the analyzed window and apply policies
+ * 
+ * Posted by the analysis thread, or called by the last incremental step.
+ * The analysis buffer is only returned at the end, so the detector is idle
+ * while its sample rate is changed.
+ */
+void reportResults() {
+    const Window& window = windows[readyWindow];
+    const SymptomResults& results = window.results;
+    gatingStats.windowsAnalyzed++;
+    
+    // Print detection results to serial console
+    printf("\r\n=== Detection Results ===\r\n");
+    printf("Tremor: %s (Intensity: %.2f)\r\n", 
+           results.tremorDetected ? "YES" : "NO",
+           results.tremorIntensity);
+    
+    printf("Dyskinesia: %s (Intensity: %.2f)\r\n", 
+           results.dyskinesiaDetected ? "YES" : "NO",
+           results.dyskinesiaIntensity);
+    
+    printf("Freezing of Gait: %s (Intensity: %.2f)\r\n", 
+           results.fogDetected ? "YES" : "NO",
+           results.fogIntensity);
+    printf("Sampling: max timing error %.1f ms, %d uniform samples, %lu analysis overruns\r\n",
+           resampler.getMaxJitterUs() / 1000.0f, window.analysisLength, windowOverruns);
+    scheduler.printStats();
+    powerMonitor.print();
+    bleManager.printStats();
+    
+    // Transmit detection results via BLE to connected mobile device
+    bleManager.updateCharacteristics(
+        results.tremorDetected,
+        results.tremorIntensity,
+        results.dyskinesiaDetected,
+        results.dyskinesiaIntensity,
+        results.fogDetected,
+        results.fogIntensity,
+        window.endTimeMs
+    );
+    bleManager.updateFeatures(window.features);  // Band powers etc. for phone-side models
+    if (suspended) {
+        bleManager.flush();  // Analyzed after gating started: nothing follows it
+    }
+    
+    // Latched while the analysis thread is idle: it writes the detector's
+    // cadence again once the next window is handed over
+    reportedCadence = symptomDetector.getCadence();
+    
+    // Gyroscope power follows cadence; takes effect with the next window
+    sensorManager.updateGyroPower(reportedCadence);
+    
+    // Adjust sensor ODR: any detection or walking cadence counts as activity
+    bool active = results.tremorDetected || results.dyskinesiaDetected ||
+                  results.fogDetected || reportedCadence > 0.3f;
+    quietWindows = active ? 0 : quietWindows + 1;
+    float targetRate = (quietWindows >= IDLE_WINDOWS_BEFORE_DOWNSHIFT) ?
+                       IDLE_SAMPLE_RATE : ACTIVE_SAMPLE_RATE;
+    if (targetRate != sensorManager.getSampleRate() &&
+        sensorManager.setSampleRate(targetRate)) {
+        float rate = sensorManager.getSampleRate();
+        symptomDetector.setSampleRate(rate);
+        if (!acquisitionParked) {
+            scheduler.setRate(acquisitionTask, rate);
+        }
+        windowLength = (int)(WINDOW_SECONDS * rate + 0.5f);
+        if (windowLength > WINDOW_SIZE) windowLength = WINDOW_SIZE;
+        sampleIndex = 0;  // Restart the partial window at the new rate
+        stepsLost = true;
+        printf("Sample rate changed to %.1f Hz\r\n", rate);
+    }
+    
+    analysisBusy = false;
+    windowFree.release();
+}
+
+/**
+ * @brief BLE task: process BLE events (connections, notifications, etc.)
+ */
+void serviceBle() {
+    bleManager.update();
+}
+
+/**
+ * @brief BLE stack callback: events are pending
+ * 
+ * Can run in interrupt context, so it only posts the BLE task.
+ */
+void signalBleEvents() {
+    scheduler.postFromInterrupt(bleTask);
+}
 
 /**
  * @brief Main program entry point
  * 
- * Initializes all system components, then enters the main loop which:
- * 1. Samples sensor data at 52Hz
- * 2. Collects 3-second data windows
- * 3. Analyzes data for symptom detection
- * 4. Transmits results via BLE
+ * Initializes all system components, starts the analysis thread and hands
+ * control to the scheduler, which releases:
+ * 1. Sensor acquisition at the sample rate (52Hz, exact on average)
+ * 2. Reporting of each analyzed 3-second window via serial and BLE
+ * 3. BLE event processing whenever the stack signals events
  * 
  * @return int Exit code (0 for success, -1 for initialization failure)
  */
@@ -61,87 +517,46 @@ int main() {
     // Initialize symptom detection algorithm
     symptomDetector.begin();
     
-    // Initialize BLE communication for transmitting detection results
+    // Initialize BLE communication for transmitting detection results;
+    // stack events post the BLE task instead of being polled
+    bleManager.setEventCallback(signalBleEvents);
     if (!bleManager.begin()) {
         printf("WARNING: BLE initialization failed, continuing in simulation mode\r\n");
     }
+    bleManager.setBatching(BLE_BATCH_WINDOWS, BLE_BATCH_MAX_MS);
+    bleManager.setNotificationPolicy(BLE_INTENSITY_DELTA, BLE_KEEPALIVE_MS);
     
-    printf("System initialization complete. Starting data acquisition...\r\n");
+    // Keep the gyroscope powered down until walking is detected
+    sensorManager.setGyroPowerPolicy(GYRO_ON_WALKING);
     
-    // Start timer and initialize sampling variables
-    timer.start();
-    int sampleIndex = 0;      // Current position in data buffer
-    int lastSampleTime = 0;   // Timestamp of last sample
+    // Use the LSM6DSL embedded pedometer for cadence instead of software peak detection
+    if (sensorManager.enablePedometer()) {
+        symptomDetector.setCadenceSource(CADENCE_STEP_COUNTER);
+    }
     
-    // Main processing loop
-    while (true) {
-        // Use elapsed_time() instead of deprecated read_ms()
-        #ifdef MBED_OS
-        int currentTime = std::chrono::duration_cast<std::chrono::milliseconds>(timer.elapsed_time()).count();
-        #else
-        int currentTime = timer.read_ms();
-        #endif
-        
-        // Sample data at 52Hz (every ~19.23ms)
-        if (currentTime - lastSampleTime >= SAMPLE_INTERVAL_MS) {
-            // Read sensor data (accelerometer and gyroscope)
-            SensorData data = sensorManager.read();
-            
-            // Store data in circular buffer
-            accelX[sampleIndex] = data.accelX;
-            accelY[sampleIndex] = data.accelY;
-            accelZ[sampleIndex] = data.accelZ;
-            gyroX[sampleIndex] = data.gyroX;
-            gyroY[sampleIndex] = data.gyroY;
-            gyroZ[sampleIndex] = data.gyroZ;
-            
-            sampleIndex++;
-            
-            // When buffer is full (3 seconds of data collected), perform analysis
-            if (sampleIndex >= WINDOW_SIZE) {
-                sampleIndex = 0;  // Reset buffer index for next window
-                
-                // Perform symptom detection analysis on collected data
-                SymptomResults results = symptomDetector.analyze(
-                    accelX, accelY, accelZ,
-                    gyroX, gyroY, gyroZ,
-                    WINDOW_SIZE
-                );
-                
-                // Print detection results to serial console
-                printf("\r\n=== Detection Results ===\r\n");
-                printf("Tremor: %s (Intensity: %.2f)\r\n", 
-                       results.tremorDetected ? "YES" : "NO",
-                       results.tremorIntensity);
-                
-                printf("Dyskinesia: %s (Intensity: %.2f)\r\n", 
-                       results.dyskinesiaDetected ? "YES" : "NO",
-                       results.dyskinesiaIntensity);
-                
-                printf("Freezing of Gait: %s (Intensity: %.2f)\r\n", 
-                       results.fogDetected ? "YES" : "NO",
-                       results.fogIntensity);
-                
-                // Transmit detection results via BLE to connected mobile device
-                bleManager.updateCharacteristics(
-                    results.tremorDetected,
-                    results.tremorIntensity,
-                    results.dyskinesiaDetected,
-                    results.dyskinesiaIntensity,
-                    results.fogDetected,
-                    results.fogIntensity
-                );
-            }
-            
-            lastSampleTime = currentTime;
-        }
-        
-        // Process BLE events (handle connections, notifications, etc.)
-        bleManager.update();
-        
-        // Small delay to prevent CPU spinning
-        thread_sleep_for(1);
+    // Let the LSM6DSL high-pass filter remove gravity instead of software mean removal
+    if (sensorManager.setGravityRemoval(true)) {
+        symptomDetector.setGravityRemovedInput(true);
     }
     
+    // Suspend windowing and FFTs while the LSM6DSL reports inactivity
+    gatingEnabled = sensorManager.enableActivityGating();
+    
+    // Acquisition first: it has priority when several tasks are due
+    acquisitionTask = scheduler.addTask("acquisition", acquireSamples, sensorManager.getSampleRate());
+    reportTask = scheduler.addTask("report", reportResults, 0.0f);
+    bleTask = scheduler.addTask("ble", serviceBle, 0.0f);
+    scheduler.post(bleTask);  // Events signalled before the task existed
+    
+    #ifdef INCREMENTAL_ANALYSIS
+    analysisTask = scheduler.addTask("analysis", analysisStep, 0.0f);
+    #else
+    analysisThread.start(analysisLoop);
+    #endif
+    
+    printf("System initialization complete. Starting data acquisition...\r\n");
+    timer.start();
+    scheduler.run();
+    
     return 0;
 }
@@ -0,0 +1,52 @@
+/**
+ * @file main_wcet.cpp
+ * @brief Worst-case execution time run of the window analysis
+ * 
+ * Firmware (PlatformIO env "wcet") or native program that runs the
+ * WcetHarness over adversarial and randomized windows, prints the per-step
+ * cycle table and reports PASSED or FAILED against the budgets. Budgets,
+ * run count and seed are build flags:
+ * - WCET_WINDOW_BUDGET_US: whole-window analysis budget (default 300000)
+ * - WCET_STEP_BUDGET_US: single analysis step budget (default 19230)
+ * - WCET_RUNS_PER_INPUT: windows per input type (default 64)
+ * - WCET_SEED: pseudo-random seed (default 12345)
+ * 
+ * Nothing else runs while the harness measures, so the figures are the
+ * analysis alone; interrupts (tickless idle timer, serial) can still add
+ * to single samples.
+ */
+
+#include "mbed_compat.h"
+#include "SymptomDetector.h"
+#include "WcetHarness.h"
+
+#ifndef WCET_WINDOW_BUDGET_US
+#define WCET_WINDOW_BUDGET_US 300000
+#endif
+#ifndef WCET_STEP_BUDGET_US
+#define WCET_STEP_BUDGET_US 19230
+#endif
+#ifndef WCET_RUNS_PER_INPUT
+#define WCET_RUNS_PER_INPUT 64
+#endif
+#ifndef WCET_SEED
+#define WCET_SEED 12345
+#endif
+
+SymptomDetector symptomDetector;
+WcetHarness harness(symptomDetector);   // Static: the timing table is ~16KB
+
+/**
+ * @brief Run the harness once and report the verdict
+ * @return 0 if within budget, 1 otherwise
+ */
+int main() {
+    printf("=== Analysis WCET harness ===\r\n");
+    symptomDetector.begin();
+    symptomDetector.setSampleRate(52.0f);
+    harness.setBudget(WCET_WINDOW_BUDGET_US, WCET_STEP_BUDGET_US);
+    harness.run(WCET_RUNS_PER_INPUT, WCET_SEED);
+    bool ok = harness.report();
+    printf("=== WCET %s ===\r\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
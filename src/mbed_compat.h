@@ -4,10 +4,14 @@
 #ifdef NATIVE_TEST_MODE
     // Native模式下的Mbed兼容层
     #include <cstdio>
+    #include <cstdint>
     #include <cstdlib>
     #include <cmath>
     #include <unistd.h>
     #include <sys/time.h>
+    #include <thread>
+    #include <mutex>
+    #include <condition_variable>
     
     // 模拟Timer类
     class Timer {
@@ -30,6 +34,148 @@
             return (currentTime.tv_sec - startTime.tv_sec) * 1000 + 
                    (currentTime.tv_usec - startTime.tv_usec) / 1000;
         }
+        
+        long long read_us() {
+            if (!started) return 0;
+            struct timeval currentTime;
+            gettimeofday(&currentTime, nullptr);
+            return (currentTime.tv_sec - startTime.tv_sec) * 1000000LL + 
+                   (currentTime.tv_usec - startTime.tv_usec);
+        }
+    };
+    
+    // 模拟LowPowerTimer类（Native模式下没有低功耗时钟，与Timer相同）
+    class LowPowerTimer : public Timer {};
+    
+    // 模拟I2C从设备接口（由寄存器级传感器模型实现，例如LSM6DSLSim）
+    class I2CTarget {
+    public:
+        virtual ~I2CTarget() {}
+        // 主机写入：返回false表示NACK
+        virtual bool i2cWrite(const char* data, int length, bool repeated) = 0;
+        // 主机读取：返回false表示NACK
+        virtual bool i2cRead(char* data, int length) = 0;
+    };
+    
+    // 模拟I2C类（接口与Mbed一致），统计事务数、字节数和总线时间
+    class I2C {
+    private:
+        I2CTarget* target;
+        int targetAddress;   // 8位地址（与Mbed一致）
+        int busHz;
+        
+    public:
+        unsigned long transactions;   // START...STOP/重复START 事务数
+        unsigned long bytesWritten;   // 主机写出的数据字节数
+        unsigned long bytesRead;      // 主机读取的数据字节数
+        double busTimeUs;             // 估算的总线占用时间（微秒）
+        
+        I2C() : target(nullptr), targetAddress(0), busHz(100000) { resetStats(); }
+        
+        // 挂接模拟从设备
+        void attach(int address, I2CTarget* device) {
+            targetAddress = address;
+            target = device;
+        }
+        
+        void frequency(int hz) { busHz = hz; }
+        
+        void resetStats() {
+            transactions = 0;
+            bytesWritten = 0;
+            bytesRead = 0;
+            busTimeUs = 0.0;
+        }
+        
+        // 返回0表示成功（与Mbed一致）
+        int write(int address, const char* data, int length, bool repeated = false) {
+            account(length);
+            bytesWritten += length;
+            if (target == nullptr || (address & 0xFE) != (targetAddress & 0xFE)) return -1;
+            return target->i2cWrite(data, length, repeated) ? 0 : -1;
+        }
+        
+        int read(int address, char* data, int length, bool repeated = false) {
+            (void)repeated;
+            account(length);
+            bytesRead += length;
+            if (target == nullptr || (address & 0xFE) != (targetAddress & 0xFE)) return -1;
+            return target->i2cRead(data, length) ? 0 : -1;
+        }
+        
+    private:
+        // 每字节9位（含ACK），另加START/STOP约2位时间
+        void account(int length) {
+            transactions++;
+            busTimeUs += ((1 + length) * 9 + 2) * 1e6 / busHz;
+        }
+    };
+    
+    // 线程优先级（Native模式下忽略，由操作系统调度）
+    enum osPriority {
+        osPriorityLow,
+        osPriorityBelowNormal,
+        osPriorityNormal,
+        osPriorityAboveNormal,
+        osPriorityHigh
+    };
+    
+    // 模拟Semaphore类（接口与Mbed一致），基于std::condition_variable
+    class Semaphore {
+    private:
+        std::mutex lock;
+        std::condition_variable available;
+        int count;
+    
+    public:
+        explicit Semaphore(int count = 0) : count(count) {}
+        
+        // 阻塞等待一个令牌
+        void acquire() {
+            std::unique_lock<std::mutex> guard(lock);
+            available.wait(guard, [this] { return count > 0; });
+            count--;
+        }
+        
+        // 非阻塞获取：没有令牌时返回false
+        bool try_acquire() {
+            std::lock_guard<std::mutex> guard(lock);
+            if (count == 0) return false;
+            count--;
+            return true;
+        }
+        
+        void release() {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                count++;
+            }
+            available.notify_one();
+        }
+    };
+    
+    // 模拟Thread类（接口与Mbed一致），基于std::thread；需要链接 -pthread
+    class Thread {
+    private:
+        std::thread worker;
+    
+    public:
+        explicit Thread(osPriority priority = osPriorityNormal) { (void)priority; }
+        
+        // 程序退出时线程可能仍在运行，分离以免std::terminate
+        ~Thread() {
+            if (worker.joinable()) worker.detach();
+        }
+        
+        // 返回0表示成功（与Mbed的osOK一致）
+        int start(void (*task)()) {
+            worker = std::thread(task);
+            return 0;
+        }
+        
+        void join() {
+            if (worker.joinable()) worker.join();
+        }
     };
     
     // 模拟thread_sleep_for
@@ -1,10 +1,51 @@
 #!/bin/bash
+#
+# 用法:
+#   ./test.sh          编译并运行 test/ 下的全部单元测试和基准（只需要 g++）
+#   ./test.sh native   用 PlatformIO 的 native 环境运行仿真程序（需先在 platformio.ini 中启用）
 
 echo "=========================================="
 echo "  帕金森症状检测系统 - 电脑端测试"
 echo "=========================================="
 echo ""
 
+if [ "$1" != "native" ]; then
+    # 单元测试和基准：每个文件头部的 "Build (native):" 注释就是它的编译命令
+    cd "$(dirname "$0")/test" || exit 1
+    BIN_DIR=$(mktemp -d)
+    trap 'rm -rf "$BIN_DIR"' EXIT
+    passed=0
+    failed=0
+
+    for src in test_*.cpp bench_*.cpp; do
+        cmd=$(sed -n '/Build (native):/,/^ \*\( *\|\/\)$/p' "$src" |
+              sed -e '/^ \*\( *\|\/\)$/d' -e 's/^ \* *//' -e 's/Build (native): *//' | tr '\n' ' ')
+        if [ -z "$cmd" ]; then
+            continue    # 没有编译命令的旧测试程序
+        fi
+        name="${src%.cpp}"
+        if ! $cmd -o "$BIN_DIR/$name" 2> "$BIN_DIR/$name.log"; then
+            echo "编译失败: $src"
+            cat "$BIN_DIR/$name.log"
+            failed=$((failed + 1))
+            continue
+        fi
+        # 测试和基准都以 "=== ... ===" 结束，失败时返回非零
+        if summary=$("$BIN_DIR/$name" 2>&1 | tail -n 1; exit "${PIPESTATUS[0]}"); then
+            echo "通过: $name  $summary"
+            passed=$((passed + 1))
+        else
+            echo "失败: $name  $summary"
+            failed=$((failed + 1))
+        fi
+    done
+
+    echo ""
+    echo "通过 $passed 个，失败 $failed 个"
+    [ $failed -eq 0 ]
+    exit $?
+fi
+
 # 检查PlatformIO是否安装
 if ! command -v pio &> /dev/null; then
     echo "错误: PlatformIO未安装"
@@ -29,4 +70,3 @@ echo ""
 
 # 运行测试
 pio run -e native -t exec
-
@@ -0,0 +1,318 @@
+/**
+ * @file bench_ble_link.cpp
+ * @brief Native throughput and latency benchmark of BLEManager's transmission modes
+ * 
+ * Runs each transmission mode through the simulated link (GattServerSim)
+ * and receives the notifications as a phone would, on the simulator's
+ * Unix socket. Per mode and link it reports the interval in use at the
+ * end, delivered payload bytes per second, notifications, end-to-end
+ * latency (mean and maximum) and the notifications refused for lack of
+ * stack buffers:
+ * - Results, every window: 10 minutes of 3 s windows with a tremor
+ *   episode; latency from the end of a window to the delivery of its record
+ * - Results, batched (4 windows or 15 s) and change-only (0.1 delta, 60 s
+ *   keep-alive), the settings of main.cpp
+ * - Features: the feature record of every window, latency from the end of
+ *   the window
+ * - Raw stream: 60 s of 6-axis frames at 52 Hz (accelerometer only at
+ *   MTU 23), latency from the first frame of a packet
+ * - Bulk download: one hour of history, credit window 16; B/s over the
+ *   download, latency from the page write to its delivery
+ * 
+ * The connection opens at 30 ms and BLEManager then requests the
+ * parameters of its traffic, as on the device. Links:
+ * - 23-byte ATT MTU without Data Length Extension
+ * - 247-byte MTU with DLE
+ * - 247-byte MTU with DLE and 10% packet loss
+ * - 247-byte MTU with DLE, central refusing parameter updates
+ * 
+ * Build (native): g++ -O2 -DNATIVE_TEST_MODE -I../src bench_ble_link.cpp
+ *                 ../src/GattServerSim.cpp ../src/AdvertisingScheduler.cpp
+ *                 ../src/ConnectionParamManager.cpp ../src/BulkTransfer.cpp
+ *                 ../src/ImuStreamCodec.cpp ../src/BLEManager.cpp
+ */
+
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../src/GattServerSim.h"
+#include "../src/BLEManager.h"
+
+static const uint32_t HOP_MS = 3000;
+static const int SESSION_WINDOWS = 200;         // 10 minutes
+static const int STREAM_RATE_HZ = 52;
+static const int STREAM_SECONDS = 60;
+static const uint16_t BULK_WINDOW = 16;
+
+enum Mode {
+    MODE_EVERY_WINDOW,
+    MODE_BATCHED,
+    MODE_CHANGE_ONLY,
+    MODE_FEATURES,
+    MODE_STREAM,
+    MODE_BULK,
+    MODES
+};
+
+static const char* const MODE_NAMES[MODES] = {
+    "results, every window", "results, batched", "results, change-only",
+    "features", "raw stream", "bulk download"
+};
+
+// Characteristic measured in each mode
+static const uint8_t MODE_CHARS[MODES] = {
+    SIM_CHAR_RESULT, SIM_CHAR_RESULT, SIM_CHAR_RESULT,
+    SIM_CHAR_FEATURE, SIM_CHAR_RAW_STREAM, SIM_CHAR_BULK_DATA
+};
+
+struct LinkCase {
+    const char* name;
+    GattLinkParams link;
+};
+
+struct Run {
+    uint32_t bytes;             // Payload bytes of the measured characteristic
+    uint32_t notifications;     // Notifications of the measured characteristic
+    float seconds;              // Time the bytes are spread over
+    uint32_t samples;           // Latency samples
+    double totalLatencyUs;      // Sum of latencies (us)
+    uint32_t maxLatencyUs;      // Longest latency (us)
+    uint32_t intervalUs;        // Interval in use at the end (us)
+    uint32_t refused;           // Notifications refused for lack of stack buffers
+    bool complete;              // Bulk download finished
+};
+
+static char socketPath[64];
+static uint8_t bulkStorage[HISTORY_RECORDS * RESULT_RECORD_SIZE];
+static uint32_t windowEndUs[SESSION_WINDOWS + 2];      // By result sequence number
+
+static uint32_t rng = 2463534242u;
+
+static float uniform() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (rng >> 8) * (1.0f / 16777216.0f);
+}
+
+static void addLatency(Run& run, uint32_t latencyUs) {
+    run.samples++;
+    run.totalLatencyUs += latencyUs;
+    if (latencyUs > run.maxLatencyUs) {
+        run.maxLatencyUs = latencyUs;
+    }
+}
+
+/**
+ * @brief Take what the phone received so far and account the measured characteristic
+ * @param client Bulk client, whose replies go back through ble; nullptr outside MODE_BULK
+ */
+static void receiveAll(GattSimSubscriber& phone, Mode mode, Run& run, BLEManager& ble,
+                       BulkTransferClient* client) {
+    GattSimNotification n;
+    while (phone.receive(n)) {
+        if (n.characteristic != MODE_CHARS[mode]) {
+            continue;
+        }
+        run.bytes += n.length;
+        run.notifications++;
+        if (n.characteristic == SIM_CHAR_RESULT) {
+            for (int i = 0; i + RESULT_RECORD_SIZE <= n.length; i += RESULT_RECORD_SIZE) {
+                ResultRecord record;
+                BLEManager::unpackResult(n.data + i, record);
+                addLatency(run, n.deliveredUs - record.timestampMs * 1000u);
+            }
+        } else if (n.characteristic == SIM_CHAR_FEATURE) {
+            FeatureRecord record;
+            BLEManager::unpackFeatures(n.data, record);
+            addLatency(run, n.deliveredUs - windowEndUs[record.sequence]);
+        } else if (n.characteristic == SIM_CHAR_RAW_STREAM) {
+            uint32_t firstUs = n.data[2] | (n.data[3] << 8) | (n.data[4] << 16) |
+                               ((uint32_t)n.data[5] << 24);
+            addLatency(run, n.deliveredUs - firstUs);
+        } else {
+            addLatency(run, n.deliveredUs - n.queuedUs);
+            uint8_t reply[BULK_CONTROL_MAX];
+            int length = client ? client->receive(n.data, n.length, reply) : 0;
+            if (length > 0) {
+                ble.handleBulkControl(reply, length);
+            }
+            if (client && client->isComplete()) {
+                run.seconds = n.deliveredUs / 1e6f;
+            }
+        }
+    }
+}
+
+// Tremor from 3 to 5 minutes, a freezing episode at 7.5 minutes, small
+// fluctuations otherwise
+static void window(BLEManager& ble, int w, uint32_t endMs) {
+    bool tremor = w >= 60 && w < 100;
+    bool fog = w >= 150 && w < 154;
+    float tremorIntensity = tremor ? 0.5f + 0.3f * sinf(w * 0.4f) : 0.08f * uniform();
+    float dyskinesiaIntensity = 0.06f * uniform();
+    float fogIntensity = fog ? 0.7f : 0.05f * uniform();
+    ble.updateCharacteristics(tremor, tremorIntensity, false, dyskinesiaIntensity,
+                              fog, fogIntensity, endMs);
+}
+
+static void runWindows(GattServerSim& sim, GattSimSubscriber& phone, BLEManager& ble,
+                       Mode mode, Run& run) {
+    SpectralFeatures features;
+    memset(&features, 0, sizeof(features));
+    for (int w = 1; w <= SESSION_WINDOWS; w++) {
+        uint32_t endUs = w * HOP_MS * 1000u;
+        int delivered = sim.advanceTo(endUs);
+        if (delivered > 0) {
+            ble.notificationsSent(delivered);
+        }
+        receiveAll(phone, mode, run, ble, nullptr);
+        window(ble, w, endUs / 1000);
+        windowEndUs[ble.getLastRecord().sequence] = endUs;
+        if (mode == MODE_FEATURES) {
+            for (int axis = 0; axis < FEATURE_AXES; axis++) {
+                for (int band = 0; band < FEATURE_BANDS; band++) {
+                    features.bandPower[axis][band] = 1e-4f * (1.0f + uniform());
+                }
+            }
+            features.peakFrequency = 4.0f + uniform();
+            features.cadence = 1.8f;
+            ble.updateFeatures(features);
+        }
+    }
+    // Let the last notifications arrive (windows still batched are not sent)
+    sim.advanceTo((SESSION_WINDOWS + 1) * HOP_MS * 1000u);
+    receiveAll(phone, mode, run, ble, nullptr);
+    run.seconds = SESSION_WINDOWS * HOP_MS / 1000.0f;
+}
+
+static void runStream(GattServerSim& sim, GattSimSubscriber& phone, BLEManager& ble, Run& run) {
+    ble.setStreaming(true);
+    const int frames = STREAM_RATE_HZ * STREAM_SECONDS;
+    for (int i = 0; i < frames; i++) {
+        uint32_t t = (uint32_t)((uint64_t)i * 1000000u / STREAM_RATE_HZ);
+        float phase = 2.0f * (float)M_PI * 1.8f * t / 1e6f;
+        float ax = 0.3f * sinf(phase) + 0.01f * uniform();
+        float ay = 0.2f * cosf(phase) + 0.01f * uniform();
+        float az = 1.0f + 0.4f * sinf(2.0f * phase);
+        float gx = 40.0f * sinf(phase), gy = 25.0f * cosf(phase), gz = 5.0f * uniform();
+        int delivered = sim.advanceTo(t);
+        if (delivered > 0) {
+            ble.notificationsSent(delivered);
+        }
+        receiveAll(phone, MODE_STREAM, run, ble, nullptr);
+        ble.streamSamples(&ax, &ay, &az, &gx, &gy, &gz, &t, 1, (float)STREAM_RATE_HZ);
+    }
+    // Packets refused at the end go out as the link frees buffers
+    uint32_t endUs = STREAM_SECONDS * 1000000u + 1000000u;
+    for (uint32_t t = STREAM_SECONDS * 1000000u; t <= endUs; t += sim.getIntervalUs()) {
+        ble.flushStream();
+        int delivered = sim.advanceTo(t);
+        if (delivered > 0) {
+            ble.notificationsSent(delivered);
+        }
+        receiveAll(phone, MODE_STREAM, run, ble, nullptr);
+    }
+    run.seconds = (float)STREAM_SECONDS;
+}
+
+static void runBulk(GattServerSim& sim, GattSimSubscriber& phone, BLEManager& ble, Run& run) {
+    BulkTransferClient client(bulkStorage, RESULT_RECORD_SIZE, HISTORY_RECORDS, BULK_WINDOW);
+    ble.setBulkTransfer(true);
+    uint8_t message[BULK_CONTROL_MAX];
+    ble.handleBulkControl(message, client.request(message));
+    uint32_t now = 0;
+    while (!client.isComplete() && now < 600000000u) {
+        now += sim.getIntervalUs();
+        int delivered = sim.advanceTo(now);
+        if (delivered > 0) {
+            ble.notificationsSent(delivered);
+        }
+        receiveAll(phone, MODE_BULK, run, ble, &client);
+    }
+    run.complete = client.isComplete() && client.getReceived() == HISTORY_RECORDS;
+}
+
+static Run runMode(Mode mode, const GattLinkParams& link) {
+    Run run;
+    memset(&run, 0, sizeof(run));
+    run.complete = true;
+    BLEManager ble;
+    if (mode == MODE_BULK) {
+        for (int i = 0; i < HISTORY_RECORDS; i++) {
+            ble.updateCharacteristics(false, 0.1f, false, 0.0f, false, 0.0f, i * HOP_MS);
+        }
+    }
+    GattServerSim sim(link);
+    GattSimSubscriber phone;
+    if (!sim.listen(socketPath) || !phone.connect(socketPath)) {
+        run.complete = false;
+        return run;
+    }
+    ble.setGattServerSim(&sim);
+    if (mode == MODE_BATCHED || mode == MODE_CHANGE_ONLY) {
+        ble.setBatching(4, 15000);
+    }
+    if (mode == MODE_CHANGE_ONLY) {
+        ble.setNotificationPolicy(0.1f, 60000);
+    }
+    ble.setFeatureNotify(mode == MODE_FEATURES);
+    ble.connectionOpened(24, 0, 400);
+    
+    if (mode == MODE_STREAM) {
+        runStream(sim, phone, ble, run);
+    } else if (mode == MODE_BULK) {
+        runBulk(sim, phone, ble, run);
+    } else {
+        runWindows(sim, phone, ble, mode, run);
+    }
+    run.intervalUs = sim.getIntervalUs();
+    run.refused = ble.getStats().refused + ble.getStreamStats().refused + ble.getStats().pagesRefused;
+    if (!phone.isConnected() || sim.getStats().subscriberDrops > 0 || sim.getStats().dropped > 0) {
+        run.complete = false;
+    }
+    return run;
+}
+
+int main() {
+    printf("=== BLE link benchmark ===\n");
+    snprintf(socketPath, sizeof(socketPath), "/tmp/bench_ble_link_%d.sock", (int)getpid());
+    
+    const LinkCase links[] = {
+        {"MTU 23",                  {30000, 6, 27, 23, 8, 0.0f, true}},
+        {"MTU 247 + DLE",           {30000, 6, 251, 247, 8, 0.0f, true}},
+        {"MTU 247 + DLE, 10% loss", {30000, 6, 251, 247, 8, 0.1f, true}},
+        {"MTU 247 + DLE, no update", {30000, 6, 251, 247, 8, 0.0f, false}},
+    };
+    int failed = 0;
+    
+    printf("  %-22s %-25s %9s %9s %7s %11s %10s %7s\n", "mode", "link", "interval",
+           "B/s", "notif", "mean (ms)", "max (ms)", "refused");
+    for (int mode = 0; mode < MODES; mode++) {
+        for (const LinkCase& c : links) {
+            // BLEManager reports connection events on stdout; keep the table readable
+            fflush(stdout);
+            int saved = dup(1);
+            int quiet = open("/dev/null", O_WRONLY);
+            dup2(quiet, 1);
+            Run run = runMode((Mode)mode, c.link);
+            fflush(stdout);
+            dup2(saved, 1);
+            close(quiet);
+            close(saved);
+            
+            if (!run.complete) failed++;
+            printf("  %-22s %-25s %6.1f ms %9.1f %7lu %11.1f %10.1f %7lu%s\n", MODE_NAMES[mode],
+                   c.name, run.intervalUs / 1000.0f, run.seconds > 0.0f ? run.bytes / run.seconds : 0.0f,
+                   (unsigned long)run.notifications,
+                   run.samples ? run.totalLatencyUs / run.samples / 1000.0 : 0.0,
+                   run.maxLatencyUs / 1000.0f, (unsigned long)run.refused,
+                   run.complete ? "" : "  INCOMPLETE");
+        }
+    }
+    
+    printf("=== %s ===\n", failed ? "FAILED" : "DONE");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file bench_imu_stream_codec.cpp
+ * @brief Native bytes-per-second benchmark of the raw IMU stream codec
+ * 
+ * Streams 60s of 52Hz 6-axis frames for several motion types and reports
+ * the stream throughput against plain int16 frames and against a simple
+ * byte-aligned baseline (zigzag delta + varint), plus packets per second
+ * at 244-byte (247 MTU with DLE) and 182-byte (185 MTU) notifications and
+ * the encode/decode cost per frame. Every packet is decoded and compared,
+ * so the program fails if the codec loses data.
+ * 
+ * Build (native): g++ -O2 -DNATIVE_TEST_MODE -I../src bench_imu_stream_codec.cpp
+ *                 ../src/ImuStreamCodec.cpp
+ */
+
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include "../src/ImuStreamCodec.h"
+#include "test_util.h"
+
+static const int RATE_HZ = 52;
+static const int DURATION_S = 60;
+static const int FRAMES = RATE_HZ * DURATION_S;
+
+static uint32_t rng = 88172645u;
+
+static float noise(float amplitude) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return amplitude * ((rng >> 8) * (2.0f / 16777216.0f) - 1.0f);
+}
+
+enum Motion { REST, TREMOR, WALKING, DYSKINESIA, MOTION_COUNT };
+static const char* const MOTION_NAMES[MOTION_COUNT] = {"rest", "tremor 4.5Hz", "walking", "dyskinesia"};
+
+static int16_t frames[FRAMES][IMU_MAX_CHANNELS];
+static int16_t decoded[IMU_STREAM_MAX_FRAMES][IMU_MAX_CHANNELS];
+
+// LSM6DSL-like noise (about 1mg, 0.1dps) on top of the motion
+static void generate(int motion) {
+    for (int i = 0; i < FRAMES; i++) {
+        float t = (float)i / RATE_HZ;
+        float a[3] = {0.0f, 0.0f, 1.0f};
+        float g[3] = {0.0f, 0.0f, 0.0f};
+        switch (motion) {
+        case TREMOR:
+            a[0] += 0.2f * sinf(6.2832f * 4.5f * t);
+            g[2] += 30.0f * cosf(6.2832f * 4.5f * t);
+            break;
+        case WALKING:
+            a[2] += 0.3f * sinf(6.2832f * 1.8f * t) + 0.1f * sinf(6.2832f * 3.6f * t);
+            a[0] += 0.15f * sinf(6.2832f * 0.9f * t);
+            g[1] += 60.0f * sinf(6.2832f * 0.9f * t);
+            break;
+        case DYSKINESIA:
+            a[0] += 0.3f * sinf(6.2832f * 0.7f * t) + 0.15f * sinf(6.2832f * 6.0f * t);
+            a[1] += 0.25f * sinf(6.2832f * 1.3f * t + 1.0f);
+            g[0] += 80.0f * sinf(6.2832f * 1.1f * t);
+            g[2] += 40.0f * sinf(6.2832f * 6.0f * t);
+            break;
+        default:
+            break;
+        }
+        for (int c = 0; c < 3; c++) {
+            frames[i][c] = ImuStreamCodec::toCounts(a[c] + noise(0.001f), IMU_ACCEL_COUNTS_PER_G);
+            frames[i][3 + c] = ImuStreamCodec::toCounts(g[c] + noise(0.1f), IMU_GYRO_COUNTS_PER_DPS);
+        }
+    }
+}
+
+// Baseline: key frame, then zigzag deltas as LEB128 varints
+static int varintBytes() {
+    int bytes = IMU_MAX_CHANNELS * 2;
+    for (int i = 1; i < FRAMES; i++) {
+        for (int c = 0; c < IMU_MAX_CHANNELS; c++) {
+            int delta = frames[i][c] - frames[i - 1][c];
+            uint32_t code = (uint32_t)((delta << 1) ^ (delta >> 31));
+            do {
+                bytes++;
+                code >>= 7;
+            } while (code);
+        }
+    }
+    return bytes;
+}
+
+struct StreamResult {
+    int bytes;          // Encoded stream (bytes)
+    int packets;        // Notifications
+    double encodeNs;    // Encode time per frame
+    double decodeNs;    // Decode time per frame
+    bool exact;         // Every frame decoded bit-exact
+};
+
+static StreamResult stream(int capacity) {
+    StreamResult result = {0, 0, 0.0, 0.0, true};
+    uint8_t packet[256];
+    std::chrono::nanoseconds encodeTime(0), decodeTime(0);
+    int sent = 0;
+    while (sent < FRAMES) {
+        auto start = std::chrono::steady_clock::now();
+        int fit = ImuStreamCodec::fitFrames(frames + sent, FRAMES - sent, IMU_MAX_CHANNELS, capacity);
+        ImuStreamHeader header = {(uint16_t)result.packets, (uint32_t)(sent * 19231u), 0,
+                                  IMU_MAX_CHANNELS, RATE_HZ};
+        int length = ImuStreamCodec::encode(header, frames + sent, fit, packet, capacity);
+        auto middle = std::chrono::steady_clock::now();
+        ImuStreamHeader parsed;
+        int n = ImuStreamCodec::decode(packet, length, parsed, decoded, IMU_STREAM_MAX_FRAMES);
+        decodeTime += std::chrono::steady_clock::now() - middle;
+        encodeTime += middle - start;
+        if (fit < 1 || n != fit) {
+            result.exact = false;
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            for (int c = 0; c < IMU_MAX_CHANNELS; c++) {
+                result.exact &= decoded[i][c] == frames[sent + i][c];
+            }
+        }
+        result.bytes += length;
+        result.packets++;
+        sent += fit;
+    }
+    result.encodeNs = (double)encodeTime.count() / FRAMES;
+    result.decodeNs = (double)decodeTime.count() / FRAMES;
+    return result;
+}
+
+int main() {
+    printf("=== IMU stream codec benchmark: %ds of %dHz 6-axis frames ===\n", DURATION_S, RATE_HZ);
+    const double rawRate = (double)IMU_MAX_CHANNELS * 2 * RATE_HZ;
+    printf("%-14s %9s %9s %9s %8s %9s %8s %9s %9s\n", "motion", "raw B/s", "varint", "stream",
+           "ratio", "pkt/s 244", "pkt/s 182", "enc ns/fr", "dec ns/fr");
+    bool exact = true, smaller = true, beatsVarint = true;
+    for (int motion = 0; motion < MOTION_COUNT; motion++) {
+        generate(motion);
+        double varintRate = (double)varintBytes() / DURATION_S;
+        StreamResult large = stream(244);
+        StreamResult small = stream(182);
+        double rate = (double)large.bytes / DURATION_S;
+        printf("%-14s %9.0f %9.0f %9.0f %8.2f %9.2f %8.2f %9.0f %9.0f\n", MOTION_NAMES[motion],
+               rawRate, varintRate, rate, rate / rawRate,
+               (double)large.packets / DURATION_S, (double)small.packets / DURATION_S,
+               large.encodeNs, large.decodeNs);
+        exact &= large.exact && small.exact;
+        smaller &= rate < 0.75 * rawRate;
+        beatsVarint &= rate < varintRate;
+    }
+    check(exact, "every packet decodes bit-exact");
+    check(smaller, "stream below 75% of raw int16 for all motions");
+    check(beatsVarint, "bit packing beats byte-aligned varints");
+    
+    return testSummary();
+}
@@ -0,0 +1,102 @@
+/**
+ * @file test_advertising_schedule.cpp
+ * @brief Native test of the adaptive advertising schedule
+ * 
+ * Checks the fast and slow intervals, that fast advertising lasts 30 s
+ * and is followed by slow advertising that only ends when bonded with an
+ * idle stop set, that the time to connect is measured per phase, that a
+ * disconnect restarts fast advertising and that a detection resumes
+ * stopped advertising.
+ * 
+ * Build (native): g++ -DNATIVE_TEST_MODE -I../src test_advertising_schedule.cpp
+ *                 ../src/AdvertisingScheduler.cpp ../src/ConnectionParamManager.cpp
+ *                 ../src/BulkTransfer.cpp ../src/ImuStreamCodec.cpp
+ *                 ../src/GattServerSim.cpp ../src/BLEManager.cpp
+ */
+
+#include <cstdio>
+#include "../src/AdvertisingScheduler.h"
+#include "../src/BLEManager.h"
+#include "test_util.h"
+
+int main() {
+    printf("=== Advertising schedule test ===\n");
+    
+    // Apple accessory guidelines: 20 ms at first, then one of the listed
+    // longer intervals (1022.5 ms here)
+    const AdvertisingParams& fast = AdvertisingScheduler::getPhaseParams(ADV_FAST);
+    const AdvertisingParams& slow = AdvertisingScheduler::getPhaseParams(ADV_SLOW);
+    check(fast.minInterval == 32 && fast.maxInterval <= 48 && fast.minInterval <= fast.maxInterval,
+          "fast interval 20-30 ms");
+    check(slow.minInterval == 1636 && slow.maxInterval == 1636, "slow interval 1022.5 ms");
+    
+    // Boot: fast for 30 s, then slow until a connection
+    AdvertisingScheduler adv;
+    check(adv.getPhase() == ADV_IDLE && !adv.isAdvertising(), "idle before the first start");
+    adv.start(1000);
+    check(adv.getPhase() == ADV_FAST && adv.getPhaseDurationMs() == ADV_FAST_DURATION_MS,
+          "fast advertising limited to 30 s");
+    check(adv.phaseEnded(31000) && adv.getPhase() == ADV_SLOW && adv.getPhaseDurationMs() == 0,
+          "slow advertising without end when not bonded");
+    adv.connected(46000);
+    const AdvertisingStats& stats = adv.getStats();
+    check(adv.getPhase() == ADV_CONNECTED && stats.slowConnections == 1 &&
+          stats.lastConnectMs == 45000, "time to connect measured from the start, slow phase");
+    check(stats.fastMs == 30000 && stats.slowMs == 15000, "time spent per phase");
+    
+    // Disconnect: fast again, quick reconnect
+    adv.start(100000);
+    adv.connected(100400);
+    check(stats.fastConnections == 1 && stats.lastConnectMs == 400 && stats.maxConnectMs == 45000,
+          "reconnect during fast advertising");
+    check(adv.getMeanConnectMs() == 22700 && stats.starts == 2, "mean time to connect");
+    
+    // Bonded with an idle stop: slow advertising ends, a wake restarts fast
+    adv.setBonded(true);
+    adv.setIdleStop(1000000);
+    adv.start(200000);
+    adv.phaseEnded(230000);
+    check(adv.getPhaseDurationMs() == ADV_MAX_DURATION_MS, "idle stop clamped to the stack's limit");
+    check(!adv.phaseEnded(885350) && adv.getPhase() == ADV_STOPPED && stats.idleStops == 1,
+          "stopped when bonded and idle");
+    check(!adv.isAdvertising() && !adv.phaseEnded(900000), "stays stopped");
+    adv.connected(950000);
+    adv.start(960000);
+    check(stats.slowConnections == 1 && stats.fastConnections == 1 && !adv.wake(961000),
+          "no time to connect without advertising, wake only when stopped");
+    adv.phaseEnded(990000);
+    adv.phaseEnded(1645350);
+    check(adv.wake(1700000) && adv.getPhase() == ADV_FAST && stats.starts == 5,
+          "wake restarts fast advertising");
+    
+    // BLEManager: begin starts fast, the stack timeout moves to slow
+    BLEManager ble;
+    ble.begin();
+    const AdvertisingScheduler& managed = ble.getAdvertising();
+    check(managed.getPhase() == ADV_FAST && managed.getStats().starts == 1,
+          "begin advertises fast");
+    ble.advertisingEnded();
+    check(managed.getPhase() == ADV_SLOW, "slow after the fast phase ended");
+    ble.connectionOpened(24, 0, 400);
+    check(managed.getPhase() == ADV_CONNECTED && managed.getStats().slowConnections == 1,
+          "connection recorded");
+    ble.connectionClosed();
+    check(managed.getPhase() == ADV_FAST && managed.getStats().starts == 2,
+          "disconnect advertises fast again");
+    
+    // Bonded and idle: stops, quiet windows keep it stopped, a detection resumes it
+    ble.setBonded(true);
+    ble.setAdvertisingIdleStop(600000);
+    ble.advertisingEnded();
+    check(managed.getPhaseDurationMs() == 600000, "slow phase ends after the idle stop time");
+    ble.advertisingEnded();
+    check(managed.getPhase() == ADV_STOPPED, "advertising stopped when bonded and idle");
+    ble.updateCharacteristics(false, 0.1f, false, 0.0f, false, 0.0f, 3000);
+    check(managed.getPhase() == ADV_STOPPED, "quiet window does not resume advertising");
+    ble.updateCharacteristics(true, 0.8f, false, 0.0f, false, 0.0f, 6000);
+    check(managed.getPhase() == ADV_FAST && managed.getStats().starts == 3,
+          "detection resumes fast advertising");
+    ble.printStats();
+    
+    return testSummary();
+}
@@ -0,0 +1,47 @@
+/**
+ * @file test_analysis_wcet.cpp
+ * @brief Native run of the analysis WCET harness
+ * 
+ * Runs every adversarial input through the step-timed analysis and checks
+ * that all windows complete with valid intensities (NaN/inf inputs
+ * included), that the recorded distributions are consistent, that the
+ * default budgets hold, and that an impossible budget is reported as
+ * exceeded.
+ * 
+ * Build (native): g++ -O2 -DNATIVE_TEST_MODE -I../src test_analysis_wcet.cpp
+ *                 ../src/WcetHarness.cpp ../src/SymptomDetector.cpp ../src/FFTProcessor.cpp
+ */
+
+#include <cstdio>
+#include "../src/WcetHarness.h"
+#include "test_util.h"
+
+static const int RUNS_PER_INPUT = 32;
+
+static SymptomDetector detector;
+static WcetHarness harness(detector);
+
+int main() {
+    printf("=== Analysis WCET test ===\n");
+    detector.setSampleRate(52.0f);
+    harness.run(RUNS_PER_INPUT, 12345);
+    
+    bool ordered = true, recorded = true;
+    for (int row = 0; row < WcetHarness::ROWS; row++) {
+        WcetStats s = harness.getStats(row);
+        ordered &= s.median <= s.p99 && s.p99 <= s.max && s.mean <= s.max;
+        recorded &= s.max > 0;
+    }
+    WcetStats window = harness.getStats(WcetHarness::ROWS - 1);
+    WcetStats spectrum = harness.getStats(2);
+    check(recorded, "every step timed");
+    check(ordered, "median <= p99 <= max, mean <= max");
+    check(window.median > spectrum.median, "window takes longer than one step");
+    check(harness.getInvalidResults() == 0, "NaN/inf windows give valid intensities");
+    
+    check(harness.report(), "default budgets hold");
+    harness.setBudget(1, 1);
+    check(!harness.report(), "exceeded budget is reported");
+    
+    return testSummary();
+}
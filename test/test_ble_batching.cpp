@@ -0,0 +1,80 @@
+/**
+ * @file test_ble_batching.cpp
+ * @brief Native test for batched result notifications
+ * 
+ * Checks that records are held until the count or age bound, that a
+ * batch is split by the ATT MTU (2 records at the default 23 bytes, 24
+ * with a 247-byte MTU), that flush() sends a partial batch, and that the
+ * default configuration still sends every window at once.
+ * 
+ * Build (native): g++ -DNATIVE_TEST_MODE -I../src test_ble_batching.cpp
+ *                 ../src/ImuStreamCodec.cpp ../src/BulkTransfer.cpp
+ *                 ../src/AdvertisingScheduler.cpp ../src/ConnectionParamManager.cpp
+ *                 ../src/GattServerSim.cpp ../src/BLEManager.cpp
+ */
+
+#include <cstdio>
+#include "../src/BLEManager.h"
+#include "test_util.h"
+
+static void sendWindows(BLEManager& ble, int count, uint32_t& timeMs) {
+    for (int i = 0; i < count; i++) {
+        timeMs += 3000;
+        ble.updateCharacteristics(false, 0.1f, false, 0.0f, false, 0.0f, timeMs);
+    }
+}
+
+int main() {
+    printf("=== BLE batching test ===\n");
+    uint32_t timeMs = 0;
+    
+    // Default: one notification per window
+    BLEManager single;
+    sendWindows(single, 5, timeMs);
+    check(single.getStats().notifications == 5 && single.getStats().bytesSent == 50,
+          "unbatched: one notification per window");
+    
+    // Count bound at the default MTU: 4 windows go out as 2 x 2 records
+    BLEManager small;
+    small.setBatching(4, 60000);
+    check(small.getBatchCapacity() == 2, "default MTU carries 2 records");
+    sendWindows(small, 3, timeMs);
+    check(small.getStats().notifications == 0, "records held below the count bound");
+    sendWindows(small, 1, timeMs);
+    check(small.getStats().notifications == 2 && small.getStats().bytesSent == 40,
+          "count bound sends the batch split by MTU");
+    
+    // Negotiated MTU with DLE: 24 windows in one notification
+    BLEManager large;
+    large.setAttMtu(247);
+    large.setBatching(MAX_BATCH_RECORDS, 3600000);
+    check(large.getBatchCapacity() == MAX_BATCH_RECORDS, "247-byte MTU carries 24 records");
+    sendWindows(large, 48, timeMs);
+    check(large.getStats().notifications == 2 && large.getStats().bytesSent == 480,
+          "48 windows in 2 notifications");
+    large.setAttMtu(517);
+    check(large.getBatchCapacity() == MAX_BATCH_RECORDS, "payload capped at one DLE packet");
+    
+    // Age bound: windows 5s apart, 10s bound -> sent with the third window
+    BLEManager aged;
+    aged.setAttMtu(247);
+    aged.setBatching(10, 10000);
+    for (int i = 0; i < 3; i++) {
+        timeMs += 5000;
+        aged.updateCharacteristics(false, 0.0f, false, 0.0f, false, 0.0f, timeMs);
+    }
+    check(aged.getStats().notifications == 1 && aged.getStats().bytesSent == 30,
+          "age bound sends early");
+    
+    // flush(): partial batch out, nothing left behind
+    sendWindows(aged, 2, timeMs);
+    aged.flush();
+    check(aged.getStats().notifications == 2 && aged.getStats().bytesSent == 50,
+          "flush sends the partial batch");
+    aged.flush();
+    check(aged.getStats().notifications == 2, "flush of an empty queue sends nothing");
+    
+    large.printStats();
+    
+    return testSummary();
+}
@@ -0,0 +1,93 @@
+/**
+ * @file test_ble_notification_policy.cpp
+ * @brief Native test for the change-only notification policy
+ * 
+ * Checks that unchanged windows are suppressed and counted, that
+ * detection changes are sent at once (bypassing batching), that intensity
+ * changes beyond the delta and keep-alives are sent, that slow drift is
+ * measured against the last record sent, and the reduction for a stable
+ * patient over an hour of windows.
+ * 
+ * Build (native): g++ -DNATIVE_TEST_MODE -I../src test_ble_notification_policy.cpp
+ *                 ../src/ImuStreamCodec.cpp ../src/BulkTransfer.cpp
+ *                 ../src/AdvertisingScheduler.cpp ../src/ConnectionParamManager.cpp
+ *                 ../src/GattServerSim.cpp ../src/BLEManager.cpp
+ */
+
+#include <cstdio>
+#include "../src/BLEManager.h"
+#include "test_util.h"
+
+static uint32_t timeMs = 0;
+
+static void window(BLEManager& ble, bool tremor, float tremorIntensity) {
+    timeMs += 3000;
+    ble.updateCharacteristics(tremor, tremorIntensity, false, 0.05f, false, 0.0f, timeMs);
+}
+
+int main() {
+    printf("=== BLE notification policy test ===\n");
+    
+    // Default policy: every window sent
+    BLEManager all;
+    for (int i = 0; i < 10; i++) {
+        window(all, false, 0.2f);
+    }
+    check(all.getStats().notifications == 10 && all.getStats().suppressed == 0,
+          "policy off: every window sent");
+    
+    BLEManager ble;
+    ble.setNotificationPolicy(0.1f, 60000);
+    window(ble, false, 0.20f);
+    check(ble.getStats().notifications == 1, "first window sent");
+    window(ble, false, 0.22f);
+    window(ble, false, 0.25f);
+    check(ble.getStats().notifications == 1 && ble.getStats().suppressed == 2,
+          "small changes suppressed and counted");
+    window(ble, false, 0.32f);
+    check(ble.getStats().notifications == 2, "drift beyond delta of last sent record sent");
+    window(ble, true, 0.35f);
+    check(ble.getStats().notifications == 3 && (ble.getLastRecord().flags & RESULT_TREMOR),
+          "detection change sent");
+    for (int i = 0; i < 19; i++) {
+        window(ble, true, 0.35f);
+    }
+    check(ble.getStats().notifications == 3, "stable detection suppressed");
+    window(ble, true, 0.35f);
+    check(ble.getStats().notifications == 4, "keep-alive after 60s");
+    
+    // Detection changes bypass the batch bounds
+    BLEManager batched;
+    batched.setBatching(8, 60000);
+    batched.setNotificationPolicy(0.1f, 60000);
+    window(batched, false, 0.1f);
+    window(batched, false, 0.5f);
+    check(batched.getStats().notifications == 0, "intensity changes wait for the batch");
+    window(batched, true, 0.5f);
+    check(batched.getStats().notifications == 2 && batched.getStats().bytesSent == 30,
+          "detection change flushes the batch at once");
+    
+    // Suppressed windows still age the queue
+    window(batched, true, 0.9f);
+    int windows = 0;
+    while (windows < 30 && batched.getStats().notifications == 2) {
+        window(batched, true, 0.9f);
+        windows++;
+    }
+    check(windows == 20, "age bound reached while suppressing");
+    
+    // An hour of a stable patient: 1200 windows of small noise
+    BLEManager stable;
+    stable.setNotificationPolicy(0.1f, 60000);
+    for (int i = 0; i < 1200; i++) {
+        window(stable, false, 0.15f + 0.03f * ((i * 7) % 5) / 4.0f);
+    }
+    const BleStats& stats = stable.getStats();
+    printf("  stable hour: %lu windows, %lu notifications, %lu suppressed\n",
+           (unsigned long)stats.windows, (unsigned long)stats.notifications,
+           (unsigned long)stats.suppressed);
+    check(stats.notifications * 10 <= stats.windows, "10x fewer notifications when stable");
+    check(stats.notifications + stats.suppressed == stats.windows, "every window accounted");
+    
+    return testSummary();
+}
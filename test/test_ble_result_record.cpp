@@ -0,0 +1,60 @@
+/**
+ * @file test_ble_result_record.cpp
+ * @brief Native test for the packed BLE result record
+ * 
+ * Checks the wire layout (flags, intensity bytes, little-endian sequence
+ * and timestamp), the pack/unpack round trip, intensity clamping and that
+ * BLEManager numbers consecutive windows.
+ * 
+ * Build (native): g++ -DNATIVE_TEST_MODE -I../src test_ble_result_record.cpp
+ *                 ../src/ImuStreamCodec.cpp ../src/BulkTransfer.cpp
+ *                 ../src/AdvertisingScheduler.cpp ../src/ConnectionParamManager.cpp
+ *                 ../src/GattServerSim.cpp ../src/BLEManager.cpp
+ */
+
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include "../src/BLEManager.h"
+#include "test_util.h"
+
+int main() {
+    printf("=== BLE result record test ===\n");
+    
+    // Wire layout
+    ResultRecord record = {RESULT_TREMOR | RESULT_FOG, 10, 20, 30, 0x1234, 0xA1B2C3D4};
+    uint8_t packed[RESULT_RECORD_SIZE];
+    BLEManager::packResult(record, packed);
+    const uint8_t expected[RESULT_RECORD_SIZE] = {0x05, 10, 20, 30, 0x34, 0x12,
+                                                  0xD4, 0xC3, 0xB2, 0xA1};
+    check(memcmp(packed, expected, RESULT_RECORD_SIZE) == 0, "little-endian wire layout");
+    
+    ResultRecord parsed;
+    BLEManager::unpackResult(packed, parsed);
+    check(parsed.flags == record.flags && parsed.tremorIntensity == 10 &&
+          parsed.dyskinesiaIntensity == 20 && parsed.fogIntensity == 30 &&
+          parsed.sequence == 0x1234 && parsed.timestampMs == 0xA1B2C3D4, "round trip");
+    
+    // Intensity encoding
+    check(BLEManager::intensityByte(0.0f) == 0 && BLEManager::intensityByte(1.0f) == 255,
+          "0.0 and 1.0 map to 0 and 255");
+    check(BLEManager::intensityByte(0.5f) == 128, "intensity rounded");
+    check(BLEManager::intensityByte(-0.2f) == 0 && BLEManager::intensityByte(1.7f) == 255 &&
+          BLEManager::intensityByte(NAN) == 0, "out-of-range and NaN clamped");
+    
+    // Consecutive windows
+    BLEManager ble;
+    ble.begin();
+    ble.updateCharacteristics(true, 0.8f, false, 0.1f, false, 0.0f, 3000);
+    ResultRecord first = ble.getLastRecord();
+    ble.updateCharacteristics(false, 0.2f, true, 0.9f, true, 0.6f, 6000);
+    ResultRecord second = ble.getLastRecord();
+    check(first.flags == RESULT_TREMOR && first.tremorIntensity == 204 &&
+          first.timestampMs == 3000, "record holds the window results");
+    check(second.flags == (RESULT_DYSKINESIA | RESULT_FOG) && second.fogIntensity == 153,
+          "detection bits per symptom");
+    check((uint16_t)(second.sequence - first.sequence) == 1 && second.timestampMs == 6000,
+          "sequence advances per window");
+    
+    return testSummary();
+}
@@ -0,0 +1,201 @@
+/**
+ * @file test_bulk_transfer.cpp
+ * @brief Native test for the paged bulk history transfer
+ * 
+ * Checks the record log ring, a complete transfer through the loopback
+ * link, that the server never sends more SDUs than it was granted, that
+ * a transfer cut by a disconnect resumes without loss or duplicates,
+ * that records overwritten while disconnected are reported as skipped,
+ * rejection of malformed messages, and the BLEManager history download.
+ * 
+ * Build (native): g++ -DNATIVE_TEST_MODE -I../src test_bulk_transfer.cpp
+ *                 ../src/BulkTransfer.cpp ../src/ImuStreamCodec.cpp
+ *                 ../src/AdvertisingScheduler.cpp ../src/ConnectionParamManager.cpp
+ *                 ../src/GattServerSim.cpp ../src/BLEManager.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include "../src/BulkTransfer.h"
+#include "../src/BLEManager.h"
+#include "test_util.h"
+
+const int RECORD_SIZE = 10;
+const int LOG_RECORDS = 1200;
+
+static uint8_t logStorage[LOG_RECORDS * RECORD_SIZE];
+static uint8_t received[2 * LOG_RECORDS * RECORD_SIZE];
+
+// Record i carries its index in the first four bytes
+static void makeRecord(uint32_t index, uint8_t* out) {
+    for (int b = 0; b < RECORD_SIZE; b++) {
+        out[b] = (uint8_t)((b < 4) ? (index >> (8 * b)) : (index * 31 + b));
+    }
+}
+
+static void fillLog(RecordLog& log, int count) {
+    uint8_t record[RECORD_SIZE];
+    for (int i = 0; i < count; i++) {
+        makeRecord(log.getEndIndex(), record);
+        log.append(record);
+    }
+}
+
+// Received records are the log indices first..first+count-1, in order
+static bool receivedInOrder(const BulkTransferClient& client, uint32_t first, int count) {
+    if (client.getReceived() != count) return false;
+    uint8_t expected[RECORD_SIZE];
+    for (int i = 0; i < count; i++) {
+        makeRecord(first + i, expected);
+        if (memcmp(client.getRecord(i), expected, RECORD_SIZE) != 0) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Channel that only counts SDUs (nothing is delivered)
+ */
+class CountingChannel : public BulkChannel {
+public:
+    int sdus = 0;
+    int getMaxSdu() const override { return 244; }
+    bool sendSdu(const uint8_t*, int) override { sdus++; return true; }
+};
+
+int main() {
+    printf("=== Bulk transfer test ===\n");
+    
+    // Record log ring
+    uint8_t small[4 * RECORD_SIZE];
+    RecordLog ring(small, RECORD_SIZE, 4);
+    fillLog(ring, 6);
+    uint8_t out[8 * RECORD_SIZE];
+    uint8_t expected[RECORD_SIZE];
+    makeRecord(2, expected);
+    check(ring.getFirstIndex() == 2 && ring.getEndIndex() == 6, "ring keeps the newest records");
+    check(ring.read(1, out, 8) == 0 && ring.read(6, out, 8) == 0, "overwritten and future indices not read");
+    check(ring.read(2, out, 8) == 4 && memcmp(out, expected, RECORD_SIZE) == 0,
+          "read stops at the end of the log");
+    
+    // Complete transfer over the loopback link
+    LinkModel link = {15000, 6, 251, 244};
+    RecordLog log(logStorage, RECORD_SIZE, LOG_RECORDS);
+    fillLog(log, LOG_RECORDS);
+    {
+        BulkTransferServer server(log);
+        BulkTransferClient client(received, RECORD_SIZE, 2 * LOG_RECORDS, 4);
+        LoopbackBulkChannel channel(link, server, client);
+        channel.connect();
+        channel.run(100000);
+        check(client.isComplete() && receivedInOrder(client, 0, LOG_RECORDS),
+              "full history received in order");
+        check(server.getStats().completed == 1 && server.getStats().pages == 53,
+              "23 records per 244-byte page");
+        printf("  1200 records: %.2f s link time, %lu LL packets\n",
+               channel.getElapsedUs() / 1e6f, (unsigned long)channel.getPackets());
+    }
+    
+    // Credits bound the SDUs in flight
+    {
+        BulkTransferServer server(log);
+        CountingChannel counter;
+        server.setChannel(&counter);
+        uint8_t request[BULK_CONTROL_MAX] = {BULK_OP_REQUEST, 0, 0, 0, 0, 3, 0};
+        check(server.handleControl(request, 7) && counter.sdus == 3 && server.getCredits() == 0,
+              "3 credits send 3 pages");
+        uint8_t credit[3] = {BULK_OP_CREDIT, 2, 0};
+        server.handleControl(credit, 3);
+        check(counter.sdus == 5 && server.getNextIndex() == 5 * 23, "CREDIT releases 2 more pages");
+        uint8_t abortMessage[1] = {BULK_OP_ABORT};
+        server.handleControl(abortMessage, 1);
+        server.handleControl(credit, 3);
+        check(counter.sdus == 5 && !server.isActive(), "nothing sent after ABORT");
+        check(!server.handleControl(request, 6) && !server.handleControl(credit, 1),
+              "malformed control messages rejected");
+        server.setChannel(nullptr);
+        check(!server.handleControl(request, 7), "control rejected without a channel");
+    }
+    
+    // Disconnect mid-transfer, then resume
+    {
+        BulkTransferServer server(log);
+        BulkTransferClient client(received, RECORD_SIZE, 2 * LOG_RECORDS, 8);
+        LoopbackBulkChannel channel(link, server, client);
+        channel.connect();
+        channel.run(5);
+        uint32_t partial = client.getNextIndex();
+        channel.disconnect();
+        check(partial > 0 && partial < LOG_RECORDS && !client.isComplete(),
+              "disconnect leaves a partial transfer");
+        channel.connect();
+        channel.run(100000);
+        check(client.isComplete() && receivedInOrder(client, 0, LOG_RECORDS) &&
+              client.getDuplicates() == 0 && client.getSkipped() == 0,
+              "resumed transfer: every record once, in order");
+        check(server.getStats().transfers == 2, "resume is a second REQUEST");
+    }
+    
+    // History overwritten while disconnected
+    {
+        uint8_t shortStorage[100 * RECORD_SIZE];
+        RecordLog shortLog(shortStorage, RECORD_SIZE, 100);
+        fillLog(shortLog, 100);
+        BulkTransferServer server(shortLog);
+        BulkTransferClient client(received, RECORD_SIZE, 2 * LOG_RECORDS, 1);
+        LoopbackBulkChannel channel(link, server, client);
+        channel.connect();
+        channel.run(2);
+        channel.disconnect();
+        uint32_t partial = client.getNextIndex();
+        fillLog(shortLog, 150);
+        channel.connect();
+        channel.run(100000);
+        check(client.isComplete() && client.getNextIndex() == 250 &&
+              client.getSkipped() == 150 - partial, "overwritten records reported as skipped");
+    }
+    
+    // Credit window larger than the link queue: refused SDUs are retried
+    {
+        BulkTransferServer server(log);
+        BulkTransferClient client(received, RECORD_SIZE, 2 * LOG_RECORDS, 64);
+        LinkModel narrow = {15000, 6, 27, 20};
+        LoopbackBulkChannel channel(narrow, server, client);
+        channel.connect();
+        channel.run(1000000);
+        check(client.isComplete() && receivedInOrder(client, 0, LOG_RECORDS),
+              "small SDUs, queue overflow: nothing lost");
+    }
+    
+    // Malformed data SDUs
+    {
+        BulkTransferClient client(received, RECORD_SIZE, 10, 4);
+        uint8_t reply[BULK_CONTROL_MAX];
+        uint8_t page[BULK_PAGE_HEADER_SIZE + RECORD_SIZE] = {BULK_OP_PAGE, 0, 0, 0, 0, 1, 9};
+        check(client.receive(page, sizeof(page), reply) < 0, "wrong record size rejected");
+        page[6] = RECORD_SIZE;
+        check(client.receive(page, sizeof(page) - 1, reply) < 0, "truncated page rejected");
+        check(client.receive(page, sizeof(page), reply) >= 0 && client.getReceived() == 1,
+              "valid page accepted");
+    }
+    
+    // BLEManager: every window, notified or not, can be downloaded
+    BLEManager ble;
+    ble.setAttMtu(247);
+    ble.setNotificationPolicy(0.1f, 60000);
+    for (int i = 0; i < 30; i++) {
+        ble.updateCharacteristics(false, 0.2f, false, 0.0f, false, 0.0f, 3000u * (i + 1));
+    }
+    check(ble.getHistory().getEndIndex() == 30 && ble.getStats().notifications < 30,
+          "suppressed windows kept in the history");
+    uint8_t request[BULK_CONTROL_MAX] = {BULK_OP_REQUEST, 0, 0, 0, 0, 8, 0};
+    check(!ble.handleBulkControl(request, 7), "request refused before the phone subscribes");
+    ble.setBulkTransfer(true);
+    check(ble.handleBulkControl(request, 7), "request accepted");
+    const BulkStats& bulk = ble.getBulkStats();
+    check(bulk.completed == 1 && bulk.records == 30 && bulk.pages == 2,
+          "30 records in 2 pages, then END");
+    ble.printStats();
+    ble.setBulkTransfer(false);
+    
+    return testSummary();
+}
@@ -0,0 +1,129 @@
+/**
+ * @file test_connection_params.cpp
+ * @brief Native test of the adaptive connection parameters
+ * 
+ * Checks that every profile meets the phone-side limits, that a fresh
+ * connection moves to the summary profile only after the relax delay,
+ * that streaming and bulk download get their short intervals at once,
+ * that the summary profile is requested from update() when no windows
+ * arrive, that a rejected request is not repeated, and that a disconnect
+ * stops streaming and bulk transfer and resets the link.
+ * 
+ * Build (native): g++ -DNATIVE_TEST_MODE -I../src test_connection_params.cpp
+ *                 ../src/AdvertisingScheduler.cpp ../src/ConnectionParamManager.cpp
+ *                 ../src/BulkTransfer.cpp ../src/ImuStreamCodec.cpp
+ *                 ../src/GattServerSim.cpp ../src/BLEManager.cpp
+ */
+
+#include <cstdio>
+#include "../src/ConnectionParamManager.h"
+#include "../src/BLEManager.h"
+#include "test_util.h"
+
+static uint32_t timeMs = 0;
+
+static void windows(BLEManager& ble, int count) {
+    for (int i = 0; i < count; i++) {
+        timeMs += 3000;
+        ble.setClockMs(timeMs);
+        ble.updateCharacteristics(false, 0.1f, false, 0.0f, false, 0.0f, timeMs);
+    }
+}
+
+// Accept the last request as the central would, at the slowest interval allowed
+static void acceptProfile(BLEManager& ble, LinkProfile profile) {
+    const ConnectionParams& p = ConnectionParamManager::getProfileParams(profile);
+    ble.connectionUpdated(true, p.maxInterval, p.slaveLatency, p.supervisionTimeout);
+}
+
+int main() {
+    printf("=== Connection parameter test ===\n");
+    
+    // Phone-side limits: max x (latency + 1) <= 2 s, min + 15 ms <= max,
+    // timeout > 3 x max x (latency + 1), latency <= 30
+    bool withinLimits = true;
+    for (int i = 0; i < LINK_PROFILES; i++) {
+        const ConnectionParams& p = ConnectionParamManager::getProfileParams((LinkProfile)i);
+        float maxMs = p.maxInterval * 1.25f;
+        float effectiveMs = maxMs * (p.slaveLatency + 1);
+        withinLimits = withinLimits && p.minInterval >= 12 && effectiveMs <= 2000.0f &&
+                       p.minInterval * 1.25f + 15.0f <= maxMs && p.slaveLatency <= 30 &&
+                       p.supervisionTimeout * 10.0f > 3.0f * effectiveMs &&
+                       p.supervisionTimeout <= 600;
+    }
+    check(withinLimits, "profiles within phone connection parameter limits");
+    check(ConnectionParamManager::satisfies(LINK_SUMMARY, 256, 5) &&
+          !ConnectionParamManager::satisfies(LINK_SUMMARY, 256, 0) &&
+          !ConnectionParamManager::satisfies(LINK_BULK, 40, 0), "profile matching");
+    
+    // Fresh connection at 30 ms: summary requested after the relax delay
+    BLEManager ble;
+    ble.setClockMs(timeMs);
+    windows(ble, 1);
+    ble.connectionOpened(24, 0, 400);
+    const LinkStats& stats = ble.getLinkManager().getStats();
+    windows(ble, 3);
+    check(stats.requests == 0, "no request during the relax delay after connecting");
+    windows(ble, 1);
+    check(stats.requests == 1, "summary requested after the relax delay");
+    windows(ble, 2);
+    check(stats.requests == 1, "no second request while the first is outstanding");
+    acceptProfile(ble, LINK_SUMMARY);
+    check(ble.getLinkManager().getInterval() == 256 && ble.getLinkManager().getLatency() == 5,
+          "summary profile in use");
+    windows(ble, 10);
+    check(stats.requests == 1, "no request while the profile is satisfied");
+    
+    // Streaming: short interval requested at once
+    ble.setAttMtu(247);
+    ble.setStreaming(true);
+    check(stats.requests == 2 && ble.getLinkManager().getDemand() == LINK_STREAMING,
+          "streaming requested at once");
+    acceptProfile(ble, LINK_STREAMING);
+    
+    // Bulk download overrides streaming, and ends with the transfer
+    ble.setBulkTransfer(true);
+    check(stats.requests == 2, "subscribing alone does not change the profile");
+    uint8_t request[BULK_CONTROL_MAX] = {BULK_OP_REQUEST, 0, 0, 0, 0, 1, 0};
+    ble.handleBulkControl(request, 7);
+    check(stats.requests == 3 && ble.getLinkManager().getDemand() == LINK_BULK,
+          "bulk download requested at once");
+    acceptProfile(ble, LINK_BULK);
+    uint8_t credit[3] = {BULK_OP_CREDIT, 4, 0};
+    ble.handleBulkControl(credit, 3);
+    check(ble.getLinkManager().getDemand() == LINK_STREAMING && stats.requests == 3,
+          "back to streaming when the download ends (30 ms already satisfies it)");
+    
+    // Streaming stops and no windows follow (activity gating): the relax
+    // delay runs on the clock, then a rejected summary is not retried
+    ble.setStreaming(false);
+    timeMs += LINK_RELAX_DELAY_MS - 1;
+    ble.setClockMs(timeMs);
+    ble.update();
+    check(stats.requests == 3 &&
+          ble.getLinkManager().msUntilRequest(timeMs) == 1, "summary waits for the relax delay");
+    timeMs += 1;
+    ble.setClockMs(timeMs);
+    ble.update();
+    check(stats.requests == 4, "summary requested by update() without windows");
+    ble.connectionUpdated(false, 0, 0, 0);
+    windows(ble, 20);
+    check(stats.rejected == 1 && stats.requests == 4 && ble.getLinkManager().getInterval() == 24,
+          "rejected request not repeated, parameters kept");
+    
+    // Disconnect resets the link and stops subscriptions
+    ble.setStreaming(true);
+    ble.connectionClosed();
+    check(!ble.isConnected() && !ble.isStreaming() && ble.getAttMtu() == ATT_DEFAULT_MTU,
+          "disconnect stops streaming and resets the MTU");
+    check(!ble.handleBulkControl(request, 7), "bulk channel closed by the disconnect");
+    windows(ble, 10);
+    uint32_t before = stats.requests;
+    ble.connectionOpened(256, 5, 600);
+    windows(ble, 10);
+    check(stats.connections == 2 && stats.requests == before,
+          "reconnect with summary parameters: nothing to request");
+    ble.printStats();
+    
+    return testSummary();
+}
@@ -0,0 +1,275 @@
+/**
+ * @file test_gatt_server_sim.cpp
+ * @brief Native test of the simulated GATT server and link
+ * 
+ * Checks LL segmentation and delivery times, the packets-per-event and
+ * event-length limits, silent drops when the stack buffers are full,
+ * that lost packets are sent again, connection parameter requests, the
+ * socket frame a subscriber receives, and BLEManager sending results,
+ * switching the interval, refusing notifications beyond the link's
+ * buffers itself and retrying the refused bulk pages, results and raw
+ * stream packets, and streaming the accelerometer alone at the default
+ * MTU through the simulator.
+ * 
+ * Build (native): g++ -DNATIVE_TEST_MODE -I../src test_gatt_server_sim.cpp
+ *                 ../src/GattServerSim.cpp ../src/AdvertisingScheduler.cpp
+ *                 ../src/ConnectionParamManager.cpp ../src/BulkTransfer.cpp
+ *                 ../src/ImuStreamCodec.cpp ../src/BLEManager.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include "../src/GattServerSim.h"
+#include "../src/BLEManager.h"
+#include "test_util.h"
+
+static uint8_t payload[GATT_SIM_MAX_PAYLOAD];
+static uint8_t bulkStorage[HISTORY_RECORDS * RESULT_RECORD_SIZE];
+
+int main() {
+    printf("=== GATT server simulator test ===\n");
+    for (int i = 0; i < GATT_SIM_MAX_PAYLOAD; i++) {
+        payload[i] = (uint8_t)(i * 13 + 1);
+    }
+    
+    // Segmentation: 7 bytes of ATT and L2CAP headers on every notification
+    check(GattServerSim::packetsFor(20, 27) == 1 && GattServerSim::packetsFor(21, 27) == 2 &&
+          GattServerSim::packetsFor(244, 27) == 10 && GattServerSim::packetsFor(244, 251) == 1,
+          "LL packets per notification");
+    check(GattServerSim::packetTimeUs(27) == 676 && GattServerSim::packetTimeUs(251) == 2468,
+          "packet and acknowledgement air time on the 1M PHY");
+    
+    // 244 bytes without DLE at 4 packets per event: 4 + 4 + 2 packets
+    GattLinkParams slow = {50000, 4, 27, 247, 4, 0.0f, true};
+    GattServerSim sim(slow);
+    check(sim.notify(SIM_CHAR_RESULT, payload, 244), "notification accepted");
+    sim.advanceTo(99999);
+    check(sim.getQueued() == 1 && sim.getStats().packets == 8, "two events carry 8 packets");
+    check(sim.advanceTo(100000) == 1 && sim.getQueued() == 0, "delivered in the third event");
+    uint32_t expectedUs = 100000 + GattServerSim::packetTimeUs(27) + GattServerSim::packetTimeUs(8);
+    check(sim.getStats().maxQueueUs == expectedUs && sim.getStats().bytes == 244,
+          "delivery time at the end of the last packet");
+    
+    // Dropped while every buffer is in use, yet accepted as the stack does
+    for (int i = 0; i < 4; i++) {
+        sim.notify(SIM_CHAR_RESULT, payload, 20);
+    }
+    check(sim.notify(SIM_CHAR_RESULT, payload, 20) && sim.getStats().dropped == 1 &&
+          sim.getQueued() == 4, "dropped silently with all buffers in use");
+    check(!sim.notify(SIM_CHAR_RESULT, payload, 245) && sim.getStats().dropped == 1,
+          "payload above the MTU rejected");
+    check(sim.advanceTo(150000) == 4 && sim.notify(SIM_CHAR_RESULT, payload, 20) &&
+          sim.getQueued() == 1, "buffers free after delivery");
+    
+    // Event length: at 7.5 ms only 3 DLE packets fit
+    GattLinkParams fast = {7500, 20, 251, 247, 8, 0.0f, false};
+    GattServerSim dle(fast);
+    for (int i = 0; i < 8; i++) {
+        dle.notify(SIM_CHAR_BULK_DATA, payload, 244);
+    }
+    check(dle.advanceTo(0) == 3 && dle.advanceTo(7500) == 3, "event length limits packets");
+    check(!dle.requestInterval(30000) && dle.getIntervalUs() == 7500,
+          "parameter request refused by the central");
+    check(sim.requestInterval(30000) && sim.getIntervalUs() == 30000 &&
+          sim.getStats().parameterUpdates == 1, "parameter request accepted");
+    
+    // Loss: every notification arrives, lost packets are sent again
+    GattLinkParams lossy = {15000, 6, 251, 247, 16, 0.2f, true};
+    GattServerSim lossSim(lossy);
+    uint32_t t = 0;
+    for (int i = 0; i < 200; i++) {
+        lossSim.notify(SIM_CHAR_RESULT, payload, 20);
+        t += 15000;
+        lossSim.advanceTo(t);
+    }
+    lossSim.advanceTo(t + 1000000);
+    const GattSimStats& lossStats = lossSim.getStats();
+    printf("  %lu packets, %lu retransmissions\n", (unsigned long)lossStats.packets,
+           (unsigned long)lossStats.retransmissions);
+    check(lossStats.notifications == 200 && lossStats.packets == 200 + lossStats.retransmissions,
+          "all delivered, lost packets sent again");
+    check(lossStats.retransmissions > 20 && lossStats.retransmissions < 80,
+          "retransmissions near the loss rate");
+    
+    // Socket: one frame per delivered notification
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/gatt_sim_test_%d.sock", (int)getpid());
+    GattServerSim server(slow);
+    GattSimSubscriber subscriber;
+    check(server.listen(path) && subscriber.connect(path), "subscriber connected");
+    server.advanceTo(1000);
+    check(server.getSubscribers() == 1, "subscriber accepted");
+    server.notify(SIM_CHAR_FEATURE, payload, 18);
+    server.advanceTo(50000);
+    GattSimNotification n;
+    check(subscriber.receive(n) && n.characteristic == SIM_CHAR_FEATURE && n.length == 18 &&
+          memcmp(n.data, payload, 18) == 0, "frame carries characteristic and payload");
+    check(n.queuedUs == 1000 && n.deliveredUs == 50000 + GattServerSim::packetTimeUs(25),
+          "frame carries write and delivery times");
+    check(!subscriber.receive(n), "nothing more");
+    
+    // BLEManager through the simulator
+    GattLinkParams phone = {30000, 6, 251, 247, 2, 0.0f, true};
+    GattServerSim link(phone);
+    link.listen(path);
+    subscriber.connect(path);
+    BLEManager ble;
+    ble.setGattServerSim(&link);
+    ble.connectionOpened(24, 0, 400);
+    check(ble.getAttMtu() == 247, "MTU taken from the simulator");
+    link.advanceTo(1000);
+    ble.updateCharacteristics(true, 0.5f, false, 0.0f, false, 0.0f, 1);
+    ble.notificationsSent(link.advanceTo(30000));
+    ResultRecord record;
+    check(subscriber.receive(n) && n.characteristic == SIM_CHAR_RESULT &&
+          n.length == RESULT_RECORD_SIZE, "result notified");
+    BLEManager::unpackResult(n.data, record);
+    check(record.timestampMs == 1 && record.tremorIntensity == 128, "result record received");
+    
+    // Windows fill the history; they do not move the link's clock
+    for (int i = 2; i <= 101; i++) {
+        ble.updateCharacteristics(false, 0.0f, false, 0.0f, false, 0.0f, 3000 * i);
+    }
+    check(link.getIntervalUs() == 30000, "no relax on window times");
+    
+    // Parameter requests go to the simulated central, timed by its clock
+    // even without windows
+    uint32_t now = LINK_RELAX_DELAY_MS * 1000u;
+    ble.notificationsSent(link.advanceTo(now - 1000));
+    ble.update();
+    check(link.getIntervalUs() == 30000, "no request during the relax delay");
+    ble.notificationsSent(link.advanceTo(now));
+    ble.update();
+    check(link.getIntervalUs() == 320000 && ble.getLinkManager().getInterval() == 256,
+          "summary interval applied after the relax delay");
+    now += 30000;
+    ble.notificationsSent(link.advanceTo(now));
+    check(link.getQueued() == 0 && ble.getStats().dropped > 0 && link.getStats().dropped == 0,
+          "refused results sent, the oldest left to the history");
+    while (subscriber.receive(n)) {
+    }
+    
+    // Bulk: two buffers, eight credits; refused pages wait for notificationsSent()
+    ble.setBulkTransfer(true);
+    BulkTransferClient client(bulkStorage, RESULT_RECORD_SIZE, HISTORY_RECORDS, 8);
+    uint8_t message[BULK_CONTROL_MAX];
+    ble.handleBulkControl(message, client.request(message));
+    check(link.getIntervalUs() == 30000, "bulk interval applied with the request");
+    check(ble.getBulkStats().pages == 2 && link.getQueued() == 2, "pages beyond the buffers refused");
+    for (int i = 0; i < 100 && !client.isComplete(); i++) {
+        now += 30000;
+        int delivered = link.advanceTo(now);
+        if (delivered > 0) {
+            ble.notificationsSent(delivered);
+        }
+        while (subscriber.receive(n)) {
+            int reply = client.receive(n.data, n.length, message);
+            if (reply > 0) {
+                ble.handleBulkControl(message, reply);
+            }
+        }
+    }
+    check(client.isComplete() && client.getReceived() == 101, "download completes after refusals");
+    check(ble.getStats().pagesRefused > 0 && link.getStats().dropped == 0,
+          "pages refused by the budget, none dropped by the link");
+    link.close();
+    
+    // Refused results stay queued and are counted once, when accepted
+    GattLinkParams busy = {30000, 6, 251, 247, 1, 0.0f, true};
+    GattServerSim busyLink(busy);
+    busyLink.listen(path);
+    subscriber.connect(path);
+    BLEManager busyBle;
+    busyBle.setGattServerSim(&busyLink);
+    busyBle.connectionOpened(24, 0, 400);
+    busyLink.advanceTo(1000);
+    busyBle.updateCharacteristics(true, 0.5f, false, 0.0f, false, 0.0f, 3000);
+    busyBle.updateCharacteristics(true, 0.6f, false, 0.0f, false, 0.0f, 6000);
+    check(busyBle.getStats().notifications == 1 && busyBle.getStats().refused == 1,
+          "refused result not counted as sent");
+    now = 1000;
+    for (int i = 0; i < 4; i++) {
+        now += 30000;
+        int delivered = busyLink.advanceTo(now);
+        if (delivered > 0) {
+            busyBle.notificationsSent(delivered);
+        }
+    }
+    int received = 0;
+    bool inOrder = true;
+    while (subscriber.receive(n)) {
+        BLEManager::unpackResult(n.data, record);
+        inOrder = inOrder && record.sequence == received;
+        received++;
+    }
+    check(received == 2 && inOrder && busyBle.getStats().notifications == 2,
+          "refused result sent by notificationsSent()");
+    
+    // Refused stream packets keep their frames until buffers are free; the
+    // link is held for 50 frames, so the second packet finds no buffer
+    busyBle.setStreaming(true);
+    uint32_t frameUs = now;
+    for (int i = 0; i < 104; i++) {
+        float noise = (float)((i * 7919) % 201 - 100);  // Large deltas: short packets
+        float ax = 0.01f * noise, ay = -ax, az = 1.0f, gx = noise, gy = -gx, gz = 0.5f * gx;
+        frameUs += 19231;
+        busyBle.streamSamples(&ax, &ay, &az, &gx, &gy, &gz, &frameUs, 1, 52.0f);
+        int delivered = (i >= 50) ? busyLink.advanceTo(frameUs) : 0;
+        if (delivered > 0) {
+            busyBle.notificationsSent(delivered);
+        }
+    }
+    const StreamStats& stream = busyBle.getStreamStats();
+    check(stream.refused > 0 && stream.dropped == 0, "stream packets refused, no frame dropped");
+    check(busyLink.getStats().dropped == 0, "nothing written beyond the link's buffers");
+    int frames = 0;
+    uint16_t expected = 0;
+    bool contiguous = true;
+    int16_t decoded[IMU_STREAM_MAX_FRAMES][IMU_MAX_CHANNELS];
+    while (subscriber.receive(n)) {
+        ImuStreamHeader header;
+        int count = ImuStreamCodec::decode(n.data, n.length, header, decoded, IMU_STREAM_MAX_FRAMES);
+        contiguous = contiguous && count > 0 && header.sequence == expected++;
+        frames += count;
+    }
+    check(contiguous && frames == (int)stream.frames && stream.packets == expected,
+          "accepted packets arrive in sequence, each counted once");
+    busyLink.close();
+    
+    // Default MTU: a 6-axis key frame does not fit, the accelerometer is sent
+    GattLinkParams small = {30000, 6, 27, 23, 8, 0.0f, true};
+    GattServerSim smallLink(small);
+    smallLink.listen(path);
+    subscriber.connect(path);
+    BLEManager smallBle;
+    smallBle.setGattServerSim(&smallLink);
+    smallBle.connectionOpened(24, 0, 400);
+    smallBle.setStreaming(true);
+    frameUs = 0;
+    for (int i = 0; i < 52; i++) {
+        float ax = 0.001f * i, ay = 0.0f, az = 1.0f, gx = 0.1f * i, gy = 0.0f, gz = 0.0f;
+        frameUs += 19231;
+        smallBle.streamSamples(&ax, &ay, &az, &gx, &gy, &gz, &frameUs, 1, 52.0f);
+        int delivered = smallLink.advanceTo(frameUs);
+        if (delivered > 0) {
+            smallBle.notificationsSent(delivered);
+        }
+    }
+    smallBle.flushStream();
+    smallLink.advanceTo(frameUs + 100000);
+    const StreamStats& smallStream = smallBle.getStreamStats();
+    frames = 0;
+    bool accelOnly = true;
+    while (subscriber.receive(n)) {
+        ImuStreamHeader header;
+        int count = ImuStreamCodec::decode(n.data, n.length, header, decoded, IMU_STREAM_MAX_FRAMES);
+        accelOnly = accelOnly && count > 0 && header.channels == 3 && n.length <= 20;
+        frames += count;
+    }
+    check(accelOnly && frames == 52 && smallStream.accelOnly == 52 && smallStream.dropped == 0,
+          "MTU 23 streams 3-channel packets, no frame dropped");
+    
+    smallLink.close();
+    return testSummary();
+}
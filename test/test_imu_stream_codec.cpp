@@ -0,0 +1,169 @@
+/**
+ * @file test_imu_stream_codec.cpp
+ * @brief Native round-trip test for the raw IMU stream codec
+ * 
+ * Encodes and decodes packets of tremor-like, random full-range and
+ * extreme (int16 min/max jumps, constant) frames with 3 and 6 channels,
+ * checks bit-exact reconstruction, capacity limits, rejection of
+ * malformed packets, and BLEManager packetizing: streaming only while
+ * subscribed, every frame sent, compression and throughput counters, and
+ * the accelerometer-only fallback at the default MTU.
+ * 
+ * Build (native): g++ -DNATIVE_TEST_MODE -I../src test_imu_stream_codec.cpp
+ *                 ../src/ImuStreamCodec.cpp ../src/BulkTransfer.cpp
+ *                 ../src/AdvertisingScheduler.cpp ../src/ConnectionParamManager.cpp
+ *                 ../src/GattServerSim.cpp ../src/BLEManager.cpp
+ */
+
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include "../src/ImuStreamCodec.h"
+#include "../src/BLEManager.h"
+#include "test_util.h"
+
+static uint32_t rng = 2463534242u;
+
+static uint32_t nextRandom() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static int16_t frames[IMU_STREAM_MAX_FRAMES][IMU_MAX_CHANNELS];
+static int16_t decoded[IMU_STREAM_MAX_FRAMES][IMU_MAX_CHANNELS];
+
+// Encode as many frames as fit, decode, compare
+static bool roundTrip(int count, int channels, int capacity, int* used = nullptr) {
+    uint8_t packet[MAX_NOTIFY_PAYLOAD];
+    int fit = ImuStreamCodec::fitFrames(frames, count, channels, capacity);
+    ImuStreamHeader header = {0xBEEF, 123456789u, 0, (uint8_t)channels, 52};
+    int length = ImuStreamCodec::encode(header, frames, fit, packet, capacity);
+    if (used) *used = fit;
+    if (fit < 1 || length <= 0 || length > capacity) return false;
+    ImuStreamHeader parsed;
+    int n = ImuStreamCodec::decode(packet, length, parsed, decoded, IMU_STREAM_MAX_FRAMES);
+    if (n != fit || parsed.sequence != 0xBEEF || parsed.timestampUs != 123456789u ||
+        parsed.channels != channels || parsed.rateHz != 52) {
+        return false;
+    }
+    for (int i = 0; i < n; i++) {
+        for (int c = 0; c < channels; c++) {
+            if (decoded[i][c] != frames[i][c]) return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    printf("=== IMU stream codec test ===\n");
+    
+    // Tremor on gravity, 6 channels
+    for (int i = 0; i < IMU_STREAM_MAX_FRAMES; i++) {
+        float t = i / 52.0f;
+        frames[i][0] = ImuStreamCodec::toCounts(0.2f * sinf(6.2832f * 4.5f * t), IMU_ACCEL_COUNTS_PER_G);
+        frames[i][1] = ImuStreamCodec::toCounts(0.05f, IMU_ACCEL_COUNTS_PER_G);
+        frames[i][2] = ImuStreamCodec::toCounts(1.0f, IMU_ACCEL_COUNTS_PER_G);
+        frames[i][3] = ImuStreamCodec::toCounts(30.0f * cosf(6.2832f * 4.5f * t), IMU_GYRO_COUNTS_PER_DPS);
+        frames[i][4] = (int16_t)(nextRandom() % 41) - 20;
+        frames[i][5] = 0;
+    }
+    int used = 0;
+    check(roundTrip(IMU_STREAM_MAX_FRAMES, 6, MAX_NOTIFY_PAYLOAD, &used), "tremor, 6 channels");
+    printf("  tremor: %d frames per 244-byte packet (%d as raw int16)\n", used,
+           (MAX_NOTIFY_PAYLOAD - IMU_STREAM_HEADER_SIZE) / 12);
+    check(roundTrip(IMU_STREAM_MAX_FRAMES, 3, MAX_NOTIFY_PAYLOAD), "accelerometer only");
+    
+    // Random full range: widths reach 16 bits
+    for (int i = 0; i < IMU_STREAM_MAX_FRAMES; i++) {
+        for (int c = 0; c < IMU_MAX_CHANNELS; c++) {
+            frames[i][c] = (int16_t)nextRandom();
+        }
+    }
+    check(roundTrip(IMU_STREAM_MAX_FRAMES, 6, MAX_NOTIFY_PAYLOAD), "random full-range samples");
+    
+    // Rail-to-rail jumps (wrapped deltas) and a constant channel
+    for (int i = 0; i < IMU_STREAM_MAX_FRAMES; i++) {
+        frames[i][0] = (i & 1) ? 32767 : -32768;
+        frames[i][1] = -32768;
+        frames[i][2] = (i % 3 == 0) ? 32767 : 0;
+    }
+    check(roundTrip(IMU_STREAM_MAX_FRAMES, 3, MAX_NOTIFY_PAYLOAD), "int16 extremes");
+    for (int i = 0; i < IMU_STREAM_MAX_FRAMES; i++) {
+        for (int c = 0; c < IMU_MAX_CHANNELS; c++) {
+            frames[i][c] = 1000;
+        }
+    }
+    check(roundTrip(IMU_STREAM_MAX_FRAMES, 6, MAX_NOTIFY_PAYLOAD, &used) &&
+          used == IMU_STREAM_MAX_FRAMES, "constant frames: 255 frames in one packet");
+    
+    // Capacity limits
+    check(ImuStreamCodec::fitFrames(frames, 10, 6, IMU_STREAM_HEADER_SIZE + 17) == 0,
+          "no frame fits below header + key frame");
+    check(roundTrip(1, 6, IMU_STREAM_HEADER_SIZE + 18), "single key frame");
+    uint8_t packet[MAX_NOTIFY_PAYLOAD];
+    ImuStreamHeader header = {1, 0, 0, 6, 52};
+    check(ImuStreamCodec::encode(header, frames, 2, packet, 20) == 0, "encode refuses overflow");
+    
+    // Malformed packets
+    for (int i = 0; i < 40; i++) {
+        for (int c = 0; c < IMU_MAX_CHANNELS; c++) {
+            frames[i][c] = (int16_t)(nextRandom() % 2001) - 1000;
+        }
+    }
+    int length = ImuStreamCodec::encode(header, frames, 40, packet, MAX_NOTIFY_PAYLOAD);
+    ImuStreamHeader parsed;
+    check(ImuStreamCodec::decode(packet, length - 1, parsed, decoded, IMU_STREAM_MAX_FRAMES) < 0,
+          "truncated packet rejected");
+    check(ImuStreamCodec::decode(packet, length, parsed, decoded, 10) < 0,
+          "packet larger than the output rejected");
+    packet[7] = 7;
+    check(ImuStreamCodec::decode(packet, length, parsed, decoded, IMU_STREAM_MAX_FRAMES) < 0,
+          "bad channel count rejected");
+    
+    // Conversion
+    check(ImuStreamCodec::toCounts(1.0f, IMU_ACCEL_COUNTS_PER_G) == 16393 &&
+          ImuStreamCodec::toCounts(5.0f, IMU_ACCEL_COUNTS_PER_G) == 32767 &&
+          ImuStreamCodec::toCounts(-300.0f, IMU_GYRO_COUNTS_PER_DPS) == -32768 &&
+          ImuStreamCodec::toCounts(NAN, IMU_GYRO_COUNTS_PER_DPS) == 0, "counts saturate, NaN is 0");
+    
+    // BLEManager packetizing: 10s of 52Hz samples in blocks of 4
+    BLEManager ble;
+    ble.setAttMtu(247);
+    float ax[4], ay[4], az[4], gx[4], gy[4], gz[4];
+    uint32_t times[4];
+    ble.streamSamples(ax, ay, az, gx, gy, gz, times, 4, 52.0f);
+    check(ble.getStreamStats().frames == 0 && ble.getStreamStats().packets == 0,
+          "nothing streamed before subscription");
+    ble.setStreaming(true);
+    int sample = 0;
+    for (int block = 0; block < 130; block++) {
+        for (int i = 0; i < 4; i++, sample++) {
+            float t = sample / 52.0f;
+            ax[i] = 0.2f * sinf(6.2832f * 4.5f * t);
+            ay[i] = 0.05f;
+            az[i] = 1.0f;
+            gx[i] = gy[i] = 0.0f;
+            gz[i] = 30.0f * cosf(6.2832f * 4.5f * t);
+            times[i] = (uint32_t)(sample * 19231u);
+        }
+        ble.streamSamples(ax, ay, az, gx, gy, gz, times, 4, 52.0f);
+    }
+    ble.setStreaming(false);
+    const StreamStats& stats = ble.getStreamStats();
+    ble.printStats();
+    check(stats.frames == 520 && stats.dropped == 0, "every frame streamed");
+    check(stats.bytesSent < stats.rawBytes / 2, "stream under half of raw int16");
+    check(stats.frames >= 40 * stats.packets, "packets filled (40+ frames each)");
+    check(ble.getStreamRate() > 0.0f, "throughput measured");
+    
+    BLEManager small;
+    small.setStreaming(true);
+    small.streamSamples(ax, ay, az, gx, gy, gz, times, 4, 52.0f);
+    small.flushStream();
+    check(small.getStreamStats().frames == 4 && small.getStreamStats().dropped == 0 &&
+          small.getStreamStats().accelOnly == 4, "accelerometer only at the default MTU");
+    
+    return testSummary();
+}
@@ -0,0 +1,152 @@
+/**
+ * @file test_incremental_analysis.cpp
+ * @brief Native test for the stepped (incremental) window analysis
+ * 
+ * Runs the same synthetic windows (rest, tremor, dyskinesia, walking and
+ * freezing) through analyze() and through beginAnalysis()/stepAnalysis()
+ * and checks that the results are identical, that a window takes a fixed
+ * number of steps, and that the longest single step is a fraction of a
+ * whole analyze() call. A freeze with some residual sway is also run
+ * with and without gyroscope data: only the stricter accelerometer-only
+ * criterion must reject it.
+ * 
+ * Build (native): g++ -O2 -DNATIVE_TEST_MODE -I../src test_incremental_analysis.cpp
+ *                 ../src/SymptomDetector.cpp ../src/FFTProcessor.cpp
+ */
+
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include "../src/SymptomDetector.h"
+#include "test_util.h"
+
+static const int WINDOW = 156;
+static const float RATE = 52.0f;
+static const int REPEATS = 200;     // Timing repetitions per window
+
+static float ax[WINDOW], ay[WINDOW], az[WINDOW];
+static float gx[WINDOW], gy[WINDOW], gz[WINDOW];
+
+// Oscillation at hz on every axis on top of gravity, plus a slow gyro sway
+static void makeWindow(float hz, float amplitude, bool freeze) {
+    for (int i = 0; i < WINDOW; i++) {
+        float t = i / RATE;
+        float scale = (freeze && i > WINDOW / 2) ? 0.05f : 1.0f;
+        float s = amplitude * scale * sinf(2.0f * (float)M_PI * hz * t);
+        ax[i] = 0.02f + s;
+        ay[i] = -0.01f + 0.5f * s;
+        az[i] = 1.0f + s;
+        gx[i] = 5.0f * sinf(2.0f * (float)M_PI * 0.5f * t);
+        gy[i] = 0.0f;
+        gz[i] = 2.0f * scale;
+    }
+}
+
+// Two thirds of heel strikes at 2 steps/s, then standing with a slow sway
+static void makeFreeze(float sway) {
+    for (int i = 0; i < WINDOW; i++) {
+        float t = i / RATE;
+        bool frozen = (i >= 2 * WINDOW / 3);
+        ax[i] = 0.02f;
+        ay[i] = -0.01f;
+        az[i] = 1.0f + (frozen ? sway * sinf(2.0f * (float)M_PI * t) : (i % 26 == 13 ? 0.8f : 0.0f));
+        gx[i] = gy[i] = gz[i] = 0.0f;
+    }
+}
+
+static bool same(const SymptomResults& a, const SymptomResults& b) {
+    return a.tremorDetected == b.tremorDetected && a.tremorIntensity == b.tremorIntensity &&
+           a.dyskinesiaDetected == b.dyskinesiaDetected &&
+           a.dyskinesiaIntensity == b.dyskinesiaIntensity &&
+           a.fogDetected == b.fogDetected && a.fogIntensity == b.fogIntensity;
+}
+
+static double microsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    printf("=== Incremental analysis test ===\n");
+    
+    struct Case { const char* name; float hz; float amplitude; bool freeze; };
+    const Case cases[] = {
+        {"rest", 0.0f, 0.0f, false},
+        {"tremor 4Hz", 4.0f, 0.3f, false},
+        {"dyskinesia 6Hz", 6.0f, 0.3f, false},
+        {"walking 1.8Hz", 1.8f, 0.35f, false},
+        {"walking then freezing", 1.8f, 0.35f, true},
+    };
+    
+    SymptomDetector reference, stepped;
+    reference.setSampleRate(RATE);
+    stepped.setSampleRate(RATE);
+    
+    bool allSame = true, fixedSteps = true, withoutGyroSame = true;
+    int steps = 0;
+    double worstStepUs = 0.0, worstAnalyzeUs = 0.0;
+    for (const Case& c : cases) {
+        makeWindow(c.hz, c.amplitude, c.freeze);
+        
+        SymptomResults expected = reference.analyze(ax, ay, az, gx, gy, gz, WINDOW);
+        stepped.beginAnalysis(ax, ay, az, gx, gy, gz, WINDOW);
+        int n = 1;
+        while (!stepped.stepAnalysis()) n++;
+        if (steps == 0) steps = n;
+        fixedSteps &= (n == steps) && !stepped.isAnalysisPending();
+        bool match = same(expected, stepped.getAnalysisResults()) &&
+                     reference.getCadence() == stepped.getCadence();
+        allSame &= match;
+        printf("  %-22s tremor %.3f dyskinesia %.3f fog %.3f  %s\n", c.name,
+               expected.tremorIntensity, expected.dyskinesiaIntensity, expected.fogIntensity,
+               match ? "same" : "DIFFERENT");
+        
+        expected = reference.analyze(ax, ay, az, nullptr, nullptr, nullptr, WINDOW);
+        stepped.beginAnalysis(ax, ay, az, nullptr, nullptr, nullptr, WINDOW);
+        while (!stepped.stepAnalysis()) {
+        }
+        withoutGyroSame &= same(expected, stepped.getAnalysisResults());
+        
+        // Longest single step vs a whole analyze() (best of REPEATS each)
+        double analyzeUs = 1e9, stepUs = 0.0;
+        for (int r = 0; r < REPEATS; r++) {
+            auto start = std::chrono::steady_clock::now();
+            reference.analyze(ax, ay, az, gx, gy, gz, WINDOW);
+            analyzeUs = fmin(analyzeUs, microsSince(start));
+        }
+        double bestStep[16];
+        for (int s = 0; s < 16; s++) bestStep[s] = 1e9;
+        for (int r = 0; r < REPEATS; r++) {
+            stepped.beginAnalysis(ax, ay, az, gx, gy, gz, WINDOW);
+            bool done = false;
+            for (int s = 0; !done && s < 16; s++) {
+                auto start = std::chrono::steady_clock::now();
+                done = stepped.stepAnalysis();
+                bestStep[s] = fmin(bestStep[s], microsSince(start));
+            }
+        }
+        for (int s = 0; s < steps && s < 16; s++) stepUs = fmax(stepUs, bestStep[s]);
+        worstStepUs = fmax(worstStepUs, stepUs);
+        worstAnalyzeUs = fmax(worstAnalyzeUs, analyzeUs);
+    }
+    
+    printf("  %d steps per window; longest step %.1f us, analyze() %.1f us\n",
+           steps, worstStepUs, worstAnalyzeUs);
+    check(allSame, "stepped results identical to analyze()");
+    check(withoutGyroSame, "identical without gyroscope data");
+    check(fixedSteps, "every window takes the same number of steps");
+    check(worstStepUs < 0.5 * worstAnalyzeUs, "longest step under half of analyze()");
+    check(stepped.stepAnalysis() && !stepped.isAnalysisPending(),
+          "stepAnalysis() with nothing pending reports completion");
+    
+    // Without the gyroscope the freeze must be stiller to count
+    makeFreeze(0.05f);
+    check(reference.analyze(ax, ay, az, nullptr, nullptr, nullptr, WINDOW).fogDetected,
+          "still freeze detected without gyroscope");
+    makeFreeze(0.12f);
+    check(reference.analyze(ax, ay, az, gx, gy, gz, WINDOW).fogDetected,
+          "swaying freeze detected with gyroscope");
+    check(!reference.analyze(ax, ay, az, nullptr, nullptr, nullptr, WINDOW).fogDetected,
+          "swaying freeze rejected without gyroscope");
+    
+    return testSummary();
+}
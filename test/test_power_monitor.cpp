@@ -0,0 +1,78 @@
+/**
+ * @file test_power_monitor.cpp
+ * @brief Native test for sleep-state accounting
+ * 
+ * Checks that a busy interval is accounted as run time and a sleeping one
+ * as deep sleep (native accounting: process CPU time vs wall-clock time),
+ * and the average current and battery life arithmetic.
+ * 
+ * Build (native): g++ -DNATIVE_TEST_MODE -I../src test_power_monitor.cpp
+ *                 ../src/PowerMonitor.cpp
+ */
+
+#include <cstdio>
+#include <cmath>
+#include <sys/time.h>
+#include "../src/PowerMonitor.h"
+#include "test_util.h"
+
+static long long wallUs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static double share(const PowerStats& stats, PowerState state) {
+    return stats.totalUs ? (double)stats.timeUs[state] / stats.totalUs : 0.0;
+}
+
+int main() {
+    printf("=== Power monitor test ===\n");
+    
+    // Busy interval: almost all run time
+    PowerMonitor monitor;
+    long long start = wallUs();
+    volatile unsigned long spin = 0;
+    while (wallUs() - start < 200000) {
+        spin++;
+    }
+    PowerStats busy = monitor.read();
+    printf("  busy: run %.1f%%, deep sleep %.1f%% of %llu us\n",
+           100.0 * share(busy, POWER_RUN), 100.0 * share(busy, POWER_DEEP_SLEEP),
+           (unsigned long long)busy.totalUs);
+    check(share(busy, POWER_RUN) > 0.8, "busy interval counted as run time");
+    
+    // Sleeping interval after reset(): almost all deep sleep
+    monitor.reset();
+    usleep(200000);
+    PowerStats idle = monitor.read();
+    printf("  idle: run %.1f%%, deep sleep %.1f%% of %llu us\n",
+           100.0 * share(idle, POWER_RUN), 100.0 * share(idle, POWER_DEEP_SLEEP),
+           (unsigned long long)idle.totalUs);
+    check(share(idle, POWER_DEEP_SLEEP) > 0.9, "idle interval counted as deep sleep");
+    check(idle.totalUs >= 190000 && idle.totalUs < 400000, "reset() starts a new interval");
+    check(idle.timeUs[POWER_RUN] + idle.timeUs[POWER_SLEEP] + idle.timeUs[POWER_DEEP_SLEEP] ==
+          idle.totalUs, "states add up to the interval");
+    
+    // Current and battery arithmetic: 10% at 10mA, 90% at 0.01mA
+    monitor.setStateCurrent(POWER_RUN, 10.0f);
+    monitor.setStateCurrent(POWER_SLEEP, 3.0f);
+    monitor.setStateCurrent(POWER_DEEP_SLEEP, 0.01f);
+    monitor.setStateCurrent(POWER_SLEEP, -1.0f);  // Ignored
+    monitor.setBatteryCapacity(100.0f);
+    PowerStats synthetic = {{100000, 0, 900000}, 1000000};
+    float current = monitor.averageCurrent(synthetic);
+    printf("  synthetic: %.4f mA, %.1f h\n", current, monitor.batteryLifeHours(synthetic));
+    check(fabsf(current - 1.009f) < 1e-4f, "average current weighted by residency");
+    check(fabsf(monitor.batteryLifeHours(synthetic) - 100.0f / 1.009f) < 0.01f,
+          "battery life from capacity and average current");
+    PowerStats sleeping = {{0, 1000, 0}, 1000};
+    check(fabsf(monitor.averageCurrent(sleeping) - 3.0f) < 1e-6f, "negative current ignored");
+    PowerStats empty = {{0, 0, 0}, 0};
+    check(monitor.averageCurrent(empty) == 0.0f && monitor.batteryLifeHours(empty) == 0.0f,
+          "empty interval gives no estimate");
+    
+    monitor.print();
+    
+    return testSummary();
+}
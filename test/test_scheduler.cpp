@@ -0,0 +1,107 @@
+/**
+ * @file test_scheduler.cpp
+ * @brief Native test for the hardware-timed task scheduler
+ * 
+ * Runs a 52Hz task in real time and checks that the average period is
+ * 1/52s (not the 19ms of an integer millisecond interval), that a stalled
+ * task is reported as an overrun with skipped releases instead of bursting,
+ * and that posted event tasks run once.
+ * 
+ * Build (native): g++ -DNATIVE_TEST_MODE -I../src test_scheduler.cpp
+ *                 ../src/Scheduler.cpp
+ */
+
+#include <cstdio>
+#include <sys/time.h>
+#include "../src/Scheduler.h"
+#include "test_util.h"
+
+static const float RATE = 52.0f;
+static const int RUNS = 105;        // About two seconds at 52Hz
+
+static long long wallUs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+static Scheduler* scheduler;
+static int sampleTask, eventTask;
+static int samples = 0;
+static int events = 0;
+static long long firstUs = 0, lastUs = 0;
+static bool stallEnabled = false;
+
+// 52Hz task: records its start times, stalls once, posts an event
+static void sampleBody() {
+    lastUs = wallUs();
+    if (samples == 0) firstUs = lastUs;
+    samples++;
+    if (stallEnabled && samples == 10) {
+        // Busy for 2.3 periods: the next release is skipped
+        while (wallUs() - lastUs < 45000) {
+        }
+    }
+    if (samples % 50 == 0) {
+        scheduler->post(eventTask);
+    }
+    if (samples == RUNS) {
+        scheduler->stop();
+    }
+}
+
+static void eventBody() {
+    events++;
+}
+
+int main() {
+    printf("=== Scheduler test ===\n");
+    
+    // Average rate over ~2s with fractional period accumulation
+    {
+        Scheduler s;
+        scheduler = &s;
+        sampleTask = s.addTask("sample", sampleBody, RATE);
+        eventTask = s.addTask("event", eventBody, 0.0f);
+        s.run();
+        double periodUs = (double)(lastUs - firstUs) / (samples - 1);
+        printf("  average period %.1f us (ideal %.1f us)\n", periodUs, 1e6 / RATE);
+        check(periodUs > 1e6 / RATE - 50.0 && periodUs < 1e6 / RATE + 50.0,
+              "average period is 1/52 s");
+        check(s.getStats(sampleTask).runs == (unsigned long)RUNS, "task ran until stopped");
+        check(events == 2 && s.getStats(eventTask).runs == 2, "posted event task ran once per post");
+        check(s.getStats(sampleTask).missedDeadlines == 0, "no missed deadlines when idle");
+        s.printStats();
+    }
+    
+    // A stalled execution is an overrun and skips one release
+    {
+        samples = 0;
+        events = 0;
+        stallEnabled = true;
+        Scheduler s;
+        scheduler = &s;
+        sampleTask = s.addTask("sample", sampleBody, RATE);
+        eventTask = s.addTask("event", eventBody, 0.0f);
+        s.run();
+        const TaskStats& stats = s.getStats(sampleTask);
+        check(stats.overruns == 1, "stall counted as one overrun");
+        check(stats.missedDeadlines == 1, "stall skipped one release");
+        check(stats.maxRunTimeUs >= 45000, "stall run time recorded");
+        double periodUs = (double)(lastUs - firstUs) / (samples - 1);
+        check(periodUs > 1e6 / RATE * RUNS / (RUNS - 1) - 100.0,
+              "releases stay on the original grid after the stall");
+        s.printStats();
+    }
+    
+    // Rate changes and unknown ids
+    {
+        Scheduler s;
+        int task = s.addTask("sample", sampleBody, RATE);
+        check(s.setRate(task, 26.0f), "rate change accepted");
+        check(!s.setRate(7, 26.0f), "unknown task rejected");
+        check(s.getStats(7).runs == 0, "unknown task has empty stats");
+    }
+    
+    return testSummary();
+}
@@ -0,0 +1,126 @@
+/**
+ * @file test_spectral_features.cpp
+ * @brief Native test of the spectral feature vector and its BLE record
+ * 
+ * Analyzes a window with a different tone on each axis and checks that
+ * each tone's power lands in its band at the expected mean-square value,
+ * that the peak frequency is the strongest tone, and that the features
+ * survive quantization and packing into the 18-byte feature record, which
+ * carries the sequence number of the window's result record and is only
+ * notified while subscribed.
+ * 
+ * Build (native): g++ -DNATIVE_TEST_MODE -I../src test_spectral_features.cpp
+ *                 ../src/SymptomDetector.cpp ../src/FFTProcessor.cpp
+ *                 ../src/AdvertisingScheduler.cpp ../src/ConnectionParamManager.cpp
+ *                 ../src/BulkTransfer.cpp ../src/ImuStreamCodec.cpp
+ *                 ../src/GattServerSim.cpp ../src/BLEManager.cpp
+ */
+
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include "../src/SymptomDetector.h"
+#include "../src/BLEManager.h"
+#include "test_util.h"
+
+static const int WINDOW = 156;
+static const float RATE = 52.0f;
+
+static float ax[WINDOW], ay[WINDOW], az[WINDOW];
+
+// Power ratio in dB
+static float db(float power, float reference) {
+    return 10.0f * log10f(power / reference);
+}
+
+int main() {
+    printf("=== Spectral feature test ===\n");
+    
+    // X: 4 Hz at 0.2 g, Y: 8 Hz at 0.1 g, Z: gravity plus 1 Hz at 0.3 g
+    for (int i = 0; i < WINDOW; i++) {
+        float t = i / RATE;
+        ax[i] = 0.2f * sinf(2.0f * (float)M_PI * 4.0f * t);
+        ay[i] = 0.1f * sinf(2.0f * (float)M_PI * 8.0f * t);
+        az[i] = 1.0f + 0.3f * sinf(2.0f * (float)M_PI * 1.0f * t);
+    }
+    SymptomDetector detector;
+    detector.begin();
+    detector.analyze(ax, ay, az, nullptr, nullptr, nullptr, WINDOW);
+    const SpectralFeatures& f = detector.getFeatures();
+    for (int axis = 0; axis < FEATURE_AXES; axis++) {
+        printf("  axis %d: %.2e %.2e %.2e %.2e g^2\n", axis, f.bandPower[axis][0],
+               f.bandPower[axis][1], f.bandPower[axis][2], f.bandPower[axis][3]);
+    }
+    printf("  peak %.2f Hz, cadence %.2f steps/s, FOG variance %.2e g^2\n",
+           f.peakFrequency, f.cadence, f.fogVariance);
+    
+    // A sine of amplitude A has a mean square of A^2 / 2
+    check(fabsf(db(f.bandPower[0][1], 0.02f)) < 1.0f, "X: 4 Hz power in the 3-5 Hz band");
+    check(fabsf(db(f.bandPower[1][3], 0.005f)) < 1.0f, "Y: 8 Hz power in the 7-12 Hz band");
+    check(fabsf(db(f.bandPower[2][0], 0.045f)) < 1.0f, "Z: 1 Hz power in the 0-2 Hz band");
+    check(f.bandPower[0][1] > 10.0f * f.bandPower[0][3] &&
+          f.bandPower[1][3] > 10.0f * f.bandPower[1][0] &&
+          f.bandPower[2][0] > 10.0f * f.bandPower[2][2], "other bands at least 10 dB lower");
+    check(fabsf(f.peakFrequency - 1.0f) < 0.25f, "peak frequency of the strongest tone");
+    check(f.cadence == detector.getCadence() && f.fogVariance > 0.0f,
+          "cadence and FOG variance of the window");
+    
+    // Incremental analysis yields the same features
+    detector.begin();
+    detector.beginAnalysis(ax, ay, az, nullptr, nullptr, nullptr, WINDOW);
+    while (!detector.stepAnalysis()) {
+    }
+    check(detector.getFeatures().bandPower[0][1] == f.bandPower[0][1] &&
+          detector.getFeatures().peakFrequency == f.peakFrequency, "incremental analysis agrees");
+    
+    // Power codes: 0.5 dB steps from -100 dB
+    bool roundTrip = true;
+    for (float p = 1e-9f; p < 1e2f; p *= 3.7f) {
+        float decoded = BLEManager::powerFromByte(BLEManager::powerByte(p));
+        roundTrip = roundTrip && fabsf(db(decoded, p)) <= 0.26f;
+    }
+    check(roundTrip, "power codes within 0.25 dB from 1e-9 to 100 g^2");
+    check(BLEManager::powerByte(0.0f) == 0 && BLEManager::powerByte(NAN) == 0 &&
+          BLEManager::powerByte(1e-12f) == 0 && BLEManager::powerByte(1e6f) == 255 &&
+          BLEManager::powerFromByte(0) == 0.0f, "power codes saturate, 0 and NaN give 0");
+    
+    // Record: quantized values, wire layout and round trip
+    FeatureRecord record;
+    BLEManager::quantizeFeatures(f, 0x1234, record);
+    uint8_t packed[FEATURE_RECORD_SIZE];
+    BLEManager::packFeatures(record, packed);
+    FeatureRecord parsed;
+    BLEManager::unpackFeatures(packed, parsed);
+    check(FEATURE_RECORD_SIZE + 3 <= ATT_DEFAULT_MTU,
+          "record fits a notification at the default MTU");
+    check(packed[0] == 0x34 && packed[1] == 0x12 && packed[2 + 1] == record.bandPower[0][1] &&
+          packed[2 + 4 + 3] == record.bandPower[1][3] && packed[14] == record.peakFrequency &&
+          packed[17] == record.fogVariance, "wire layout");
+    check(memcmp(&parsed.bandPower, &record.bandPower, sizeof(record.bandPower)) == 0 &&
+          parsed.sequence == record.sequence && parsed.peakFrequency == record.peakFrequency &&
+          parsed.cadence == record.cadence && parsed.fogVariance == record.fogVariance,
+          "pack/unpack round trip");
+    check(record.peakFrequency == (int)(f.peakFrequency * 10.0f + 0.5f) &&
+          fabsf(db(BLEManager::powerFromByte(record.bandPower[0][1]), f.bandPower[0][1])) <= 0.26f,
+          "peak in 0.1 Hz units, band powers as codes");
+    
+    // BLEManager: sequence of the window's result, notified only while subscribed
+    BLEManager ble;
+    ble.updateCharacteristics(false, 0.0f, false, 0.0f, false, 0.0f, 3000);
+    ble.updateCharacteristics(true, 0.5f, false, 0.0f, false, 0.0f, 6000);
+    ble.updateFeatures(f);
+    check(ble.getLastFeatures().sequence == ble.getLastRecord().sequence &&
+          ble.getLastFeatures().sequence == 1, "feature record carries the window's sequence");
+    check(ble.getStats().featureNotifications == 0, "not notified without a subscription");
+    ble.setFeatureNotify(true);
+    ble.updateFeatures(f);
+    ble.updateFeatures(f);
+    check(ble.getStats().featureNotifications == 2, "notified while subscribed");
+    ble.connectionOpened(24, 0, 400);
+    ble.connectionClosed();
+    ble.updateFeatures(f);
+    check(!ble.isFeatureNotify() && ble.getStats().featureNotifications == 2,
+          "disconnect ends the subscription");
+    
+    return testSummary();
+}
@@ -0,0 +1,160 @@
+/**
+ * @file test_spsc_ring_buffer.cpp
+ * @brief Native test for the lock-free SPSC ring buffer
+ * 
+ * Checks FIFO order, full/empty handling and drop counting on one thread,
+ * then stresses the ring with a producer and a consumer thread: once with
+ * a producer that retries (every frame must arrive, in order) and once with
+ * a producer that drops on full (received + dropped must add up, order must
+ * hold). Finally a RingSampleSource is fed from a second thread.
+ * 
+ * Build (native): g++ -std=c++11 -O2 -pthread -DNATIVE_TEST_MODE -I../src
+ *                 test_spsc_ring_buffer.cpp
+ */
+
+#include <cstdio>
+#include <thread>
+#include "../src/SpscRingBuffer.h"
+#include "../src/SampleSource.h"
+#include "test_util.h"
+
+static const uint32_t STRESS_FRAMES = 2000000;
+
+// Frame whose fields are all derived from a sequence number, so a torn
+// read (fields from two different pushes) is detected
+static SensorData frame(uint32_t seq) {
+    SensorData data;
+    data.accelX = (float)(seq & 0xFFFF);
+    data.accelY = (float)(seq >> 16);
+    data.accelZ = -data.accelX;
+    data.gyroX = data.gyroY = data.gyroZ = (float)(seq % 1000);
+    data.timestampUs = seq;
+    return data;
+}
+
+static bool intact(const SensorData& data) {
+    uint32_t seq = data.timestampUs;
+    return data.accelX == (float)(seq & 0xFFFF) && data.accelY == (float)(seq >> 16) &&
+           data.accelZ == -data.accelX && data.gyroZ == (float)(seq % 1000);
+}
+
+static void singleThreadTests() {
+    SpscRingBuffer<int, 8> ring;
+    int value = 0;
+    check(!ring.pop(value) && ring.empty(), "empty ring pops nothing");
+    
+    bool allPushed = true;
+    for (int i = 0; i < 8; i++) allPushed &= ring.push(i);
+    check(allPushed && ring.size() == 8, "all N slots usable");
+    check(!ring.push(99) && ring.getDropped() == 1, "push on full fails and counts a drop");
+    
+    bool ordered = true;
+    for (int i = 0; i < 8; i++) ordered &= ring.pop(value) && value == i;
+    check(ordered && ring.empty(), "FIFO order");
+    
+    // Wrap the slot index several times with block pops
+    int block[5];
+    int next = 0, expected = 0;
+    ordered = true;
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 5; i++) ring.push(next++);
+        int n = ring.popBlock(block, 3);
+        for (int i = 0; i < n; i++) ordered &= block[i] == expected++;
+        n = ring.popBlock(block, 5);
+        for (int i = 0; i < n; i++) ordered &= block[i] == expected++;
+    }
+    check(ordered && expected == next, "block pops keep order across wraps");
+    check(ring.popBlock(block, 0) == 0, "popBlock with no room removes nothing");
+}
+
+static void retryingStress() {
+    static SpscRingBuffer<SensorData, 256> ring;
+    std::thread producer([] {
+        for (uint32_t seq = 0; seq < STRESS_FRAMES; seq++) {
+            SensorData data = frame(seq);
+            while (!ring.push(data)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    
+    uint32_t expected = 0;
+    bool ordered = true, whole = true;
+    SensorData block[32];
+    while (expected < STRESS_FRAMES) {
+        int n = ring.popBlock(block, 32);
+        for (int i = 0; i < n; i++) {
+            ordered &= block[i].timestampUs == expected++;
+            whole &= intact(block[i]);
+        }
+        if (n == 0) std::this_thread::yield();
+    }
+    producer.join();
+    printf("  retrying producer: %u frames, %u full rejections\n", expected, ring.getDropped());
+    check(ordered, "stress: every frame arrives in order");
+    check(whole, "stress: no torn frames");
+    check(ring.empty(), "stress: ring drained");
+}
+
+static void droppingStress() {
+    static SpscRingBuffer<SensorData, 64> ring;
+    std::thread producer([] {
+        for (uint32_t seq = 0; seq < STRESS_FRAMES; seq++) {
+            ring.push(frame(seq));
+        }
+    });
+    
+    uint32_t received = 0;
+    uint32_t last = 0;
+    bool ordered = true, whole = true, first = true;
+    SensorData data;
+    while (true) {
+        if (ring.pop(data)) {
+            ordered &= first || data.timestampUs > last;
+            whole &= intact(data);
+            last = data.timestampUs;
+            first = false;
+            received++;
+            if (last == STRESS_FRAMES - 1) break;
+        } else if (received + ring.getDropped() >= STRESS_FRAMES) {
+            break;
+        }
+    }
+    producer.join();
+    while (ring.pop(data)) received++;
+    printf("  dropping producer: %u received, %u dropped\n", received, ring.getDropped());
+    check(ordered && whole, "drop mode: order kept, no torn frames");
+    check(received + ring.getDropped() == STRESS_FRAMES, "drop mode: received + dropped = pushed");
+}
+
+static void sampleSourceFromThread() {
+    static RingSampleSource source;
+    const uint32_t count = 50000;
+    std::thread producer([count] {
+        for (uint32_t seq = 0; seq < count; seq++) {
+            while (!source.push(frame(seq))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    
+    SensorData block[16];
+    uint32_t expected = 0;
+    bool ordered = true;
+    while (expected < count) {
+        int n = source.readSamples(block, 16);
+        for (int i = 0; i < n; i++) ordered &= block[i].timestampUs == expected++;
+    }
+    producer.join();
+    check(ordered && source.isPaced() && source.isTimestamped(),
+          "RingSampleSource delivers thread-pushed samples in order");
+}
+
+int main() {
+    printf("=== SPSC ring buffer test ===\n");
+    singleThreadTests();
+    retryingStress();
+    droppingStress();
+    sampleSourceFromThread();
+    return testSummary();
+}
@@ -0,0 +1,37 @@
+/**
+ * @file test_util.h
+ * @brief Check and summary helpers shared by the native tests and benchmarks
+ * 
+ * Each test is a standalone program: check() prints one PASS/FAIL line
+ * per condition, and testSummary() prints the closing line and gives
+ * main() its exit code.
+ */
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <cstdio>
+
+static int failures = 0;    // Failed checks so far
+
+/**
+ * @brief Print the outcome of one check and count a failure
+ * @param condition true if the check passed
+ * @param name Description printed with the outcome
+ */
+static void check(bool condition, const char* name) {
+    printf("  %s: %s\n", name, condition ? "PASS" : "FAIL");
+    if (!condition) failures++;
+}
+
+/**
+ * @brief Print the summary line
+ * @return Exit code: 0 if every check passed, 1 otherwise
+ */
+static int testSummary() {
+    printf("=== %s (%d failure%s) ===\n", failures ? "FAILED" : "ALL PASSED",
+           failures, failures == 1 ? "" : "s");
+    return failures ? 1 : 0;
+}
+
+#endif // TEST_UTIL_H